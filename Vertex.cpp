@@ -131,6 +131,9 @@ int main(int argc, char*argv[])
 
     //run for additional timesteps, and record timing information. Save frames to a database if desired
     cudaProfilerStart();
+#ifdef ENABLE_PROFILING
+    regionProfiler::reset();
+#endif
     t1=clock();
     for (int timestep = 0; timestep < tSteps; ++timestep)
         {
@@ -148,6 +151,10 @@ int main(int argc, char*argv[])
     cout << "timestep time per iteration currently at " <<  (t2-t1)/(double)CLOCKS_PER_SEC/tSteps << endl << endl;
     avm->reportMeanVertexForce();
     cout << "Mean q = " << avm->reportq() << endl;
+#ifdef ENABLE_PROFILING
+    regionProfiler::printSummary();
+    regionProfiler::writeChromeTrace("vertexTrace.json");
+#endif
 
     /*
     {
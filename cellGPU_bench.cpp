@@ -0,0 +1,558 @@
+#include "std_include.h"
+
+#include "cuda_runtime.h"
+#include "cuda_profiler_api.h"
+
+#include <chrono>
+#include <functional>
+#include <fstream>
+
+#include "Simulation.h"
+#include "voronoiQuadraticEnergy.h"
+#include "vertexQuadraticEnergy.h"
+#include "cellListGPU.h"
+#include "DelaunayGPU.h"
+#include "DelaunayCPU.h"
+#include "brownianParticleDynamics.h"
+#include "langevinDynamics.h"
+#include "NoseHooverChainNVT.h"
+#include "velocityVerlet.h"
+#include "selfPropelledParticleDynamics.h"
+#include "selfPropelledAligningParticleDynamics.h"
+#include "selfPropelledVicsekAligningParticleDynamics.h"
+#include "selfPropelledCellVertexDynamics.h"
+#include "EnergyMinimizerFIRE2D.h"
+#include "simpleVoronoiDatabase.h"
+#include "simpleVertexDatabase.h"
+#include "analysisPackage.h"
+
+/*!
+This file compiles to produce the cellGPU_bench executable, a reproducible set of micro-benchmarks
+(single routines: forces, geometry, test-and-repair, global triangulation, cell lists, Hilbert
+sorting, HDF5 writes and analysis routines) and whole-step benchmarks (one Simulation::performTimestep
+with each equation of motion, and a FIRE iteration) for the voronoi and vertex models.
+
+The number of cells is swept over decades (by default from 10^3 to 10^6) and, on the CPU, the number
+of openMP threads over powers of two up to all available cores. Every (benchmark, N, threads) case is
+run once to warm up and then timed repeatedly, until either the requested number of samples or the
+time budget of the case is reached. The results are written as JSON: the median, mean, minimum and
+10th/90th/99th percentiles of the time per call, the calls (time steps) per second, and the number of
+bytes each call moves. The latter is an estimate of the compulsory memory traffic -- every array a
+routine reads or writes counted once, and gathers of neighbor data counted per neighbor -- except for
+the HDF5 benchmarks, where it is the measured growth of the file. A typical use is
+    cellGPU_bench -n 1000 -m 100000 -t 8 -o before.json
+and similarly after a change, comparing the two files. The "-f" option restricts the run to the
+benchmarks whose names contain the given string, e.g. "-f voronoi/" or "-f step".
+*/
+
+//!The wall-clock time in seconds
+double wallTime()
+    {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    };
+
+//!The timing statistics of one (benchmark, N, threads) case
+struct benchmarkResult
+    {
+    string name;
+    //!"micro" for single routines, "step" for complete time steps
+    string category;
+    int N;
+    int threads;
+    int samples;
+    double median, mean, minimum, p10, p90, p99;
+    double bytesMoved;
+    };
+
+//!The linearly interpolated q-th quantile of a sorted vector
+double quantile(const vector<double> &sorted, double q)
+    {
+    double position = q*(sorted.size()-1);
+    int lower = (int)floor(position);
+    int upper = min(lower+1,(int)sorted.size()-1);
+    return sorted[lower] + (position-lower)*(sorted[upper]-sorted[lower]);
+    };
+
+//!Times operations and collects the results
+class benchmarkRunner
+    {
+    public:
+        benchmarkRunner(int _repeats, double _budget, string _filter, bool _gpu)
+            {
+            repeats = _repeats;
+            budget = _budget;
+            filter = _filter;
+            gpu = _gpu;
+            };
+
+        //!Set the system size and thread count that subsequent measurements are labeled with
+        void setCase(int _N, int _threads){N = _N; threads = _threads;};
+
+        //!Does the benchmark with this name pass the filter?
+        bool selected(const string &name)
+            {
+            return filter.empty() || name.find(filter) != string::npos;
+            };
+
+        /*!
+        Might a benchmark whose name starts with prefix pass the filter? Filters without a "/" (e.g.
+        "forces" or "step") can match in any group, those with one only in the group they name
+        */
+        bool wanted(const string &prefix)
+            {
+            if(filter.empty() || filter.find('/') == string::npos)
+                return true;
+            return filter.find(prefix) == 0 || prefix.find(filter) == 0;
+            };
+
+        /*!
+        Time operation, calling prepare (untimed) before every call. Returns false if the benchmark
+        was filtered out
+        */
+        bool measure(const string &name, const string &category, double bytes, function<void()> operation,
+                     function<void()> prepare = [](){})
+            {
+            if(!selected(name))
+                return false;
+            prepare();
+            operation();
+            synchronize();
+            calls = 1;
+
+            vector<double> times;
+            double elapsed = 0.0;
+            while((int)times.size() < repeats && (elapsed < budget || times.size() < 3))
+                {
+                prepare();
+                synchronize();
+                double t1 = wallTime();
+                operation();
+                synchronize();
+                double dt = wallTime()-t1;
+                times.push_back(dt);
+                elapsed += dt;
+                calls += 1;
+                };
+            sort(times.begin(),times.end());
+
+            benchmarkResult result;
+            result.name = name;
+            result.category = category;
+            result.N = N;
+            result.threads = threads;
+            result.samples = times.size();
+            result.median = quantile(times,0.5);
+            result.minimum = times[0];
+            result.p10 = quantile(times,0.1);
+            result.p90 = quantile(times,0.9);
+            result.p99 = quantile(times,0.99);
+            result.mean = 0.0;
+            for (size_t ii = 0; ii < times.size(); ++ii)
+                result.mean += times[ii]/times.size();
+            result.bytesMoved = bytes;
+            results.push_back(result);
+            printf("%-44s N = %8i threads = %3i: median %.4e s (p10 %.4e, p90 %.4e), %i samples\n",
+                   name.c_str(),N,threads,result.median,result.p10,result.p90,result.samples);
+            return true;
+            };
+
+        //!Write every result, and the settings of the run, to a JSON file
+        void writeJSON(const string &fileName)
+            {
+            FILE *output = fopen(fileName.c_str(),"w");
+            if(output == NULL)
+                {
+                printf("could not open %s for writing\n",fileName.c_str());
+                throw std::exception();
+                };
+            fprintf(output,"{\n  \"settings\": {\"gpu\": %s, \"hardware_threads\": %i, \"repeats\": %i, \"time_budget_s\": %g, \"filter\": \"%s\"},\n",
+                    gpu ? "true" : "false",omp_get_num_procs(),repeats,budget,filter.c_str());
+            fprintf(output,"  \"results\": [\n");
+            for (size_t ii = 0; ii < results.size(); ++ii)
+                {
+                benchmarkResult &r = results[ii];
+                fprintf(output,"    {\"name\": \"%s\", \"category\": \"%s\", \"N\": %i, \"threads\": %i, \"samples\": %i, "
+                        "\"median_s\": %.6e, \"mean_s\": %.6e, \"min_s\": %.6e, \"p10_s\": %.6e, \"p90_s\": %.6e, \"p99_s\": %.6e, "
+                        "\"steps_per_s\": %.6e, \"bytes_moved\": %.6e, \"bandwidth_GBps\": %.6e}%s\n",
+                        r.name.c_str(),r.category.c_str(),r.N,r.threads,r.samples,r.median,r.mean,r.minimum,r.p10,
+                        r.p90,r.p99,1.0/r.median,r.bytesMoved,1e-9*r.bytesMoved/r.median,
+                        (ii+1 < results.size()) ? "," : "");
+                };
+            fprintf(output,"  ]\n}\n");
+            fclose(output);
+            };
+
+        vector<benchmarkResult> results;
+        //!The number of calls (including the warm-up) made by the most recent measurement
+        int calls;
+
+    protected:
+        void synchronize()
+            {
+            if(gpu)
+                cudaDeviceSynchronize();
+            };
+
+        int repeats;
+        double budget;
+        string filter;
+        bool gpu;
+        int N;
+        int threads;
+    };
+
+//!The size of a file, in bytes
+double fileSize(const string &fileName)
+    {
+    std::ifstream file(fileName,std::ios::binary | std::ios::ate);
+    return file.good() ? (double)file.tellg() : 0.0;
+    };
+
+//!Fill an array with small random displacements
+void randomDisplacements(GPUArray<double2> &displacements, int n, double scale, noiseSource &noise)
+    {
+    displacements.resize(n);
+    ArrayHandle<double2> h_d(displacements,access_location::host,access_mode::overwrite);
+    for (int ii = 0; ii < n; ++ii)
+        h_d.data[ii] = make_double2(noise.getRealUniform(-scale,scale),noise.getRealUniform(-scale,scale));
+    };
+
+//!Builds one equation of motion
+typedef function<shared_ptr<updater>()> updaterFactory;
+
+/*!
+Build, for each equation of motion that has a selected "prefix/step/name" benchmark, the updater and a
+Simulation advancing model with it. Unselected ones are never constructed, so that, e.g., "-f voronoi/forces"
+does not pay for (or trip over) the set-up of every integrator
+*/
+void buildSimulations(benchmarkRunner &runner, const string &prefix, ForcePtr model,
+                      const vector<pair<string,updaterFactory> > &factories, bool gpu, double dt,
+                      vector<shared_ptr<updater> > &updaters, vector<string> &updaterNames,
+                      vector<SimulationPtr> &simulations)
+    {
+    for (size_t ff = 0; ff < factories.size(); ++ff)
+        {
+        if(!runner.selected(prefix+"/step/"+factories[ff].first))
+            continue;
+        updaters.push_back(factories[ff].second());
+        updaterNames.push_back(factories[ff].first);
+        SimulationPtr simulation = make_shared<Simulation>();
+        simulation->setConfiguration(model);
+        simulation->addUpdater(updaters.back(),model);
+        simulation->setIntegrationTimestep(dt);
+        simulation->setCPUOperation(!gpu);
+        simulation->setReproducible(true);
+        simulations.push_back(simulation);
+        };
+    };
+
+//!A FIRE minimizer of model set up to take single steps, or a null pointer if "prefix/step/FIRE" is not selected
+shared_ptr<EnergyMinimizerFIRE> buildFIRE(benchmarkRunner &runner, const string &prefix, ForcePtr model, bool gpu, double dt)
+    {
+    if(!runner.selected(prefix+"/step/FIRE"))
+        return nullptr;
+    shared_ptr<EnergyMinimizerFIRE> fire = make_shared<EnergyMinimizerFIRE>(model,gpu);
+    if(!gpu)
+        fire->setCPU();
+    fire->setDeltaT(dt);
+    fire->setMaximumIterations(0);
+    fire->minimize();
+    return fire;
+    };
+
+/*!
+Benchmarks of the voronoi model, its equations of motion, and of the cell list, triangulation, database
+and analysis routines that act on its cell positions. Per call byte estimates use the fact that the
+Delaunay triangulation of N points on a torus has exactly 6N directed edges and 2N triangles
+*/
+void voronoiBenchmarks(benchmarkRunner &runner, int N, const vector<int> &threadCounts, bool gpu,
+                       double dt, int maximumPairN, const string &scratchFile)
+    {
+    noiseSource noise;
+    noise.setReproducible(true);
+    double n = (double)N;
+    printf("initializing a voronoi model of %i cells\n",N);
+    shared_ptr<VoronoiQuadraticEnergy> model = make_shared<VoronoiQuadraticEnergy>(N,1.0,3.8,true,gpu);
+    model->setv0Dr(0.05,1.0);
+    model->setCellVelocitiesMaxwellBoltzmann(0.01);
+
+    //one simulation per selected equation of motion, all sharing the same model
+    vector<pair<string,updaterFactory> > factories = {
+        {"brownian",[&](){return make_shared<brownianParticleDynamics>(N,gpu);}},
+        {"langevin",[&](){return make_shared<langevinDynamics>(N,0.01,1.0,gpu);}},
+        {"noseHooverNVT",[&](){return make_shared<NoseHooverChainNVT>(N,2,gpu);}},
+        {"velocityVerlet",[&](){return make_shared<velocityVerlet>(N,gpu);}},
+        {"selfPropelled",[&](){return make_shared<selfPropelledParticleDynamics>(N,gpu);}},
+        {"selfPropelledAligning",[&](){return make_shared<selfPropelledAligningParticleDynamics>(N,gpu);}},
+        {"selfPropelledVicsek",[&](){return make_shared<selfPropelledVicsekAligningParticleDynamics>(N,0.0,1.0,gpu);}}};
+    vector<shared_ptr<updater> > updaters;
+    vector<string> updaterNames;
+    vector<SimulationPtr> simulations;
+    buildSimulations(runner,"voronoi",model,factories,gpu,dt,updaters,updaterNames,simulations);
+    shared_ptr<EnergyMinimizerFIRE> fire = buildFIRE(runner,"voronoi",model,gpu,dt);
+
+    cellListGPU cellList;
+    cellList.GPUcompute = gpu;
+    cellList.setNp(N);
+    cellList.setBox(model->Box);
+    cellList.setGridSize(1.0);
+    //the triangulation routines are timed on their own, writing to scratch neighbor lists
+    DelaunayGPU delaunayGPU;
+    delaunayGPU.initialize(N,16,1.0,model->Box,gpu);
+    delaunayGPU.setGPUcompute(gpu);
+    DelaunayCPU delaunayCPU(model->Box);
+    GPUArray<int> scratchNeighbors, scratchNeighborNum;
+    scratchNeighborNum.resize(N);
+    //Simulations sort through the configuration base class, as done here
+    shared_ptr<Simple2DModel> configuration = model;
+
+    GPUArray<double2> displacements;
+    randomDisplacements(displacements,N,0.01,noise);
+    double sign = 1.0;
+    Index2D n_idx = model->n_idx;
+
+    //the per-call traffic of the component routines, in bytes
+    double geometryBytes = n*(16+4+4+16) + 6*n*(4+16+16+32);
+    double forceBytes = geometryBytes + 6*n*(8+4+48+16+32+16+8) + n*(32+16) + 6*n*16;
+    double cellListBytes = n*(16+4+4+8) + 4*n;
+    double repairBytes = cellListBytes + 6*n*4 + 2*n*(12+3*16+9*(4+16));
+    double triangulationBytes = cellListBytes + n*16 + 6*n*(4+16+16);
+    double integratorBytes = n*(16+16+16+16+8);
+
+    for (size_t tt = 0; tt < threadCounts.size(); ++tt)
+        {
+        int threads = threadCounts[tt];
+        runner.setCase(N,threads);
+        if(!gpu)
+            {
+            model->setOmpThreads(threads);
+            for (size_t uu = 0; uu < updaters.size(); ++uu)
+                updaters[uu]->setOmpThreads(threads);
+            if(fire)
+                fire->setOmpThreads(threads);
+            cellList.setOmpThreads(threads);
+            delaunayGPU.setOmpThreads(threads);
+            delaunayCPU.setOmpThreads(threads);
+            };
+
+        runner.measure("voronoi/geometry","micro",geometryBytes,[&](){model->computeGeometry();});
+        runner.measure("voronoi/forces","micro",forceBytes,
+                       [&](){model->computeForces();},[&](){model->forcesUpToDate = false;});
+        runner.measure("voronoi/testAndRepair","micro",repairBytes,
+                       [&](){model->enforceTopology();},
+                       [&](){model->moveDegreesOfFreedom(displacements,sign); sign = -sign;});
+        runner.measure("voronoi/globalTriangulation/DelaunayGPU","micro",triangulationBytes,
+                       [&](){delaunayGPU.globalDelaunayTriangulation(model->cellPositions,scratchNeighbors,scratchNeighborNum);});
+        if(!gpu)
+            runner.measure("voronoi/globalTriangulation/DelaunayCPU","micro",triangulationBytes,
+                           [&](){delaunayCPU.periodicTriangulation(model->cellPositions);});
+        if(gpu)
+            runner.measure("cellList","micro",cellListBytes,[&](){cellList.computeGPU(model->cellPositions);});
+        else
+            runner.measure("cellList","micro",cellListBytes,[&](){cellList.compute(model->cellPositions);});
+        //every per-cell array is read and written once
+        runner.measure("voronoi/hilbertSort","micro",2*n*(16+16+16+16+8+8+16+4),[&](){configuration->spatialSorting();});
+
+        for (size_t uu = 0; uu < simulations.size(); ++uu)
+            runner.measure("voronoi/step/"+updaterNames[uu],"step",forceBytes+repairBytes+integratorBytes,
+                           [&](){simulations[uu]->performTimestep();});
+        if(fire)
+            runner.measure("voronoi/step/FIRE","step",forceBytes+repairBytes+integratorBytes+3*n*16,
+                           [&](){fire->velocityVerlet(); fire->fireStep();});
+
+        //databases and analysis routines do not depend on the number of threads the model uses
+        if(tt > 0)
+            continue;
+        if(runner.selected("voronoi/hdf5Write"))
+            {
+            std::remove(scratchFile.c_str());
+                {
+                simpleVoronoiDatabase database(N,scratchFile,fileMode::replace);
+                runner.measure("voronoi/hdf5Write","micro",0.0,[&](){database.writeState(model);});
+                }
+            runner.results.back().bytesMoved = fileSize(scratchFile)/runner.calls;
+            std::remove(scratchFile.c_str());
+            };
+
+        dynamicalFeatures dynamics(model->cellPositions,model->Box);
+        structuralFeatures structure(model->Box);
+        runner.measure("analysis/msd","micro",n*(16+16),[&](){dynamics.computeMSD(model->cellPositions);});
+        runner.measure("analysis/overlap","micro",n*(16+16),[&](){dynamics.computeOverlapFunction(model->cellPositions);});
+        runner.measure("analysis/sisf","micro",n*(16+16),[&](){dynamics.computeSISF(model->cellPositions);});
+        runner.measure("analysis/FsChi4","micro",n*(16+16),[&](){dynamics.computeFsChi4(model->cellPositions);});
+        runner.measure("analysis/bondOrder","micro",n*(16+4)+6*n*(4+16),
+                       [&](){structure.computeBondOrderParameter(model->cellPositions,model->neighbors,model->neighborNum,n_idx);});
+        if(runner.selected("analysis/multiOriginDynamics"))
+            {
+            multiOriginDynamics multiOrigin(model->cellPositions,model->Box);
+            runner.measure("analysis/multiOriginDynamics","micro",n*(16+16),[&](){multiOrigin.update(model->cellPositions);});
+            };
+        //the pair-sum routines are quadratic in N
+        if(N <= maximumPairN)
+            {
+            vector<double2> points(N);
+                {
+                ArrayHandle<double2> h_p(model->cellPositions,access_location::host,access_mode::read);
+                for (int ii = 0; ii < N; ++ii)
+                    points[ii] = h_p.data[ii];
+                }
+            vector<double2> result;
+            runner.measure("analysis/radialDistributionFunction","micro",n*16,
+                           [&](){structure.computeRadialDistributionFunction(points,result);});
+            runner.measure("analysis/structureFactor","micro",n*16,
+                           [&](){structure.computeStructureFactor(points,result);});
+            };
+        };
+    };
+
+/*!
+Benchmarks of the vertex model and its equations of motion. There are 2N vertices, each with three
+cells and three vertex neighbors, so 6N (cell,vertex) pairs
+*/
+void vertexBenchmarks(benchmarkRunner &runner, int N, const vector<int> &threadCounts, bool gpu,
+                      double dt, const string &scratchFile)
+    {
+    noiseSource noise;
+    noise.setReproducible(true);
+    double n = (double)N;
+    printf("initializing a vertex model of %i cells\n",N);
+    shared_ptr<VertexQuadraticEnergy> model = make_shared<VertexQuadraticEnergy>(N,1.0,3.8,true,false,gpu);
+    model->setv0Dr(0.05,1.0);
+    model->setT1Threshold(0.04);
+    int Nvertices = model->getNumberOfDegreesOfFreedom();
+
+    vector<pair<string,updaterFactory> > factories = {
+        {"brownian",[&](){return make_shared<brownianParticleDynamics>(Nvertices,gpu);}},
+        {"selfPropelledCellVertex",[&](){return make_shared<selfPropelledCellVertexDynamics>(N,Nvertices,gpu);}}};
+    vector<shared_ptr<updater> > updaters;
+    vector<string> updaterNames;
+    vector<SimulationPtr> simulations;
+    buildSimulations(runner,"vertex",model,factories,gpu,dt,updaters,updaterNames,simulations);
+    shared_ptr<EnergyMinimizerFIRE> fire = buildFIRE(runner,"vertex",model,gpu,dt);
+
+    GPUArray<double2> displacements;
+    randomDisplacements(displacements,Nvertices,0.005,noise);
+    double sign = 1.0;
+
+    double geometryBytes = n*(4+16) + 6*n*(4+16+12+16+32);
+    double forceBytes = geometryBytes + 6*n*(16+32+16+16) + 2*n*(48+16);
+    double T1Bytes = 6*n*(4+32);
+    double integratorBytes = 2*n*(16+16+16);
+
+    for (size_t tt = 0; tt < threadCounts.size(); ++tt)
+        {
+        int threads = threadCounts[tt];
+        runner.setCase(N,threads);
+        if(!gpu)
+            {
+            model->setOmpThreads(threads);
+            for (size_t uu = 0; uu < updaters.size(); ++uu)
+                updaters[uu]->setOmpThreads(threads);
+            if(fire)
+                fire->setOmpThreads(threads);
+            };
+
+        runner.measure("vertex/geometry","micro",geometryBytes,[&](){model->computeGeometry();});
+        runner.measure("vertex/forces","micro",forceBytes,
+                       [&](){model->computeForces();},[&](){model->forcesUpToDate = false;});
+        runner.measure("vertex/T1","micro",T1Bytes,
+                       [&](){model->enforceTopology();},
+                       [&](){model->moveDegreesOfFreedom(displacements,sign); sign = -sign;});
+        runner.measure("vertex/hilbertSort","micro",2*2*n*(16+16+16+8+8+12+12),[&](){model->spatialSorting();});
+        for (size_t uu = 0; uu < simulations.size(); ++uu)
+            runner.measure("vertex/step/"+updaterNames[uu],"step",forceBytes+T1Bytes+integratorBytes,
+                           [&](){simulations[uu]->performTimestep();});
+        if(fire)
+            runner.measure("vertex/step/FIRE","step",forceBytes+T1Bytes+integratorBytes+3*2*n*16,
+                           [&](){fire->velocityVerlet(); fire->fireStep();});
+
+        if(tt == 0 && runner.selected("vertex/hdf5Write"))
+            {
+            std::remove(scratchFile.c_str());
+                {
+                simpleVertexDatabase database(Nvertices,scratchFile,fileMode::replace);
+                runner.measure("vertex/hdf5Write","micro",0.0,[&](){database.writeState(model);});
+                }
+            runner.results.back().bytesMoved = fileSize(scratchFile)/runner.calls;
+            std::remove(scratchFile.c_str());
+            };
+        };
+    };
+
+int main(int argc, char*argv[])
+{
+    int minimumN = 1000; //the smallest system size
+    int maximumN = 1000000; //the largest system size
+    int stepsPerDecade = 1; //system sizes per decade of N
+    int maximumThreads = omp_get_max_threads(); //the largest number of threads
+    int USE_GPU = -1; //0 or greater runs on that gpu, any negative number on the cpu
+    int repeats = 20; //the maximum number of timed calls per case
+    double budget = 2.0; //the time, in seconds, after which no more calls of a case are made (at least three are)
+    int maximumPairN = 20000; //the largest N for which the O(N^2) analysis routines are run
+    double dt = 0.01; //the time step of the whole-step benchmarks
+    string filter = ""; //only run benchmarks whose names contain this
+    string outputFile = "cellGPU_bench.json";
+    string scratchFile = "cellGPU_bench_scratch.h5";
+    int c;
+    while((c=getopt(argc,argv,"n:m:d:t:g:r:b:p:e:f:o:s:")) != -1)
+        switch(c)
+        {
+            case 'n': minimumN = atoi(optarg); break;
+            case 'm': maximumN = atoi(optarg); break;
+            case 'd': stepsPerDecade = atoi(optarg); break;
+            case 't': maximumThreads = atoi(optarg); break;
+            case 'g': USE_GPU = atoi(optarg); break;
+            case 'r': repeats = atoi(optarg); break;
+            case 'b': budget = atof(optarg); break;
+            case 'p': maximumPairN = atoi(optarg); break;
+            case 'e': dt = atof(optarg); break;
+            case 'f': filter = optarg; break;
+            case 'o': outputFile = optarg; break;
+            case 's': scratchFile = optarg; break;
+            case '?':
+                    if(isprint(optopt))
+                        std::cerr<<"Unknown option '-" << optopt << "'.\n";
+                    else
+                        std::cerr << "Unknown option character.\n";
+                    return 1;
+            default:
+                       abort();
+        };
+
+    bool gpu = chooseGPU(USE_GPU);
+
+    //log-spaced system sizes, and threads counts 1,2,4,... and all of them
+    vector<int> sizes;
+    for (int ii = 0; ; ++ii)
+        {
+        int N = (int)round(minimumN*pow(10.0,(double)ii/stepsPerDecade));
+        if(N > maximumN)
+            break;
+        sizes.push_back(N);
+        };
+    vector<int> threadCounts;
+    if(gpu)
+        threadCounts.push_back(1);
+    else
+        {
+        for (int t = 1; t < maximumThreads; t *= 2)
+            threadCounts.push_back(t);
+        threadCounts.push_back(maximumThreads);
+        };
+
+    benchmarkRunner runner(repeats,budget,filter,gpu);
+    for (size_t ii = 0; ii < sizes.size(); ++ii)
+        {
+        if(runner.wanted("voronoi/") || runner.wanted("cellList") || runner.wanted("analysis/"))
+            voronoiBenchmarks(runner,sizes[ii],threadCounts,gpu,dt,maximumPairN,scratchFile);
+        if(runner.wanted("vertex/"))
+            vertexBenchmarks(runner,sizes[ii],threadCounts,gpu,dt,scratchFile);
+        //write after every system size, so that long sweeps can be inspected as they run
+        runner.writeJSON(outputFile);
+        };
+    printf("wrote %lu results to %s\n",runner.results.size(),outputFile.c_str());
+
+    if(gpu)
+        cudaDeviceReset();
+    return 0;
+};
@@ -0,0 +1,134 @@
+#include "std_include.h"
+
+#include "Ensemble.h"
+#include "vertexQuadraticEnergy.h"
+#include "voronoiQuadraticEnergy.h"
+#include "brownianParticleDynamics.h"
+#include "ensembleDatabase.h"
+
+/*!
+This file compiles to produce an executable that runs a parameter sweep as one Ensemble: a grid of
+p0 values (-p to -P, in -k steps) by v0 values (-v to -V, in -l steps) by -s seeds, each an independent
+small system of -n cells. As in Vertex.cpp, the dynamics are brownian dynamics of the degrees of freedom
+at a temperature set by v0. All replicas are advanced concurrently by -w threads, and every -f time steps
+of the production run the state of every replica is appended to a single hdf5 file (-o), whose header
+also records the p0, v0 and seed of each replica.
+-z 0 runs the vertex model, -z 1 the Voronoi model.
+Every replica starts from the same reproducible random configuration, and its own noise (seeded by
+its index) decorrelates it from the others during the -i initialization time steps.
+*/
+int main(int argc, char*argv[])
+{
+    int numpts = 400; //number of cells per replica
+    int threads = 1; //number of replicas advanced concurrently
+    int tSteps = 1000; //number of time steps to run after initialization
+    int initSteps = 100; //number of initialization steps
+    int saveEvery = 100; //time steps between saved frames
+    int seeds = 4; //replicas per (p0,v0) point
+    int program_switch = 0; //0: vertex model, 1: voronoi model
+
+    double dt = 0.01; //the time step size
+    double p0Min = 3.7, p0Max = 4.0;
+    int p0Points = 4;
+    double v0Min = 0.01, v0Max = 0.1;
+    int v0Points = 2;
+    string outputName = "ensembleSweep.h5";
+
+    int c;
+    while((c=getopt(argc,argv,"n:w:t:i:f:s:z:e:p:P:k:v:V:l:o:")) != -1)
+        switch(c)
+        {
+            case 'n': numpts = atoi(optarg); break;
+            case 'w': threads = atoi(optarg); break;
+            case 't': tSteps = atoi(optarg); break;
+            case 'i': initSteps = atoi(optarg); break;
+            case 'f': saveEvery = atoi(optarg); break;
+            case 's': seeds = atoi(optarg); break;
+            case 'z': program_switch = atoi(optarg); break;
+            case 'e': dt = atof(optarg); break;
+            case 'p': p0Min = atof(optarg); break;
+            case 'P': p0Max = atof(optarg); break;
+            case 'k': p0Points = atoi(optarg); break;
+            case 'v': v0Min = atof(optarg); break;
+            case 'V': v0Max = atof(optarg); break;
+            case 'l': v0Points = atoi(optarg); break;
+            case 'o': outputName = optarg; break;
+            case '?':
+                    if(optopt=='c')
+                        std::cerr<<"Option -" << optopt << "requires an argument.\n";
+                    else if(isprint(optopt))
+                        std::cerr<<"Unknown option '-" << optopt << "'.\n";
+                    else
+                        std::cerr << "Unknown option character.\n";
+                    return 1;
+            default:
+                       abort();
+        };
+    bool reproducible = true;
+    bool vertexModel = (program_switch == 0);
+    int degreesOfFreedom = vertexModel ? 2*numpts : numpts;
+
+    //build every replica as in Vertex.cpp or voronoi.cpp, on the CPU
+    Ensemble ensemble(threads);
+    vector<double> replicaP0, replicaV0;
+    for (int pp = 0; pp < p0Points; ++pp)
+        for (int vv = 0; vv < v0Points; ++vv)
+            for (int ss = 0; ss < seeds; ++ss)
+                {
+                double p0 = (p0Points > 1) ? p0Min + (p0Max-p0Min)*pp/(p0Points-1) : p0Min;
+                double v0 = (v0Points > 1) ? v0Min + (v0Max-v0Min)*vv/(v0Points-1) : v0Min;
+                ForcePtr model;
+                if(vertexModel)
+                    {
+                    shared_ptr<VertexQuadraticEnergy> avm = make_shared<VertexQuadraticEnergy>(numpts,1.0,p0,reproducible,false,false);
+                    avm->setCellPreferencesUniform(1.0,p0);
+                    avm->setT1Threshold(0.04);
+                    model = avm;
+                    }
+                else
+                    {
+                    shared_ptr<VoronoiQuadraticEnergy> spv = make_shared<VoronoiQuadraticEnergy>(numpts,1.0,p0,reproducible,false);
+                    spv->setCellPreferencesUniform(1.0,p0);
+                    model = spv;
+                    };
+                shared_ptr<brownianParticleDynamics> bd = make_shared<brownianParticleDynamics>(degreesOfFreedom,false);
+                bd->setT(v0);
+
+                SimulationPtr sim = make_shared<Simulation>();
+                sim->setConfiguration(model);
+                sim->addUpdater(bd,model);
+                sim->setIntegrationTimestep(dt);
+                sim->setCPUOperation(true);
+                sim->setReproducible(reproducible);
+                ensemble.addReplica(sim,model,{bd});
+                replicaP0.push_back(p0);
+                replicaV0.push_back(v0);
+                };
+    printf("running %i replicas of %i cells with %i threads\n",ensemble.size(),numpts,threads);
+
+    ensemble.performTimesteps(initSteps);
+    printf("initialization: %g replica time steps per second\n",ensemble.lastThroughput);
+
+    ensembleDatabase output(ensemble.size(),degreesOfFreedom,outputName,fileMode::replace);
+    output.addHeaderData("p0",replicaP0);
+    output.addHeaderData("v0",replicaV0);
+    output.addHeaderData("seed",ensemble.getSeeds());
+    output.writeState(ensemble.getConfigurations());
+    double wallTime = 0.0;
+    for (int timestep = 0; timestep < tSteps; timestep += saveEvery)
+        {
+        ensemble.performTimesteps(min(saveEvery,tSteps-timestep));
+        wallTime += ensemble.lastWallTime;
+        output.writeState(ensemble.getConfigurations());
+        };
+    printf("production: %g replica time steps per second\n",(double)tSteps*ensemble.size()/wallTime);
+
+    double meanQ = 0.0;
+    for (int rr = 0; rr < ensemble.size(); ++rr)
+        meanQ += ensemble.getConfiguration(rr)->reportq()/ensemble.size();
+    cout << "mean q over the ensemble = " << meanQ << endl;
+#ifdef ENABLE_PROFILING
+    regionProfiler::printSummary();
+#endif
+    return 0;
+};
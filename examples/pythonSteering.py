@@ -0,0 +1,39 @@
+"""
+Drive a Voronoi model from python through the cellGPU module (build with -DPYTHON_BINDINGS=ON, and put
+the build directory on PYTHONPATH). Every few time steps the positions are analyzed in place, and the
+simulation is steered by shearing the cells in the middle of the box -- without copies or file I/O.
+"""
+import numpy as np
+import cellGPU
+
+N = 400
+model = cellGPU.VoronoiQuadraticEnergy(N, 1.0, 3.8, reproducible=True, usegpu=False)
+model.setCellPreferencesUniform(1.0, 3.8)
+bd = cellGPU.brownianParticleDynamics(N, usegpu=False)
+bd.setT(0.01)
+
+sim = cellGPU.Simulation()
+sim.setConfiguration(model)
+sim.addUpdater(bd, model)
+sim.setIntegrationTimestep(0.01)
+sim.setCPUOperation(True)
+sim.setReproducible(True)
+
+trajectory = cellGPU.mappedTrajectoryDatabase("pythonSteering.cgt", cellGPU.fileMode.replace)
+Lx = model.box()[0]
+for block in range(20):
+    sim.performTimesteps(50)
+    #a read-only view: x is a NumPy array over the model's own memory
+    with model.positions() as x, model.areaPeri() as ap:
+        print("t = %g, mean shape index %f, max |y| %f" % (sim.Time, np.mean(ap[:,1]/np.sqrt(ap[:,0])), np.abs(x[:,1]).max()))
+    #a writable view: views must be closed (here, by the with block) before the simulation advances
+    with model.positions(cellGPU.access_mode.readwrite) as x:
+        middle = np.abs(x[:,1] - 0.5*Lx) < 0.1*Lx
+        x[middle,0] = np.mod(x[middle,0] + 0.01, Lx)
+    trajectory.writeState(model)
+trajectory.flush()
+
+#frames of the trajectory are zero-copy, read-only views of the mapped file
+frames = cellGPU.mappedTrajectoryDatabase("pythonSteering.cgt")
+first, last = frames.frame(0), frames.frame(-1)
+print("displacement along x over %d frames: %f" % (frames.numberOfFrames(), np.mean(last["positions"][:,0] - first["positions"][:,0])))
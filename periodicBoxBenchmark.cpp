@@ -0,0 +1,167 @@
+#include "std_include.h"
+
+#include "cuda_runtime.h"
+#include "cuda_profiler_api.h"
+
+#include <chrono>
+
+#include "periodicBoundaries.h"
+#include "noiseSource.h"
+#include "DelaunayGPU.h"
+#include "voronoiModelBase.cuh"
+
+/*!
+This file compiles to produce an executable that measures the effect of specializing the periodic
+boundary routines on the shape of the box. The same random point set is placed in a rectangular box
+and in an identical box that is declared as a general (possibly sheared) one; in the first case the
+geometry, triangulation and circumcircle kernels are dispatched to their rectangular specializations,
+and in the second to the general ones. For each box the executable times
+    the Voronoi geometry (computeVoronoiGeometryFunction, via gpu_compute_voronoi_geometry)
+    the circumcircle tests of a valid triangulation (testAndRepairDelaunayTriangulation)
+    a complete triangulation (globalDelaunayTriangulation)
+and reports the speedup of the rectangular path. Since the two boxes describe the same domain, the
+cell areas computed in them must agree up to round-off, and this is checked as well.
+*/
+
+//!The wall-clock time in seconds
+double wallTime()
+    {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    };
+
+//!The results of timing one box
+struct boxTimings
+    {
+    double geometry;
+    double circumcircles;
+    double triangulation;
+    };
+
+//!Time the geometry, circumcircle tests and global triangulation of the point set in the given box
+boxTimings timeBox(GPUArray<double2> &points, PeriodicBoxPtr box, int repeats, bool gpu, int nThreads,
+                   GPUArray<double2> &areaPerimeter)
+    {
+    boxTimings result;
+    int N = points.getNumElements();
+    DelaunayGPU delaunay;
+    delaunay.initialize(N,16,1.0,box,gpu);
+    delaunay.setGPUcompute(gpu);
+    delaunay.setOmpThreads(nThreads);
+
+    GPUArray<int> neighbors, neighborNum, neighborOffsets;
+    neighborNum.resize(N);
+    neighborOffsets.resize(N);
+    double t1 = wallTime();
+    for (int rr = 0; rr < repeats; ++rr)
+        delaunay.globalDelaunayTriangulation(points,neighbors,neighborNum);
+    if(gpu)
+        cudaDeviceSynchronize();
+    result.triangulation = (wallTime()-t1)/repeats;
+
+    Index2D n_idx(delaunay.MaxSize,N);
+    int totalNeighbors = 0;
+        {
+        ArrayHandle<int> h_nn(neighborNum,access_location::host,access_mode::read);
+        ArrayHandle<int> h_off(neighborOffsets,access_location::host,access_mode::overwrite);
+        for (int ii = 0; ii < N; ++ii)
+            {
+            h_off.data[ii] = totalNeighbors;
+            totalNeighbors += h_nn.data[ii];
+            };
+        }
+    GPUArray<double2> voroCur;
+    GPUArray<double4> voroLastNext;
+    voroCur.resize(totalNeighbors);
+    voroLastNext.resize(totalNeighbors);
+    areaPerimeter.resize(N);
+
+    access_location::Enum location = gpu ? access_location::device : access_location::host;
+    t1 = wallTime();
+        {
+        ArrayHandle<double2> d_p(points,location,access_mode::read);
+        ArrayHandle<double2> d_AP(areaPerimeter,location,access_mode::overwrite);
+        ArrayHandle<int> d_nn(neighborNum,location,access_mode::read);
+        ArrayHandle<int> d_n(neighbors,location,access_mode::read);
+        ArrayHandle<int> d_off(neighborOffsets,location,access_mode::read);
+        ArrayHandle<double2> d_vc(voroCur,location,access_mode::overwrite);
+        ArrayHandle<double4> d_vln(voroLastNext,location,access_mode::overwrite);
+        for (int rr = 0; rr < repeats; ++rr)
+            gpu_compute_voronoi_geometry(d_p.data,d_AP.data,d_nn.data,d_n.data,d_off.data,d_vc.data,d_vln.data,
+                                         N,n_idx,*(box),gpu,nThreads);
+        if(gpu)
+            cudaDeviceSynchronize();
+        }
+    result.geometry = (wallTime()-t1)/repeats;
+
+    //the triangulation is already Delaunay, so this is (almost) entirely the cost of the circumcircle tests
+    t1 = wallTime();
+    for (int rr = 0; rr < repeats; ++rr)
+        delaunay.testAndRepairDelaunayTriangulation(points,neighbors,neighborNum);
+    if(gpu)
+        cudaDeviceSynchronize();
+    result.circumcircles = (wallTime()-t1)/repeats;
+    return result;
+    };
+
+int main(int argc, char*argv[])
+{
+    int numpts = 10000; //number of points
+    int USE_GPU = -1; //0 or greater uses a gpu, any negative number runs on the cpu with that many threads
+    int repeats = 20; //the number of times each routine is timed
+    int c;
+    while((c=getopt(argc,argv,"n:g:r:")) != -1)
+        switch(c)
+        {
+            case 'n': numpts = atoi(optarg); break;
+            case 'g': USE_GPU = atoi(optarg); break;
+            case 'r': repeats = atoi(optarg); break;
+            case '?':
+                    if(isprint(optopt))
+                        std::cerr<<"Unknown option '-" << optopt << "'.\n";
+                    else
+                        std::cerr << "Unknown option character.\n";
+                    return 1;
+            default:
+                       abort();
+        };
+
+    bool gpu = chooseGPU(USE_GPU);
+    int nThreads = gpu ? 1 : abs(USE_GPU);
+
+    double boxLength = sqrt((double)numpts);
+    PeriodicBoxPtr rectangularBox = make_shared<periodicBoundaries>(boxLength,boxLength);
+    PeriodicBoxPtr generalBox = make_shared<periodicBoundaries>(boxLength,0.0,0.0,boxLength);
+
+    noiseSource noise;
+    noise.setReproducible(true);
+    GPUArray<double2> points;
+    points.resize(numpts);
+        {
+        ArrayHandle<double2> h_p(points,access_location::host,access_mode::overwrite);
+        for (int ii = 0; ii < numpts; ++ii)
+            h_p.data[ii] = make_double2(noise.getRealUniform(0.0,boxLength),noise.getRealUniform(0.0,boxLength));
+        }
+
+    GPUArray<double2> rectangularAP, generalAP;
+    boxTimings general = timeBox(points,generalBox,repeats,gpu,nThreads,generalAP);
+    boxTimings rectangular = timeBox(points,rectangularBox,repeats,gpu,nThreads,rectangularAP);
+
+    double maxAreaDifference = 0.0;
+        {
+        ArrayHandle<double2> h_r(rectangularAP,access_location::host,access_mode::read);
+        ArrayHandle<double2> h_g(generalAP,access_location::host,access_mode::read);
+        for (int ii = 0; ii < numpts; ++ii)
+            maxAreaDifference = max(maxAreaDifference,fabs(h_r.data[ii].x-h_g.data[ii].x));
+        }
+
+    printf("N = %i, %s, %i repeats\n",numpts,gpu ? "GPU" : "CPU",repeats);
+    printf("routine\t\t\tgeneral box (s)\trectangular box (s)\tspeedup\n");
+    printf("voronoi geometry\t%e\t%e\t\t%.2f\n",general.geometry,rectangular.geometry,general.geometry/rectangular.geometry);
+    printf("circumcircle tests\t%e\t%e\t\t%.2f\n",general.circumcircles,rectangular.circumcircles,general.circumcircles/rectangular.circumcircles);
+    printf("global triangulation\t%e\t%e\t\t%.2f\n",general.triangulation,rectangular.triangulation,general.triangulation/rectangular.triangulation);
+    printf("largest difference between the cell areas in the two boxes: %e\n",maxAreaDifference);
+
+    if(gpu)
+        cudaDeviceReset();
+    return 0;
+};
@@ -40,7 +40,10 @@ void dynamicalFeatures::computeDisplacements(GPUArray<double2> &currentPos)
         {
         cur = fPos.data[ii];
         init = iPos[ii];
-        Box->minDist(cur,init,disp);
+        if(positionsUnwrapped)
+            disp = make_double2(cur.x-init.x,cur.y-init.y);
+        else
+            Box->minDist(cur,init,disp);
         currentDisplacements[ii] = disp;
         }
     };
@@ -148,33 +151,129 @@ double dynamicalFeatures::computeCageRelativeSISF(GPUArray<double2> &currentPos,
 
 
 /*!
-returns <F_s^2(q,t)> for a set of displacements
+Averaging exp(i x cos(theta-phi)) over L equally spaced angles gives
+J_0(x) + 2 sum_{p>=1} i^{pL} J_{pL}(x) cos(pL phi),
+and since |J_n(x)| <= (x/2)^n/n!, the error relative to the exact angular average J_0(x) is bounded by
+2 sum_{p>=1} (x/2)^{pL}/(pL)!, which is what is returned (it is not capped, so for L < x it is useless)
+*/
+double dynamicalFeatures::angularQuadratureErrorBound(double x, int L)
+    {
+    if(x <= 0)
+        return 0.0;
+    double bound = 0.0;
+    double logHalfX = log(0.5*x);
+    for (int p = 1; p < 1000; ++p)
+        {
+        double n = (double) p*L;
+        double term = exp(n*logHalfX - lgamma(n+1.0));
+        bound += 2.0*term;
+        if(term < 1e-3*bound || term < 1e-300)
+            break;
+        };
+    return bound;
+    };
+
+/*!
+returns <F_s^2(q,t)> for a set of displacements, i.e., the angular average of |(1/N) sum_j exp(i q.r_j)|^2
+over the shell |q| = k. Rather than the exact O(N^2) pairwise Bessel sum, this is evaluated as an
+average over M wavevector directions evenly spaced on the half circle (the other half gives identical
+values), costing O(N M). The pair terms of the exact expression are then replaced by the 2M-point
+quadrature of J_0(k r_ij), so the error is bounded by angularQuadratureErrorBound(k*max|r_ij|,2M);
+the bound is stored in chi4ErrorBound. If chi4Directions <= 0 the smallest M meeting chi4Tolerance is used.
+
+The phases q.r_j change with every set of displacements, so exp(i q.r_j) itself cannot be tabulated.
+Instead each phase is split as 2 pi t/trigTableSize + delta with |delta| <= pi/trigTableSize, the
+first factor is looked up in cosTable/sinTable and the second is a short Taylor series; the truncation
+error (|delta|^6/720 ~ 1e-18) is far below double rounding, so no libm calls remain in the inner loop.
+Phases too large to index with an int fall back to cos and sin.
 */
 double dynamicalFeatures::chi4Helper(vector<double2> &displacements, double k)
     {
-    double2 disp,disp2,totalDisp, relativeDisp;
-    double kr;
+    //SoA copies of the displacements, and the largest possible pair separation
+    vector<double> dx(N), dy(N);
+    double maxNorm2 = 0.0;
+    for (int ii = 0; ii < N; ++ii)
+        {
+        dx[ii] = displacements[ii].x;
+        dy[ii] = displacements[ii].y;
+        maxNorm2 = max(maxNorm2, dx[ii]*dx[ii]+dy[ii]*dy[ii]);
+        };
+    double xMax = 2.0*k*sqrt(maxNorm2);
 
-    double chi4Contribution = 0.0;
-    //self contribution
-    chi4Contribution = 1.0*N;
-    //relative contributions
-    for(int ii = 0; ii < N-1; ++ii)
+    int M = chi4Directions;
+    if (M <= 0)
         {
-        disp = displacements[ii];
-        for (int jj = ii+1; jj < N; ++jj)
+        M = 4;
+        while(angularQuadratureErrorBound(xMax,2*M) > chi4Tolerance)
+            M += 4;
+        };
+    chi4ErrorBound = min(2.0,angularQuadratureErrorBound(xMax,2*M));
+
+    //tabulate the wavevectors
+    vector<double> kx(M), ky(M);
+    for (int mm = 0; mm < M; ++mm)
+        {
+        double theta = PI*mm/M;
+        kx[mm] = k*cos(theta);
+        ky[mm] = k*sin(theta);
+        };
+
+    fillTrigTables();
+    const double toTable = trigTableSize/(2.0*PI);
+    //|q.r_j| <= xMax/2, so the table index fits in an int unless the displacements are enormous
+    bool useTable = 0.5*xMax*toTable < 1.0e9;
+
+    const double *px = dx.data();
+    const double *py = dy.data();
+    const double *ct = cosTable.data();
+    const double *st = sinTable.data();
+    double fsSquared = 0.0;
+    #pragma omp parallel for reduction(+:fsSquared) schedule(static)
+    for (int mm = 0; mm < M; ++mm)
+        {
+        double qx = kx[mm];
+        double qy = ky[mm];
+        double re = 0.0;
+        double im = 0.0;
+        if(useTable)
+            {
+            #pragma omp simd reduction(+:re,im)
+            for (int jj = 0; jj < N; ++jj)
+                {
+                double c, s;
+                tabulatedCosSin((qx*px[jj]+qy*py[jj])*toTable,ct,st,c,s);
+                re += c;
+                im += s;
+                };
+            }
+        else
             {
-            disp2 = displacements[jj];
-            relativeDisp.x=disp.x-disp2.x;
-            relativeDisp.y=disp.y-disp2.y;
-            kr = k*sqrt(dot(relativeDisp,relativeDisp));
-            chi4Contribution += 2*std::cyl_bessel_j((double) 0.0, (double) kr);
+            for (int jj = 0; jj < N; ++jj)
+                {
+                double phase = qx*px[jj]+qy*py[jj];
+                re += cos(phase);
+                im += sin(phase);
+                };
             };
-        }
+        fsSquared += re*re+im*im;
+        };
 
-    return (chi4Contribution / (N*N));
+    return fsSquared / ((double)M*N*N);
     }
 
+void dynamicalFeatures::fillTrigTables()
+    {
+    if(cosTable.size() == (size_t)trigTableSize)
+        return;
+    cosTable.resize(trigTableSize);
+    sinTable.resize(trigTableSize);
+    for (int tt = 0; tt < trigTableSize; ++tt)
+        {
+        cosTable[tt] = cos(2.0*PI*tt/trigTableSize);
+        sinTable[tt] = sin(2.0*PI*tt/trigTableSize);
+        };
+    };
+
 double2 dynamicalFeatures::computeFsChi4(GPUArray<double2> &currentPos, double k)
     {
     double2 ans; ans.x=0;ans.y=0;
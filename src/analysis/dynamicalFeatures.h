@@ -15,6 +15,9 @@ class dynamicalFeatures
         //!The constructor takes in a defining set of boundary conditions
         dynamicalFeatures(GPUArray<double2> &initialPos, PeriodicBoxPtr _bx, double fractionAnalyzed = 1.0);
 
+        //!Declare that the positions passed to this class are unwrapped (e.g., from Simple2DCell::getUnwrappedPositions), so displacements are not minimum-image ones
+        void setPositionsUnwrapped(bool unwrapped = true){positionsUnwrapped = unwrapped;};
+
         //!set the list of neighbors forming initial cages of the particles (to be used for cage-relative calculations)
         void setCageNeighbors(GPUArray<int> &neighbors, GPUArray<int> &neighborNum, Index2D n_idx);
 
@@ -35,6 +38,10 @@ class dynamicalFeatures
         double2 computeFsChi4(GPUArray<double2> &currentPos, double k = 6.28319);
         //!compute cage-relative verions of above function
         double2 computeCageRelativeFsChi4(GPUArray<double2> &currentPos, double k = 6.28319);
+        //!Set the number of wavevector directions used for chi_4; M <= 0 chooses M so that the error bound is below tolerance
+        void setChi4Directions(int M, double tolerance = 1e-8){chi4Directions = M; chi4Tolerance = tolerance;};
+        //!An upper bound on the error in <F_s^2> (relative to the exact angular average) of the last chi_4 computation
+        double chi4ErrorBound = 0.0;
 
         //!compute *un-normalized* flenner-Szamel psi_6 bond correlation decay (i.e., without the average |\psi_6|^2) that would make the function 1 at t=0. return.x is real, return.y is imaginary part
         double2 computeOrientationalCorrelationFunction(GPUArray<double2> &currentPos,GPUArray<int> &currentNeighbors, GPUArray<int> &currentNeighborNum, Index2D n_idx, int n=6);
@@ -47,6 +54,8 @@ class dynamicalFeatures
         void computeDisplacements(GPUArray<double2> &currentPos);
         //!helper function that computes the angular average of <F_s^2(q,t)>
         double chi4Helper(vector<double2> &displacements, double k);
+        //!bound on the error of averaging exp(i x cos(theta)) over L equally spaced angles instead of exactly
+        double angularQuadratureErrorBound(double x, int L);
         //!helper function that computes the angular average self-intermediate scattering function associated with a vector of displacements
         double angularAverageSISF(vector<double2> &displacements, double k);
         //!helper function that computes the mean dot product of a vector of double2's
@@ -61,10 +70,36 @@ class dynamicalFeatures
         vector<double2> cageRelativeDisplacements;
         //!the number of double2's
         int N;
+        //!are the positions unwrapped? If not, displacements are computed with the minimum image convention
+        bool positionsUnwrapped = false;
         vector<vector<int>> cageNeighbors;
         Index2D nIdx;
 
         bool initialBondOrderComputed = false;
         vector<double2> initialConjugateBondOrder;
+
+        //!number of wavevector directions on the half-circle |q| = k used by chi4Helper (<= 0 means automatic)
+        int chi4Directions = 0;
+        //!target error bound when the number of directions is chosen automatically
+        double chi4Tolerance = 1e-8;
+        //!number of entries in the cos/sin tables used by chi4Helper (a power of two)
+        static const int trigTableSize = 1024;
+        //!cos(2 pi t/trigTableSize) and sin(2 pi t/trigTableSize), filled by fillTrigTables
+        vector<double> cosTable, sinTable;
+        //!fill cosTable and sinTable, if that has not been done yet
+        void fillTrigTables();
+        //!cos and sin of the phase 2 pi u/trigTableSize, from the tables and a short Taylor series (see chi4Helper)
+        static inline __attribute__((always_inline)) void tabulatedCosSin(double u, const double *ct, const double *st,
+                                                                          double &c, double &s)
+            {
+            double nearest = floor(u+0.5);
+            int idx = ((int) nearest) & (trigTableSize-1);
+            double d = (u-nearest)*(2.0*PI/trigTableSize);
+            double d2 = d*d;
+            double cd = 1.0 - d2*(0.5 - d2*(1.0/24.0));
+            double sd = d*(1.0 - d2*(1.0/6.0 - d2*(1.0/120.0)));
+            c = ct[idx]*cd - st[idx]*sd;
+            s = st[idx]*cd + ct[idx]*sd;
+            };
     };
 #endif
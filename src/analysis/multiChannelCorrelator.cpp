@@ -0,0 +1,236 @@
+#include "multiChannelCorrelator.h"
+/*! \file multiChannelCorrelator.cpp */
+
+/*!
+The constructor determines the number of channels, the number of points per correlator level, the
+number of points over which to average, the time spacing rate at which samples will be added, and
+whether the full matrix of cross-correlations should be accumulated
+*/
+multiChannelCorrelator::multiChannelCorrelator(int _channels, int pp, int mm, double deltaT, bool _crossCorrelations)
+    {
+    if(_channels < 1 || mm < 1 || pp < mm)
+        {
+        printf("multiChannelCorrelator needs at least one channel, and at least m points per level\n");
+        throw std::exception();
+        };
+    channels = _channels;
+    crossCorrelations = _crossCorrelations;
+    p=pp;
+    m=mm;
+    minimumDistance = p/m;
+    setDeltaT(deltaT);
+    initialize();
+    };
+
+/*!
+initializes the necessary data structures
+*/
+void multiChannelCorrelator::initialize()
+    {
+    nCorrelators = 0;
+    nSamples = 0;
+    accumulatedValue.assign(channels,0.0);
+    insertIndex.clear();
+    nAccumulator.clear();
+    accumulator.clear();
+    shiftFilled.clear();
+    shift.clear();
+    nCorrelation.clear();
+    correlation.clear();
+    crossCorrelation.clear();
+    growCorrelationLevel();
+    };
+
+/*!
+If a value is added so that the number of correlator levels needs to grow, this function will be
+called to do this;
+*/
+void multiChannelCorrelator::growCorrelationLevel()
+    {
+    insertIndex.push_back(0);
+    nAccumulator.push_back(0);
+    accumulator.push_back(vector<double>(channels,0.0));
+    shiftFilled.push_back(vector<int>(p,0));
+    shift.push_back(vector<double>(p*channels,0.0));
+    nCorrelation.push_back(vector<int>(p,0));
+    correlation.push_back(vector<double>(p*channels,0.0));
+    if(crossCorrelations)
+        crossCorrelation.push_back(vector<double>(p*channels*channels,0.0));
+    nCorrelators+=1;
+    };
+
+/*!
+\param w a pointer to samples*channels doubles; sample s, channel c is w[s*channels+c]
+*/
+void multiChannelCorrelator::add(const double *w, int samples)
+    {
+    for (int ss = 0; ss < samples; ++ss)
+        {
+        const double *sample = w + (size_t)ss*channels;
+        double *acc = accumulatedValue.data();
+        #pragma omp simd
+        for (int cc = 0; cc < channels; ++cc)
+            acc[cc] += sample[cc];
+        nSamples += 1;
+        addToLevel(0,sample);
+        };
+    };
+
+void multiChannelCorrelator::add(vector<double> &w)
+    {
+    add(w.data(), w.size()/channels);
+    };
+
+void multiChannelCorrelator::add(GPUArray<double> &w)
+    {
+    ArrayHandle<double> h_w(w,access_location::host,access_mode::read);
+    add(h_w.data, w.getNumElements()/channels);
+    };
+
+/*!
+Insert a sample into the history of level k and correlate it with every earlier sample still in the
+history (the zeroth level correlates all lags, higher levels only lags >= p/m, since shorter lags are
+covered by the level below). Every m samples the average is passed up to level k+1.
+*/
+void multiChannelCorrelator::addToLevel(int k, const double *w)
+    {
+    if (k == nCorrelators)
+        growCorrelationLevel();
+
+    int C = channels;
+    int index1 = insertIndex[k];
+    double *current = &shift[k][index1*C];
+    #pragma omp simd
+    for (int cc = 0; cc < C; ++cc)
+        current[cc] = w[cc];
+    shiftFilled[k][index1] = 1;
+
+    int firstLag = (k==0) ? 0 : minimumDistance;
+    for (int jj = firstLag; jj < p; ++jj)
+        {
+        int index2 = index1 - jj;
+        if (index2 < 0) index2 += p;
+        if (!shiftFilled[k][index2])
+            continue;
+        const double *past = &shift[k][index2*C];
+        double *corr = &correlation[k][jj*C];
+        #pragma omp simd
+        for (int cc = 0; cc < C; ++cc)
+            corr[cc] += current[cc]*past[cc];
+        if(crossCorrelations)
+            {
+            for (int aa = 0; aa < C; ++aa)
+                {
+                double *cross = &crossCorrelation[k][(jj*C+aa)*C];
+                double ca = current[aa];
+                #pragma omp simd
+                for (int bb = 0; bb < C; ++bb)
+                    cross[bb] += ca*past[bb];
+                };
+            };
+        nCorrelation[k][jj] += 1;
+        };
+    insertIndex[k] +=1;
+    if (insertIndex[k] == p)
+        insertIndex[k] = 0;
+
+    //accumulate, and if needed pass the average to the next level
+    double *acc = accumulator[k].data();
+    #pragma omp simd
+    for (int cc = 0; cc < C; ++cc)
+        acc[cc] += w[cc];
+    nAccumulator[k] += 1;
+    if(nAccumulator[k] == m)
+        {
+        double invM = 1.0/m;
+        #pragma omp simd
+        for (int cc = 0; cc < C; ++cc)
+            acc[cc] *= invM;
+        addToLevel(k+1,acc);
+        for (int cc = 0; cc < C; ++cc)
+            acc[cc] = 0.0;
+        nAccumulator[k] = 0;
+        };
+    };
+
+void multiChannelCorrelator::sampledLags(vector<int2> &levelAndLag, vector<double> &times)
+    {
+    levelAndLag.clear();
+    times.clear();
+    for (int ii = 0; ii < p; ++ii)
+        if(nCorrelation[0][ii] > 0)
+            {
+            levelAndLag.push_back(make_int2(0,ii));
+            times.push_back(ii*dt);
+            };
+    for (int k = 1; k < nCorrelators; ++k)
+        for (int ii = minimumDistance; ii < p; ++ii)
+            if (nCorrelation[k][ii] > 0)
+                {
+                levelAndLag.push_back(make_int2(k,ii));
+                times.push_back(dt*ii*pow((double)m,k));
+                };
+    };
+
+/*!
+if normalize is true, the product of the channel means is subtracted (as for the scalar autocorrelator)
+*/
+void multiChannelCorrelator::evaluate(vector<double> &times, vector<double> &values, bool normalize)
+    {
+    vector<int2> levelAndLag;
+    sampledLags(levelAndLag,times);
+    int C = channels;
+    values.resize(times.size()*C);
+    vector<double> mean(C,0.0);
+    if(normalize && nSamples > 0)
+        for (int cc = 0; cc < C; ++cc)
+            mean[cc] = accumulatedValue[cc]/nSamples;
+    for (int tt = 0; tt < (int)times.size(); ++tt)
+        {
+        int k = levelAndLag[tt].x;
+        int jj = levelAndLag[tt].y;
+        double invN = 1.0/nCorrelation[k][jj];
+        for (int cc = 0; cc < C; ++cc)
+            values[tt*C+cc] = correlation[k][jj*C+cc]*invN - mean[cc]*mean[cc];
+        };
+    };
+
+void multiChannelCorrelator::evaluateCrossCorrelations(vector<double> &times, vector<double> &values, bool normalize)
+    {
+    if(!crossCorrelations)
+        {
+        printf("multiChannelCorrelator was constructed without cross-correlations\n");
+        throw std::exception();
+        };
+    vector<int2> levelAndLag;
+    sampledLags(levelAndLag,times);
+    int C = channels;
+    values.resize(times.size()*C*C);
+    vector<double> mean(C,0.0);
+    if(normalize && nSamples > 0)
+        for (int cc = 0; cc < C; ++cc)
+            mean[cc] = accumulatedValue[cc]/nSamples;
+    for (int tt = 0; tt < (int)times.size(); ++tt)
+        {
+        int k = levelAndLag[tt].x;
+        int jj = levelAndLag[tt].y;
+        double invN = 1.0/nCorrelation[k][jj];
+        for (int aa = 0; aa < C; ++aa)
+            for (int bb = 0; bb < C; ++bb)
+                values[(tt*C+aa)*C+bb] = crossCorrelation[k][(jj*C+aa)*C+bb]*invN - mean[aa]*mean[bb];
+        };
+    };
+
+void multiChannelCorrelator::evaluateChannelAverage(vector<double2> &correlator, bool normalize)
+    {
+    vector<double> times, values;
+    evaluate(times,values,normalize);
+    correlator.resize(times.size());
+    for (int tt = 0; tt < (int)times.size(); ++tt)
+        {
+        double average = 0.0;
+        for (int cc = 0; cc < channels; ++cc)
+            average += values[tt*channels+cc];
+        correlator[tt] = make_double2(times[tt],average/channels);
+        };
+    };
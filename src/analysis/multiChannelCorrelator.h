@@ -0,0 +1,92 @@
+#ifndef multiChannelCorrelator_H
+#define multiChannelCorrelator_H
+
+#include "std_include.h"
+#include "gpuarray.h"
+
+/*! \file multiChannelCorrelator.h */
+
+//! On-the-fly multiple-tau correlation functions of many channels (e.g., one per cell) at once
+/*!
+This is the same multiple-time correlator scheme as the autocorrelator class (Ramirez, Sukumaran,
+Vorselaars and Likhtman, J. Chem. Phys. 133, 154103 (2010)), but each sample is a contiguous block of
+C doubles (one per channel) and all channels share the per-level bookkeeping. Each correlator level
+stores its history as a contiguous p x C buffer, so that adding a sample is a sequence of unit-stride
+loops over channels, which the compiler vectorizes. Optionally, all C^2 cross-correlations
+<A_a(t) A_b(0)> are also accumulated (only sensible for a modest number of channels, e.g., the
+components of the stress tensor).
+
+As with the autocorrelator, the number of levels grows as needed.
+*/
+class multiChannelCorrelator
+    {
+    public:
+        //!The constructor sets the number of channels, points per level, averaging number, time spacing, and whether to compute cross-correlations
+        multiChannelCorrelator(int _channels, int pp = 16, int mm = 2, double deltaT = 1.0, bool _crossCorrelations = false);
+
+        //!Add "samples" consecutive samples, each a contiguous block of (number of channels) values
+        void add(const double *w, int samples = 1);
+        //!Add one or more samples stored contiguously in a vector
+        void add(vector<double> &w);
+        //!Add one or more samples stored contiguously in a GPUArray
+        void add(GPUArray<double> &w);
+
+        //!Fill times and (times.size() x channels) values with the autocorrelation of every channel
+        void evaluate(vector<double> &times, vector<double> &values, bool normalize = false);
+        //!Fill times and (times.size() x channels x channels) values with all cross-correlations <A_a(t)A_b(0)>
+        void evaluateCrossCorrelations(vector<double> &times, vector<double> &values, bool normalize = false);
+        //!The channel-averaged autocorrelation, as (time, value) pairs in the format of the autocorrelator class
+        void evaluateChannelAverage(vector<double2> &correlator, bool normalize = false);
+
+        //! Set the time spacing
+        void setDeltaT(double deltaT){dt=deltaT;};
+        //! Initialize all data structures to zero
+        void initialize();
+        //!The number of channels
+        int getNumberOfChannels(){return channels;};
+
+    protected:
+        //!add a single sample to correlator level k, cascading to higher levels as needed
+        void addToLevel(int k, const double *w);
+        //!grow data structures if a new level of the correlation function needs to be added
+        void growCorrelationLevel();
+        //!the list of (level, lag index) pairs with data, and their times
+        void sampledLags(vector<int2> &levelAndLag, vector<double> &times);
+
+        //!The number of channels
+        int channels;
+        //!Are cross-correlations being computed?
+        bool crossCorrelations;
+        //!The time spacing
+        double dt;
+        //!points per correlator
+        int p;
+        //!number of points over which to average
+        int m;
+        //!Current number of correlator levels
+        int nCorrelators;
+        //!Minimum distance betwee points for correlators other than the zeroth level
+        int minimumDistance;
+        //!the total number of samples added
+        long long nSamples;
+        //!Accumulated sum of values added to each channel
+        vector<double> accumulatedValue;
+
+        //!Where in each level the next value will be inserted
+        vector<int> insertIndex;
+        //!How many values have been accumulated in each level's accumulator
+        vector<int> nAccumulator;
+        //!The per-level accumulators (C values each)
+        vector<vector<double> > accumulator;
+        //!Whether each slot of each level's history has been filled
+        vector<vector<int> > shiftFilled;
+        //!Each level's history, a p x C buffer
+        vector<vector<double> > shift;
+        //!The number of products accumulated at each lag of each level (shared by all channels)
+        vector<vector<int> > nCorrelation;
+        //!The accumulated autocorrelations of each level, a p x C buffer
+        vector<vector<double> > correlation;
+        //!The accumulated cross-correlations of each level, a p x C x C buffer
+        vector<vector<double> > crossCorrelation;
+    };
+#endif
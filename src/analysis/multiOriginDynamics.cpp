@@ -0,0 +1,278 @@
+#include "multiOriginDynamics.h"
+/*! \file multiOriginDynamics.cpp */
+
+/*!
+The initial positions are the first time origin. Lags are sampled at log-spaced integers up to the
+largest lag that can still be reached by the oldest origin in the ring, originSpacing*maximumOrigins
+*/
+multiOriginDynamics::multiOriginDynamics(GPUArray<double2> &initialPos, PeriodicBoxPtr _bx, int _originSpacing,
+                                         int _maximumOrigins, double lagExponent, double _k, double _overlapCutoff)
+    : dynamicalFeatures(initialPos,_bx)
+    {
+    if(_originSpacing < 1 || _maximumOrigins < 1)
+        {
+        printf("multiOriginDynamics requires a positive origin spacing and number of origins\n");
+        throw std::exception();
+        };
+    originSpacing = _originSpacing;
+    maximumOrigins = _maximumOrigins;
+    k = _k;
+    overlapCutoff = _overlapCutoff;
+    frame = 0;
+
+    previousPos.assign(iPos.begin(),iPos.begin()+N);
+    unwrappedPos = previousPos;
+    originPos.resize(maximumOrigins);
+    originFrame.assign(maximumOrigins,-1);
+    nextOriginSlot = 0;
+    addOrigin();
+
+    int maximumLag = originSpacing*maximumOrigins;
+    lagBin.assign(maximumLag+1,-1);
+    logSpacedIntegers lagSchedule(1,lagExponent);
+    while(lagSchedule.nextSave <= maximumLag)
+        {
+        lagBin[lagSchedule.nextSave] = lagValues.size();
+        lagValues.push_back(lagSchedule.nextSave);
+        lagSchedule.update();
+        };
+    int nLags = lagValues.size();
+    nSamples.assign(nLags,0);
+    msdSum.assign(nLags,0.0);
+    fsSum.assign(nLags,0.0);
+    fs2Sum.assign(nLags,0.0);
+    overlapSum.assign(nLags,0.0);
+    overlap2Sum.assign(nLags,0.0);
+    };
+
+void multiOriginDynamics::addOrigin()
+    {
+    originPos[nextOriginSlot] = unwrappedPos;
+    originFrame[nextOriginSlot] = frame;
+    nextOriginSlot = (nextOriginSlot+1) % maximumOrigins;
+    };
+
+/*!
+Unwraps the new frame against the previous one (or, after setPositionsUnwrapped, just copies it),
+accumulates every (origin, lag) pair that lands on a sampled lag, and then (every originSpacing frames)
+replaces the oldest origin with the current frame
+*/
+void multiOriginDynamics::update(GPUArray<double2> &currentPos)
+    {
+    frame += 1;
+    {//scope for array handle
+    ArrayHandle<double2> h_p(currentPos,access_location::host,access_mode::read);
+    double2 disp;
+    for (int ii = 0; ii < N; ++ii)
+        {
+        if(positionsUnwrapped)
+            {
+            unwrappedPos[ii] = h_p.data[ii];
+            continue;
+            };
+        Box->minDist(h_p.data[ii],previousPos[ii],disp);
+        unwrappedPos[ii].x += disp.x;
+        unwrappedPos[ii].y += disp.y;
+        previousPos[ii] = h_p.data[ii];
+        };
+    }
+    accumulate();
+    if(frame % originSpacing == 0)
+        addOrigin();
+    };
+
+/*!
+The tables grow by doubling, so over a run J_0 and J_1 are evaluated directly only O(k |d|_max) times.
+Cubic Hermite interpolation on a grid of spacing h = 1/512 has an error of at most h^4/384 < 4e-14,
+since no derivative of J_0 exceeds one in magnitude.
+*/
+void multiOriginDynamics::extendBesselTables(double xMax)
+    {
+    int needed = (int)(xMax*besselTableDensity) + 2;
+    if((int)besselJ0.size() >= needed)
+        return;
+    int oldSize = besselJ0.size();
+    int newSize = max(needed,max(2*oldSize,4*besselTableDensity));
+    besselJ0.resize(newSize);
+    besselJ1.resize(newSize);
+    for (int tt = oldSize; tt < newSize; ++tt)
+        {
+        double x = (double)tt/besselTableDensity;
+        besselJ0[tt] = std::cyl_bessel_j(0.0,x);
+        besselJ1[tt] = std::cyl_bessel_j(1.0,x);
+        };
+    };
+
+/*!
+All active origins are handled in one pass over the particles: each thread accumulates, for every active
+origin, the MSD, the (angularly averaged) F_s, the overlap, and the real and imaginary parts of
+sum_j exp(i q.d_j) for M wavevector directions on the half circle |q| = k, and the per-thread partial sums
+are then merged. M is chosen exactly as in chi4Helper, using the largest displacement of any active origin.
+J_0 is interpolated in tables that cover the largest k|d|, and cos and sin of the phases come from the
+same tables (with the same fallback for huge phases) as in chi4Helper.
+*/
+void multiOriginDynamics::accumulate()
+    {
+    vector<int> activeSlot, activeBin;
+    for (int oo = 0; oo < maximumOrigins; ++oo)
+        {
+        if(originFrame[oo] < 0)
+            continue;
+        int lag = frame - originFrame[oo];
+        if(lag < (int)lagBin.size() && lagBin[lag] >= 0)
+            {
+            activeSlot.push_back(oo);
+            activeBin.push_back(lagBin[lag]);
+            };
+        };
+    int nActive = activeSlot.size();
+    if(nActive == 0)
+        return;
+
+    //pre-pass for the largest displacement, which sets the number of directions
+    double maxNorm2 = 0.0;
+    for (int aa = 0; aa < nActive; ++aa)
+        {
+        const double2 *origin = originPos[activeSlot[aa]].data();
+        for (int ii = 0; ii < N; ++ii)
+            {
+            double dx = unwrappedPos[ii].x - origin[ii].x;
+            double dy = unwrappedPos[ii].y - origin[ii].y;
+            maxNorm2 = max(maxNorm2,dx*dx+dy*dy);
+            };
+        };
+    double xMax = 2.0*k*sqrt(maxNorm2);
+    int M = chi4Directions;
+    if (M <= 0)
+        {
+        M = 4;
+        while(angularQuadratureErrorBound(xMax,2*M) > chi4Tolerance)
+            M += 4;
+        };
+    chi4ErrorBound = min(2.0,angularQuadratureErrorBound(xMax,2*M));
+
+    const double toTable = trigTableSize/(2.0*PI);
+    bool useTable = 0.5*xMax*toTable < 1.0e9;
+    fillTrigTables();
+    extendBesselTables(0.5*xMax);
+    const double *ct = cosTable.data();
+    const double *st = sinTable.data();
+    const double *j0 = besselJ0.data();
+    const double *j1 = besselJ1.data();
+
+    //when the tables are used the wavevectors are stored in units of the table spacing
+    double qScale = useTable ? toTable : 1.0;
+    vector<double> kx(M), ky(M);
+    for (int mm = 0; mm < M; ++mm)
+        {
+        double theta = PI*mm/M;
+        kx[mm] = qScale*k*cos(theta);
+        ky[mm] = qScale*k*sin(theta);
+        };
+
+    //per origin: msd, fs, overlap; per origin and direction: re, im
+    vector<double> msd(nActive,0.0), fs(nActive,0.0), overlap(nActive,0.0);
+    vector<double> re(nActive*M,0.0), im(nActive*M,0.0);
+    double cutoff2 = overlapCutoff*overlapCutoff;
+    const double *qx = kx.data();
+    const double *qy = ky.data();
+    #pragma omp parallel
+    {
+    vector<double> tMsd(nActive,0.0), tFs(nActive,0.0), tOverlap(nActive,0.0);
+    vector<double> tRe(nActive*M,0.0), tIm(nActive*M,0.0);
+    #pragma omp for schedule(static)
+    for (int ii = 0; ii < N; ++ii)
+        {
+        double2 cur = unwrappedPos[ii];
+        for (int aa = 0; aa < nActive; ++aa)
+            {
+            double dx = cur.x - originPos[activeSlot[aa]][ii].x;
+            double dy = cur.y - originPos[activeSlot[aa]][ii].y;
+            double norm2 = dx*dx+dy*dy;
+            tMsd[aa] += norm2;
+            tFs[aa] += tabulatedJ0(k*sqrt(norm2),j0,j1);
+            if(norm2 < cutoff2)
+                tOverlap[aa] += 1.0;
+            double *pRe = &tRe[aa*M];
+            double *pIm = &tIm[aa*M];
+            if(useTable)
+                {
+                #pragma omp simd
+                for (int mm = 0; mm < M; ++mm)
+                    {
+                    double c, s;
+                    tabulatedCosSin(qx[mm]*dx+qy[mm]*dy,ct,st,c,s);
+                    pRe[mm] += c;
+                    pIm[mm] += s;
+                    };
+                }
+            else
+                {
+                #pragma omp simd
+                for (int mm = 0; mm < M; ++mm)
+                    {
+                    double phase = qx[mm]*dx+qy[mm]*dy;
+                    pRe[mm] += cos(phase);
+                    pIm[mm] += sin(phase);
+                    };
+                };
+            };
+        };
+    #pragma omp critical
+    {
+    for (int aa = 0; aa < nActive; ++aa)
+        {
+        msd[aa] += tMsd[aa];
+        fs[aa] += tFs[aa];
+        overlap[aa] += tOverlap[aa];
+        };
+    for (int am = 0; am < nActive*M; ++am)
+        {
+        re[am] += tRe[am];
+        im[am] += tIm[am];
+        };
+    }
+    }
+
+    double norm = 1.0/N;
+    for (int aa = 0; aa < nActive; ++aa)
+        {
+        double fsSquared = 0.0;
+        for (int mm = 0; mm < M; ++mm)
+            fsSquared += re[aa*M+mm]*re[aa*M+mm]+im[aa*M+mm]*im[aa*M+mm];
+        fsSquared = fsSquared*norm*norm/M;
+        double Q = overlap[aa]*norm;
+        int bin = activeBin[aa];
+        nSamples[bin] += 1;
+        msdSum[bin] += msd[aa]*norm;
+        fsSum[bin] += fs[aa]*norm;
+        fs2Sum[bin] += fsSquared;
+        overlapSum[bin] += Q;
+        overlap2Sum[bin] += Q*Q;
+        };
+    };
+
+/*!
+For each sampled lag (in frames), returns the origin-averaged MSD, F_s, and overlap, together with
+chi_4 = N(<F_s^2> - <F_s>^2) and N(<Q^2> - <Q>^2), where the averages run over time origins (and, for
+F_s^2, over wavevector directions)
+*/
+void multiOriginDynamics::getDynamics(vector<int> &lags, vector<double> &msd, vector<double> &fs, vector<double> &overlap,
+                                      vector<double> &chi4Fs, vector<double> &chi4Overlap)
+    {
+    lags.clear();msd.clear();fs.clear();overlap.clear();chi4Fs.clear();chi4Overlap.clear();
+    for (int bb = 0; bb < (int)lagValues.size(); ++bb)
+        {
+        if(nSamples[bb] == 0)
+            continue;
+        double n = nSamples[bb];
+        double meanFs = fsSum[bb]/n;
+        double meanQ = overlapSum[bb]/n;
+        lags.push_back(lagValues[bb]);
+        msd.push_back(msdSum[bb]/n);
+        fs.push_back(meanFs);
+        overlap.push_back(meanQ);
+        chi4Fs.push_back(N*(fs2Sum[bb]/n - meanFs*meanFs));
+        chi4Overlap.push_back(N*(overlap2Sum[bb]/n - meanQ*meanQ));
+        };
+    };
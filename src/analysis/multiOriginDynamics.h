@@ -0,0 +1,102 @@
+#ifndef multiOriginDynamics_H
+#define multiOriginDynamics_H
+
+#include "dynamicalFeatures.h"
+#include "logSpacedIntegers.h"
+
+/*! \file multiOriginDynamics.h */
+
+//! Streaming computation of time-origin averaged dynamical quantities
+/*!
+Rather than comparing every frame to a single reference configuration, this class keeps a ring of
+time origins (a new one every originSpacing frames, at most maximumOrigins of them) and, each time
+update is called with a new frame, accumulates the MSD, the self-intermediate scattering function,
+the overlap function, and the associated four-point susceptibilities for every origin whose lag to
+the current frame is one of a set of log-spaced lag times. Wrapped positions are unwrapped incrementally,
+so update must be called often enough that no particle moves more than half a box length between calls;
+that restriction is lifted by passing unwrapped positions (see setPositionsUnwrapped).
+
+All active origins are handled in a single parallel pass over the particles. chi_4 of F_s uses the same
+wavevector-direction average (and error bound) as dynamicalFeatures::computeFsChi4, and is averaged over
+time origins as well as directions; chi_4 of the overlap function is the variance over time origins.
+*/
+class multiOriginDynamics : public dynamicalFeatures
+    {
+    public:
+        //!The constructor takes the first frame, the box, and the origin / lag schedule
+        multiOriginDynamics(GPUArray<double2> &initialPos, PeriodicBoxPtr _bx, int _originSpacing = 10,
+                            int _maximumOrigins = 100, double lagExponent = 0.05,
+                            double _k = 6.28319, double _overlapCutoff = 0.5);
+
+        //!Add the next frame, updating the unwrapped positions and all accumulators
+        void update(GPUArray<double2> &currentPos);
+
+        //!Get the origin-averaged results for every lag that has been sampled at least once
+        void getDynamics(vector<int> &lags, vector<double> &msd, vector<double> &fs, vector<double> &overlap,
+                         vector<double> &chi4Fs, vector<double> &chi4Overlap);
+
+        //!The number of frames (beyond the first) that have been added
+        int frame;
+
+    protected:
+        //!register the current unwrapped positions as a new time origin
+        void addOrigin();
+        //!accumulate all observables for the origins at a scheduled lag from the current frame
+        void accumulate();
+        //!extend besselJ0 and besselJ1 so that they cover [0,xMax]
+        void extendBesselTables(double xMax);
+        //!J_0(x), by cubic Hermite interpolation in the tables (J_0' = -J_1); the error is below 4e-14
+        static inline __attribute__((always_inline)) double tabulatedJ0(double x, const double *j0, const double *j1)
+            {
+            double t = x*besselTableDensity;
+            int idx = (int) t;
+            double f = t - idx;
+            double h = 1.0/besselTableDensity;
+            double g = 1.0 - f;
+            return g*g*((1.0+2.0*f)*j0[idx] - f*h*j1[idx]) + f*f*((3.0-2.0*f)*j0[idx+1] + g*h*j1[idx+1]);
+            };
+
+        //!The number of frames between time origins
+        int originSpacing;
+        //!The size of the ring of time origins
+        int maximumOrigins;
+        //!wavevector magnitude for F_s and chi_4
+        double k;
+        //!cutoff distance for the overlap function
+        double overlapCutoff;
+
+        //!The wrapped positions of the previous frame
+        vector<double2> previousPos;
+        //!The current unwrapped positions
+        vector<double2> unwrappedPos;
+        //!The unwrapped positions at each stored time origin
+        vector<vector<double2> > originPos;
+        //!The frame at which each stored time origin was set (-1 if the slot is unused)
+        vector<int> originFrame;
+        //!The next slot of the origin ring to be overwritten
+        int nextOriginSlot;
+
+        //!The log-spaced lag times (in frames) at which observables are accumulated
+        vector<int> lagValues;
+        //!lagBin[l] is the index in lagValues of lag l, or -1 if it is not sampled
+        vector<int> lagBin;
+
+        //!number of entries per unit of x in besselJ0 and besselJ1
+        static const int besselTableDensity = 512;
+        //!J_0(x) and J_1(x) at x = t/besselTableDensity, extended as larger values of k|d| are met
+        vector<double> besselJ0, besselJ1;
+
+        //!per-lag number of samples
+        vector<int> nSamples;
+        //!per-lag accumulated MSD
+        vector<double> msdSum;
+        //!per-lag accumulated F_s
+        vector<double> fsSum;
+        //!per-lag accumulated angular average of F_s^2
+        vector<double> fs2Sum;
+        //!per-lag accumulated overlap
+        vector<double> overlapSum;
+        //!per-lag accumulated overlap squared
+        vector<double> overlap2Sum;
+    };
+#endif
@@ -148,10 +148,15 @@ unsigned long baseHDF5Database::getDatasetDimensions(std::string name)
     herr_t ndims = H5Sget_simple_extent_dims(dataspace,dims,NULL);
     if(ndims<0)
         ERRORERROR("failed to get dimensions\n");
-    H5Dclose(dataspace);
+    H5Sclose(dataspace);
     return dims[0];
     };
 
+bool baseHDF5Database::datasetExists(std::string name)
+    {
+    return H5Lexists(hdf5File,name.c_str(),H5P_DEFAULT) > 0;
+    };
+
 template<typename T>
 void baseHDF5Database::extendDataset(std::string name,std::vector<T> &data)
     {
@@ -224,7 +229,6 @@ void baseHDF5Database::readDataset(std::string name,std::vector<T> &data, int re
     hsize_t rowIndex = record;
     if(record < 0)
         rowIndex = dims[0]-1;
-    std::cerr << record << " " <<dims[0] << " " << dims[1] << " " << rowIndex << "\n";
     if(rowIndex >= dims[0])
         ERRORERROR("Trying to read past the end of the dataset\n");
 
@@ -236,7 +240,7 @@ void baseHDF5Database::readDataset(std::string name,std::vector<T> &data, int re
 
     H5Dread(dataset.internalId,getDatatypeFor<T>(),memorySpace.internalId,dataspace, H5P_DEFAULT, data.data());
 
-    H5Dclose(dataspace);
+    H5Sclose(dataspace);
     };
 
 void baseHDF5Database::readTest(int record)
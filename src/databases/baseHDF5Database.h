@@ -51,6 +51,9 @@ class baseHDF5Database : public baseDatabaseInformation
         //! A helper function to get the number of records in a named dataset
         unsigned long getDatasetDimensions(std::string name);
 
+        //! Does a dataset with the given name exist in the file?
+        bool datasetExists(std::string name);
+
         //! read a record of a named dataset. Default to the final row
         template<typename T>
         void readDataset(std::string name, std::vector<T> &readData, int record = -1);
@@ -0,0 +1,120 @@
+#include "ensembleDatabase.h"
+#include "debuggingHelp.h"
+/*! \file ensembleDatabase.cpp */
+
+ensembleDatabase::ensembleDatabase(int _replicas, int _N, string fn, fileMode::Enum _mode)
+    : baseHDF5Database(fn,_mode)
+    {
+    objectName = "ensembleDatabase";
+    replicas = _replicas;
+    N = _N;
+    timeVector.resize(replicas);
+    boxVector.resize(4*replicas);
+    coordinateVector.resize(2*N*replicas);
+    imageVector.resize(2*N*replicas);
+
+    if(mode == fileMode::replace)
+        registerDatasets();
+    if(mode == fileMode::readwrite && !datasetExists("time"))
+        registerDatasets();
+    logMessage(logger::verbose, "ensembleDatabase initialized");
+    };
+
+void ensembleDatabase::registerDatasets()
+    {
+    addHeaderData<int>("replicas",vector<int>(1,replicas));
+    addHeaderData<int>("degreesOfFreedom",vector<int>(1,N));
+    registerExtendableDataset<double>("time",replicas);
+    registerExtendableDataset<double>("boxMatrix",4*replicas);
+    registerExtendableDataset<double>("position",2*N*replicas);
+    registerExtendableDataset<int>("image",2*N*replicas);
+    registerExtendableDataset<double>("velocity",2*N*replicas);
+    };
+
+unsigned long ensembleDatabase::currentNumberOfRecords()
+    {
+    return getDatasetDimensions("time");
+    };
+
+void ensembleDatabase::writeState(const vector<STATE> &configurations)
+    {
+    PROFILE_SCOPE("ensembleDatabase::writeState");
+    if(configurations.size() != (size_t)replicas)
+        ERRORERROR("ensembleDatabase: wrong number of replicas");
+    for (int rr = 0; rr < replicas; ++rr)
+        {
+        const STATE &c = configurations[rr];
+        if(c->getNumberOfDegreesOfFreedom() != N)
+            ERRORERROR("ensembleDatabase: every replica must have the same number of degrees of freedom");
+        timeVector[rr] = c->currentTime;
+        c->Box->getBoxDims(boxVector[4*rr],boxVector[4*rr+1],boxVector[4*rr+2],boxVector[4*rr+3]);
+        }
+    extendDataset("time",timeVector);
+    extendDataset("boxMatrix",boxVector);
+
+    //positions and images, ordered by the tags of cells or vertices
+    for (int rr = 0; rr < replicas; ++rr)
+        {
+        const STATE &c = configurations[rr];
+        vector<int> &tagToIdx = (&(c->returnPositions()) == &(c->vertexPositions)) ? c->tagToIdxVertex : c->tagToIdx;
+        ArrayHandle<double2> h_p(c->returnPositions(),access_location::host,access_mode::read);
+        ArrayHandle<int2> h_i(c->returnImages(),access_location::host,access_mode::read);
+        int offset = 2*N*rr;
+        for (int ii = 0; ii < N; ++ii)
+            {
+            int pidx = tagToIdx[ii];
+            coordinateVector[offset+2*ii] = h_p.data[pidx].x;
+            coordinateVector[offset+2*ii+1] = h_p.data[pidx].y;
+            imageVector[offset+2*ii] = h_i.data[pidx].x;
+            imageVector[offset+2*ii+1] = h_i.data[pidx].y;
+            }
+        }
+    extendDataset("position",coordinateVector);
+    extendDataset("image",imageVector);
+
+    for (int rr = 0; rr < replicas; ++rr)
+        {
+        const STATE &c = configurations[rr];
+        vector<int> &tagToIdx = (&(c->returnPositions()) == &(c->vertexPositions)) ? c->tagToIdxVertex : c->tagToIdx;
+        ArrayHandle<double2> h_v(c->returnVelocities(),access_location::host,access_mode::read);
+        int offset = 2*N*rr;
+        for (int ii = 0; ii < N; ++ii)
+            {
+            int pidx = tagToIdx[ii];
+            coordinateVector[offset+2*ii] = h_v.data[pidx].x;
+            coordinateVector[offset+2*ii+1] = h_v.data[pidx].y;
+            }
+        }
+    extendDataset("velocity",coordinateVector);
+    };
+
+/*!
+\param box is set to the box of the replica
+\param positions is filled with the positions of the replica's degrees of freedom, ordered by tag
+*/
+void ensembleDatabase::readReplica(int replica, int rec, double &time, PeriodicBoxPtr box, vector<double2> &positions, bool unwrapped)
+    {
+    PROFILE_SCOPE("ensembleDatabase::readReplica");
+    if(replica < 0 || replica >= replicas)
+        ERRORERROR("ensembleDatabase: no such replica");
+    readDataset("time",timeVector,rec);
+    time = timeVector[replica];
+    readDataset("boxMatrix",boxVector,rec);
+    box->setGeneral(boxVector[4*replica],boxVector[4*replica+1],boxVector[4*replica+2],boxVector[4*replica+3]);
+    readDataset("position",coordinateVector,rec);
+    if(unwrapped)
+        readDataset("image",imageVector,rec);
+    positions.resize(N);
+    int offset = 2*N*replica;
+    for (int ii = 0; ii < N; ++ii)
+        {
+        double2 p = make_double2(coordinateVector[offset+2*ii],coordinateVector[offset+2*ii+1]);
+        if(unwrapped)
+            {
+            int2 image = make_int2(imageVector[offset+2*ii],imageVector[offset+2*ii+1]);
+            box->unwrap(p,image,positions[ii]);
+            }
+        else
+            positions[ii] = p;
+        }
+    };
@@ -0,0 +1,47 @@
+#ifndef ENSEMBLEDATABASE_H
+#define ENSEMBLEDATABASE_H
+
+#include "baseHDF5Database.h"
+
+/*! \file ensembleDatabase.h */
+//!A database that stores the states of every replica of an Ensemble in one file
+/*!
+Every call of writeState appends one record holding all replicas, so that a whole sweep ends up in a
+single hdf5 file with a replica dimension. Each dataset row is laid out replica by replica:
+    time        replicas                 (the simulation time of each replica)
+    boxMatrix   replicas x 4
+    position    replicas x N x 2         (wrapped positions of the degrees of freedom, ordered by tag)
+    image       replicas x N x 2         (periodic image counters, so unwrapped positions can be reconstructed)
+    velocity    replicas x N x 2
+so a row of "position" can be read as an array of shape (replicas, N, 2). N is the number of degrees of
+freedom (cells in Voronoi models, vertices in vertex models), which must be the same for all replicas.
+The header holds "replicas" and "degreesOfFreedom"; per-replica parameters (seeds, p0, v0, ...) can be
+added with addHeaderData.
+The states are gathered and written by the calling thread, between calls of Ensemble::performTimesteps.
+*/
+class ensembleDatabase : public baseHDF5Database
+    {
+    public:
+        //!A database for the given number of replicas, each with N degrees of freedom
+        ensembleDatabase(int _replicas, int _N, string fn="ensemble.h5", fileMode::Enum _mode=fileMode::readonly);
+
+        //!Append the current state of every replica as a new record
+        void writeState(const vector<STATE> &configurations);
+        //!Read the time, box and positions (unwrapped, if requested) of one replica in record rec (-1 means the last one)
+        void readReplica(int replica, int rec, double &time, PeriodicBoxPtr box, vector<double2> &positions, bool unwrapped = false);
+        //! The number of records that have been saved so far
+        unsigned long currentNumberOfRecords();
+
+    protected:
+        void registerDatasets();
+        //!the number of replicas
+        int replicas;
+        //!the number of degrees of freedom per replica
+        int N;
+
+        std::vector<double> timeVector;
+        std::vector<double> boxVector;
+        std::vector<double> coordinateVector;
+        std::vector<int> imageVector;
+    };
+#endif
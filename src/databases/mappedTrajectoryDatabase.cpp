@@ -0,0 +1,589 @@
+#include "mappedTrajectoryDatabase.h"
+#include "baseHDF5Database.h"
+#include "debuggingHelp.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*! \file mappedTrajectoryDatabase.cpp */
+
+//!Frames, and the sections within them, start at multiples of this many bytes
+static const size_t trajectoryAlignment = 64;
+
+static size_t alignedSize(size_t bytes)
+    {
+    return ((bytes + trajectoryAlignment - 1)/trajectoryAlignment)*trajectoryAlignment;
+    };
+
+//!Map a whole file for reading, returning NULL if it cannot be opened or is empty
+static char *mapFile(const string &fileName, size_t &bytes)
+    {
+    bytes = 0;
+    int descriptor = open(fileName.c_str(),O_RDONLY);
+    if(descriptor < 0)
+        return NULL;
+    struct stat status;
+    fstat(descriptor,&status);
+    bytes = status.st_size;
+    char *mapping = NULL;
+    if(bytes > 0)
+        {
+        void *mapped = mmap(NULL,bytes,PROT_READ,MAP_PRIVATE,descriptor,0);
+        if(mapped != MAP_FAILED)
+            mapping = (char *)mapped;
+        };
+    close(descriptor);
+    return mapping;
+    };
+
+mappedTrajectoryDatabase::mappedTrajectoryDatabase(string fn, fileMode::Enum _mode, bool _storeTopology)
+    : sized(false), storeTopology(_storeTopology), output(NULL), indexOnDisk(false), mapping(NULL), mappingSize(0)
+    {
+    objectName = "mappedTrajectoryDatabase";
+    filename = fn;
+    mode = _mode;
+    Records = 0;
+    memset(&header,0,sizeof(header));
+
+    if(mode == fileMode::readonly)
+        {
+        mapping = mapFile(filename,mappingSize);
+        if(mapping == NULL || !readHeader(mapping,mappingSize))
+            {
+            printf("could not map the trajectory %s\n",filename.c_str());
+            throw std::exception();
+            };
+        findFrames(mapping,mappingSize);
+        };
+    if(mode == fileMode::readwrite)
+        {
+        //continue an existing trajectory after its last complete frame, dropping the old index
+        size_t bytes;
+        char *existing = mapFile(filename,bytes);
+        if(existing != NULL)
+            {
+            if(!readHeader(existing,bytes))
+                {
+                munmap(existing,bytes);
+                printf("%s is not a cellGPU trajectory\n",filename.c_str());
+                throw std::exception();
+                };
+            findFrames(existing,bytes);
+            munmap(existing,bytes);
+            storeTopology = hasTopology();
+            frameBuffer.assign(header.frameStride,0);
+            sized = true;
+            output = fopen(filename.c_str(),"r+b");
+            if(output != NULL && ftruncate(fileno(output),header.firstFrame + Records*header.frameStride) != 0)
+                ERRORERROR("could not truncate the index of the trajectory");
+            }
+        else
+            output = fopen(filename.c_str(),"w+b");
+        };
+    if(mode == fileMode::replace)
+        output = fopen(filename.c_str(),"w+b");
+    if(mode != fileMode::readonly && output == NULL)
+        {
+        printf("could not open the trajectory %s for writing\n",filename.c_str());
+        throw std::exception();
+        };
+    logMessage(logger::verbose, "mappedTrajectoryDatabase initialized");
+    };
+
+mappedTrajectoryDatabase::~mappedTrajectoryDatabase()
+    {
+    if(output != NULL)
+        {
+        flush();
+        fclose(output);
+        };
+    if(mapping != NULL)
+        munmap(mapping,mappingSize);
+    };
+
+/*!
+Sections are placed one after the other behind the 64 byte frame header; a section that is not stored
+keeps the offset zero
+*/
+void mappedTrajectoryDatabase::setLayout(bool vertexModel, int Ncells, int degreesOfFreedom)
+    {
+    memset(&header,0,sizeof(header));
+    memcpy(header.magic,"cellGPUt",8);
+    header.version = mappedTrajectoryFormatVersion;
+    header.vertexModel = vertexModel ? 1 : 0;
+    header.Ncells = Ncells;
+    header.degreesOfFreedom = degreesOfFreedom;
+
+    vector<size_t> bytes(trajectorySection::count,0);
+    bytes[trajectorySection::position] = sizeof(double2)*degreesOfFreedom;
+    bytes[trajectorySection::image] = sizeof(int2)*degreesOfFreedom;
+    bytes[trajectorySection::velocity] = sizeof(double2)*degreesOfFreedom;
+    bytes[trajectorySection::type] = sizeof(int)*Ncells;
+    if(vertexModel)
+        bytes[trajectorySection::cellPosition] = sizeof(double2)*Ncells;
+    if(storeTopology && !vertexModel)
+        {
+        bytes[trajectorySection::neighborNum] = sizeof(int)*Ncells;
+        bytes[trajectorySection::neighborOffset] = sizeof(int)*Ncells;
+        bytes[trajectorySection::neighbor] = sizeof(int)*6*Ncells;
+        };
+    if(storeTopology && vertexModel)
+        {
+        bytes[trajectorySection::vertexNeighbor] = sizeof(int)*3*degreesOfFreedom;
+        bytes[trajectorySection::vertexCellNeighbor] = sizeof(int)*3*degreesOfFreedom;
+        bytes[trajectorySection::cellVertexNum] = sizeof(int)*Ncells;
+        bytes[trajectorySection::cellVertexOffset] = sizeof(int)*Ncells;
+        bytes[trajectorySection::cellVertex] = sizeof(int)*3*degreesOfFreedom;
+        };
+    size_t offset = alignedSize(sizeof(trajectoryFrameHeader));
+    for (int ss = 0; ss < trajectorySection::count; ++ss)
+        if(bytes[ss] > 0)
+            {
+            header.sections[ss] = offset;
+            offset += alignedSize(bytes[ss]);
+            };
+    header.frameStride = offset;
+    header.firstFrame = alignedSize(sizeof(mappedTrajectoryHeader));
+    frameBuffer.assign(header.frameStride,0);
+    sized = true;
+    };
+
+bool mappedTrajectoryDatabase::readHeader(const char *data, size_t bytes)
+    {
+    if(bytes < sizeof(mappedTrajectoryHeader))
+        return false;
+    memcpy(&header,data,sizeof(header));
+    if(memcmp(header.magic,"cellGPUt",8) != 0 || header.frameStride == 0)
+        return false;
+    if(header.version > mappedTrajectoryFormatVersion)
+        {
+        printf("%s was written in trajectory format %u, but only formats up to %u can be read\n",
+               filename.c_str(),header.version,mappedTrajectoryFormatVersion);
+        throw std::exception();
+        };
+    sized = true;
+    return true;
+    };
+
+/*!
+A complete file ends with its index, which is used if it is consistent with the header; otherwise every
+stride-sized block after the header whose frame header carries the right frame number is taken as a frame
+*/
+void mappedTrajectoryDatabase::findFrames(const char *data, size_t bytes)
+    {
+    frameTimes.clear();
+    frameOffsets.clear();
+    if(bytes >= header.firstFrame + sizeof(trajectoryIndexTrailer))
+        {
+        trajectoryIndexTrailer trailer;
+        memcpy(&trailer,data + bytes - sizeof(trailer),sizeof(trailer));
+        if(memcmp(trailer.magic,"cellGPUi",8) == 0 &&
+           trailer.indexOffset == header.firstFrame + trailer.numberOfFrames*header.frameStride &&
+           trailer.indexOffset + trailer.numberOfFrames*sizeof(trajectoryIndexEntry) + sizeof(trailer) == bytes)
+            {
+            const trajectoryIndexEntry *entries = (const trajectoryIndexEntry *)(data + trailer.indexOffset);
+            for (unsigned long long ff = 0; ff < trailer.numberOfFrames; ++ff)
+                {
+                frameTimes.push_back(entries[ff].time);
+                frameOffsets.push_back(entries[ff].offset);
+                };
+            Records = frameTimes.size();
+            return;
+            };
+        };
+
+    for (unsigned long long offset = header.firstFrame; offset + header.frameStride <= bytes; offset += header.frameStride)
+        {
+        trajectoryFrameHeader frame;
+        memcpy(&frame,data + offset,sizeof(frame));
+        if(frame.frame != frameTimes.size())
+            break;
+        frameTimes.push_back(frame.time);
+        frameOffsets.push_back(offset);
+        };
+    Records = frameTimes.size();
+    logMessage(logger::warning, "the index of the trajectory is missing; recovered "+to_string(Records)+" frames");
+    };
+
+void mappedTrajectoryDatabase::fillFrame(STATE c, double time)
+    {
+    char *frame = frameBuffer.data();
+    int Ncells = header.Ncells;
+    int degreesOfFreedom = header.degreesOfFreedom;
+    bool vertexModel = isVertexModel();
+
+    trajectoryFrameHeader frameHeader;
+    memset(&frameHeader,0,sizeof(frameHeader));
+    frameHeader.time = time;
+    c->Box->getBoxDims(frameHeader.box[0],frameHeader.box[1],frameHeader.box[2],frameHeader.box[3]);
+    frameHeader.frame = Records;
+    memcpy(frame,&frameHeader,sizeof(frameHeader));
+
+    //positions, images and velocities of the degrees of freedom, and the types of the cells, by tag
+    vector<int> &tagToIdx = vertexModel ? c->tagToIdxVertex : c->tagToIdx;
+    {//scope for array handles
+    ArrayHandle<double2> h_p(c->returnPositions(),access_location::host,access_mode::read);
+    ArrayHandle<int2> h_i(c->returnImages(),access_location::host,access_mode::read);
+    ArrayHandle<double2> h_v(c->returnVelocities(),access_location::host,access_mode::read);
+    double2 *positions = (double2 *)(frame + header.sections[trajectorySection::position]);
+    int2 *images = (int2 *)(frame + header.sections[trajectorySection::image]);
+    double2 *velocities = (double2 *)(frame + header.sections[trajectorySection::velocity]);
+    for (int ii = 0; ii < degreesOfFreedom; ++ii)
+        {
+        int pidx = tagToIdx[ii];
+        positions[ii] = h_p.data[pidx];
+        images[ii] = h_i.data[pidx];
+        velocities[ii] = h_v.data[pidx];
+        };
+    ArrayHandle<int> h_ct(c->cellType,access_location::host,access_mode::read);
+    int *types = (int *)(frame + header.sections[trajectorySection::type]);
+    for (int ii = 0; ii < Ncells; ++ii)
+        types[ii] = h_ct.data[c->tagToIdx[ii]];
+    };
+
+    shared_ptr<vertexModelBase> vm = dynamic_pointer_cast<vertexModelBase>(c);
+    if(vertexModel)
+        {
+        vm->getCellPositions();
+        ArrayHandle<double2> h_cp(vm->cellPositions,access_location::host,access_mode::read);
+        double2 *cellPositions = (double2 *)(frame + header.sections[trajectorySection::cellPosition]);
+        for (int ii = 0; ii < Ncells; ++ii)
+            cellPositions[ii] = h_cp.data[c->tagToIdx[ii]];
+        };
+    if(!hasTopology())
+        return;
+
+    //neighbor lists, with every index translated to a tag
+    cellTags.resize(Ncells);
+    for (int ii = 0; ii < Ncells; ++ii)
+        cellTags[c->tagToIdx[ii]] = ii;
+    if(!vertexModel)
+        {
+        ArrayHandle<int> h_nn(c->neighborNum,access_location::host,access_mode::read);
+        ArrayHandle<int> h_n(c->neighbors,access_location::host,access_mode::read);
+        int *neighborNum = (int *)(frame + header.sections[trajectorySection::neighborNum]);
+        int *neighborOffsets = (int *)(frame + header.sections[trajectorySection::neighborOffset]);
+        int *neighbors = (int *)(frame + header.sections[trajectorySection::neighbor]);
+        int offset = 0;
+        for (int ii = 0; ii < Ncells; ++ii)
+            {
+            int cidx = c->tagToIdx[ii];
+            int neighs = h_nn.data[cidx];
+            if(offset + neighs > 6*Ncells)
+                ERRORERROR("the triangulation has more than 6 neighbors per cell on average");
+            neighborNum[ii] = neighs;
+            neighborOffsets[ii] = offset;
+            for (int nn = 0; nn < neighs; ++nn)
+                neighbors[offset+nn] = cellTags[h_n.data[c->n_idx(nn,cidx)]];
+            offset += neighs;
+            };
+        if(offset != 6*Ncells)
+            ERRORERROR("the triangulation has fewer than 6 neighbors per cell on average");
+        }
+    else
+        {
+        vertexTags.resize(degreesOfFreedom);
+        for (int ii = 0; ii < degreesOfFreedom; ++ii)
+            vertexTags[c->tagToIdxVertex[ii]] = ii;
+        ArrayHandle<int> h_vn(vm->vertexNeighbors,access_location::host,access_mode::read);
+        ArrayHandle<int> h_vcn(vm->vertexCellNeighbors,access_location::host,access_mode::read);
+        int *vertexNeighbors = (int *)(frame + header.sections[trajectorySection::vertexNeighbor]);
+        int *vertexCellNeighbors = (int *)(frame + header.sections[trajectorySection::vertexCellNeighbor]);
+        for (int ii = 0; ii < degreesOfFreedom; ++ii)
+            {
+            int vidx = c->tagToIdxVertex[ii];
+            for (int nn = 0; nn < 3; ++nn)
+                {
+                vertexNeighbors[3*ii+nn] = vertexTags[h_vn.data[3*vidx+nn]];
+                vertexCellNeighbors[3*ii+nn] = cellTags[h_vcn.data[3*vidx+nn]];
+                };
+            };
+        ArrayHandle<int> h_cvn(vm->cellVertexNum,access_location::host,access_mode::read);
+        ArrayHandle<int> h_cv(vm->cellVertices,access_location::host,access_mode::read);
+        int *cellVertexNum = (int *)(frame + header.sections[trajectorySection::cellVertexNum]);
+        int *cellVertexOffsets = (int *)(frame + header.sections[trajectorySection::cellVertexOffset]);
+        int *cellVertices = (int *)(frame + header.sections[trajectorySection::cellVertex]);
+        int offset = 0;
+        for (int ii = 0; ii < Ncells; ++ii)
+            {
+            int cidx = c->tagToIdx[ii];
+            int neighs = h_cvn.data[cidx];
+            if(offset + neighs > 3*degreesOfFreedom)
+                ERRORERROR("the cells have more vertices than three per vertex");
+            cellVertexNum[ii] = neighs;
+            cellVertexOffsets[ii] = offset;
+            for (int nn = 0; nn < neighs; ++nn)
+                cellVertices[offset+nn] = vertexTags[h_cv.data[vm->n_idx(nn,cidx)]];
+            offset += neighs;
+            };
+        if(offset != 3*degreesOfFreedom)
+            ERRORERROR("the cells have fewer vertices than three per vertex");
+        };
+    };
+
+/*!
+The first state written sizes the file; every later state must come from the same kind of model with
+the same number of cells and degrees of freedom
+*/
+void mappedTrajectoryDatabase::writeState(STATE c, double time, int rec)
+    {
+    PROFILE_SCOPE("mappedTrajectoryDatabase::writeState");
+    if(mode == fileMode::readonly)
+        ERRORERROR("the trajectory was opened readonly");
+    if(rec >= 0)
+        ERRORERROR("overwriting specific records not implemented at the moment");
+    bool vertexModel = (dynamic_pointer_cast<vertexModelBase>(c) != NULL);
+    if(!sized)
+        {
+        setLayout(vertexModel,c->Ncells,c->getNumberOfDegreesOfFreedom());
+        vector<char> headerBlock(header.firstFrame,0);
+        memcpy(headerBlock.data(),&header,sizeof(header));
+        if(fseeko(output,0,SEEK_SET) != 0 || fwrite(headerBlock.data(),1,headerBlock.size(),output) != headerBlock.size())
+            ERRORERROR("could not write the header of the trajectory");
+        };
+    if(vertexModel != isVertexModel() || c->Ncells != (int)header.Ncells ||
+       c->getNumberOfDegreesOfFreedom() != (int)header.degreesOfFreedom)
+        ERRORERROR("every state of a trajectory must come from the same kind and size of model");
+    if (time < 0) time = c->currentTime;
+
+    fillFrame(c,time);
+    unsigned long long offset = header.firstFrame + Records*header.frameStride;
+    //a flushed index is overwritten by the new frame, and must not linger behind it
+    fflush(output);
+    if(indexOnDisk && ftruncate(fileno(output),offset) != 0)
+        ERRORERROR("could not remove the old index of the trajectory");
+    indexOnDisk = false;
+    if(fseeko(output,offset,SEEK_SET) != 0 || fwrite(frameBuffer.data(),1,frameBuffer.size(),output) != frameBuffer.size())
+        ERRORERROR("could not write a frame of the trajectory");
+    frameTimes.push_back(time);
+    frameOffsets.push_back(offset);
+    Records += 1;
+    };
+
+void mappedTrajectoryDatabase::flush()
+    {
+    if(output == NULL || !sized || indexOnDisk)
+        return;
+    vector<trajectoryIndexEntry> entries(Records);
+    for (int ff = 0; ff < Records; ++ff)
+        {
+        entries[ff].time = frameTimes[ff];
+        entries[ff].offset = frameOffsets[ff];
+        };
+    trajectoryIndexTrailer trailer;
+    memcpy(trailer.magic,"cellGPUi",8);
+    trailer.numberOfFrames = Records;
+    trailer.indexOffset = header.firstFrame + Records*header.frameStride;
+    bool success = fseeko(output,trailer.indexOffset,SEEK_SET) == 0;
+    if(Records > 0)
+        success = success && fwrite(entries.data(),sizeof(trajectoryIndexEntry),Records,output) == (size_t)Records;
+    success = success && fwrite(&trailer,sizeof(trailer),1,output) == 1;
+    success = success && fflush(output) == 0;
+    if(!success)
+        ERRORERROR("could not write the index of the trajectory");
+    indexOnDisk = true;
+    };
+
+double mappedTrajectoryDatabase::frameTime(int rec)
+    {
+    if(rec < 0 || rec >= Records)
+        ERRORERROR("no such frame in the trajectory");
+    return frameTimes[rec];
+    };
+
+trajectoryFrame mappedTrajectoryDatabase::getFrame(int rec)
+    {
+    if(mapping == NULL)
+        ERRORERROR("frames can only be viewed in readonly mode");
+    if(rec < 0)
+        rec = Records-1;
+    if(rec < 0 || rec >= Records)
+        ERRORERROR("no such frame in the trajectory");
+    int Ncells = header.Ncells;
+    int degreesOfFreedom = header.degreesOfFreedom;
+
+    trajectoryFrame f;
+    trajectoryFrameHeader frameHeader;
+    memcpy(&frameHeader,mapping + frameOffsets[rec],sizeof(frameHeader));
+    f.time = frameHeader.time;
+    for (int ii = 0; ii < 4; ++ii)
+        f.box[ii] = frameHeader.box[ii];
+    f.positions = section<double2>(rec,trajectorySection::position,degreesOfFreedom);
+    f.images = section<int2>(rec,trajectorySection::image,degreesOfFreedom);
+    f.velocities = section<double2>(rec,trajectorySection::velocity,degreesOfFreedom);
+    f.types = section<int>(rec,trajectorySection::type,Ncells);
+    f.cellPositions = isVertexModel() ? section<double2>(rec,trajectorySection::cellPosition,Ncells) : f.positions;
+    f.neighborNum = section<int>(rec,trajectorySection::neighborNum,Ncells);
+    f.neighborOffsets = section<int>(rec,trajectorySection::neighborOffset,Ncells);
+    f.neighbors = section<int>(rec,trajectorySection::neighbor,6*Ncells);
+    f.vertexNeighbors = section<int>(rec,trajectorySection::vertexNeighbor,3*degreesOfFreedom);
+    f.vertexCellNeighbors = section<int>(rec,trajectorySection::vertexCellNeighbor,3*degreesOfFreedom);
+    f.cellVertexNum = section<int>(rec,trajectorySection::cellVertexNum,Ncells);
+    f.cellVertexOffsets = section<int>(rec,trajectorySection::cellVertexOffset,Ncells);
+    f.cellVertices = section<int>(rec,trajectorySection::cellVertex,3*degreesOfFreedom);
+    return f;
+    };
+
+/*!
+\param n_idx is set so that the k-th neighbor of cell i is neighbors[n_idx(k,i)], with room for the
+largest number of neighbors in the frame
+*/
+void mappedTrajectoryDatabase::getNeighborLists(int rec, GPUArray<int> &neighbors, GPUArray<int> &neighborNum, Index2D &n_idx)
+    {
+    trajectoryFrame f = getFrame(rec);
+    if(f.neighborNum.empty())
+        ERRORERROR("the trajectory does not store Delaunay neighbors");
+    int Ncells = header.Ncells;
+    int neighMax = *max_element(f.neighborNum.begin(),f.neighborNum.end());
+    n_idx = Index2D(neighMax,Ncells);
+    f.neighborNum.copyTo(neighborNum);
+    neighbors.resize(neighMax*Ncells);
+    ArrayHandle<int> h_n(neighbors,access_location::host,access_mode::overwrite);
+    for (int ii = 0; ii < Ncells; ++ii)
+        for (int nn = 0; nn < f.neighborNum[ii]; ++nn)
+            h_n.data[n_idx(nn,ii)] = f.neighbors[f.neighborOffsets[ii]+nn];
+    };
+
+void mappedTrajectoryDatabase::readState(STATE c, int rec, bool geometry)
+    {
+    PROFILE_SCOPE("mappedTrajectoryDatabase::readState");
+    trajectoryFrame f = getFrame(rec);
+    shared_ptr<vertexModelBase> vm = dynamic_pointer_cast<vertexModelBase>(c);
+    shared_ptr<voronoiModelBase> vor = dynamic_pointer_cast<voronoiModelBase>(c);
+    if((vm != NULL) != isVertexModel() || c->Ncells != (int)header.Ncells ||
+       c->getNumberOfDegreesOfFreedom() != (int)header.degreesOfFreedom)
+        ERRORERROR("the model does not match the trajectory");
+    if(vm != NULL && !hasTopology())
+        ERRORERROR("vertex models can only be read from trajectories that store the topology");
+
+    c->Box->setGeneral(f.box[0],f.box[1],f.box[2],f.box[3]);
+    {//scope for array handles
+    ArrayHandle<double2> h_p(c->returnPositions(),access_location::host,access_mode::overwrite);
+    memcpy(h_p.data,f.positions.data,sizeof(double2)*f.positions.size);
+    ArrayHandle<int2> h_i(c->returnImages(),access_location::host,access_mode::overwrite);
+    memcpy(h_i.data,f.images.data,sizeof(int2)*f.images.size);
+    ArrayHandle<double2> h_v(c->returnVelocities(),access_location::host,access_mode::overwrite);
+    memcpy(h_v.data,f.velocities.data,sizeof(double2)*f.velocities.size);
+    ArrayHandle<int> h_ct(c->cellType,access_location::host,access_mode::overwrite);
+    memcpy(h_ct.data,f.types.data,sizeof(int)*f.types.size);
+    };
+
+    if(vor != NULL)
+        {
+        //the frame is stored by tag, which become the new indices
+        vor->initializeCellSorting();
+        if(geometry)
+            {
+            vor->globalTriangulationDelGPU();
+            vor->resetLists();
+            vor->computeGeometry();
+            };
+        return;
+        };
+
+    vm->initializeCellSorting();
+    vm->initializeVertexSorting();
+    int neighMax = *max_element(f.cellVertexNum.begin(),f.cellVertexNum.end());
+    if(neighMax >= vm->vertexMax)
+        vm->growCellVerticesList(neighMax);
+    {//scope for array handles
+    ArrayHandle<double2> h_cp(vm->cellPositions,access_location::host,access_mode::overwrite);
+    memcpy(h_cp.data,f.cellPositions.data,sizeof(double2)*f.cellPositions.size);
+    ArrayHandle<int> h_vn(vm->vertexNeighbors,access_location::host,access_mode::overwrite);
+    memcpy(h_vn.data,f.vertexNeighbors.data,sizeof(int)*f.vertexNeighbors.size);
+    ArrayHandle<int> h_vcn(vm->vertexCellNeighbors,access_location::host,access_mode::overwrite);
+    memcpy(h_vcn.data,f.vertexCellNeighbors.data,sizeof(int)*f.vertexCellNeighbors.size);
+    ArrayHandle<int> h_cvn(vm->cellVertexNum,access_location::host,access_mode::overwrite);
+    memcpy(h_cvn.data,f.cellVertexNum.data,sizeof(int)*f.cellVertexNum.size);
+    ArrayHandle<int> h_cv(vm->cellVertices,access_location::host,access_mode::readwrite);
+    for (int ii = 0; ii < (int)header.Ncells; ++ii)
+        for (int nn = 0; nn < f.cellVertexNum[ii]; ++nn)
+            h_cv.data[vm->n_idx(nn,ii)] = f.cellVertices[f.cellVertexOffsets[ii]+nn];
+    };
+    vm->halfEdgesCurrent = false;
+    if(geometry)
+        vm->computeGeometry();
+    };
+
+/*!
+The datasets are those of simpleVoronoiDatabase (time, boxMatrix, type, position, image, velocity) or
+simpleVertexDatabase (time, boxMatrix, cellType, vertexPosition, vertexImage, cellPosition,
+vertexVertexNeighbors, vertexCellNeighbors), plus the velocities of vertices and, if stored, the compact
+topology (neighborNum and neighbors, or cellVertexNum and cellVertices) with every index a tag
+*/
+void mappedTrajectoryDatabase::exportToHDF5(const string &fileName)
+    {
+    PROFILE_SCOPE("mappedTrajectoryDatabase::exportToHDF5");
+    if(mapping == NULL)
+        ERRORERROR("only trajectories opened readonly can be exported");
+    int Ncells = header.Ncells;
+    int N = header.degreesOfFreedom;
+    bool vertexModel = isVertexModel();
+    bool topology = hasTopology();
+
+    baseHDF5Database archive(fileName,fileMode::replace);
+    archive.registerExtendableDataset<double>("time",1);
+    archive.registerExtendableDataset<double>("boxMatrix",4);
+    archive.registerExtendableDataset<int>(vertexModel ? "cellType" : "type",Ncells);
+    archive.registerExtendableDataset<double>(vertexModel ? "vertexPosition" : "position",2*N);
+    archive.registerExtendableDataset<int>(vertexModel ? "vertexImage" : "image",2*N);
+    archive.registerExtendableDataset<double>(vertexModel ? "vertexVelocity" : "velocity",2*N);
+    if(vertexModel)
+        archive.registerExtendableDataset<double>("cellPosition",2*Ncells);
+    if(topology && !vertexModel)
+        {
+        archive.registerExtendableDataset<int>("neighborNum",Ncells);
+        archive.registerExtendableDataset<int>("neighbors",6*Ncells);
+        };
+    if(topology && vertexModel)
+        {
+        archive.registerExtendableDataset<int>("vertexVertexNeighbors",3*N);
+        archive.registerExtendableDataset<int>("vertexCellNeighbors",3*N);
+        archive.registerExtendableDataset<int>("cellVertexNum",Ncells);
+        archive.registerExtendableDataset<int>("cellVertices",3*N);
+        };
+
+    vector<double> timeVector(1), boxVector(4), coordinateVector(2*N), cellCoordinateVector(2*Ncells);
+    vector<int> imageVector(2*N);
+    for (int rec = 0; rec < Records; ++rec)
+        {
+        trajectoryFrame f = getFrame(rec);
+        timeVector[0] = f.time;
+        archive.extendDataset("time",timeVector);
+        boxVector.assign(f.box,f.box+4);
+        archive.extendDataset("boxMatrix",boxVector);
+        vector<int> types = f.types.toVector();
+        archive.extendDataset(vertexModel ? "cellType" : "type",types);
+
+        memcpy(coordinateVector.data(),f.positions.data,sizeof(double2)*N);
+        archive.extendDataset(vertexModel ? "vertexPosition" : "position",coordinateVector);
+        memcpy(imageVector.data(),f.images.data,sizeof(int2)*N);
+        archive.extendDataset(vertexModel ? "vertexImage" : "image",imageVector);
+        memcpy(coordinateVector.data(),f.velocities.data,sizeof(double2)*N);
+        archive.extendDataset(vertexModel ? "vertexVelocity" : "velocity",coordinateVector);
+        if(vertexModel)
+            {
+            memcpy(cellCoordinateVector.data(),f.cellPositions.data,sizeof(double2)*Ncells);
+            archive.extendDataset("cellPosition",cellCoordinateVector);
+            };
+        if(topology && !vertexModel)
+            {
+            vector<int> neighborNum = f.neighborNum.toVector();
+            vector<int> neighbors = f.neighbors.toVector();
+            archive.extendDataset("neighborNum",neighborNum);
+            archive.extendDataset("neighbors",neighbors);
+            };
+        if(topology && vertexModel)
+            {
+            vector<int> vertexNeighbors = f.vertexNeighbors.toVector();
+            vector<int> vertexCellNeighbors = f.vertexCellNeighbors.toVector();
+            vector<int> cellVertexNum = f.cellVertexNum.toVector();
+            vector<int> cellVertices = f.cellVertices.toVector();
+            archive.extendDataset("vertexVertexNeighbors",vertexNeighbors);
+            archive.extendDataset("vertexCellNeighbors",vertexCellNeighbors);
+            archive.extendDataset("cellVertexNum",cellVertexNum);
+            archive.extendDataset("cellVertices",cellVertices);
+            };
+        };
+    };
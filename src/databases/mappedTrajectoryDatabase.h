@@ -0,0 +1,231 @@
+#ifndef MAPPEDTRAJECTORYDATABASE_H
+#define MAPPEDTRAJECTORYDATABASE_H
+
+#include "baseDatabase.h"
+#include "voronoiModelBase.h"
+#include "vertexModelBase.h"
+
+/*! \file mappedTrajectoryDatabase.h */
+
+//!The version of the trajectory format written by mappedTrajectoryDatabase
+const unsigned int mappedTrajectoryFormatVersion = 1;
+
+//!The per-frame sections of a mapped trajectory
+struct trajectorySection
+    {
+    //!An enumeration of the sections, in the order they appear in a frame
+    enum Enum
+        {
+        position,           //!< double2 per degree of freedom
+        image,              //!< int2 per degree of freedom
+        velocity,           //!< double2 per degree of freedom
+        type,               //!< int per cell
+        cellPosition,       //!< double2 per cell (vertex models only)
+        neighborNum,        //!< int per cell: the number of Delaunay neighbors (Voronoi models)
+        neighborOffset,     //!< int per cell: where the neighbors of each cell start
+        neighbor,           //!< 6*Ncells ints: the Delaunay neighbors of every cell
+        vertexNeighbor,     //!< 3 ints per vertex: the vertices connected to each vertex (vertex models)
+        vertexCellNeighbor, //!< 3 ints per vertex: the cells each vertex touches
+        cellVertexNum,      //!< int per cell: the number of vertices of each cell
+        cellVertexOffset,   //!< int per cell: where the vertices of each cell start
+        cellVertex,         //!< 3*Nvertices ints: the vertices of every cell, counter-clockwise
+        count               //!< the number of sections
+        };
+    };
+
+//!The header at the start of a mapped trajectory
+struct mappedTrajectoryHeader
+    {
+    char magic[8];
+    unsigned int version;
+    unsigned int vertexModel;
+    unsigned int Ncells;
+    unsigned int degreesOfFreedom;
+    unsigned long long frameStride;
+    unsigned long long firstFrame;
+    //!The offset of each section from the start of a frame, or zero if the section is not stored
+    unsigned long long sections[trajectorySection::count];
+    };
+
+//!The 64 bytes at the start of every frame
+struct trajectoryFrameHeader
+    {
+    double time;
+    double box[4];
+    unsigned long long frame;
+    unsigned long long unused[2];
+    };
+
+//!One entry of the index at the end of a mapped trajectory
+struct trajectoryIndexEntry
+    {
+    double time;
+    unsigned long long offset;
+    };
+
+//!The last bytes of a complete mapped trajectory
+struct trajectoryIndexTrailer
+    {
+    char magic[8];
+    unsigned long long numberOfFrames;
+    unsigned long long indexOffset;
+    };
+
+//!A read-only view of a contiguous run of elements in a mapped trajectory
+template<typename T>
+struct trajectorySpan
+    {
+    const T *data = NULL;
+    size_t size = 0;
+
+    const T & operator[](size_t i) const {return data[i];};
+    const T * begin() const {return data;};
+    const T * end() const {return data+size;};
+    bool empty() const {return size == 0;};
+    //!A copy of the span, for code that wants a vector
+    vector<T> toVector() const {return vector<T>(data,data+size);};
+    //!Copy the span into a GPUArray (resized as needed), for the analysis classes that take one
+    void copyTo(GPUArray<T> &array) const
+        {
+        if(array.getNumElements() != size)
+            array.resize(size);
+        if(size == 0)
+            return;
+        ArrayHandle<T> h(array,access_location::host,access_mode::overwrite);
+        memcpy(h.data,data,size*sizeof(T));
+        };
+    };
+
+//!Every per-frame quantity of a mapped trajectory, as views into the mapped file
+/*!
+Everything is ordered by tag, and neighbor lists refer to tags. The Delaunay neighbors of cell i are
+neighbors[neighborOffsets[i]], ... neighbors[neighborOffsets[i]+neighborNum[i]-1], and the vertices of
+a cell are found through cellVertexNum and cellVertexOffsets in the same way. Spans of sections that
+are not stored are empty; for Voronoi models cellPositions is the same span as positions.
+*/
+struct trajectoryFrame
+    {
+    double time;
+    double box[4];
+    trajectorySpan<double2> positions;
+    trajectorySpan<int2> images;
+    trajectorySpan<double2> velocities;
+    trajectorySpan<int> types;
+    trajectorySpan<double2> cellPositions;
+    trajectorySpan<int> neighborNum;
+    trajectorySpan<int> neighborOffsets;
+    trajectorySpan<int> neighbors;
+    trajectorySpan<int> vertexNeighbors;
+    trajectorySpan<int> vertexCellNeighbors;
+    trajectorySpan<int> cellVertexNum;
+    trajectorySpan<int> cellVertexOffsets;
+    trajectorySpan<int> cellVertices;
+    };
+
+//!An append-only binary trajectory that is memory mapped for random-access analysis
+/*!
+Every frame has the same size, so frame f of a file starts at firstFrame + f*frameStride:
+
+    header   char magic[8] = "cellGPUt" | version | vertex model? | Ncells | degrees of freedom |
+             frame stride | offset of the first frame | offset of each section within a frame
+    frames   a trajectoryFrameHeader (time, box matrix, frame number) followed by the sections,
+             each starting at a multiple of 64 bytes
+    index    (time, offset) of every frame, then "cellGPUi" | number of frames | offset of the index
+
+Positions, images, velocities and types are always stored (plus the cell positions of vertex
+models); with storeTopology the neighbor lists of every frame are stored too. In a periodic
+triangulation the neighbor counts of the cells add up to exactly 6*Ncells, and in a vertex model every
+vertex belongs to exactly three cells, so the compact topology blocks have a fixed size as well.
+
+The index is written when the database is closed (or on flush). A file whose index is missing, e.g.
+after a crash, is still readable -- its frames are found from the stride -- and opening it in readwrite
+mode continues appending after the last complete frame.
+
+In readonly mode the file is mapped, and getFrame hands out views of any frame without copying;
+readState loads a frame into a model and exportToHDF5 converts the trajectory for archival. The
+database is sized by the first state written to it, and the model kind (Voronoi or vertex) must not
+change afterwards.
+*/
+class mappedTrajectoryDatabase : public baseDatabaseInformation
+    {
+    public:
+        typedef shared_ptr<Simple2DCell> STATE;
+        //!Open (readonly, readwrite) or create (replace) a trajectory; storeTopology only matters for new files
+        mappedTrajectoryDatabase(string fn = "trajectory.cgt", fileMode::Enum _mode = fileMode::readonly, bool _storeTopology = true);
+        //!Writes the index (in write modes) and closes the file
+        ~mappedTrajectoryDatabase();
+
+        //!Append the current state of the system as a new frame (overwriting specific frames is not supported)
+        void writeState(STATE c, double time = -1.0, int rec = -1);
+        //!Write the index, so that the file on disk is complete; writing can continue afterwards
+        void flush();
+
+        //!The number of frames in the file
+        int numberOfFrames(){return Records;};
+        //!The time of frame rec
+        double frameTime(int rec);
+        //!Views of every stored quantity of frame rec (-1 means the last frame); readonly mode only
+        trajectoryFrame getFrame(int rec = -1);
+        //!Copy the Delaunay neighbors of frame rec into the padded layout (neighbors[n_idx(k,i)]) the analysis classes use
+        void getNeighborLists(int rec, GPUArray<int> &neighbors, GPUArray<int> &neighborNum, Index2D &n_idx);
+        /*!
+        Load frame rec into a model with the same number of cells and vertices. Positions, images,
+        velocities and types are read into the arrays of the model in tag order, and its tags are reset.
+        Voronoi models are retriangulated (if geometry is true); vertex models need the stored topology,
+        which replaces their own.
+        */
+        void readState(STATE c, int rec, bool geometry = true);
+        //!Write every frame to an hdf5 file, with the datasets of simpleVoronoiDatabase or simpleVertexDatabase plus the topology
+        void exportToHDF5(const string &fileName);
+
+        //!Was the trajectory written by a vertex model?
+        bool isVertexModel(){return header.vertexModel == 1;};
+        //!Does the trajectory store neighbor lists?
+        bool hasTopology(){return header.sections[trajectorySection::neighborNum] != 0 || header.sections[trajectorySection::cellVertex] != 0;};
+        int getNumberOfCells(){return header.Ncells;};
+        int getNumberOfDegreesOfFreedom(){return header.degreesOfFreedom;};
+
+    protected:
+        //!Set up the header and section layout for a model
+        void setLayout(bool vertexModel, int Ncells, int degreesOfFreedom);
+        //!Read and check the header of an existing file
+        bool readHeader(const char *data, size_t bytes);
+        //!Find the frames of an existing file, from its index or (if that is missing) from the stride
+        void findFrames(const char *data, size_t bytes);
+        //!Fill one frame of the write buffer from the model
+        void fillFrame(STATE c, double time);
+        //!A pointer to the start of a section of frame rec in the mapping
+        template<typename T> trajectorySpan<T> section(int rec, trajectorySection::Enum s, size_t size)
+            {
+            trajectorySpan<T> span;
+            if(header.sections[s] == 0)
+                return span;
+            span.data = (const T *)(mapping + frameOffsets[rec] + header.sections[s]);
+            span.size = size;
+            return span;
+            };
+
+        mappedTrajectoryHeader header;
+        //!Are the header and layout known (i.e., has the file been sized by a model)?
+        bool sized;
+        //!Should new files store neighbor lists?
+        bool storeTopology;
+        //!The time and offset of every frame
+        vector<double> frameTimes;
+        vector<unsigned long long> frameOffsets;
+
+        //!The file, in write modes
+        FILE *output;
+        //!Does the file end with an up-to-date index?
+        bool indexOnDisk;
+        //!A frame being assembled in write mode
+        vector<char> frameBuffer;
+        //!tag lookups from the current indices, used to translate neighbor lists to tags
+        vector<int> cellTags, vertexTags;
+
+        //!The mapped file, in readonly mode
+        char *mapping;
+        //!The size of the mapping
+        size_t mappingSize;
+    };
+#endif
@@ -14,6 +14,7 @@ simpleVertexDatabase::simpleVertexDatabase(int np, string fn,fileMode::Enum _mod
     intVector.resize(Nc);
     doubleVector.resize(N);
     coordinateVector.resize(2*N);
+    imageVector.resize(2*N);
     cellCoordinateVector.resize(2*Nc);
     vertexNeighborVector.resize(3*N);
     vertexCellNeighborVector.resize(3*N);
@@ -38,8 +39,10 @@ void simpleVertexDatabase::registerDatasets()
     registerExtendableDataset<int>("cellType",Nc);
 
     registerExtendableDataset<double>("vertexPosition", 2*N);
+    registerExtendableDataset<int>("vertexImage", 2*N);
 
     registerExtendableDataset<double>("cellPosition", 2*Nc);
+    registerExtendableDataset<double>("moduli", 2*Nc);
     registerExtendableDataset<double>("vertexVertexNeighbors", 3*N);
     registerExtendableDataset<double>("vertexCellNeighbors", 3*N);
     // registerExtendableDataset<double>("additionalData", 2*N);
@@ -47,6 +50,7 @@ void simpleVertexDatabase::registerDatasets()
 
 void simpleVertexDatabase::writeState(STATE c, double time, int rec)
     {
+    PROFILE_SCOPE("simpleVertexDatabase::writeState");
     if(rec >= 0)
         ERRORERROR("overwriting specific records not implemented at the moment");
     shared_ptr<vertexModelBase> s = dynamic_pointer_cast<vertexModelBase>(c);
@@ -83,6 +87,16 @@ void simpleVertexDatabase::writeState(STATE c, double time, int rec)
         }
     extendDataset("vertexPosition",coordinateVector); 
 
+    //vertex periodic images
+    ArrayHandle<int2> h_i(s->returnImages(),access_location::host,access_mode::read);
+    for (int ii = 0; ii < N; ++ii)
+        {
+        int pidx = s->tagToIdxVertex[ii];
+        imageVector[2*ii] = h_i.data[pidx].x;
+        imageVector[2*ii+1] = h_i.data[pidx].y;
+        }
+    extendDataset("vertexImage",imageVector);
+
     //cellPosition
     s->getCellPositionsCPU();
     ArrayHandle<double2> h_cpos(s->cellPositions);
@@ -93,6 +107,16 @@ void simpleVertexDatabase::writeState(STATE c, double time, int rec)
         cellCoordinateVector[2*ii+1] = h_cpos.data[pidx].y;
         }
     extendDataset("cellPosition",cellCoordinateVector);
+
+    //moduli
+    ArrayHandle<double2> h_m(s->Moduli,access_location::host,access_mode::read);
+    for (int ii = 0; ii < Nc; ++ii)
+        {
+        int pidx = s->tagToIdx[ii];
+        cellCoordinateVector[2*ii] = h_m.data[pidx].x;
+        cellCoordinateVector[2*ii+1] = h_m.data[pidx].y;
+        }
+    extendDataset("moduli",cellCoordinateVector);
     
     //vertexVertexNeighbors
     ArrayHandle<int> h_vn(s->vertexNeighbors,access_location::host,access_mode::read);
@@ -105,7 +129,7 @@ void simpleVertexDatabase::writeState(STATE c, double time, int rec)
         for (int ii = 0 ;ii < 3; ++ii)
             {
             vertexNeighborVector[3*vv+ii] = s->idxToTagVertex[h_vn.data[3*vertexIndex+ii]];
-            vertexCellNeighborVector[3*vv+ii] = s->idxToTagVertex[h_vcn.data[3*vertexIndex+ii]];
+            vertexCellNeighborVector[3*vv+ii] = s->idxToTag[h_vcn.data[3*vertexIndex+ii]];
             };
         };
     extendDataset("vertexVertexNeighbors",vertexNeighborVector);
@@ -113,42 +137,137 @@ void simpleVertexDatabase::writeState(STATE c, double time, int rec)
   
     }
 
+/*!
+Records are stored in tag order, so the state is read back unsorted (each index equal to its tag). The
+vertex lists of the cells are not stored; they are rebuilt by walking around each cell along the vertex
+neighbors, and ordered counter-clockwise. Vertex velocities and the area and perimeter preferences are
+not stored, and keep their current values.
+*/
 void simpleVertexDatabase::readState(STATE c, int rec, bool geometry)
     {
+    PROFILE_SCOPE("simpleVertexDatabase::readState");
     shared_ptr<vertexModelBase> t = dynamic_pointer_cast<vertexModelBase>(c);
+    if(t->Nvertices != N || t->Ncells != Nc)
+        ERRORERROR("the model does not have the numbers of vertices and cells of the database");
 
     readDataset("time",timeVector,rec);
+    t->currentTime = timeVector[0];
 
     readDataset("boxMatrix",boxVector,rec);
     t->Box->setGeneral(boxVector[0],boxVector[1],boxVector[2],boxVector[3]);
 
-    readDataset("type",intVector,rec);
+    {//scope for array handles
+    readDataset("cellType",intVector,rec);
     ArrayHandle<int> h_ct(t->cellType,access_location::host,access_mode::overwrite);
-    for (int idx = 0; idx < N; ++idx)
-        {
-        h_ct.data[idx]=intVector[idx];;
-        };
+    for (int idx = 0; idx < Nc; ++idx)
+        h_ct.data[idx]=intVector[idx];
 
-    readDataset("position",coordinateVector,rec);
-    ArrayHandle<double2> h_p(t->cellPositions,access_location::host,access_mode::overwrite);
+    readDataset("vertexPosition",coordinateVector,rec);
+    ArrayHandle<double2> h_p(t->vertexPositions,access_location::host,access_mode::overwrite);
     for (int idx = 0; idx < N; ++idx)
         {
         h_p.data[idx].x = coordinateVector[(2*idx)];
         h_p.data[idx].y = coordinateVector[(2*idx)+1];
         };
 
-    readDataset("velocity",coordinateVector,rec);
-    ArrayHandle<double2> h_v(t->returnVelocities(),access_location::host,access_mode::overwrite);
+    readDataset("vertexImage",imageVector,rec);
+    ArrayHandle<int2> h_i(t->vertexImages,access_location::host,access_mode::overwrite);
     for (int idx = 0; idx < N; ++idx)
         {
-        h_v.data[idx].x = coordinateVector[(2*idx)];
-        h_v.data[idx].y = coordinateVector[(2*idx)+1];
+        h_i.data[idx].x = imageVector[(2*idx)];
+        h_i.data[idx].y = imageVector[(2*idx)+1];
+        };
+
+    readDataset("moduli",cellCoordinateVector,rec);
+    vector<double2> moduli(Nc);
+    bool uniform = true;
+    for (int idx = 0; idx < Nc; ++idx)
+        {
+        moduli[idx].x = cellCoordinateVector[(2*idx)];
+        moduli[idx].y = cellCoordinateVector[(2*idx)+1];
+        if(moduli[idx].x != moduli[0].x || moduli[idx].y != moduli[0].y)
+            uniform = false;
+        };
+    if(uniform)
+        t->setModuliUniform(moduli[0].x,moduli[0].y);
+    else
+        t->setModuli(moduli);
+
+    readDataset("vertexVertexNeighbors",vertexNeighborVector,rec);
+    readDataset("vertexCellNeighbors",vertexCellNeighborVector,rec);
+    ArrayHandle<int> h_vn(t->vertexNeighbors,access_location::host,access_mode::overwrite);
+    ArrayHandle<int> h_vcn(t->vertexCellNeighbors,access_location::host,access_mode::overwrite);
+    vector<vector<int> > verticesOfCell(Nc);
+    for (int idx = 0; idx < 3*N; ++idx)
+        {
+        h_vn.data[idx] = vertexNeighborVector[idx];
+        h_vcn.data[idx] = vertexCellNeighborVector[idx];
+        verticesOfCell[vertexCellNeighborVector[idx]].push_back(idx/3);
+        };
+
+    //walk around each cell: two of the three neighbors of each of its vertices are also its vertices
+    int largestCell = 0;
+    for (int cell = 0; cell < Nc; ++cell)
+        {
+        vector<int> &cellList = verticesOfCell[cell];
+        int vertices = cellList.size();
+        largestCell = max(largestCell,vertices);
+        vector<int> ordered(1,cellList[0]);
+        int previous = -1;
+        while((int)ordered.size() < vertices)
+            {
+            int current = ordered.back();
+            int next = -1;
+            for (int ff = 0; ff < 3 && next < 0; ++ff)
+                {
+                int candidate = h_vn.data[3*current+ff];
+                if(candidate != previous && (h_vcn.data[3*candidate] == cell ||
+                        h_vcn.data[3*candidate+1] == cell || h_vcn.data[3*candidate+2] == cell))
+                    next = candidate;
+                };
+            if(next < 0)
+                ERRORERROR("the stored vertex neighbors do not close up around a cell");
+            ordered.push_back(next);
+            previous = current;
+            };
+        //the walk went one way or the other around the cell; make it counter-clockwise
+        double area = 0.0;
+        double2 last = make_double2(0.0,0.0);
+        for (int vv = 1; vv < vertices; ++vv)
+            {
+            double2 current;
+            t->Box->minDist(h_p.data[ordered[vv]],h_p.data[ordered[0]],current);
+            area += last.x*current.y - current.x*last.y;
+            last = current;
+            };
+        if(area < 0)
+            std::reverse(ordered.begin()+1,ordered.end());
+        cellList = ordered;
+        };
+
+    if(largestCell > t->vertexMax)
+        t->growCellVerticesList(largestCell);
+    ArrayHandle<int> h_cvn(t->cellVertexNum,access_location::host,access_mode::overwrite);
+    ArrayHandle<int> h_cv(t->cellVertices,access_location::host,access_mode::overwrite);
+    for (int cell = 0; cell < Nc; ++cell)
+        {
+        h_cvn.data[cell] = verticesOfCell[cell].size();
+        for (int vv = 0; vv < h_cvn.data[cell]; ++vv)
+            h_cv.data[t->n_idx(vv,cell)] = verticesOfCell[cell][vv];
         };
+    };//scope for array handles
+    t->initializeCellSorting();
+    t->initializeVertexSorting();
+    t->halfEdgesCurrent = false;
 
-    ERRORERROR("vertexModel reading currently not functional");
-    //by default, compute the triangulation and geometrical information
+    //by default, compute the geometrical information
     if(geometry)
         {
+        if(t->GPUcompute)
+            t->computeGeometryGPU();
+        else
+            t->computeGeometryCPU();
+        t->getCellPositions();
         };
     }
 
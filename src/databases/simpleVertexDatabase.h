@@ -42,6 +42,8 @@ private:
     std::vector<double> doubleVector;
     //! a vector of length N
     std::vector<int> intVector;
+    //! a vector of length 2*N
+    std::vector<int> imageVector;
     //! a vector of length 3*N
     std::vector<int> vertexNeighborVector;
     //! a vector of length 3*N
@@ -12,6 +12,7 @@ simpleVoronoiDatabase::simpleVoronoiDatabase(int np, string fn,fileMode::Enum _m
     intVector.resize(N);
     doubleVector.resize(N);
     coordinateVector.resize(2*N);
+    imageVector.resize(2*N);
 
     if(mode == fileMode::replace)
         {
@@ -33,12 +34,15 @@ void simpleVoronoiDatabase::registerDatasets()
     registerExtendableDataset<int>("type",N);
 
     registerExtendableDataset<double>("position", 2*N);
+    registerExtendableDataset<int>("image", 2*N);
     registerExtendableDataset<double>("velocity", 2*N);
+    registerExtendableDataset<double>("moduli", 2*N);
     // registerExtendableDataset<double>("additionalData", 2*N);
     }
 
 void simpleVoronoiDatabase::writeState(STATE c, double time, int rec)
     {
+    PROFILE_SCOPE("simpleVoronoiDatabase::writeState");
     if(rec >= 0)
         ERRORERROR("overwriting specific records not implemented at the moment");
     shared_ptr<voronoiModelBase> s = dynamic_pointer_cast<voronoiModelBase>(c);
@@ -75,6 +79,16 @@ void simpleVoronoiDatabase::writeState(STATE c, double time, int rec)
         }
     extendDataset("position",coordinateVector); 
 
+    //periodic images, so that unwrapped positions can be reconstructed from sparse records
+    ArrayHandle<int2> h_i(s->returnImages(),access_location::host,access_mode::read);
+    for (int ii = 0; ii < N; ++ii)
+        {
+        int pidx = s->tagToIdx[ii];
+        imageVector[2*ii] = h_i.data[pidx].x;
+        imageVector[2*ii+1] = h_i.data[pidx].y;
+        }
+    extendDataset("image",imageVector);
+
     //velocity
     ArrayHandle<double2> h_v(s->returnVelocities(),access_location::host,access_mode::read);
     for (int ii = 0; ii < N; ++ii)
@@ -85,10 +99,20 @@ void simpleVoronoiDatabase::writeState(STATE c, double time, int rec)
         }
     extendDataset("velocity",coordinateVector); 
 
+    //moduli
+    ArrayHandle<double2> h_m(s->Moduli,access_location::host,access_mode::read);
+    for (int ii = 0; ii < N; ++ii)
+        {
+        int pidx = s->tagToIdx[ii];
+        coordinateVector[2*ii] = h_m.data[pidx].x;
+        coordinateVector[2*ii+1] = h_m.data[pidx].y;
+        }
+    extendDataset("moduli",coordinateVector); 
     }
 
 void simpleVoronoiDatabase::readState(STATE c, int rec, bool geometry)
     {
+    PROFILE_SCOPE("simpleVoronoiDatabase::readState");
     shared_ptr<voronoiModelBase> t = dynamic_pointer_cast<voronoiModelBase>(c);
 
     readDataset("time",timeVector,rec);
@@ -111,6 +135,20 @@ void simpleVoronoiDatabase::readState(STATE c, int rec, bool geometry)
         h_p.data[idx].y = coordinateVector[(2*idx)+1];
         };
 
+    //files written before image counters were stored start counting from the wrapped positions
+    if(datasetExists("image"))
+        {
+        readDataset("image",imageVector,rec);
+        ArrayHandle<int2> h_i(t->cellImages,access_location::host,access_mode::overwrite);
+        for (int idx = 0; idx < N; ++idx)
+            {
+            h_i.data[idx].x = imageVector[(2*idx)];
+            h_i.data[idx].y = imageVector[(2*idx)+1];
+            };
+        }
+    else
+        t->resetImages();
+
     readDataset("velocity",coordinateVector,rec);
     ArrayHandle<double2> h_v(t->returnVelocities(),access_location::host,access_mode::overwrite);
     for (int idx = 0; idx < N; ++idx)
@@ -119,6 +157,25 @@ void simpleVoronoiDatabase::readState(STATE c, int rec, bool geometry)
         h_v.data[idx].y = coordinateVector[(2*idx)+1];
         };
 
+    //files written before per-cell moduli were supported just keep the current moduli
+    if(datasetExists("moduli"))
+        {
+        readDataset("moduli",coordinateVector,rec);
+        vector<double2> moduli(N);
+        bool uniform = true;
+        for (int idx = 0; idx < N; ++idx)
+            {
+            moduli[idx].x = coordinateVector[(2*idx)];
+            moduli[idx].y = coordinateVector[(2*idx)+1];
+            if(moduli[idx].x != moduli[0].x || moduli[idx].y != moduli[0].y)
+                uniform = false;
+            };
+        if(uniform)
+            t->setModuliUniform(moduli[0].x,moduli[0].y);
+        else
+            t->setModuli(moduli);
+        };
+
     //by default, compute the triangulation and geometrical information
     if(geometry)
         {
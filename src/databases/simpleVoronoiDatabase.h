@@ -8,7 +8,8 @@
 //!Simple databse for reading/writing 2d spv states
 /*!
 Class for a state database for a 2d delaunay triangulation
-the box dimensions are stored, the 2d unwrapped coordinate of the delaunay vertices,
+the box dimensions are stored, the 2d (wrapped) coordinate of the delaunay vertices and their periodic
+image counters (so that unwrapped coordinates can be reconstructed),
 and the shape index parameter for each vertex
 */
 class simpleVoronoiDatabase : public baseHDF5Database
@@ -34,6 +35,8 @@ private:
     std::vector<double> boxVector;
     //! a vector of length 2*N
     std::vector<double> coordinateVector;
+    //! a vector of length 2*N
+    std::vector<int> imageVector;
     //! a vector of length N
     std::vector<double> doubleVector;
     //! a vector of length N
@@ -32,6 +32,7 @@ void valueVectorDatabase::registerDatasets()
 
 void valueVectorDatabase::writeState(double val, std::vector<double> &data)
     {
+    PROFILE_SCOPE("valueVectorDatabase::writeState");
     logMessage(logger::verbose, "valueVectorDatabase state saved");
     extendDataset("vector", data);
     valueVector[0] = val;
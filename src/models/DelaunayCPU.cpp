@@ -0,0 +1,547 @@
+#include "DelaunayCPU.h"
+#include "functions.h"
+#include "exactPredicates.h"
+/*! \file DelaunayCPU.cpp */
+
+/*!
+\param n the number of points that will be inserted
+\param minimum the lower corner of a box containing all of the points
+\param maximum the upper corner of a box containing all of the points
+The enclosing triangle is far enough away that it only affects triangles near the edge of the point
+set, whose circumdisks are never inside the region covered by a block
+*/
+void DelaunayCPU::localTriangulation::initialize(int n, double2 minimum, double2 maximum)
+    {
+    double2 center = make_double2(0.5*(minimum.x+maximum.x),0.5*(minimum.y+maximum.y));
+    double extent = max(maximum.x-minimum.x,maximum.y-minimum.y)+1.0;
+    points.resize(n+3);
+    points[n] = make_double2(center.x-30.*extent,center.y-30.*extent);
+    points[n+1] = make_double2(center.x+30.*extent,center.y-30.*extent);
+    points[n+2] = make_double2(center.x,center.y+30.*extent);
+    rank.resize(n+3);
+    rank[n] = -1;
+    rank[n+1] = -2;
+    rank[n+2] = -3;
+    vertices.clear();
+    neighbors.clear();
+    alive.clear();
+    freeTriangles.clear();
+    inCavity.clear();
+    vertexTriangle.assign(n+3,-1);
+    lastTriangle = makeTriangle(n,n+1,n+2);
+    neighbors[lastTriangle] = make_int3(-1,-1,-1);
+    };
+
+int DelaunayCPU::localTriangulation::makeTriangle(int a, int b, int c)
+    {
+    int t;
+    if(!freeTriangles.empty())
+        {
+        t = freeTriangles.back();
+        freeTriangles.pop_back();
+        vertices[t] = make_int3(a,b,c);
+        alive[t] = 1;
+        inCavity[t] = 0;
+        }
+    else
+        {
+        t = vertices.size();
+        vertices.push_back(make_int3(a,b,c));
+        neighbors.push_back(make_int3(-1,-1,-1));
+        alive.push_back(1);
+        inCavity.push_back(0);
+        };
+    vertexTriangle[a] = t;
+    vertexTriangle[b] = t;
+    vertexTriangle[c] = t;
+    return t;
+    };
+
+//!access the components of an int3 by index
+static inline int &component(int3 &v, int i)
+    {
+    return (i==0) ? v.x : ((i==1) ? v.y : v.z);
+    };
+
+/*!
+A visibility walk from the most recently created triangle, falling back on a linear search if the walk
+fails to terminate
+*/
+int DelaunayCPU::localTriangulation::locate(const double2 &p)
+    {
+    int t = lastTriangle;
+    int maxSteps = vertices.size()+10;
+    for (int step = 0; step < maxSteps; ++step)
+        {
+        int3 v = vertices[t];
+        int next = -1;
+        for (int ii = 0; ii < 3; ++ii)
+            {
+            int a = component(v,(ii+1)%3);
+            int b = component(v,(ii+2)%3);
+            if(orient2DAdaptive(points[a],points[b],p) < 0)
+                {
+                next = component(neighbors[t],ii);
+                break;
+                };
+            };
+        if(next < 0)
+            return t;
+        t = next;
+        };
+    for (int tt = 0; tt < (int)vertices.size(); ++tt)
+        {
+        if(!alive[tt])
+            continue;
+        int3 v = vertices[tt];
+        if(orient2DAdaptive(points[v.x],points[v.y],p) >= 0 && orient2DAdaptive(points[v.y],points[v.z],p) >= 0
+           && orient2DAdaptive(points[v.z],points[v.x],p) >= 0)
+            return tt;
+        };
+    return -1;
+    };
+
+/*!
+The cavity is the connected set of triangles whose circumcircles contain p; the exact predicates (which
+decide near-degenerate cases in a frame that does not depend on the block, with exact ties broken by the
+global indices of the points) make it star-shaped as seen from p. As a safeguard, triangles
+are removed from the cavity until every boundary edge is visible from p, and the cavity is then replaced
+by a fan of triangles around p.
+*/
+bool DelaunayCPU::localTriangulation::insert(int p)
+    {
+    const double2 &pp = points[p];
+    int t0 = locate(pp);
+    if(t0 < 0)
+        return false;
+    {
+    int3 v = vertices[t0];
+    if((points[v.x].x == pp.x && points[v.x].y == pp.y) || (points[v.y].x == pp.x && points[v.y].y == pp.y)
+       || (points[v.z].x == pp.x && points[v.z].y == pp.y))
+        return false;
+    }
+
+    cavity.clear();
+    stack.clear();
+    stack.push_back(t0);
+    inCavity[t0] = 1;
+    while(!stack.empty())
+        {
+        int t = stack.back();
+        stack.pop_back();
+        cavity.push_back(t);
+        for (int ii = 0; ii < 3; ++ii)
+            {
+            int n = component(neighbors[t],ii);
+            if(n < 0 || inCavity[n])
+                continue;
+            int3 v = vertices[n];
+            if(periodicInCircleSign(points[v.x],points[v.y],points[v.z],pp,rank[v.x],rank[v.y],rank[v.z],rank[p],
+                                    globalPoints,*box,coordinateError) > 0)
+                {
+                inCavity[n] = 1;
+                stack.push_back(n);
+                };
+            };
+        };
+
+    //find the boundary, shrinking the cavity until it is star-shaped with respect to p
+    bool starShaped = false;
+    while(!starShaped)
+        {
+        starShaped = true;
+        boundaryTriangle.clear();
+        boundaryEdge.clear();
+        for (int cc = 0; cc < (int)cavity.size() && starShaped; ++cc)
+            {
+            int t = cavity[cc];
+            if(!inCavity[t])
+                continue;
+            for (int ii = 0; ii < 3; ++ii)
+                {
+                int n = component(neighbors[t],ii);
+                if(n >= 0 && inCavity[n])
+                    continue;
+                int a = component(vertices[t],(ii+1)%3);
+                int b = component(vertices[t],(ii+2)%3);
+                if(orient2DAdaptive(points[a],points[b],pp) <= 0 && t != t0)
+                    {
+                    inCavity[t] = 0;
+                    starShaped = false;
+                    break;
+                    };
+                boundaryTriangle.push_back(t);
+                boundaryEdge.push_back(ii);
+                };
+            };
+        };
+    int nKept = 0;
+    for (int cc = 0; cc < (int)cavity.size(); ++cc)
+        if(inCavity[cavity[cc]])
+            cavity[nKept++] = cavity[cc];
+    cavity.resize(nKept);
+
+    //create the new fan of triangles (a,b,p), each across from the outside neighbor of edge (a,b)
+    int nBoundary = boundaryTriangle.size();
+    vector<int3> boundary(nBoundary);
+    for (int bb = 0; bb < nBoundary; ++bb)
+        {
+        int t = boundaryTriangle[bb];
+        int ii = boundaryEdge[bb];
+        boundary[bb] = make_int3(component(vertices[t],(ii+1)%3),component(vertices[t],(ii+2)%3),
+                                 component(neighbors[t],ii));
+        };
+    for (int cc = 0; cc < (int)cavity.size(); ++cc)
+        {
+        alive[cavity[cc]] = 0;
+        inCavity[cavity[cc]] = 0;
+        freeTriangles.push_back(cavity[cc]);
+        };
+    newTriangles.resize(nBoundary);
+    for (int bb = 0; bb < nBoundary; ++bb)
+        {
+        int a = boundary[bb].x;
+        int b = boundary[bb].y;
+        int outside = boundary[bb].z;
+        int t = makeTriangle(a,b,p);
+        newTriangles[bb] = t;
+        neighbors[t] = make_int3(-1,-1,outside);
+        if(outside >= 0)
+            {
+            for (int ii = 0; ii < 3; ++ii)
+                {
+                int oa = component(vertices[outside],(ii+1)%3);
+                int ob = component(vertices[outside],(ii+2)%3);
+                if(oa == b && ob == a)
+                    component(neighbors[outside],ii) = t;
+                };
+            };
+        };
+    //stitch the fan: the edge (b,p) of (a,b,p) is shared with the new triangle (b,c,p)
+    for (int bb = 0; bb < nBoundary; ++bb)
+        {
+        int t = newTriangles[bb];
+        int b = vertices[t].y;
+        for (int cc = 0; cc < nBoundary; ++cc)
+            {
+            int t2 = newTriangles[cc];
+            if(vertices[t2].x == b)
+                {
+                neighbors[t].x = t2;
+                neighbors[t2].y = t;
+                break;
+                };
+            };
+        };
+    if(nBoundary > 0)
+        lastTriangle = newTriangles[0];
+    return true;
+    };
+
+/*!
+Walk CCW around v: in the triangle (v,x,y) the next neighbor is x, and the next triangle is the one
+across the edge (v,y)
+*/
+bool DelaunayCPU::localTriangulation::ring(int v, vector<int> &ringPoints, vector<int> &ringTriangles)
+    {
+    ringPoints.clear();
+    ringTriangles.clear();
+    int t0 = vertexTriangle[v];
+    if(t0 < 0 || !alive[t0])
+        return false;
+    int t = t0;
+    do
+        {
+        int ii = (vertices[t].x == v) ? 0 : ((vertices[t].y == v) ? 1 : 2);
+        ringPoints.push_back(component(vertices[t],(ii+1)%3));
+        ringTriangles.push_back(t);
+        t = component(neighbors[t],(ii+1)%3);
+        if(t < 0 || ringPoints.size() > 64)
+            return false;
+        } while (t != t0);
+    return true;
+    };
+
+/*!
+The cell list is built from the fractional coordinates of the points, scaled to a square box of the
+same area, so that the bins are (in real space) parallelograms aligned with the unit cell. Bins are
+about two mean interparticle spacings across, and the blocks are rectangular groups of bins, with a few
+blocks per thread
+*/
+void DelaunayCPU::partition(GPUArray<double2> &points)
+    {
+    N = points.getNumElements();
+    double b11,b12,b21,b22;
+    Box->getBoxDims(b11,b12,b21,b22);
+    double area = fabs(b11*b22-b12*b21);
+    double side = sqrt(area);
+    Box->getBoxHeights(cellHeights.x,cellHeights.y);
+
+    vector<double2> fractional(N);
+    {
+    ArrayHandle<double2> h_p(points,access_location::host,access_mode::read);
+    for (int ii = 0; ii < N; ++ii)
+        {
+        double2 s;
+        Box->invTrans(h_p.data[ii],s);
+        s.x -= floor(s.x);
+        s.y -= floor(s.y);
+        fractional[ii] = make_double2(min(s.x,1.0-1e-12)*side,min(s.y,1.0-1e-12)*side);
+        };
+    }
+    periodicBoundaries binBox(side,side);
+    cList.GPUcompute = false;
+    cList.setBox(binBox);
+    cList.setParticles(fractional);
+    cList.setGridSize(min(0.5*side,2.0*side/sqrt((double)N)));
+    cList.compute();
+
+    int targetBlocks = max(1,4*ompThreadNum);
+    blocksX = max(1,min(cList.getXsize(),(int)round(sqrt((double)targetBlocks))));
+    blocksY = max(1,min(cList.getYsize(),targetBlocks/blocksX));
+    };
+
+/*!
+\param block the index of the block, blockX + blocksX*blockY
+\param halo the number of bins around the block to include
+\param h_p the positions of all points
+\param T the local triangulation to use
+\param localIndex on output, the global index of each local point
+\param primary on output, the global index of the points owned by the block (in local order), else -1
+\param blockTriangles on output, the triangles owned by the block
+*/
+bool DelaunayCPU::triangulateBlock(int block, int halo, const double2 *h_p, localTriangulation &T,
+                                   vector<int> &localIndex, vector<int> &primary, vector<int3> &blockTriangles)
+    {
+    int xsize = cList.getXsize();
+    int ysize = cList.getYsize();
+    int bx = block % blocksX;
+    int by = block / blocksX;
+    int x0 = (bx*xsize)/blocksX, x1 = ((bx+1)*xsize)/blocksX;
+    int y0 = (by*ysize)/blocksY, y1 = ((by+1)*ysize)/blocksY;
+    //do not let the halo wrap around more than once
+    halo = min(halo,xsize+ysize);
+    int hx = min(halo,xsize), hy = min(halo,ysize);
+
+    ArrayHandle<unsigned int> h_cs(cList.cell_sizes,access_location::host,access_mode::read);
+    ArrayHandle<int> h_idx(cList.idxs,access_location::host,access_mode::read);
+    ArrayHandle<int> h_start(cList.cell_start,access_location::host,access_mode::read);
+
+    //gather local points, bin by bin in a serpentine order for walk locality
+    localIndex.clear();
+    primary.clear();
+    vector<double2> &lp = T.points;
+    lp.clear();
+    double2 minimum = make_double2(1e300,1e300), maximum = make_double2(-1e300,-1e300);
+    int row = 0;
+    for (int iy = y0-hy; iy < y1+hy; ++iy, ++row)
+        {
+        int wy = ((iy % ysize)+ysize)%ysize;
+        int sy = (iy-wy)/ysize;
+        for (int jx = 0; jx < x1-x0+2*hx; ++jx)
+            {
+            int ix = (row%2 == 0) ? x0-hx+jx : x1+hx-1-jx;
+            int wx = ((ix % xsize)+xsize)%xsize;
+            int sx = (ix-wx)/xsize;
+            double2 shift;
+            Box->Trans(make_double2((double)sx,(double)sy),shift);
+            bool core = (ix >= x0 && ix < x1 && iy >= y0 && iy < y1);
+            int bin = cList.cell_indexer(wx,wy);
+            for (int nn = 0; nn < (int)h_cs.data[bin]; ++nn)
+                {
+                int idx = h_idx.data[h_start.data[bin]+nn];
+                double2 pos = make_double2(h_p[idx].x+shift.x,h_p[idx].y+shift.y);
+                lp.push_back(pos);
+                localIndex.push_back(idx);
+                primary.push_back(core ? idx : -1);
+                minimum.x = min(minimum.x,pos.x); minimum.y = min(minimum.y,pos.y);
+                maximum.x = max(maximum.x,pos.x); maximum.y = max(maximum.y,pos.y);
+                };
+            };
+        };
+    int n = lp.size();
+    if(n == 0)
+        return true;
+    T.initialize(n,minimum,maximum);
+    for (int ii = 0; ii < n; ++ii)
+        T.rank[ii] = localIndex[ii];
+    T.globalPoints = h_p;
+    T.box = Box.get();
+    T.coordinateError = minDistError(*Box);
+    for (int ii = 0; ii < n; ++ii)
+        if(!T.insert(ii))
+            return false;
+
+    //the region covered by the block and its halo, in fractional coordinates
+    double fx0 = (double)(x0-hx)/xsize, fx1 = (double)(x1+hx)/xsize;
+    double fy0 = (double)(y0-hy)/ysize, fy1 = (double)(y1+hy)/ysize;
+    double tolerance = 1e-10*(cellHeights.x+cellHeights.y);
+    vector<char> checked(T.vertices.size(),0), valid(T.vertices.size(),0);
+    vector<int> ringPoints, ringTriangles;
+    for (int ii = 0; ii < n; ++ii)
+        {
+        if(primary[ii] < 0)
+            continue;
+        if(!T.ring(ii,ringPoints,ringTriangles))
+            return false;
+        for (int tt = 0; tt < (int)ringTriangles.size(); ++tt)
+            {
+            int t = ringTriangles[tt];
+            if(!checked[t])
+                {
+                checked[t] = 1;
+                int3 v = T.vertices[t];
+                if(v.x >= n || v.y >= n || v.z >= n)
+                    return false;
+                double2 center, s;
+                double radius;
+                Circumcircle(lp[v.x],lp[v.y],lp[v.z],center,radius);
+                Box->invTrans(center,s);
+                radius += tolerance;
+                valid[t] = ((s.x-fx0)*cellHeights.x >= radius && (fx1-s.x)*cellHeights.x >= radius &&
+                            (s.y-fy0)*cellHeights.y >= radius && (fy1-s.y)*cellHeights.y >= radius);
+                };
+            if(!valid[t])
+                return false;
+            };
+        int idx = primary[ii];
+        int neighs = ringPoints.size();
+        if(neighs > maximumNeighbors)
+            {
+            neighborOverflow = true;
+            neighs = maximumNeighbors;
+            };
+        neighborNumber[idx] = ringPoints.size();
+        for (int nn = 0; nn < neighs; ++nn)
+            neighborList[neighborIndexer(nn,idx)] = localIndex[ringPoints[nn]];
+        };
+
+    //triangles are owned by the block that owns their lowest-indexed point
+    blockTriangles.clear();
+    for (int t = 0; t < (int)T.vertices.size(); ++t)
+        {
+        if(!T.alive[t] || !checked[t])
+            continue;
+        int3 v = T.vertices[t];
+        int a = localIndex[v.x], b = localIndex[v.y], c = localIndex[v.z];
+        int owner = (a <= b && a <= c) ? v.x : ((b <= c) ? v.y : v.z);
+        if(primary[owner] >= 0)
+            blockTriangles.push_back(make_int3(a,b,c));
+        };
+    return true;
+    };
+
+bool DelaunayCPU::consistent()
+    {
+    long long totalNeighbors = 0;
+    bool symmetric = true;
+    #pragma omp parallel for num_threads(ompThreadNum) reduction(+:totalNeighbors) reduction(&&:symmetric)
+    for (int ii = 0; ii < N; ++ii)
+        {
+        totalNeighbors += neighborNumber[ii];
+        for (int nn = 0; nn < neighborNumber[ii]; ++nn)
+            {
+            int jj = neighborList[neighborIndexer(nn,ii)];
+            bool found = false;
+            for (int mm = 0; mm < neighborNumber[jj]; ++mm)
+                if(neighborList[neighborIndexer(mm,jj)] == ii)
+                    found = true;
+            symmetric = symmetric && found;
+            };
+        };
+    return symmetric && totalNeighbors == 6*(long long)N && (long long)triangles.size() == 2*(long long)N;
+    };
+
+/*!
+Blocks are triangulated in parallel; any block whose halo turned out to be too small is redone with
+twice the halo. Returns false if the stitched triangulation is not a consistent triangulation of the
+torus (which can happen for degenerate, e.g. cocircular, point sets, since the predicates are evaluated
+in floating point)
+*/
+bool DelaunayCPU::periodicTriangulation(GPUArray<double2> &points)
+    {
+    partition(points);
+    ArrayHandle<double2> h_p(points,access_location::host,access_mode::read);
+    int nBlocks = blocksX*blocksY;
+    int maximumHalo = cList.getXsize()+cList.getYsize();
+    bool retriangulate = true;
+    while(retriangulate)
+        {
+        retriangulate = false;
+        neighborOverflow = false;
+        neighborIndexer = Index2D(maximumNeighbors,N);
+        neighborNumber.assign(N,0);
+        neighborList.resize(maximumNeighbors*N);
+        vector<vector<int3> > blockTriangles(nBlocks);
+        vector<int> halo(nBlocks,2);
+        vector<int> todo(nBlocks);
+        for (int bb = 0; bb < nBlocks; ++bb)
+            todo[bb] = bb;
+        while(!todo.empty())
+            {
+            vector<char> failed(todo.size(),0);
+            #pragma omp parallel num_threads(ompThreadNum)
+            {
+            localTriangulation T;
+            vector<int> localIndex, primary;
+            #pragma omp for schedule(dynamic)
+            for (int bb = 0; bb < (int)todo.size(); ++bb)
+                if(!triangulateBlock(todo[bb],halo[todo[bb]],h_p.data,T,localIndex,primary,blockTriangles[todo[bb]]))
+                    failed[bb] = 1;
+            }
+            vector<int> stillToDo;
+            for (int bb = 0; bb < (int)todo.size(); ++bb)
+                {
+                if(!failed[bb])
+                    continue;
+                if(halo[todo[bb]] >= maximumHalo)
+                    return false;
+                halo[todo[bb]] *= 2;
+                stillToDo.push_back(todo[bb]);
+                };
+            todo.swap(stillToDo);
+            };
+        if(neighborOverflow)
+            {
+            int nmax = *max_element(neighborNumber.begin(),neighborNumber.end());
+            maximumNeighbors = nmax + 2;
+            retriangulate = true;
+            continue;
+            };
+        triangles.clear();
+        for (int bb = 0; bb < nBlocks; ++bb)
+            triangles.insert(triangles.end(),blockTriangles[bb].begin(),blockTriangles[bb].end());
+        };
+    return consistent();
+    };
+
+/*!
+\param points the points to triangulate
+\param neighbors on output, neighbors.data[Index2D(neighMax,N)(nn,i)] is the nn-th CCW neighbor of point i
+\param neighborNum on output, the number of neighbors of each point
+\param neighMax the stride of neighbors; increased (to an even number, as elsewhere in the code) and
+neighbors resized if some point has more neighbors than this
+*/
+bool DelaunayCPU::globalTriangulation(GPUArray<double2> &points, GPUArray<int> &neighbors, GPUArray<int> &neighborNum, int &neighMax)
+    {
+    if(!periodicTriangulation(points))
+        return false;
+    int nmax = *max_element(neighborNumber.begin(),neighborNumber.end());
+    if(nmax > neighMax)
+        neighMax = (nmax%2 == 0) ? nmax+2 : nmax+1;
+    if(neighbors.getNumElements() != (unsigned int)(neighMax*N))
+        neighbors.resize(neighMax*N);
+    if(neighborNum.getNumElements() != (unsigned int)N)
+        neighborNum.resize(N);
+    Index2D n_idx(neighMax,N);
+    ArrayHandle<int> h_nn(neighborNum,access_location::host,access_mode::overwrite);
+    ArrayHandle<int> h_n(neighbors,access_location::host,access_mode::overwrite);
+    #pragma omp parallel for num_threads(ompThreadNum)
+    for (int ii = 0; ii < N; ++ii)
+        {
+        h_nn.data[ii] = neighborNumber[ii];
+        for (int nn = 0; nn < neighborNumber[ii]; ++nn)
+            h_n.data[n_idx(nn,ii)] = neighborList[neighborIndexer(nn,ii)];
+        };
+    return true;
+    };
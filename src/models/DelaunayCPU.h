@@ -0,0 +1,120 @@
+#ifndef DELAUNAYCPU_H
+#define DELAUNAYCPU_H
+
+#include "std_include.h"
+#include "gpuarray.h"
+#include "indexer.h"
+#include "periodicBoundaries.h"
+#include "cellListGPU.h"
+
+/*! \file DelaunayCPU.h */
+//!A native, multithreaded construction of the complete Delaunay triangulation of a periodic point set
+/*!
+The periodic domain is partitioned into rectangular blocks of cellListGPU bins (the bins are built in
+the fractional coordinates of the box, so general periodic domains are handled). Each block is
+triangulated independently, with an incremental Bowyer-Watson algorithm, together with a halo of
+neighboring bins (which contain periodic images of points across the boundaries). The neighbors of a
+point are read off of the triangulation of the block that owns it, and are accepted only if the
+circumdisk of every triangle around the point lies inside the region covered by the block and its
+halo: no other point can then invalidate those triangles. Blocks for which this fails are redone with
+a larger halo. Finally the per-block results are stitched together: each point's CCW-ordered neighbor
+list is written once, each triangle is reported by the block that owns its lowest-indexed point, and the
+result is checked for global consistency (a symmetric neighbor relation and the Euler characteristic of
+the torus). The orientation and in-circle tests are exact (see exactPredicates.h), with exactly cocircular
+points resolved consistently by their indices, so degenerate point sets such as lattices are handled.
+ */
+class DelaunayCPU
+    {
+    public:
+        //!blank constructor
+        DelaunayCPU(){};
+        //!constructor with a box
+        DelaunayCPU(PeriodicBoxPtr bx){Box = bx;};
+
+        //!Set the box
+        void setBox(PeriodicBoxPtr bx){Box=bx;};
+        //!Set the number of threads to ask openMP to use
+        virtual void setOmpThreads(int _number){ompThreadNum = _number;cList.setOmpThreads(_number);};
+
+        //!Triangulate the point set, filling neighborNumber, neighborList and triangles. Returns false if the result is inconsistent
+        bool periodicTriangulation(GPUArray<double2> &points);
+        //!Triangulate the point set and write the neighbor lists directly into neighbors, with stride neighMax (increased if needed)
+        bool globalTriangulation(GPUArray<double2> &points, GPUArray<int> &neighbors, GPUArray<int> &neighborNum, int &neighMax);
+
+        //!The number of Delaunay neighbors of every point
+        vector<int> neighborNumber;
+        //!The CCW-ordered neighbors of every point, neighborList[neighborIndexer(nn,i)]
+        vector<int> neighborList;
+        //!Indexes neighborList
+        Index2D neighborIndexer;
+        //!Every triangle of the periodic triangulation exactly once, as CCW-ordered point indices
+        vector<int3> triangles;
+
+        //! A box to calculate relative distances in a periodic domain.
+        PeriodicBoxPtr Box;
+
+    protected:
+        //!A Bowyer-Watson triangulation of the points of one block and its halo
+        struct localTriangulation
+            {
+            //!positions of the local points; the last three are the corners of an enclosing triangle
+            vector<double2> points;
+            //!the global index of each local point, used to decide near-degenerate cases (negative for the corners)
+            vector<int> rank;
+            //!the positions of all points, and the box, for deciding near-degenerate cases in a canonical frame
+            const double2 *globalPoints;
+            periodicBoundaries *box;
+            //!a bound on the error of the local positions
+            double coordinateError;
+            //!CCW-ordered vertices of each triangle
+            vector<int3> vertices;
+            //!neighbors[t].x is the triangle across the edge opposite vertices[t].x, etc. (-1 if none)
+            vector<int3> neighbors;
+            //!is the triangle part of the current triangulation?
+            vector<char> alive;
+            //!some live triangle containing each point
+            vector<int> vertexTriangle;
+            //!slots of deleted triangles available for re-use
+            vector<int> freeTriangles;
+            //!the most recently created triangle, where point location starts
+            int lastTriangle;
+            //!scratch space for insertions
+            vector<int> cavity, stack, boundaryTriangle, boundaryEdge, newTriangles;
+            vector<char> inCavity;
+
+            //!set up the enclosing triangle for points in the given bounding box
+            void initialize(int n, double2 minimum, double2 maximum);
+            //!insert the local point with the given index
+            bool insert(int p);
+            //!find a triangle containing point p
+            int locate(const double2 &p);
+            //!the CCW-ordered ring of points around point v, and the triangles of that fan
+            bool ring(int v, vector<int> &ringPoints, vector<int> &ringTriangles);
+            //!make a triangle and return its index
+            int makeTriangle(int a, int b, int c);
+            };
+
+        //!prepare the bins and the block decomposition
+        void partition(GPUArray<double2> &points);
+        //!triangulate a block with a halo of the given number of bins; returns false if the halo was too small
+        bool triangulateBlock(int block, int halo, const double2 *h_p, localTriangulation &T,
+                              vector<int> &localIndex, vector<int> &primary, vector<int3> &blockTriangles);
+        //!check that every neighbor relation is symmetric and that the number of triangles is right
+        bool consistent();
+
+        //!number of openMP threads to use
+        int ompThreadNum = 1;
+        //!The number of points
+        int N;
+        //!A cell list of the fractional coordinates of the points (scaled to a square box)
+        cellListGPU cList;
+        //!the number of blocks in each direction
+        int blocksX, blocksY;
+        //!The maximum number of neighbors any point is allowed before neighborList is regrown
+        int maximumNeighbors = 16;
+        //!Set when some point has more than maximumNeighbors neighbors
+        bool neighborOverflow;
+        //!The distances between opposite sides of the unit cell (for testing whether disks lie in a block)
+        double2 cellHeights;
+    };
+#endif
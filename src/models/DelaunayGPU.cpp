@@ -2,6 +2,7 @@
 #include "DelaunayGPU.cuh"
 #include "cellListGPU.cuh"
 #include "utilities.cuh"
+#include "functions.h"
 
 DelaunayGPU::DelaunayGPU() :
 	cellsize(1.10), cListUpdated(false), Ncells(0), NumCircumcircles(0), GPUcompute(false)
@@ -27,7 +28,7 @@ void DelaunayGPU::initialize(int N, int maximumNeighborsGuess, double cellSize,
         circumcirclesAssist.neverGPU = true;
         GPUcompute = false;
         };
-    prof.start("initialization");
+    PROFILE_SCOPE("DelaunayGPU::initialize");
     Ncells = N;
     NumCircumcircles = 0;
     MaxSize = max(4,maximumNeighborsGuess);
@@ -45,7 +46,6 @@ void DelaunayGPU::initialize(int N, int maximumNeighborsGuess, double cellSize,
     repair.resize(Ncells);
     delGPUcircumcircles.resize(Ncells);
     initializeCellList();
-    prof.end("initialization");
     }
 
 //Resize the relevant array for the triangulation
@@ -67,6 +67,75 @@ void DelaunayGPU::initializeCellList()
     cList.setGridSize(cellsize);
     }
 
+/*!
+Registers
+    delaunay/repairedPoints          points whose circumcircles were found to be violated (a counter, and a
+                                     histogram of the number per test-and-repair call)
+    delaunay/oneRingResizes          restarts of a triangulation routine because a one-ring outgrew MaxSize
+    delaunay/globalTriangulations    calls of globalDelaunayTriangulation
+    delaunay/maximumNeighbors        MaxSize
+    cellList/maximumOccupancy        the largest number of points in one bucket of the cell list
+Counting the repaired points needs the repair list on the host, so on the GPU it costs a small copy per
+call; nothing is done when no registry is set.
+*/
+void DelaunayGPU::setMetrics(shared_ptr<runtimeMetrics> _metrics)
+    {
+    metrics = _metrics;
+    if(!metrics)
+        return;
+    repairedPointsMetric = metrics->registerCounter("delaunay/repairedPoints");
+    repairedPointsHistogram = metrics->registerHistogram("delaunay/repairedPointsPerCall",runtimeMetrics::powerOfTwoEdges(max(Ncells,1)));
+    oneRingResizeMetric = metrics->registerCounter("delaunay/oneRingResizes");
+    globalTriangulationMetric = metrics->registerCounter("delaunay/globalTriangulations");
+    maximumNeighborsMetric = metrics->registerGauge("delaunay/maximumNeighbors");
+    cellListOccupancyMetric = metrics->registerGauge("cellList/maximumOccupancy");
+    }
+
+void DelaunayGPU::reportRepairs()
+    {
+    ArrayHandle<int> h_repair(repair,access_location::host,access_mode::read);
+    int repairs = 0;
+    for (int ii = 0; ii < Ncells; ++ii)
+        if(h_repair.data[ii] >= 0)
+            repairs += 1;
+    metrics->increment(repairedPointsMetric,repairs);
+    metrics->record(repairedPointsHistogram,repairs);
+    metrics->setGauge(cellListOccupancyMetric,cList.getNmax());
+    }
+
+/*!
+Only the points in the repair list are recomputed by a local repair, so the voronoi vertices and one-ring
+data of every other point are carried over from earlier calls; they are stored verbatim. The cell list
+is rebuilt before every use and is not stored.
+*/
+void DelaunayGPU::writeCheckpoint(checkpointWriter &out)
+    {
+    out.addValue("MaxSize",MaxSize);
+    out.addValue("NumCircumcircles",NumCircumcircles);
+    out.addArray("maxOneRingSize",maxOneRingSize);
+    out.addArray("GPUVoroCur",GPUVoroCur);
+    out.addArray("GPUDelNeighsPos",GPUDelNeighsPos);
+    out.addArray("GPUPointIndx",GPUPointIndx);
+    out.addArray("circumcircles",delGPUcircumcircles);
+    out.addArray("repair",repair);
+    };
+
+void DelaunayGPU::readCheckpoint(checkpointReader &in)
+    {
+    int checkpointMaxSize;
+    in.readValue("MaxSize",checkpointMaxSize);
+    if(checkpointMaxSize != MaxSize)
+        resize(checkpointMaxSize);
+    in.readValue("NumCircumcircles",NumCircumcircles);
+    in.readArray("maxOneRingSize",maxOneRingSize);
+    in.readArray("GPUVoroCur",GPUVoroCur);
+    in.readArray("GPUDelNeighsPos",GPUDelNeighsPos);
+    in.readArray("GPUPointIndx",GPUPointIndx);
+    in.readArray("circumcircles",delGPUcircumcircles);
+    in.readArray("repair",repair);
+    cListUpdated = false;
+    };
+
 //sets the bucket lists with the points that they contain to use later in the triangulation
 void DelaunayGPU::setCellListSize(double csize)
     {
@@ -102,13 +171,13 @@ void DelaunayGPU::locallyRepairDelaunayTriangulation(GPUArray<double2> &points,
     int currentN = points.getNumElements();
     if(cListUpdated==false)
 		{
-        prof.start("cellList");
+        PROFILE_SCOPE("DelaunayGPU::cellList");
         updateList(points);
-        prof.end("cellList");
 		}
     bool recompute = true;
     while (recompute)
         {
+        int oldMaxSize = MaxSize;
         if(GPUcompute==true)
             {
             voronoiCalcRepairList(points, GPUTriangulation, cellNeighborNum,repairList);
@@ -119,10 +188,10 @@ void DelaunayGPU::locallyRepairDelaunayTriangulation(GPUArray<double2> &points,
             voronoiCalcRepairList_CPU(points, GPUTriangulation, cellNeighborNum,repairList);
             recompute = computeTriangulationRepairList_CPU(points, GPUTriangulation, cellNeighborNum,repairList);
             }
+        //only the cells in the repair list are recomputed, so the rows of every other cell must be
+        //carried over to the new stride rather than flatly resized
         if(recompute)
-            {
-            GPUTriangulation.resize(MaxSize*currentN);
-            }
+            restrideGPUArray(GPUTriangulation,oldMaxSize,MaxSize,currentN);
         };
     cListUpdated=false;
     }
@@ -130,6 +199,9 @@ void DelaunayGPU::locallyRepairDelaunayTriangulation(GPUArray<double2> &points,
 //Main function that does the complete triangulation of all points
 void DelaunayGPU::globalDelaunayTriangulation(GPUArray<double2> &points, GPUArray<int> &GPUTriangulation, GPUArray<int> &cellNeighborNum)
     {
+	PROFILE_SCOPE("DelaunayGPU::globalTriangulation");
+	if(metrics)
+		metrics->increment(globalTriangulationMetric);
 	int currentN = points.getNumElements();
 	if(currentN==0)
         {
@@ -143,30 +215,38 @@ void DelaunayGPU::globalDelaunayTriangulation(GPUArray<double2> &points, GPUArra
         GPUTriangulation.resize(GPUVoroCur.getNumElements());
         initializeCellList();
 		}
-    prof.start("cellList");
+    {
+    PROFILE_SCOPE("DelaunayGPU::cellList");
     updateList(points);
-    prof.end("cellList");
+    }
 
     bool recompute = true;
     while (recompute)
 	    {
-        prof.start("vorocalc");
+        {
+        PROFILE_SCOPE("DelaunayGPU::voronoiCalc");
         if(GPUcompute==true)
             Voronoi_Calc(points, GPUTriangulation, cellNeighborNum);
         else
             Voronoi_Calc_CPU(points, GPUTriangulation, cellNeighborNum);
-        prof.end("vorocalc");
-        prof.start("get 1 ring");
+        }
+        {
+        PROFILE_SCOPE("DelaunayGPU::getOneRings");
         if(GPUcompute==true)
             recompute = get_neighbors(points, GPUTriangulation, cellNeighborNum);
         else
             recompute = get_neighbors_CPU(points, GPUTriangulation, cellNeighborNum);
-        prof.end("get 1 ring");
+        }
         if(recompute)
             {
             GPUTriangulation.resize(MaxSize*currentN);
             }
         };
+    if(metrics)
+        {
+        metrics->setGauge(maximumNeighborsMetric,MaxSize);
+        metrics->setGauge(cellListOccupancyMetric,cList.getNmax());
+        }
     }
 
 void DelaunayGPU::voronoiCalcRepairList_CPU(GPUArray<double2> &points, GPUArray<int> &GPUTriangulation, GPUArray<int> &cellNeighborNum,GPUArray<int> &repairList)
@@ -174,6 +254,7 @@ void DelaunayGPU::voronoiCalcRepairList_CPU(GPUArray<double2> &points, GPUArray<
     ArrayHandle<double2> d_pt(points,access_location::host,access_mode::read);
     ArrayHandle<unsigned int> d_cell_sizes(cList.cell_sizes,access_location::host,access_mode::read);
     ArrayHandle<int> d_cell_idx(cList.idxs,access_location::host,access_mode::read);
+    ArrayHandle<int> d_cell_start(cList.cell_start,access_location::host,access_mode::read);
 
     ArrayHandle<int> d_P_idx(GPUTriangulation,access_location::host,access_mode::readwrite);
     ArrayHandle<int> d_neighnum(cellNeighborNum,access_location::host,access_mode::readwrite);
@@ -195,7 +276,7 @@ void DelaunayGPU::voronoiCalcRepairList_CPU(GPUArray<double2> &points, GPUArray<
                         cList.getBoxsize(),
                         *(Box),
                         cList.cell_indexer,
-                        cList.cell_list_indexer,
+                        d_cell_start.data,
                         d_repair.data,
                         GPU_idx,
                         GPUcompute,
@@ -211,6 +292,7 @@ void DelaunayGPU::Voronoi_Calc_CPU(GPUArray<double2> &points, GPUArray<int> &GPU
     ArrayHandle<double2> d_pt(points,access_location::host,access_mode::read);
     ArrayHandle<unsigned int> d_cell_sizes(cList.cell_sizes,access_location::host,access_mode::read);
     ArrayHandle<int> d_cell_idx(cList.idxs,access_location::host,access_mode::read);
+    ArrayHandle<int> d_cell_start(cList.cell_start,access_location::host,access_mode::read);
 
     ArrayHandle<int> d_P_idx(GPUTriangulation,access_location::host,access_mode::overwrite);
     ArrayHandle<int> d_neighnum(cellNeighborNum,access_location::host,access_mode::overwrite);
@@ -231,7 +313,7 @@ void DelaunayGPU::Voronoi_Calc_CPU(GPUArray<double2> &points, GPUArray<int> &GPU
                         cList.getBoxsize(),
                         *(Box),
                         cList.cell_indexer,
-                        cList.cell_list_indexer,
+                        d_cell_start.data,
                         GPU_idx,
                         GPUcompute,
                         ompThreadNum
@@ -248,6 +330,7 @@ bool DelaunayGPU::computeTriangulationRepairList_CPU(GPUArray<double2> &points,
         ArrayHandle<double2> d_pt(points,access_location::host,access_mode::read);
         ArrayHandle<unsigned int> d_cell_sizes(cList.cell_sizes,access_location::host,access_mode::read);
         ArrayHandle<int> d_cell_idx(cList.idxs,access_location::host,access_mode::read);
+        ArrayHandle<int> d_cell_start(cList.cell_start,access_location::host,access_mode::read);
 
         ArrayHandle<int> d_P_idx(GPUTriangulation,access_location::host,access_mode::readwrite);
         ArrayHandle<int> d_neighnum(cellNeighborNum,access_location::host,access_mode::readwrite);
@@ -270,7 +353,7 @@ bool DelaunayGPU::computeTriangulationRepairList_CPU(GPUArray<double2> &points,
                                 cList.getBoxsize(),
                                 *(Box),
                                 cList.cell_indexer,
-                                cList.cell_list_indexer,
+                                d_cell_start.data,
                                 d_repair.data,
                                 GPU_idx,
                                 d_ms.data,
@@ -290,6 +373,8 @@ bool DelaunayGPU::computeTriangulationRepairList_CPU(GPUArray<double2> &points,
                 {
                     recomputeNeighbors = true;
                     printf("resizing potential neighbors from %i to %i and re-computing...\n",currentMaxOneRingSize,postCallMaxOneRingSize);
+                    if(metrics)
+                        metrics->increment(oneRingResizeMetric);
                     resize(postCallMaxOneRingSize);
                 }
             };
@@ -307,6 +392,7 @@ bool DelaunayGPU::get_neighbors_CPU(GPUArray<double2> &points, GPUArray<int> &GP
         ArrayHandle<double2> d_pt(points,access_location::host,access_mode::read);
         ArrayHandle<unsigned int> d_cell_sizes(cList.cell_sizes,access_location::host,access_mode::read);
         ArrayHandle<int> d_cell_idx(cList.idxs,access_location::host,access_mode::read);
+        ArrayHandle<int> d_cell_start(cList.cell_start,access_location::host,access_mode::read);
 
         ArrayHandle<int> d_P_idx(GPUTriangulation,access_location::host,access_mode::readwrite);
         ArrayHandle<int> d_neighnum(cellNeighborNum,access_location::host,access_mode::readwrite);
@@ -328,7 +414,7 @@ bool DelaunayGPU::get_neighbors_CPU(GPUArray<double2> &points, GPUArray<int> &GP
                          cList.getBoxsize(),
                          *(Box),
                          cList.cell_indexer,
-                         cList.cell_list_indexer,
+                         d_cell_start.data,
                          GPU_idx,
                          d_ms.data,
                          currentMaxOneRingSize,
@@ -349,6 +435,8 @@ bool DelaunayGPU::get_neighbors_CPU(GPUArray<double2> &points, GPUArray<int> &GP
             {
             recomputeNeighbors = true;
             printf("resizing potential neighbors from %i to %i and re-computing...\n",currentMaxOneRingSize,postCallMaxOneRingSize);
+            if(metrics)
+                metrics->increment(oneRingResizeMetric);
             resize(postCallMaxOneRingSize);
             }
         };
@@ -370,6 +458,7 @@ void DelaunayGPU::testTriangulationCPU(GPUArray<double2> &points)
 
     ArrayHandle<unsigned int> d_cell_sizes(cList.cell_sizes,access_location::host,access_mode::read);
     ArrayHandle<int> d_c_idx(cList.idxs,access_location::host,access_mode::read);
+    ArrayHandle<int> d_cell_start(cList.cell_start,access_location::host,access_mode::read);
 
     ArrayHandle<int> d_repair(repair,access_location::host,access_mode::readwrite);
 
@@ -388,7 +477,7 @@ void DelaunayGPU::testTriangulationCPU(GPUArray<double2> &points)
                            cList.getBoxsize(),
                            *(Box),
                            cList.cell_indexer,
-                           cList.cell_list_indexer,
+                           d_cell_start.data,
                            GPUcompute,
                            ompThreadNum
                            );
@@ -399,6 +488,7 @@ void DelaunayGPU::voronoiCalcRepairList(GPUArray<double2> &points, GPUArray<int>
     ArrayHandle<double2> d_pt(points,access_location::device,access_mode::read);
     ArrayHandle<unsigned int> d_cell_sizes(cList.cell_sizes,access_location::device,access_mode::read);
     ArrayHandle<int> d_cell_idx(cList.idxs,access_location::device,access_mode::read);
+    ArrayHandle<int> d_cell_start(cList.cell_start,access_location::device,access_mode::read);
 
     ArrayHandle<int> d_P_idx(GPUTriangulation,access_location::device,access_mode::readwrite);
     ArrayHandle<int> d_neighnum(cellNeighborNum,access_location::device,access_mode::readwrite);
@@ -420,7 +510,7 @@ void DelaunayGPU::voronoiCalcRepairList(GPUArray<double2> &points, GPUArray<int>
                         cList.getBoxsize(),
                         *(Box),
                         cList.cell_indexer,
-                        cList.cell_list_indexer,
+                        d_cell_start.data,
                         d_repair.data,
                         GPU_idx,
                         GPUcompute,
@@ -436,6 +526,7 @@ void DelaunayGPU::Voronoi_Calc(GPUArray<double2> &points, GPUArray<int> &GPUTria
     ArrayHandle<double2> d_pt(points,access_location::device,access_mode::read);
     ArrayHandle<unsigned int> d_cell_sizes(cList.cell_sizes,access_location::device,access_mode::read);
     ArrayHandle<int> d_cell_idx(cList.idxs,access_location::device,access_mode::read);
+    ArrayHandle<int> d_cell_start(cList.cell_start,access_location::device,access_mode::read);
 
     ArrayHandle<int> d_P_idx(GPUTriangulation,access_location::device,access_mode::overwrite);
     ArrayHandle<int> d_neighnum(cellNeighborNum,access_location::device,access_mode::overwrite);
@@ -456,7 +547,7 @@ void DelaunayGPU::Voronoi_Calc(GPUArray<double2> &points, GPUArray<int> &GPUTria
                         cList.getBoxsize(),
                         *(Box),
                         cList.cell_indexer,
-                        cList.cell_list_indexer,
+                        d_cell_start.data,
                         GPU_idx,
                         GPUcompute,
                         ompThreadNum
@@ -472,6 +563,7 @@ bool DelaunayGPU::computeTriangulationRepairList(GPUArray<double2> &points, GPUA
         ArrayHandle<double2> d_pt(points,access_location::device,access_mode::read);
         ArrayHandle<unsigned int> d_cell_sizes(cList.cell_sizes,access_location::device,access_mode::read);
         ArrayHandle<int> d_cell_idx(cList.idxs,access_location::device,access_mode::read);
+        ArrayHandle<int> d_cell_start(cList.cell_start,access_location::device,access_mode::read);
 
         ArrayHandle<int> d_P_idx(GPUTriangulation,access_location::device,access_mode::readwrite);
         ArrayHandle<int> d_neighnum(cellNeighborNum,access_location::device,access_mode::readwrite);
@@ -494,7 +586,7 @@ bool DelaunayGPU::computeTriangulationRepairList(GPUArray<double2> &points, GPUA
                                  cList.getBoxsize(),
                                  *(Box),
                                  cList.cell_indexer,
-                                 cList.cell_list_indexer,
+                                 d_cell_start.data,
                                  d_repair.data,
                                  GPU_idx,
                                  d_ms.data,
@@ -514,9 +606,9 @@ bool DelaunayGPU::computeTriangulationRepairList(GPUArray<double2> &points, GPUA
             {
             recomputeNeighbors = true;
             printf("Resizing potential neighbors from %i to %i and re-computing (computeTriangulationRepairList function)...\n",currentMaxOneRingSize,postCallMaxOneRingSize);
+            if(metrics)
+                metrics->increment(oneRingResizeMetric);
             resize(postCallMaxOneRingSize);
-            GPUTriangulation.resize(MaxSize*points.getNumElements());
-            globalDelaunayTriangulation(points,GPUTriangulation,cellNeighborNum);
             }
         };
     return recomputeNeighbors;
@@ -533,6 +625,7 @@ bool DelaunayGPU::get_neighbors(GPUArray<double2> &points, GPUArray<int> &GPUTri
         ArrayHandle<double2> d_pt(points,access_location::device,access_mode::read);
         ArrayHandle<unsigned int> d_cell_sizes(cList.cell_sizes,access_location::device,access_mode::read);
         ArrayHandle<int> d_cell_idx(cList.idxs,access_location::device,access_mode::read);
+        ArrayHandle<int> d_cell_start(cList.cell_start,access_location::device,access_mode::read);
 
         ArrayHandle<int> d_P_idx(GPUTriangulation,access_location::device,access_mode::readwrite);
         ArrayHandle<int> d_neighnum(cellNeighborNum,access_location::device,access_mode::readwrite);
@@ -554,7 +647,7 @@ bool DelaunayGPU::get_neighbors(GPUArray<double2> &points, GPUArray<int> &GPUTri
                           cList.getBoxsize(),
                           *(Box),
                           cList.cell_indexer,
-                          cList.cell_list_indexer,
+                          d_cell_start.data,
                           GPU_idx,
                           d_ms.data,
                           currentMaxOneRingSize,
@@ -573,6 +666,8 @@ bool DelaunayGPU::get_neighbors(GPUArray<double2> &points, GPUArray<int> &GPUTri
             {
             recomputeNeighbors = true;
             printf("resizing potential neighbors from %i to %i and re-computing (get_neighbors function)...\n",currentMaxOneRingSize,postCallMaxOneRingSize);
+            if(metrics)
+                metrics->increment(oneRingResizeMetric);
             resize(postCallMaxOneRingSize);
             GPUTriangulation.resize(MaxSize*points.getNumElements());
             globalDelaunayTriangulation(points,GPUTriangulation,cellNeighborNum);
@@ -583,39 +678,45 @@ bool DelaunayGPU::get_neighbors(GPUArray<double2> &points, GPUArray<int> &GPUTri
 
 void DelaunayGPU::testAndRepairDelaunayTriangulation(GPUArray<double2> &points, GPUArray<int> &GPUTriangulation, GPUArray<int> &cellNeighborNum)
     {
+    PROFILE_SCOPE("DelaunayGPU::testAndRepair");
     //resize circumcircles array if needed and populate:
     if(delGPUcircumcircles.getNumElements()!= 2*points.getNumElements())
         delGPUcircumcircles.resize(2*points.getNumElements());
-    prof.start("getC idxs");
+    {
+    PROFILE_SCOPE("DelaunayGPU::getCircumcircles");
     if(GPUcompute)
         getCircumcirclesGPU(GPUTriangulation,cellNeighborNum);
     else
         getCircumcirclesCPU(GPUTriangulation,cellNeighborNum);
+    }
 
-    prof.end("getC idxs");
-
-    prof.start("cellList");
+    {
+    PROFILE_SCOPE("DelaunayGPU::cellList");
     if(GPUcompute)
 	    cList.computeGPU(points);
     else
 	    cList.compute(points);
     cListUpdated=true;
-    prof.end("cellList");
+    }
 
-    prof.start("testCCS");
+    {
+    PROFILE_SCOPE("DelaunayGPU::testCircumcircles");
     if(GPUcompute)
         testTriangulation(points);
     else
         testTriangulationCPU(points);
-    prof.end("testCCS");
-    
+    if(metrics)
+        reportRepairs();
+    }
+
     //locally repair
-    prof.start("repairPoints");
+    PROFILE_SCOPE("DelaunayGPU::repairPoints");
     locallyRepairDelaunayTriangulation(points,GPUTriangulation,cellNeighborNum,repair);
+    if(metrics)
+        metrics->setGauge(maximumNeighborsMetric,MaxSize);
 #ifdef DEBUGFLAGUP
 cudaDeviceSynchronize();
 #endif
-    prof.end("repairPoints");
     }
 
 /*!
@@ -623,7 +724,6 @@ only intended to be used as part of the testAndRepair sequence
 */
 void DelaunayGPU::testTriangulation(GPUArray<double2> &points)
     {
-    prof.start("resetRepair");
     {
     ArrayHandle<int> d_repair(repair,access_location::device,access_mode::readwrite);
     gpu_set_array(d_repair.data,-1,Ncells);
@@ -631,12 +731,12 @@ void DelaunayGPU::testTriangulation(GPUArray<double2> &points)
 #ifdef DEBUGFLAGUP
 cudaDeviceSynchronize();
 #endif
-    prof.end("resetRepair");
     //access data handles
     ArrayHandle<double2> d_pt(points,access_location::device,access_mode::read);
 
     ArrayHandle<unsigned int> d_cell_sizes(cList.cell_sizes,access_location::device,access_mode::read);
     ArrayHandle<int> d_c_idx(cList.idxs,access_location::device,access_mode::read);
+    ArrayHandle<int> d_cell_start(cList.cell_start,access_location::device,access_mode::read);
 
     ArrayHandle<int> d_repair(repair,access_location::device,access_mode::readwrite);
 
@@ -655,7 +755,7 @@ cudaDeviceSynchronize();
                            cList.getBoxsize(),
                            *(Box),
                            cList.cell_indexer,
-                           cList.cell_list_indexer,
+                           d_cell_start.data,
                            GPUcompute,
                            ompThreadNum
                            );
@@ -3,6 +3,7 @@
 #include "indexer.h"
 #include "periodicBoundaries.h"
 #include "functions.h"
+#include "exactPredicates.h"
 #include <iostream>
 #include <stdio.h>
 #include "DelaunayGPU.cuh"
@@ -14,6 +15,8 @@
 */
 
 #define THREADCOUNT 128
+//!relative slack of the floating-point circumcircle distance tests; points that pass are decided exactly
+#define CIRCUMCIRCLE_SLACK 1e-6
 
 //Some specialized functions
 __host__ __device__ inline unsigned positiveModulo(int i, unsigned n)
@@ -22,65 +25,26 @@ __host__ __device__ inline unsigned positiveModulo(int i, unsigned n)
     return i < 0 ? mod+n : mod;
     };
 
-//below are a bunch of geometric tests... I am re-writing them (below) as bools where positive = true
-/*
-__host__ __device__ inline double checkCCW(const double2 pa, const double2 pb, const double2 pc)
-    {
-    return (pa.x - pb.x) * (pa.y - pc.y) - (pa.y - pb.y) * (pa.x - pc.x);
-    }
-__host__ __device__ inline int checkCW(const double pax, const double pay, const double pbx, const double pby, const double pcx, const double pcy)
-    {
-    return (pax - pbx) * (pay - pcy) > (pay - pby) * (pax - pcx) ? 0 : 1;
-    }
-__host__ __device__ inline int checkCW(const double2 pa, const double pbx, const double pby, const double2 pc)
-    {
-    return (pa.x - pbx) * (pa.y - pc.y) > (pa.y - pby) * (pa.x - pc.x) ? 0 : 1;
-    }
-__host__ __device__ inline int checkCWhalf(const double2 pa, const double pby, const double2 pc)
-    {
-    return (pa.y-2.*pby)*pc.x > pa.x*(pc.y - pby) ? 0 : 1;
-    }
-__host__ __device__ inline int checkCWhalf(const double2 pa, const double pbx, const double pby, const double2 pc)
-    {
-    return (0.5*pa.x - pbx) * (0.5*pa.y - pc.y) > (0.5*pa.y - pby) * (0.5*pa.x - pc.x) ? 0 : 1;
-    }
-__host__ __device__ inline int checkCW(const double2 pa, const double pbx, const double pby)
-    {
-    return pa.x*pby > pa.y*pbx ? 0 : 1;
-    }
-__host__ __device__ inline int checkCW(const double pax, const double pby)
-    {
-    return pax*pby >0 ? 0 : 1;
-    }
-*/
 __host__ __device__ inline bool checkCCW(const double2 pa, const double2 pb, const double2 pc)
     {
     return signbit((pa.x - pb.x) * (pa.y - pc.y) - (pa.y - pb.y) * (pa.x - pc.x));
     }
-__host__ __device__ inline int checkCW(const double pax, const double pay, const double pbx, const double pby, const double pcx, const double pcy)
-    {
-    return (pax - pbx) * (pay - pcy) > (pay - pby) * (pax - pcx) ? 0 : 1;
-    }
-__host__ __device__ inline int checkCW(const double2 pa, const double pbx, const double pby, const double2 pc)
-    {
-    return (pa.x - pbx) * (pa.y - pc.y) > (pa.y - pby) * (pa.x - pc.x) ? 0 : 1;
-    }
-__host__ __device__ inline int checkCWhalf(const double2 pa, const double pby, const double2 pc)
-    {
-    return (pa.y-2.*pby)*pc.x > pa.x*(pc.y - pby) ? 0 : 1;
-    }
-__host__ __device__ inline int checkCWhalf(const double2 pa, const double pbx, const double pby, const double2 pc)
-    {
-    return (0.5*pa.x - pbx) * (0.5*pa.y - pc.y) > (0.5*pa.y - pby) * (0.5*pa.x - pc.x) ? 0 : 1;
-    }
-__host__ __device__ inline int checkCW(const double2 pa, const double pbx, const double pby)
-    {
-    return pa.x*pby > pa.y*pbx ? 0 : 1;
-    }
-__host__ __device__ inline int checkCW(const double pax, const double pby)
+
+/*!
+Is the point disp (relative to the point v whose one-ring is being built) strictly inside the circumcircle
+of v and the consecutive one-ring points P[w] and P[w+1]? Equivalently, does the half-plane of points closer
+to disp than to v contain the voronoi vertex Q[w]? Consecutive one-ring points are always in CCW order
+around v, so only the in-circle test is needed. Near-degenerate cases are decided exactly, in the same
+way for every one-ring, with ties broken by the particle indices (the virtual initial points have index -1)
+*/
+__host__ __device__ inline bool voronoiVertexRemoved(const double2 *P, const int *P_idx, int baseIdx, int w,
+                                                     int poly_size, const double2 &disp, int kidx, int newidx,
+                                                     const double2 *d_pt, periodicBoundaries &Box, double coordinateError)
     {
-    return signbit(pax*pby) ? 1 : 0;
-    }
+    int next = (w+1 < poly_size) ? w+1 : 0;
+    return periodicInCircleSign(make_double2(0.0,0.0),P[baseIdx+w],P[baseIdx+next],disp,
+                                kidx,P_idx[baseIdx+w],P_idx[baseIdx+next],newidx,d_pt,Box,coordinateError) > 0;
+    };
 
 template<typename T, int N = -1>
 __device__ inline void rotateInMemoryRight( T *inList, int saveIdx, int rotationOffset,int rotationSize)
@@ -240,7 +204,8 @@ __device__ inline bool cellBucketInsideAngle(const double2 v, const int cx, cons
     return false;
     }
 
-//per-circumcircle test function
+//per-circumcircle test function, for a box that is (or is not) rectangular
+template<bool rectangular>
 __host__ __device__ inline void test_circumcircle_kernel_function(int idx,
                                               int* __restrict__ d_repair,
                                               const int3* __restrict__ d_circumcircles,
@@ -252,33 +217,33 @@ __host__ __device__ inline void test_circumcircle_kernel_function(int idx,
                                               double boxsize,
                                               periodicBoundaries Box,
                                               Index2D ci,
-                                              Index2D cli
+                                              const int* __restrict__ d_cell_start
                                               )
     {
     //the indices of particles forming the circumcircle
     int3 i1 = d_circumcircles[idx];
     //the vertex we will take to be the origin, and its cell position
     double2 v = ldgHD(&d_pt[i1.x]);
-    int cc,dd,cx,cy,bin,newidx,cell_x,cell_y,xOrY,cell_rad;
+    int cc,dd,cx,cy,bin,newidx,cell_x,cell_y,cell_rad;
 
-    double2 pt1,pt2,Q;
-    Box.minDist(ldgHD(&d_pt[i1.y]),v,pt1);
-    Box.minDist(ldgHD(&d_pt[i1.z]),v,pt2);
+    double2 pt1,pt2,Q,disp;
+    Box.minDist<rectangular>(ldgHD(&d_pt[i1.y]),v,pt1);
+    Box.minDist<rectangular>(ldgHD(&d_pt[i1.z]),v,pt2);
 
 
     //get the circumcircle
     double currentRadius;
     Circumcircle(pt1,pt2,Q,currentRadius);
-    double2 QinBox = v+Q;
-    Box.putInBoxReal(QinBox);
-    cell_x = (int)floor(QinBox.x/boxsize) % xsize;
-    cell_y = (int)floor(QinBox.y/boxsize) % ysize;
+    int2 cell = cellListBin(v+Q,xsize,ysize,Box);
+    cell_x = cell.x;
+    cell_y = cell.y;
 
-    //look through cells for other particles...re-use pt1 and pt2 variables below
+    //look through cells for other particles
     bool badParticle = false;
-    xOrY = max(xsize,ysize);
-    cell_rad = min((int) ceil(currentRadius/boxsize),xOrY/2);
-    double rad2 = currentRadius*currentRadius;
+    int2 searchWidth = cellListSearchWidth(currentRadius,xsize,ysize,Box);
+    cell_rad = max(searchWidth.x,searchWidth.y);
+    double rad2 = currentRadius*currentRadius*(1.0+CIRCUMCIRCLE_SLACK);
+    double coordinateError = minDistError(Box);
 
     cell_rad = (2*cell_rad+1);
     cc = 0;
@@ -288,6 +253,8 @@ __host__ __device__ inline void test_circumcircle_kernel_function(int idx,
         {
         cx = positiveModulo(cell_x+dd,xsize);
         cy = positiveModulo(cell_y+cc,ysize);
+        //the spiral covers a square of bins, but the search widths can differ in the two directions
+        bool searchCell = (abs(dd) <= searchWidth.x && abs(cc) <= searchWidth.y);
 
         //cue up the next pair of (dd,cc) cell indices relative to cell_x and cell_y
         if(abs(dd) <= abs(cc) && (dd != cc || dd >=0 ))
@@ -304,20 +271,24 @@ __host__ __device__ inline void test_circumcircle_kernel_function(int idx,
             else
                 cc += 1;
             }
+        if(!searchCell)
+            continue;
         bin = ci(cx,cy);
 
         for (int pp = 0; pp < d_cell_sizes[bin]; ++pp)
             {
-            newidx = d_cell_idx[cli(pp,bin)];
+            newidx = d_cell_idx[d_cell_start[bin]+pp];
             if(newidx == i1.x || newidx == i1.y || newidx == i1.z)
                 continue;
 
-            Box.minDist(ldgHD(&d_pt[newidx]),v,pt1);
-            //everything is pt1 and Q are now already relative positions... no need for a minDist call
-            pt2 = pt1-Q; //Box.minDist(pt1,Q,pt2);
+            Box.minDist<rectangular>(ldgHD(&d_pt[newidx]),v,disp);
+            //disp and Q are now already relative positions... no need for a minDist call
+            double2 fromCenter = disp-Q;
 
-            //if it's in the circumcircle, check that its not one of the three points
-            if(pt2.x*pt2.x+pt2.y*pt2.y < rad2)
+            //if it might be in the circumcircle, decide exactly
+            if(fromCenter.x*fromCenter.x+fromCenter.y*fromCenter.y < rad2 &&
+               periodicCircumcircleContains(make_double2(0.0,0.0),pt1,pt2,disp,i1.x,i1.y,i1.z,newidx,
+                                            d_pt,Box,coordinateError))
                 {
                 d_repair[newidx] = newidx;
                 badParticle = true;
@@ -339,6 +310,7 @@ __host__ __device__ inline void test_circumcircle_kernel_function(int idx,
   vertices of that triangle is empty. Use the cell list to ensure that only checks of nearby
   particles are required.
   */
+template<bool rectangular>
 __global__ void gpu_test_circumcircles_kernel(
                                               int* __restrict__ d_repair,
                                               const int3* __restrict__ d_circumcircles,
@@ -351,22 +323,23 @@ __global__ void gpu_test_circumcircles_kernel(
                                               double boxsize,
                                               periodicBoundaries Box,
                                               Index2D ci,
-                                              Index2D cli
+                                              const int* __restrict__ d_cell_start
                                               )
     {
     // read in the index that belongs to this thread
     unsigned int idx = blockDim.x * blockIdx.x + threadIdx.x;
     if (idx >= Nccs)
         return;
-    test_circumcircle_kernel_function(idx,d_repair,d_circumcircles,d_pt,
+    test_circumcircle_kernel_function<rectangular>(idx,d_repair,d_circumcircles,d_pt,
                                       d_cell_sizes,d_cell_idx,xsize,ysize,
-                                      boxsize,Box,ci,cli);
+                                      boxsize,Box,ci,d_cell_start);
     return;
     };
 
 /*!
 device function carries out the task of finding a good enclosing polygon, using the virtual point and half-plane intersection method
 */
+template<bool rectangular>
 __host__ __device__ inline void virtual_voronoi_calc_function(        int kidx,
                                               const double2* __restrict__ d_pt,
                                               const unsigned int* __restrict__ d_cell_sizes,
@@ -381,7 +354,7 @@ __host__ __device__ inline void virtual_voronoi_calc_function(        int kidx,
                                               double boxsize,
                                               periodicBoundaries Box,
                                               Index2D ci,
-                                              Index2D cli,
+                                              const int* __restrict__ d_cell_start,
                                               Index2D GPU_idx
                                               )
     {
@@ -389,8 +362,12 @@ __host__ __device__ inline void virtual_voronoi_calc_function(        int kidx,
     int m, n;
     double2 pt1;
     double rr;
-    double Lmax=(xsize*boxsize)*0.5; 
+    //the virtual points must be closer than half the smallest box height, so that minDist finds their images
+    double hx,hy;
+    Box.getBoxHeights(hx,hy);
+    double Lmax=0.5*min(hx,hy);
     double LL=Lmax/1.414213562373095-EPSILON;
+    double coordinateError = minDistError(Box);
 
     poly_size=4;
     P[GPU_idx(0, kidx)].x=LL;
@@ -429,24 +406,24 @@ t1=clock();
 #endif
 
     double2 disp, pt2, v;
-    double xx, yy,currentRadius;
-    unsigned int numberInCell, newidx, aa, removed, removeCW;
+    double currentRadius;
+    unsigned int numberInCell, newidx, aa, removed;
     int pp, w, j, jj, cx, cy, cc, dd, cell_rad, bin, cell_x, cell_y;
 
 
     v = ldgHD(&d_pt[kidx]);
-    bool flag=false,removeCCW,firstRemove;
+    bool flag=false,removeCW,removeCCW,firstRemove;
     double2 currentQ;
     int baseIdx = GPU_idx(0,kidx);
     for(jj=0; jj<poly_size; jj++)
         {
         currentQ = Q[GPU_idx(jj,kidx)];
         currentRadius = norm(currentQ);
-        pt1=v;//+Q[GPU_idx(jj,kidx)]; //absolute position (within box) of circumcenter
-        Box.putInBoxReal(pt1);
-        cell_x = (int)floor(pt1.x/boxsize) % xsize;
-        cell_y = (int)floor(pt1.y/boxsize) % ysize;
-        cell_rad = min((int) ceil(currentRadius/boxsize),xsize/2);
+        int2 cell = cellListBin(v,xsize,ysize,Box);//+Q[GPU_idx(jj,kidx)]; //absolute position (within box) of circumcenter
+        cell_x = cell.x;
+        cell_y = cell.y;
+        int2 searchWidth = cellListSearchWidth(currentRadius,xsize,ysize,Box);
+        cell_rad = max(searchWidth.x,searchWidth.y);
         cell_rad = (2*cell_rad+1);
         cc = 0;
         dd = 0;
@@ -465,6 +442,7 @@ t2=clock();
             {
             cx = positiveModulo(cell_x+dd,xsize); 
             cy = positiveModulo(cell_y+cc,ysize); 
+            bool searchCell = (abs(dd) <= searchWidth.x && abs(cc) <= searchWidth.y);
 
             //cue up the next pair of (dd,cc) cell indices relative to cell_x and cell_y
             if(abs(dd) <= abs(cc) && (dd != cc || dd >=0 ))
@@ -481,6 +459,8 @@ t2=clock();
                 else
                     cc += 1;
                 }
+            if(!searchCell)
+                continue;
 
                 //check if there are any points in cellsns, if so do change, otherwise go for next bin
                 bin = ci(cx,cy);
@@ -495,9 +475,9 @@ t2=clock();
 blah +=1;
 t3=clock();
 #endif
-                    newidx = d_cell_idx[cli(aa,bin)];
+                    newidx = d_cell_idx[d_cell_start[bin]+aa];
                     //6-Compute the half-plane Hv defined by the bissector of v and c, containing c
-                    newidx = d_cell_idx[cli(aa,bin)];
+                    newidx = d_cell_idx[d_cell_start[bin]+aa];
                     if(newidx == kidx || newidx == P_idx[baseIdx]) continue;
                     bool skipPoint = false;
                     for (int pidx = jj; pidx < poly_size; ++pidx)
@@ -507,38 +487,16 @@ t3=clock();
 blah2+=1;
 #endif
                     //how far is the point from the circumcircle's center?
-                    rr=currentRadius*currentRadius;
-                    Box.minDist(ldgHD(&d_pt[newidx]), v, disp); //disp = vector between new point and the point we're constructing the one ring of
-                    Box.minDist(disp,currentQ,pt1); // pt1 gets overwritten by vector between new point and Pi's circumcenter
+                    rr=currentRadius*currentRadius*(1.0+CIRCUMCIRCLE_SLACK);
+                    Box.minDist<rectangular>(ldgHD(&d_pt[newidx]), v, disp); //disp = vector between new point and the point we're constructing the one ring of
+                    Box.minDist<rectangular>(disp,currentQ,pt1); // pt1 gets overwritten by vector between new point and Pi's circumcenter
                     if(pt1.x*pt1.x+pt1.y*pt1.y>rr)continue;
 #ifdef DEBUGFLAGUP
 blah3 +=1;
 #endif
-                    //calculate half-plane bissector
-                    if(abs(disp.y) > THRESHOLD)
-                        {
-                        yy=(disp.y*disp.y+disp.x*disp.x)/(2*disp.y);
-                        xx=0;
-                        cx = checkCW(disp.x,yy);
-                        if(cx== checkCWhalf(disp,yy,Q[GPU_idx(jj,kidx)]))
-                            continue;
-                        }
-                    else if(abs(disp.y)<THRESHOLD)
-                        {
-                        yy=disp.y/2+1;
-                        xx=disp.x/2;
-                        cx = checkCW(disp,xx,yy);
-                        if(cx== checkCWhalf(disp,xx,yy,Q[GPU_idx(jj,kidx)]))
-                            continue;
-                        }
-                    if(abs(disp.x)<THRESHOLD)
-                        {
-                        yy=disp.y/2;
-                        xx=disp.x/2+1;
-                        cx = checkCW(disp,xx,yy);
-                        if(cx== checkCWhalf(disp,xx,yy,Q[GPU_idx(jj,kidx)]))
-                            continue;
-                        }
+                    //is the point strictly inside the circumcircle of v and the current pair of one-ring points?
+                    if(!voronoiVertexRemoved(P,P_idx,baseIdx,jj,poly_size,disp,kidx,newidx,d_pt,Box,coordinateError))
+                        continue;
 
                     //7-Q<-Hv intersect Q
                     //8-Update P, based on Q (Algorithm 2)      
@@ -548,16 +506,13 @@ t1 += t4-t3;
 #endif
                     //Remove the voronoi test points on the opposite half sector from the cell v
                     //If more than 1 voronoi test point is removed, then also adjust the delaunay neighbors of v
-                    removeCW=0;
                     removeCCW=false;
                     firstRemove=true;
                     removed=0;
                     j=-1;
                     //which side will Q be at
-                    cy = checkCWhalf(disp,xx,yy,Q[baseIdx+poly_size-1]);
-
-                    removeCW=cy;
-                    if(cy!=cx)
+                    removeCW = voronoiVertexRemoved(P,P_idx,baseIdx,poly_size-1,poly_size,disp,kidx,newidx,d_pt,Box,coordinateError);
+                    if(removeCW)
                         {
                         j=poly_size-1;
                         removed++;
@@ -566,8 +521,7 @@ t1 += t4-t3;
 
                     for(w=0; w<poly_size-1; w++)
                         {
-                        cy = checkCWhalf(disp,xx,yy,Q[baseIdx+w]);
-                        if(cy!=cx)
+                        if(voronoiVertexRemoved(P,P_idx,baseIdx,w,poly_size,disp,kidx,newidx,d_pt,Box,coordinateError))
                             {
                             if(removeCCW==false)
                                 {
@@ -607,7 +561,7 @@ t1 += t4-t3;
                             else
                                 removeCCW=false;
                         }
-                    if(removeCW!=cx && removeCCW==true && firstRemove==false)
+                    if(removeCW && removeCCW && !firstRemove)
                         {
                         poly_size--;
                         if(j>w)j--;
@@ -672,6 +626,7 @@ t7 += clock()-t2;
     }
 
 //assumes "fixlist" has the structure fixlist[ii]=-1 --> dont triangulate
+template<bool rectangular>
 __global__ void gpu_voronoi_calc_no_sort_kernel(const double2* __restrict__ d_pt,
                                               const unsigned int* __restrict__ d_cell_sizes,
                                               const int* __restrict__ d_cell_idx,
@@ -685,7 +640,7 @@ __global__ void gpu_voronoi_calc_no_sort_kernel(const double2* __restrict__ d_pt
                                               double boxsize,
                                               periodicBoundaries Box,
                                               Index2D ci,
-                                              Index2D cli,
+                                              const int* __restrict__ d_cell_start,
                                               const int* __restrict__ d_fixlist,
                                               Index2D GPU_idx
                                               )
@@ -694,11 +649,11 @@ __global__ void gpu_voronoi_calc_no_sort_kernel(const double2* __restrict__ d_pt
     if (tidx >= Ncells)return;
     if(d_fixlist[tidx] >= 0)
         {
-        virtual_voronoi_calc_function(tidx,d_pt,d_cell_sizes,d_cell_idx,
+        virtual_voronoi_calc_function<rectangular>(tidx,d_pt,d_cell_sizes,d_cell_idx,
                           P_idx, P, Q,
                           d_neighnum,
                           Ncells, xsize,ysize, boxsize,Box,
-                          ci,cli,GPU_idx);
+                          ci,d_cell_start,GPU_idx);
         };
     return;
     }
@@ -710,6 +665,7 @@ GPU implementation of the DT. It makes use of a locallity lema described in (doi
 //Currently it only uses 4 points, one in each quadrant.
 //The initial test voronoi cell needs to be valid for the algorithm to work.
 //Thus if the search fails, 4 virtual points are used at maximum distance as the starting polygon
+template<bool rectangular>
 __global__ void gpu_voronoi_calc_global_kernel(const double2* __restrict__ d_pt,
                                               const unsigned int* __restrict__ d_cell_sizes,
                                               const int* __restrict__ d_cell_idx,
@@ -723,24 +679,25 @@ __global__ void gpu_voronoi_calc_global_kernel(const double2* __restrict__ d_pt,
                                               double boxsize,
                                               periodicBoundaries Box,
                                               Index2D ci,
-                                              Index2D cli,
+                                              const int* __restrict__ d_cell_start,
                                               Index2D GPU_idx
                                               )
     {
     unsigned int tidx = blockDim.x * blockIdx.x + threadIdx.x;
     if (tidx >= Ncells)return;
 
-    virtual_voronoi_calc_function(tidx,d_pt,d_cell_sizes,d_cell_idx,
+    virtual_voronoi_calc_function<rectangular>(tidx,d_pt,d_cell_sizes,d_cell_idx,
                           P_idx, P, Q, 
                           d_neighnum,
                           Ncells, xsize,ysize, boxsize,Box,
-                          ci,cli,GPU_idx);
+                          ci,d_cell_start,GPU_idx);
     return;
     }
 
 /*!
 device function that goes from a candidate 1-ring to an actual 1-ring
 */
+template<bool rectangular>
 __host__ __device__ inline void get_oneRing_function(int kidx,
                 const double2* __restrict__ d_pt,
                 const unsigned int* __restrict__ d_cell_sizes,
@@ -755,7 +712,7 @@ __host__ __device__ inline void get_oneRing_function(int kidx,
                 double boxsize,
                 periodicBoundaries Box,
                 Index2D ci,
-                Index2D cli,
+                const int* __restrict__ d_cell_start,
                 Index2D GPU_idx,
                 int const currentMaxNeighbors,
                 int *maximumNeighborNumber
@@ -763,26 +720,26 @@ __host__ __device__ inline void get_oneRing_function(int kidx,
     {
     //note that many of these variable names get re-used in different contexts throughout the kernel... take care
     double2 disp, pt1, pt2, v,currentQ;// v1, v2;
-    double rr, xx, yy,currentRadius;
-    unsigned int newidx, aa, removed, removeCW;
+    double rr, currentRadius;
+    unsigned int newidx, aa, removed;
     int pp, m, w, j, jj, cx, cy, cc, dd, cell_rad, bin, cell_x, cell_y;
 
     v = ldgHD(&d_pt[kidx]);
     unsigned int poly_size=d_neighnum[kidx];
-    bool flag=false, removeCCW, firstRemove;
+    double coordinateError = minDistError(Box);
+    bool flag=false, removeCW, removeCCW, firstRemove;
 
     int baseIdx = GPU_idx(0,kidx);
     for(jj=0; jj<poly_size; jj++)
         {
         currentQ = Q[baseIdx+jj];
         currentRadius = norm(currentQ);
-        pt1=v+currentQ; //absolute position (within box) of circumcenter
-        Box.putInBoxReal(pt1);
-
         //check neighbours of Q's cell inside the circumcircle
-        cell_x = (int)floor(pt1.x/boxsize) % xsize;
-        cell_y = (int)floor(pt1.y/boxsize) % ysize;
-        cell_rad = min((int) ceil(currentRadius/boxsize),xsize/2);
+        int2 cell = cellListBin(v+currentQ,xsize,ysize,Box);
+        cell_x = cell.x;
+        cell_y = cell.y;
+        int2 searchWidth = cellListSearchWidth(currentRadius,xsize,ysize,Box);
+        cell_rad = max(searchWidth.x,searchWidth.y);
         /*cells are currently checked in a spiral search from the central cell to the outermost...
         current algorithm searches CW, with the spiral being {{0,0},{1,0},{1,-1},...,{max,max}}.
         A small optimization could select the spiral used based on the quadrant relative to the
@@ -795,6 +752,7 @@ __host__ __device__ inline void get_oneRing_function(int kidx,
             {
             cx = positiveModulo(cell_x+dd,xsize); 
             cy = positiveModulo(cell_y+cc,ysize); 
+            bool searchCell = (abs(dd) <= searchWidth.x && abs(cc) <= searchWidth.y);
 
             //cue up the next pair of (dd,cc) cell indices relative to cell_x and cell_y
             if(abs(dd) <= abs(cc) && (dd != cc || dd >=0 ))
@@ -811,6 +769,8 @@ __host__ __device__ inline void get_oneRing_function(int kidx,
                 else
                     cc += 1;
                 }
+            if(!searchCell)
+                continue;
             //a possible future optimization, but requires some changes in logic...
             //if(cellBucketInsideAngle(v, cx, cy, v1, v2, boxsize, Box)==false)continue;
 
@@ -819,7 +779,7 @@ __host__ __device__ inline void get_oneRing_function(int kidx,
 
             for(aa = 0; aa < d_cell_sizes[bin]; ++aa) //check points in cell
                 {
-                newidx = ldgHD(&d_cell_idx[cli(aa,bin)]);
+                newidx = ldgHD(&d_cell_idx[d_cell_start[bin]+aa]);
                 if(newidx == kidx || newidx == P_idx[baseIdx]) continue;
                 bool skipPoint = false;
                 for (int pidx = jj; pidx < poly_size; ++pidx)
@@ -827,51 +787,26 @@ __host__ __device__ inline void get_oneRing_function(int kidx,
                 if (skipPoint) continue;
                 //6-Compute the half-plane Hv defined by the bissector of v and c, containing c
                 //how far is the point from the circumcircle's center?
-                rr=currentRadius*currentRadius;
-                Box.minDist(ldgHD(&d_pt[newidx]), v, disp); //disp = vector between new point and the point we're constructing the one ring of
-                Box.minDist(disp,currentQ,pt1); // pt1 gets overwritten by vector between new point and Pi's circumcenter
+                rr=currentRadius*currentRadius*(1.0+CIRCUMCIRCLE_SLACK);
+                Box.minDist<rectangular>(ldgHD(&d_pt[newidx]), v, disp); //disp = vector between new point and the point we're constructing the one ring of
+                Box.minDist<rectangular>(disp,currentQ,pt1); // pt1 gets overwritten by vector between new point and Pi's circumcenter
                 if(pt1.x*pt1.x+pt1.y*pt1.y>rr)continue;
-                //calculate half-plane bissector
-                if(abs(disp.y) > THRESHOLD)
-                    {
-                    yy=(disp.y*disp.y+disp.x*disp.x)/(2*disp.y);
-                    xx=0;
-                    cx = checkCW(disp.x,yy);
-                    if(cx== checkCWhalf(disp,yy,currentQ))
-                        continue;
-                    }
-                else if(abs(disp.y)<THRESHOLD)
-                    {
-                    yy=disp.y/2+1;
-                    xx=disp.x/2;
-                    cx = checkCW(disp,xx,yy);
-                    if(cx== checkCWhalf(disp,xx,yy,currentQ))
-                        continue;
-                    }
-                if(abs(disp.x)<THRESHOLD)
-                    {
-                    yy=disp.y/2;
-                    xx=disp.x/2+1;
-                    cx = checkCW(disp,xx,yy);
-                    if(cx== checkCWhalf(disp,xx,yy,currentQ))
-                        continue;
-                    }
+                //is the point strictly inside the circumcircle of v and the current pair of one-ring points?
+                if(!voronoiVertexRemoved(P,P_idx,baseIdx,jj,poly_size,disp,kidx,newidx,d_pt,Box,coordinateError))
+                    continue;
 
                 //7-Q<-Hv intersect Q
                 //8-Update P, based on Q (Algorithm 2)      
 
                 //Remove the voronoi test points on the opposite half sector from the cell v
                 //If more than 1 voronoi test point is removed, then also adjust the delaunay neighbors of v
-                removeCW=0;
                 removeCCW=false;
                 firstRemove=true;
                 removed=0;
                 j=-1;
                 //which side will Q be at
-                cy = checkCWhalf(disp,xx,yy,Q[baseIdx+poly_size-1]);
-
-                removeCW=cy;
-                if(cy!=cx)
+                removeCW = voronoiVertexRemoved(P,P_idx,baseIdx,poly_size-1,poly_size,disp,kidx,newidx,d_pt,Box,coordinateError);
+                if(removeCW)
                     {
                     j=poly_size-1;
                     removed++;
@@ -881,8 +816,7 @@ __host__ __device__ inline void get_oneRing_function(int kidx,
 
                 for(w=jj; w<poly_size-1; w++)
                     {
-                    cy = checkCWhalf(disp,xx,yy,Q[baseIdx+w]);
-                    if(cy!=cx)
+                    if(voronoiVertexRemoved(P,P_idx,baseIdx,w,poly_size,disp,kidx,newidx,d_pt,Box,coordinateError))
                         {
                         if(removeCCW==false)
                             {
@@ -922,7 +856,7 @@ __host__ __device__ inline void get_oneRing_function(int kidx,
                         else
                             removeCCW=false;
                     }
-                if(removeCW!=cx && removeCCW==true && firstRemove==false)
+                if(removeCW && removeCCW && !firstRemove)
                     {
                     poly_size--;
                     if(j>w)j--;
@@ -1017,6 +951,7 @@ __host__ __device__ inline void get_oneRing_function(int kidx,
     return;
     }//end function
 
+template<bool rectangular>
 __global__ void gpu_get_neighbors_no_sort_kernel(const double2* __restrict__ d_pt,
                 const unsigned int* __restrict__ d_cell_sizes,
                 const int* __restrict__ d_cell_idx,
@@ -1030,7 +965,7 @@ __global__ void gpu_get_neighbors_no_sort_kernel(const double2* __restrict__ d_p
                 double boxsize,
                 periodicBoundaries Box,
                 Index2D ci,
-                Index2D cli,
+                const int* __restrict__ d_cell_start,
                 const int* __restrict__ d_fixlist,
                 Index2D GPU_idx,
                 int *maximumNeighborNum,
@@ -1044,7 +979,7 @@ __global__ void gpu_get_neighbors_no_sort_kernel(const double2* __restrict__ d_p
     if(d_fixlist[tidx] <0)
         return;
 
-    get_oneRing_function(tidx, d_pt,d_cell_sizes,d_cell_idx,P_idx, P,Q,d_neighnum, Ncells,xsize,ysize,boxsize,Box,ci,cli,GPU_idx, currentMaxNeighborNum,maximumNeighborNum);
+    get_oneRing_function<rectangular>(tidx, d_pt,d_cell_sizes,d_cell_idx,P_idx, P,Q,d_neighnum, Ncells,xsize,ysize,boxsize,Box,ci,d_cell_start,GPU_idx, currentMaxNeighborNum,maximumNeighborNum);
 
     return;
     }//end function
@@ -1053,6 +988,7 @@ __global__ void gpu_get_neighbors_no_sort_kernel(const double2* __restrict__ d_p
 //It goes through the same steps as in the paper, using the half plane intersection routine.
 //It outputs the complete triangulation per point in CCW order
 //!global get neighbors does not need a fixlist
+template<bool rectangular>
 __global__ void gpu_get_neighbors_global_kernel(const double2* __restrict__ d_pt,
                 const unsigned int* __restrict__ d_cell_sizes,
                 const int* __restrict__ d_cell_idx,
@@ -1066,7 +1002,7 @@ __global__ void gpu_get_neighbors_global_kernel(const double2* __restrict__ d_pt
                 double boxsize,
                 periodicBoundaries Box,
                 Index2D ci,
-                Index2D cli,
+                const int* __restrict__ d_cell_start,
                 Index2D GPU_idx,
                 int *maximumNeighborNum,
                 int currentMaxNeighborNum
@@ -1075,7 +1011,7 @@ __global__ void gpu_get_neighbors_global_kernel(const double2* __restrict__ d_pt
     unsigned int tidx = blockDim.x * blockIdx.x + threadIdx.x;
     if (tidx >= Ncells)return;
 
-    get_oneRing_function(tidx, d_pt,d_cell_sizes,d_cell_idx,P_idx, P,Q,d_neighnum, Ncells,xsize,ysize,boxsize,Box,ci,cli,GPU_idx, currentMaxNeighborNum,maximumNeighborNum);
+    get_oneRing_function<rectangular>(tidx, d_pt,d_cell_sizes,d_cell_idx,P_idx, P,Q,d_neighnum, Ncells,xsize,ysize,boxsize,Box,ci,d_cell_start,GPU_idx, currentMaxNeighborNum,maximumNeighborNum);
         
     return;
     }//end function
@@ -1121,7 +1057,7 @@ bool gpu_voronoi_calc_no_sort(const double2* d_pt,
                       double boxsize,
                       periodicBoundaries Box,
                       Index2D ci,
-                      Index2D cli,
+                      const int* d_cell_start,
                       int* d_fixlist,
                       Index2D GPU_idx,
                       bool GPUcompute,
@@ -1131,26 +1067,15 @@ bool gpu_voronoi_calc_no_sort(const double2* d_pt,
     unsigned int block_size = THREADCOUNT;
     if (Ncells < THREADCOUNT) block_size = 32;
     unsigned int nblocks  = Ncells/block_size + 1;
+    bool rectangular = Box.isBoxSquare();
     if(GPUcompute==true)
         {
-        gpu_voronoi_calc_no_sort_kernel<<<nblocks,block_size>>>(
-                        d_pt,
-                        d_cell_sizes,
-                        d_cell_idx,
-                        P_idx,
-                        P,
-                        Q,
-                        d_neighnum,
-                        Ncells,
-                        xsize,
-                        ysize,
-                        boxsize,
-                        Box,
-                        ci,
-                        cli,
-                        d_fixlist,
-                        GPU_idx
-                        );
+        if(rectangular)
+            gpu_voronoi_calc_no_sort_kernel<true><<<nblocks,block_size>>>(d_pt,d_cell_sizes,d_cell_idx,P_idx,P,Q,
+                        d_neighnum,Ncells,xsize,ysize,boxsize,Box,ci,d_cell_start,d_fixlist,GPU_idx);
+        else
+            gpu_voronoi_calc_no_sort_kernel<false><<<nblocks,block_size>>>(d_pt,d_cell_sizes,d_cell_idx,P_idx,P,Q,
+                        d_neighnum,Ncells,xsize,ysize,boxsize,Box,ci,d_cell_start,d_fixlist,GPU_idx);
         HANDLE_ERROR(cudaGetLastError());
 #ifdef DEBUGFLAGUP
         cudaDeviceSynchronize();
@@ -1159,16 +1084,17 @@ bool gpu_voronoi_calc_no_sort(const double2* d_pt,
         }
     else
         {
+        auto virtualVoronoiCalc = rectangular ? virtual_voronoi_calc_function<true> : virtual_voronoi_calc_function<false>;
     	if(ompThreadNum==1)
 	        {
             for(int tidx=0; tidx<Ncells; tidx++)
                 {
                 if(d_fixlist[tidx]>=0)
-                    virtual_voronoi_calc_function(tidx,d_pt,d_cell_sizes,d_cell_idx,
+                    virtualVoronoiCalc(tidx,d_pt,d_cell_sizes,d_cell_idx,
                       P_idx, P, Q,
                       d_neighnum,
                       Ncells, xsize,ysize, boxsize,Box,
-                      ci,cli,GPU_idx);
+                      ci,d_cell_start,GPU_idx);
                 }
 	        }
     	else
@@ -1177,11 +1103,11 @@ bool gpu_voronoi_calc_no_sort(const double2* d_pt,
             for(int tidx=0; tidx<Ncells; tidx++)
                 {
                 if(d_fixlist[tidx]>=0)
-                    virtual_voronoi_calc_function(tidx,d_pt,d_cell_sizes,d_cell_idx,
+                    virtualVoronoiCalc(tidx,d_pt,d_cell_sizes,d_cell_idx,
                       P_idx, P, Q,
                       d_neighnum,
                       Ncells, xsize,ysize, boxsize,Box,
-                      ci,cli,GPU_idx);
+                      ci,d_cell_start,GPU_idx);
                 }
 	        }
         }
@@ -1201,7 +1127,7 @@ bool gpu_voronoi_calc(const double2* d_pt,
                 double boxsize,
                 periodicBoundaries Box,
                 Index2D ci,
-                Index2D cli,
+                const int* d_cell_start,
                 Index2D GPU_idx,
                 bool GPUcompute,
 		unsigned int ompThreadNum
@@ -1211,25 +1137,15 @@ bool gpu_voronoi_calc(const double2* d_pt,
     if (Ncells < THREADCOUNT) block_size = 32;
     unsigned int nblocks  = Ncells/block_size + 1;
 
+    bool rectangular = Box.isBoxSquare();
     if(GPUcompute==true)
         {
-        gpu_voronoi_calc_global_kernel<<<nblocks,block_size>>>(
-                        d_pt,
-                        d_cell_sizes,
-                        d_cell_idx,
-                        P_idx,
-                        P,
-                        Q,
-                        d_neighnum,
-                        Ncells,
-                        xsize,
-                        ysize,
-                        boxsize,
-                        Box,
-                        ci,
-                        cli,
-                        GPU_idx
-                        );
+        if(rectangular)
+            gpu_voronoi_calc_global_kernel<true><<<nblocks,block_size>>>(d_pt,d_cell_sizes,d_cell_idx,P_idx,P,Q,
+                        d_neighnum,Ncells,xsize,ysize,boxsize,Box,ci,d_cell_start,GPU_idx);
+        else
+            gpu_voronoi_calc_global_kernel<false><<<nblocks,block_size>>>(d_pt,d_cell_sizes,d_cell_idx,P_idx,P,Q,
+                        d_neighnum,Ncells,xsize,ysize,boxsize,Box,ci,d_cell_start,GPU_idx);
 
         HANDLE_ERROR(cudaGetLastError());
 #ifdef DEBUGFLAGUP
@@ -1239,11 +1155,12 @@ bool gpu_voronoi_calc(const double2* d_pt,
         return cudaSuccess;
         }
     else
-        ompFunctionLoop((int)ompThreadNum,Ncells,virtual_voronoi_calc_function,d_pt,d_cell_sizes,d_cell_idx,
+        ompFunctionLoop((int)ompThreadNum,Ncells,
+                          rectangular ? virtual_voronoi_calc_function<true> : virtual_voronoi_calc_function<false>,d_pt,d_cell_sizes,d_cell_idx,
                           P_idx, P, Q,
                           d_neighnum,
                           Ncells, xsize,ysize, boxsize,Box,
-                          ci,cli,GPU_idx);
+                          ci,d_cell_start,GPU_idx);
     return true;
 };
 
@@ -1260,7 +1177,7 @@ bool gpu_get_neighbors_no_sort(const double2* d_pt, //the point set
                 double boxsize,
                 periodicBoundaries Box,
                 Index2D ci,
-                Index2D cli,
+                const int* d_cell_start,
                 int* d_fixlist,
                 Index2D GPU_idx,
                 int *maximumNeighborNum,
@@ -1272,11 +1189,18 @@ bool gpu_get_neighbors_no_sort(const double2* d_pt, //the point set
     unsigned int block_size = THREADCOUNT;
     if (Ncells < THREADCOUNT) block_size = 32;
     unsigned int nblocks  = Ncells/block_size + 1;
+    bool rectangular = Box.isBoxSquare();
     if(GPUcompute==true)
         {
-        gpu_get_neighbors_no_sort_kernel<<<nblocks,block_size>>>(
+        if(rectangular)
+            gpu_get_neighbors_no_sort_kernel<true><<<nblocks,block_size>>>(
                       d_pt,d_cell_sizes,d_cell_idx,P_idx,P,Q,d_neighnum,Ncells,xsize,ysize,
-                      boxsize,Box,ci,cli,d_fixlist,GPU_idx,maximumNeighborNum,currentMaxNeighborNum
+                      boxsize,Box,ci,d_cell_start,d_fixlist,GPU_idx,maximumNeighborNum,currentMaxNeighborNum
+                      );
+        else
+            gpu_get_neighbors_no_sort_kernel<false><<<nblocks,block_size>>>(
+                      d_pt,d_cell_sizes,d_cell_idx,P_idx,P,Q,d_neighnum,Ncells,xsize,ysize,
+                      boxsize,Box,ci,d_cell_start,d_fixlist,GPU_idx,maximumNeighborNum,currentMaxNeighborNum
                       );
 
         HANDLE_ERROR(cudaGetLastError());
@@ -1287,14 +1211,15 @@ bool gpu_get_neighbors_no_sort(const double2* d_pt, //the point set
         }
     else
         {
+        auto oneRing = rectangular ? get_oneRing_function<true> : get_oneRing_function<false>;
     	if(ompThreadNum==1)
 	        {
             for(int tidx=0; tidx<Ncells; tidx++)
                 {
                 if(d_fixlist[tidx]>=0)
-                    get_oneRing_function(tidx, d_pt,d_cell_sizes,d_cell_idx,P_idx,
+                    oneRing(tidx, d_pt,d_cell_sizes,d_cell_idx,P_idx,
                                  P,Q,d_neighnum, Ncells,xsize,ysize,
-                                 boxsize,Box,ci,cli,GPU_idx, currentMaxNeighborNum,
+                                 boxsize,Box,ci,d_cell_start,GPU_idx, currentMaxNeighborNum,
                                  maximumNeighborNum);
                 }
 	        }
@@ -1304,9 +1229,9 @@ bool gpu_get_neighbors_no_sort(const double2* d_pt, //the point set
             for(int tidx=0; tidx<Ncells; tidx++)
                 {
                 if(d_fixlist[tidx]>=0)
-                    get_oneRing_function(tidx, d_pt,d_cell_sizes,d_cell_idx,P_idx, 
+                    oneRing(tidx, d_pt,d_cell_sizes,d_cell_idx,P_idx, 
                                  P,Q,d_neighnum, Ncells,xsize,ysize,
-                                 boxsize,Box,ci,cli,GPU_idx, currentMaxNeighborNum,
+                                 boxsize,Box,ci,d_cell_start,GPU_idx, currentMaxNeighborNum,
                                  maximumNeighborNum);
                 }
 	        }
@@ -1327,7 +1252,7 @@ bool gpu_get_neighbors(const double2* d_pt, //the point set
                 double boxsize,
                 periodicBoundaries Box,
                 Index2D ci,
-                Index2D cli,
+                const int* d_cell_start,
                 Index2D GPU_idx,
                 int *maximumNeighborNum,
                 int currentMaxNeighborNum,
@@ -1339,11 +1264,18 @@ bool gpu_get_neighbors(const double2* d_pt, //the point set
     if (Ncells < THREADCOUNT) block_size = 32;
     unsigned int nblocks  = Ncells/block_size + 1;
 
+    bool rectangular = Box.isBoxSquare();
     if(GPUcompute==true)
         {
-        gpu_get_neighbors_global_kernel<<<nblocks,block_size>>>(
+        if(rectangular)
+            gpu_get_neighbors_global_kernel<true><<<nblocks,block_size>>>(
+                      d_pt,d_cell_sizes,d_cell_idx,P_idx,P,Q,d_neighnum,
+                      Ncells,xsize,ysize,boxsize,Box,ci,d_cell_start,GPU_idx,maximumNeighborNum,currentMaxNeighborNum
+                      );
+        else
+            gpu_get_neighbors_global_kernel<false><<<nblocks,block_size>>>(
                       d_pt,d_cell_sizes,d_cell_idx,P_idx,P,Q,d_neighnum,
-                      Ncells,xsize,ysize,boxsize,Box,ci,cli,GPU_idx,maximumNeighborNum,currentMaxNeighborNum
+                      Ncells,xsize,ysize,boxsize,Box,ci,d_cell_start,GPU_idx,maximumNeighborNum,currentMaxNeighborNum
                       );
 
         HANDLE_ERROR(cudaGetLastError());
@@ -1353,10 +1285,11 @@ bool gpu_get_neighbors(const double2* d_pt, //the point set
         return cudaSuccess;
         }
     else
-        ompFunctionLoop((int)ompThreadNum,Ncells,get_oneRing_function,
+        ompFunctionLoop((int)ompThreadNum,Ncells,
+                rectangular ? get_oneRing_function<true> : get_oneRing_function<false>,
                 d_pt,d_cell_sizes,d_cell_idx,P_idx,
                 P,Q,d_neighnum, Ncells,xsize,ysize,
-                boxsize,Box,ci,cli,GPU_idx, currentMaxNeighborNum,
+                boxsize,Box,ci,d_cell_start,GPU_idx, currentMaxNeighborNum,
                 maximumNeighborNum);
 
     return true;
@@ -1401,7 +1334,7 @@ bool gpu_test_circumcircles(int *d_repair,
                             double boxsize,
                             periodicBoundaries &Box,
                             Index2D &ci,
-                            Index2D &cli,
+                            const int *d_cell_start,
                             bool GPUcompute,
 			    unsigned int ompThreadNum
                             )
@@ -1410,22 +1343,15 @@ bool gpu_test_circumcircles(int *d_repair,
     if (Nccs < THREADCOUNT) block_size = 32;
     unsigned int nblocks  = Nccs/block_size + 1;
 
+    bool rectangular = Box.isBoxSquare();
     if(GPUcompute)
         {
-        gpu_test_circumcircles_kernel<<<nblocks,block_size>>>(
-                            d_repair,
-                            d_ccs,
-                            d_pt,
-                            d_cell_sizes,
-                            d_idx,
-                            Nccs,
-                            xsize,
-                            ysize,
-                            boxsize,
-                            Box,
-                            ci,
-                            cli
-                            );
+        if(rectangular)
+            gpu_test_circumcircles_kernel<true><<<nblocks,block_size>>>(d_repair,d_ccs,d_pt,d_cell_sizes,d_idx,
+                                                                       Nccs,xsize,ysize,boxsize,Box,ci,d_cell_start);
+        else
+            gpu_test_circumcircles_kernel<false><<<nblocks,block_size>>>(d_repair,d_ccs,d_pt,d_cell_sizes,d_idx,
+                                                                        Nccs,xsize,ysize,boxsize,Box,ci,d_cell_start);
 
         HANDLE_ERROR(cudaGetLastError());
 #ifdef DEBUGFLAGUP
@@ -1433,10 +1359,14 @@ bool gpu_test_circumcircles(int *d_repair,
 #endif
         return cudaSuccess;
         }
+    else if(rectangular)
+        ompFunctionLoop((int)ompThreadNum,Nccs,test_circumcircle_kernel_function<true>,d_repair,d_ccs,d_pt,
+                                      d_cell_sizes,d_idx,xsize,ysize,
+                                      boxsize,Box,ci,d_cell_start);
     else
-        ompFunctionLoop((int)ompThreadNum,Nccs,test_circumcircle_kernel_function,d_repair,d_ccs,d_pt,
+        ompFunctionLoop((int)ompThreadNum,Nccs,test_circumcircle_kernel_function<false>,d_repair,d_ccs,d_pt,
                                       d_cell_sizes,d_idx,xsize,ysize,
-                                      boxsize,Box,ci,cli);
+                                      boxsize,Box,ci,d_cell_start);
     return true;
     };
 
@@ -38,7 +38,7 @@ bool gpu_test_circumcircles(int *d_repair,
                             double boxsize,
                             periodicBoundaries &Box,
                             Index2D &ci,
-                            Index2D &cli,
+                            const int *d_cell_start,
                             bool GPUcompute,
                             unsigned int ompThreadNum
                             );
@@ -56,7 +56,7 @@ bool gpu_voronoi_calc(const double2* d_pt,
                       double boxsize,
                       periodicBoundaries Box,
                       Index2D ci,
-                      Index2D cli,
+                      const int* d_cell_start,
                       Index2D GPU_idx,
                       bool GPUcompute,
                       unsigned int ompThreadNum
@@ -76,7 +76,7 @@ bool gpu_voronoi_calc_no_sort(const double2* d_pt,
                       double boxsize,
                       periodicBoundaries Box,
                       Index2D ci,
-                      Index2D cli,
+                      const int* d_cell_start,
                       int* d_fixlist,
                       Index2D GPU_idx,
                       bool GPUcompute,
@@ -97,7 +97,7 @@ bool gpu_get_neighbors(const double2* d_pt,
                       double boxsize,
                       periodicBoundaries Box,
                       Index2D ci,
-                      Index2D cli,
+                      const int* d_cell_start,
                       Index2D GPU_idx,
                       int* maximumNeighborNum,
                       int currentMaxNeighborNum,
@@ -119,7 +119,7 @@ bool gpu_get_neighbors_no_sort(const double2* d_pt,
                       double boxsize,
                       periodicBoundaries Box,
                       Index2D ci,
-                      Index2D cli,
+                      const int* d_cell_start,
                       int* d_fixlist,
                       Index2D GPU_idx,
                       int* maximumNeighborNum,
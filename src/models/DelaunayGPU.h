@@ -4,7 +4,9 @@
 #include "gpuarray.h"
 #include "periodicBoundaries.h"
 #include "cellListGPU.h"
-#include "multiProfiler.h"
+#include "regionProfiler.h"
+#include "runtimeMetrics.h"
+#include "checkpointFile.h"
 
 using namespace std;
 
@@ -47,9 +49,13 @@ class DelaunayGPU
         //!set a flag to use GPU routines. When false, use CPU routines
         void setGPUcompute(bool flag){GPUcompute=flag;};
         //!Set the number of threads to ask openMP to use during CPU-based triangulation loops
-        virtual void setOmpThreads(int _number){ompThreadNum = _number;};
-        //!A lightweight profiler to use when timing the functionality of this class
-        multiProfiler prof;
+        virtual void setOmpThreads(int _number){ompThreadNum = _number;cList.setOmpThreads(_number);};
+        //!Report repairs, one-ring resizes, global triangulations and cell list occupancy to a metrics registry
+        void setMetrics(shared_ptr<runtimeMetrics> _metrics);
+        //!Add the one-ring size and the per-point work arrays (which carry over between repairs) to a checkpoint
+        void writeCheckpoint(checkpointWriter &out);
+        //!Restore a state written by writeCheckpoint
+        void readCheckpoint(checkpointReader &in);
         //! A box to calculate relative distances in a periodic domain.
         PeriodicBoxPtr Box;
         //! The maximum number of neighbors any point has
@@ -127,5 +133,13 @@ class DelaunayGPU
         cellListGPU cList;
         //!keep track of the linear size of the cells used by the cellListGPU object
         double cellsize;
+
+        //!count the points marked for repair and record the largest cell list occupancy, if metrics are being reported
+        void reportRepairs();
+        //!The registry metrics are reported to (null if they are not)
+        shared_ptr<runtimeMetrics> metrics;
+        //!ids of the reported metrics
+        int repairedPointsMetric, repairedPointsHistogram, oneRingResizeMetric, globalTriangulationMetric;
+        int maximumNeighborsMetric, cellListOccupancyMetric;
     };
 #endif
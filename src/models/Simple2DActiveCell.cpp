@@ -150,3 +150,23 @@ void Simple2DActiveCell::cellDivision(const vector<int> &parameters, const vecto
         h_v.data[Ncells-1].y = h_mot.data[Ncells-1].x*sin(h_cd.data[Ncells-1]);
         };
     };
+
+void Simple2DActiveCell::writeCheckpoint(checkpointWriter &out)
+    {
+    Simple2DCell::writeCheckpoint(out);
+    out.addValue("v0",v0);
+    out.addValue("Dr",Dr);
+    out.addArray("cellDirectors",cellDirectors);
+    out.addArray("cellDirectorForces",cellDirectorForces);
+    out.addArray("Motility",Motility);
+    };
+
+void Simple2DActiveCell::readCheckpoint(checkpointReader &in)
+    {
+    Simple2DCell::readCheckpoint(in);
+    in.readValue("v0",v0);
+    in.readValue("Dr",Dr);
+    in.readArray("cellDirectors",cellDirectors);
+    in.readArray("cellDirectorForces",cellDirectorForces);
+    in.readArray("Motility",Motility);
+    };
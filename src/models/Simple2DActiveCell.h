@@ -41,6 +41,11 @@ class Simple2DActiveCell : public Simple2DCell
         //!Kill the indexed cell
         virtual void cellDeath(int cellIndex);
 
+        //!Add the cell directors and motilities to the Simple2DCell checkpoint
+        virtual void writeCheckpoint(checkpointWriter &out);
+        //!Restore a state written by writeCheckpoint
+        virtual void readCheckpoint(checkpointReader &in);
+
         //!measure the viscek order parameter N^-1 \sum \frac{v_i}{|v_i}
         double vicsekOrderParameter(double2 &vParallel, double2 &vPerpendicular)
             {
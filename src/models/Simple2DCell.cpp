@@ -6,7 +6,7 @@
 An extremely simple constructor that does nothing, but enforces default GPU operation
 */
 Simple2DCell::Simple2DCell() :
-    Ncells(0), Nvertices(0),GPUcompute(true),Energy(-1.0)
+    Ncells(0), Nvertices(0),Energy(-1.0),GPUcompute(true),uniformModuli(true)
     {
     forcesUpToDate = false;
     Box = make_shared<periodicBoundaries>();
@@ -25,6 +25,8 @@ void Simple2DCell::initializeSimple2DCell(int n, bool gpu)
         cout << " disabling gpu memory use" << endl;
         cellPositions.neverGPU = true;
         vertexPositions.neverGPU = true;
+        cellImages.neverGPU = true;
+        vertexImages.neverGPU = true;
         cellVelocities.neverGPU = true;
         cellMasses.neverGPU = true;
         vertexVelocities.neverGPU = true;
@@ -112,6 +114,7 @@ Simply call either the CPU or GPU routine in the current or derived model
 */
 void Simple2DCell::computeGeometry()
     {
+    PROFILE_SCOPE("Simple2DCell::computeGeometry");
     if(GPUcompute)
         computeGeometryGPU();
     else
@@ -154,6 +157,7 @@ void Simple2DCell::setCellPositionsRandomly()
         h_p.data[ii].x = x;
         h_p.data[ii].y = y;
         };
+    resetImages();
     };
 
 /*!
@@ -167,6 +171,7 @@ void Simple2DCell::setCellPositions(vector<double2> newCellPositions)
     ArrayHandle<double2> h_p(cellPositions,access_location::host,access_mode::overwrite);
     for (int ii = 0; ii < Ncells; ++ii)
         h_p.data[ii] = newCellPositions[ii];
+    resetImages();
     }
 
 /*!
@@ -180,18 +185,54 @@ void Simple2DCell::setVertexPositions(vector<double2> newVertexPositions)
     ArrayHandle<double2> h_v(vertexPositions,access_location::host,access_mode::overwrite);
     for (int ii = 0; ii < Nvertices; ++ii)
         h_v.data[ii] = newVertexPositions[ii];
+    resetImages();
     }
 
+/*!
+Subsequent calls to moveDegreesOfFreedom will measure unwrapped positions relative to the current
+(wrapped) positions
+*/
+void Simple2DCell::resetImages()
+    {
+    cellImages.resize(Ncells);
+    vertexImages.resize(Nvertices);
+    vector<int2> zeroC(Ncells,make_int2(0,0));
+    vector<int2> zeroV(Nvertices,make_int2(0,0));
+    fillGPUArrayWithVector(zeroC,cellImages);
+    fillGPUArrayWithVector(zeroV,vertexImages);
+    };
+
+/*!
+The unwrapped positions are the positions of the degrees of freedom (cells or vertices, according to
+returnPositions) shifted by their periodic image counters. Differences of unwrapped positions at two
+times give true displacements no matter how far the degrees of freedom have travelled, so (e.g.) an MSD
+can be computed from arbitrarily sparse snapshots.
+*/
+void Simple2DCell::getUnwrappedPositions(GPUArray<double2> &unwrappedPositions)
+    {
+    GPUArray<double2> &pos = returnPositions();
+    GPUArray<int2> &images = returnImages();
+    int N = pos.getNumElements();
+    if(unwrappedPositions.getNumElements() != (unsigned int)N)
+        unwrappedPositions.resize(N);
+    ArrayHandle<double2> h_p(pos,access_location::host,access_mode::read);
+    ArrayHandle<int2> h_i(images,access_location::host,access_mode::read);
+    ArrayHandle<double2> h_u(unwrappedPositions,access_location::host,access_mode::overwrite);
+    for (int ii = 0; ii < N; ++ii)
+        Box->unwrap(h_p.data[ii],h_i.data[ii],h_u.data[ii]);
+    };
+
 
 /*!
 set all cell K_A, K_P preferences to uniform values.
-PLEASE NOTE that as an optimization this data is not actually used at the moment,
-but the code could be trivially altered to use this
+The Moduli array is filled for bookkeeping, but the force and energy routines will use the scalar
+KA and KP directly (and so avoid a per-cell memory read) until setModuli is called
 */
 void Simple2DCell::setModuliUniform(double newKA, double newKP)
     {
     KA=newKA;
     KP=newKP;
+    uniformModuli = true;
     Moduli.resize(Ncells);
     ArrayHandle<double2> h_m(Moduli,access_location::host,access_mode::overwrite);
     for (int ii = 0; ii < Ncells; ++ii)
@@ -201,6 +242,22 @@ void Simple2DCell::setModuliUniform(double newKA, double newKP)
         };
     };
 
+/*!
+Set the (K_A,K_P) of every cell. After this call the force and energy routines read the moduli of
+each cell from the Moduli array
+\param newModuli a vector of length Ncells of (K_A,K_P) pairs
+*/
+void Simple2DCell::setModuli(vector<double2> &newModuli)
+    {
+    if(newModuli.size() != (size_t)Ncells)
+        {
+        printf("Error in setModuli: the input vector has %lu elements, but there are %i cells\n",newModuli.size(),Ncells);
+        throw std::exception();
+        };
+    uniformModuli = false;
+    fillGPUArrayWithVector(newModuli,Moduli);
+    };
+
 /*!
  * set all cell types to i
  */
@@ -424,6 +481,20 @@ void Simple2DCell::reIndexCellArray(GPUArray<double2> &array)
         };
     };
 
+/*!
+Re-indexes GPUarrays of int2s
+*/
+void Simple2DCell::reIndexCellArray(GPUArray<int2> &array)
+    {
+    GPUArray<int2> TEMP = array;
+    ArrayHandle<int2> temp(TEMP,access_location::host,access_mode::read);
+    ArrayHandle<int2> ar(array,access_location::host,access_mode::readwrite);
+    for (int ii = 0; ii < Ncells; ++ii)
+        {
+        ar.data[ii] = temp.data[itt[ii]];
+        };
+    };
+
 /*!
 Re-indexes GPUarrays of doubles
 */
@@ -467,6 +538,20 @@ void Simple2DCell::reIndexVertexArray(GPUArray<double2> &array)
         };
     };
 
+/*!
+Re-indexes GPUarrays of int2s
+*/
+void Simple2DCell::reIndexVertexArray(GPUArray<int2> &array)
+    {
+    GPUArray<int2> TEMP = array;
+    ArrayHandle<int2> temp(TEMP,access_location::host,access_mode::read);
+    ArrayHandle<int2> ar(array,access_location::host,access_mode::readwrite);
+    for (int ii = 0; ii < Nvertices; ++ii)
+        {
+        ar.data[ii] = temp.data[ittVertex[ii]];
+        };
+    };
+
 void Simple2DCell::reIndexVertexArray(GPUArray<double> &array)
     {
     GPUArray<double> TEMP = array;
@@ -525,6 +610,7 @@ void Simple2DCell::spatiallySortCells()
         tagToIdx[tempi[itt[ii]]] = ii;
         };
     reIndexCellArray(cellPositions);
+    reIndexCellArray(cellImages);
     reIndexCellArray(Moduli);
     reIndexCellArray(AreaPeriPreferences);
     reIndexCellArray(AreaPeri);
@@ -572,6 +658,7 @@ void Simple2DCell::spatiallySortVertices()
         tagToIdxVertex[tempi[ittVertex[ii]]] = ii;
         };
     reIndexVertexArray(vertexPositions);
+    reIndexVertexArray(vertexImages);
     reIndexCellArray(vertexVelocities);
     reIndexCellArray(vertexMasses);
 
@@ -627,6 +714,7 @@ void Simple2DCell::spatiallySortVertices()
         };
 
     reIndexCellArray(cellPositions);
+    reIndexCellArray(cellImages);
 
     //Finally, now that both cell and vertex re-indexing is known, update auxiliary data structures
     //Start with everything that can be done with just the cell indexing
@@ -864,6 +952,7 @@ void Simple2DCell::cellDeath(int cellIndex)
     removeGPUArrayElement(cellVelocities,cellIndex);
     removeGPUArrayElement(cellType,cellIndex);
     removeGPUArrayElement(cellPositions,cellIndex);
+    removeGPUArrayElement(cellImages,cellIndex);
     };
 
 /*!
@@ -896,12 +985,149 @@ void Simple2DCell::cellDivision(const vector<int> &parameters, const vector<doub
     growGPUArray(cellVelocities,1);
     growGPUArray(cellType,1);
     growGPUArray(cellPositions,1);
+    growGPUArray(cellImages,1);
 
         {//arrayhandle scope
         ArrayHandle<double2> h_APP(AreaPeriPreferences); h_APP.data[Ncells-1] = h_APP.data[cellIdx];
         ArrayHandle<double2> h_Mod(Moduli); h_Mod.data[Ncells-1] = h_Mod.data[cellIdx];
         ArrayHandle<int> h_ct(cellType); h_ct.data[Ncells-1] = h_ct.data[cellIdx];
+        ArrayHandle<int2> h_ci(cellImages); h_ci.data[Ncells-1] = h_ci.data[cellIdx];
         ArrayHandle<double> h_cm(cellMasses);  h_cm.data[Ncells-1] = h_cm.data[cellIdx];
         ArrayHandle<double2> h_v(cellVelocities); h_v.data[Ncells-1] = make_double2(0.0,0.0);
         };
     };
+
+/*!
+Global parameters (moduli set by setModuliUniform, the box shape, ...) are stored along with the
+per-cell and per-vertex arrays, since spatial sorting, division and death permute and resize the latter;
+the box is stored by its matrix, so that every object sharing it sees the restored box
+*/
+void Simple2DCell::writeCheckpoint(checkpointWriter &out)
+    {
+    out.addValue("Ncells",Ncells);
+    out.addValue("Nvertices",Nvertices);
+    double b11,b12,b21,b22;
+    Box->getBoxDims(b11,b12,b21,b22);
+    out.addValue("box",make_double4(b11,b12,b21,b22));
+    out.addValue("boxSquare",Box->isBoxSquare());
+    out.addValue("Timestep",Timestep);
+    out.addValue("deltaT",deltaT);
+    out.addValue("currentTime",currentTime);
+    out.addValue("Energy",Energy);
+    out.addValue("KineticEnergy",KineticEnergy);
+    out.addValue("forcesUpToDate",forcesUpToDate);
+    out.addValue("Reproducible",Reproducible);
+    out.addValue("KA",KA);
+    out.addValue("KP",KP);
+    out.addValue("uniformModuli",uniformModuli);
+    out.addValue("vertexMax",vertexMax);
+    out.addValue("n_idx",make_int2(n_idx.getW(),n_idx.getH()));
+    out.addValue("cellTypeIndexer",make_int2(cellTypeIndexer.getW(),cellTypeIndexer.getH()));
+
+    out.addArray("cellPositions",cellPositions);
+    out.addArray("vertexPositions",vertexPositions);
+    out.addArray("cellImages",cellImages);
+    out.addArray("vertexImages",vertexImages);
+    out.addArray("cellVelocities",cellVelocities);
+    out.addArray("cellMasses",cellMasses);
+    out.addArray("vertexVelocities",vertexVelocities);
+    out.addArray("vertexMasses",vertexMasses);
+    out.addArray("vertexNeighbors",vertexNeighbors);
+    out.addArray("vertexCellNeighbors",vertexCellNeighbors);
+    out.addArray("neighborNum",neighborNum);
+    out.addArray("neighbors",neighbors);
+    out.addArray("cellVertexNum",cellVertexNum);
+    out.addArray("vertexForces",vertexForces);
+    out.addArray("cellForces",cellForces);
+    out.addArray("cellType",cellType);
+    out.addArray("Moduli",Moduli);
+    out.addArray("AreaPeri",AreaPeri);
+    out.addArray("AreaPeriPreferences",AreaPeriPreferences);
+    out.addArray("cellVertices",cellVertices);
+    out.addArray("voroCur",voroCur);
+    out.addArray("voroLastNext",voroLastNext);
+
+    out.addVector("tagToIdx",tagToIdx);
+    out.addVector("idxToTag",idxToTag);
+    out.addVector("itt",itt);
+    out.addVector("tti",tti);
+    out.addVector("tagToIdxVertex",tagToIdxVertex);
+    out.addVector("idxToTagVertex",idxToTagVertex);
+    out.addVector("ittVertex",ittVertex);
+    out.addVector("ttiVertex",ttiVertex);
+    noise.writeCheckpoint(out,"noise");
+    };
+
+/*!
+\pre the model was constructed (and set to the CPU or GPU) as the one that wrote the checkpoint, with the
+same number of cells and vertices
+*/
+void Simple2DCell::readCheckpoint(checkpointReader &in)
+    {
+    int checkpointCells, checkpointVertices;
+    in.readValue("Ncells",checkpointCells);
+    in.readValue("Nvertices",checkpointVertices);
+    if(checkpointCells != Ncells || checkpointVertices != Nvertices)
+        {
+        printf("the checkpoint has %i cells and %i vertices, but the model has %i and %i\n",
+               checkpointCells,checkpointVertices,Ncells,Nvertices);
+        throw std::exception();
+        };
+    double4 b;
+    bool square;
+    in.readValue("box",b);
+    in.readValue("boxSquare",square);
+    if(square)
+        Box->setSquare(b.x,b.w);
+    else
+        Box->setGeneral(b.x,b.y,b.z,b.w);
+    in.readValue("Timestep",Timestep);
+    in.readValue("deltaT",deltaT);
+    in.readValue("currentTime",currentTime);
+    in.readValue("Energy",Energy);
+    in.readValue("KineticEnergy",KineticEnergy);
+    in.readValue("forcesUpToDate",forcesUpToDate);
+    in.readValue("Reproducible",Reproducible);
+    in.readValue("KA",KA);
+    in.readValue("KP",KP);
+    in.readValue("uniformModuli",uniformModuli);
+    in.readValue("vertexMax",vertexMax);
+    int2 indexer;
+    in.readValue("n_idx",indexer);
+    n_idx = Index2D(indexer.x,indexer.y);
+    in.readValue("cellTypeIndexer",indexer);
+    cellTypeIndexer = Index2D(indexer.x,indexer.y);
+
+    in.readArray("cellPositions",cellPositions);
+    in.readArray("vertexPositions",vertexPositions);
+    in.readArray("cellImages",cellImages);
+    in.readArray("vertexImages",vertexImages);
+    in.readArray("cellVelocities",cellVelocities);
+    in.readArray("cellMasses",cellMasses);
+    in.readArray("vertexVelocities",vertexVelocities);
+    in.readArray("vertexMasses",vertexMasses);
+    in.readArray("vertexNeighbors",vertexNeighbors);
+    in.readArray("vertexCellNeighbors",vertexCellNeighbors);
+    in.readArray("neighborNum",neighborNum);
+    in.readArray("neighbors",neighbors);
+    in.readArray("cellVertexNum",cellVertexNum);
+    in.readArray("vertexForces",vertexForces);
+    in.readArray("cellForces",cellForces);
+    in.readArray("cellType",cellType);
+    in.readArray("Moduli",Moduli);
+    in.readArray("AreaPeri",AreaPeri);
+    in.readArray("AreaPeriPreferences",AreaPeriPreferences);
+    in.readArray("cellVertices",cellVertices);
+    in.readArray("voroCur",voroCur);
+    in.readArray("voroLastNext",voroLastNext);
+
+    in.readVector("tagToIdx",tagToIdx);
+    in.readVector("idxToTag",idxToTag);
+    in.readVector("itt",itt);
+    in.readVector("tti",tti);
+    in.readVector("tagToIdxVertex",tagToIdxVertex);
+    in.readVector("idxToTagVertex",idxToTagVertex);
+    in.readVector("ittVertex",ittVertex);
+    in.readVector("ttiVertex",ttiVertex);
+    noise.readCheckpoint(in,"noise");
+    };
@@ -69,6 +69,27 @@ __global__ void gpu_move_degrees_of_freedom_kernel(double2 *d_points,
     return;
     };
 
+/*!
+  As above, but also accumulate the number of box vectors removed from each point in its image counter
+*/
+__global__ void gpu_move_degrees_of_freedom_kernel(double2 *d_points,
+                                          double2 *d_disp,
+                                          int2 *d_images,
+                                          double scale,
+                                          int N,
+                                          periodicBoundaries Box
+                                         )
+    {
+    // read in the particle that belongs to this thread
+    unsigned int idx = blockDim.x * blockIdx.x + threadIdx.x;
+    if (idx >= N)
+        return;
+    d_points[idx].x += scale*d_disp[idx].x;
+    d_points[idx].y += scale*d_disp[idx].y;
+    Box.putInBoxReal(d_points[idx],d_images[idx]);
+    return;
+    };
+
 /*!
 every thread just writes in a value
 */
@@ -139,6 +160,39 @@ bool gpu_move_degrees_of_freedom(double2 *d_points,
     return cudaSuccess;
     };
 
+/*!
+\param d_points double2 array of locations
+\param d_disp   double2 array of displacements
+\param d_images int2 array of periodic image counters
+\param scale    the factor multiplying every displacement
+\param N        The number of degrees of freedom to move
+\param Box      The periodicBoundaries in which the new positions must reside
+*/
+bool gpu_move_degrees_of_freedom(double2 *d_points,
+                        double2 *d_disp,
+                        int2 *d_images,
+                        double  scale,
+                        int N,
+                        periodicBoundaries &Box
+                        )
+    {
+    unsigned int block_size = 128;
+    if (N < 128) block_size = 32;
+    unsigned int nblocks  = N/block_size + 1;
+
+    gpu_move_degrees_of_freedom_kernel<<<nblocks,block_size>>>(
+                                                d_points,
+                                                d_disp,
+                                                d_images,
+                                                scale,
+                                                N,
+                                                Box
+                                                );
+    HANDLE_ERROR(cudaGetLastError());
+
+    return cudaSuccess;
+    };
+
 /*!
 \param d_array int array of values
 \param value   the integer to set the entire array to
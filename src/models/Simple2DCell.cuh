@@ -33,6 +33,15 @@ bool gpu_move_degrees_of_freedom(double2 *d_points,
                     periodicBoundaries &Box
                     );
 
+//!The same as the above, also updating the periodic image counter of every degree of freedom
+bool gpu_move_degrees_of_freedom(double2 *d_points,
+                    double2 *d_disp,
+                    int2 *d_images,
+                    double  scale,
+                    int N,
+                    periodicBoundaries &Box
+                    );
+
 //!A utility function; set all copmonents of an integer array to value
 bool gpu_set_integer_array(int *d_array,
                            int value,
@@ -74,6 +74,8 @@ class Simple2DCell : public Simple2DModel
 
         //!Set random cell positions, and set the periodic box to a square with average cell area=1
         void setCellPositionsRandomly();
+        //!Seed the reproducible random number generator used for random positions, areas and velocities
+        void setRandomSeed(int seed){noise.setReproducibleSeed(seed);};
 
         //!allow for cell division, according to a vector of model-dependent parameters
         virtual void cellDivision(const vector<int> &parameters,const vector<double> &dParams={});
@@ -85,6 +87,10 @@ class Simple2DCell : public Simple2DModel
         void setCellPositions(vector<double2> newCellPositions);
         //!Set vertex positions according to a user-specified vector
         void setVertexPositions(vector<double2> newVertexPositions);
+        //!Zero the periodic image counters of the cells and vertices (i.e., treat the current positions as unwrapped)
+        void resetImages();
+        //!Fill the array with the unwrapped positions of the degrees of freedom (in current index order)
+        void getUnwrappedPositions(GPUArray<double2> &unwrappedPositions);
         //!Set velocities via a temperature. The return value is the total kinetic energy
         double setCellVelocitiesMaxwellBoltzmann(double T);
         //!Set velocities via a temperature for the vertex degrees of freedom
@@ -92,6 +98,10 @@ class Simple2DCell : public Simple2DModel
 
         //! set uniform moduli for all cells
         void setModuliUniform(double newKA, double newKP);
+        //!Set per-cell (K_A,K_P) moduli according to the input vector
+        void setModuli(vector<double2> &newModuli);
+        //!Are all cells using the same (KA,KP)?
+        bool getModuliUniform(){return uniformModuli;};
 
         //!Set all cells to the same "type"
         void setCellTypeUniform(int i);
@@ -122,16 +132,25 @@ class Simple2DCell : public Simple2DModel
         virtual GPUArray<double2> & returnVelocities(){return cellVelocities;};
         //!Return a reference to Positions on cells
         virtual GPUArray<double2> & returnPositions(){return cellPositions;};
+        //!Return a reference to the periodic image counters of the cells
+        virtual GPUArray<int2> & returnImages(){return cellImages;};
         //!Return a reference to forces on cells
         virtual GPUArray<double2> & returnForces(){return cellForces;};
         //!Return a reference to Masses on cells
         virtual GPUArray<double> & returnMasses(){return cellMasses;};
+        //!Return a reference to the vertices of every cell (indexed by n_idx)
+        GPUArray<int> & returnCellVertices(){return cellVertices;};
 
         //!Return other data just returns the masses; in this class it's not needed
         virtual GPUArray<double> & returnOtherData(){return cellMasses;};
         //!Set the simulation time stepsize
         void setDeltaT(double dt){deltaT = dt;};
 
+        //!Add the box, the per-cell and per-vertex arrays, the index maps, and the noise state to a checkpoint
+        virtual void writeCheckpoint(checkpointWriter &out);
+        //!Restore a state written by writeCheckpoint into a model with the same number of cells and vertices
+        virtual void readCheckpoint(checkpointReader &in);
+
     //protected functions
     protected:
         //!set the size of the cell-sorting structures, initialize lists simply
@@ -144,12 +163,16 @@ class Simple2DCell : public Simple2DModel
         void reIndexCellArray(GPUArray<double> &array);
         //!why use templates when you can type more?
         void reIndexCellArray(GPUArray<double2> &array);
+        //!why use templates when you can type more?
+        void reIndexCellArray(GPUArray<int2> &array);
         //!Re-index vertex after a spatial sorting has occured.
         void reIndexVertexArray(GPUArray<int> &array);
         //!why use templates when you can type more?
         void reIndexVertexArray(GPUArray<double> &array);
         //!why use templates when you can type more?
         void reIndexVertexArray(GPUArray<double2> &array);
+        //!why use templates when you can type more?
+        void reIndexVertexArray(GPUArray<int2> &array);
         //!Perform a spatial sorting of the cells to try to maintain data locality
         void spatiallySortCells();
         //!Perform a spatial sorting of the vertices to try to maintain data locality
@@ -167,6 +190,14 @@ class Simple2DCell : public Simple2DModel
         GPUArray<double2> cellPositions;
         //! Position of the vertices
         GPUArray<double2> vertexPositions;
+        //!The number of times each cell has crossed the periodic boundaries; the unwrapped position is cellPositions + Box*cellImages
+        /*!
+        Maintained by models in which the cells are the degrees of freedom (so that cell positions are
+        actually moved, rather than recomputed from other degrees of freedom)
+        */
+        GPUArray<int2> cellImages;
+        //!The number of times each vertex has crossed the periodic boundaries (maintained by vertex models)
+        GPUArray<int2> vertexImages;
         //!The velocity vector of cells (only relevant if the equations of motion use it)
         GPUArray<double2> cellVelocities;
         //!The masses of the cells
@@ -279,8 +310,10 @@ class Simple2DCell : public Simple2DModel
         double KA;
         //!The perimeter modulus
         double KP;
-        //!The area and perimeter moduli of each cell. CURRENTLY NOT SUPPORTED, BUT EASY TO IMPLEMENT
+        //!The area and perimeter moduli of each cell; only read by the force kernels when uniformModuli is false
         GPUArray<double2> Moduli;//(KA,KP)
+        //!If true, every cell has moduli (KA,KP) and the force kernels skip the per-cell lookup
+        bool uniformModuli;
 
         //!The current area and perimeter of each cell
         GPUArray<double2> AreaPeri;//(current A,P) for each cell
@@ -293,6 +326,8 @@ class Simple2DCell : public Simple2DModel
         the index of the kth vertex of cell c (where the ordering is counter-clockwise starting
         with a random vertex) is given by
         cellVertices[n_idx(k,c)];
+        Unlike the per-neighbor Voronoi arrays, which use offsets (see voronoiModelBase::neighborOffsets),
+        every row is padded to vertexMax: T1 transitions change the vertex counts of four cells in place.
         */
         GPUArray<int> cellVertices;
         //!An upper bound for the maximum number of neighbors that any cell has
@@ -301,7 +336,8 @@ class Simple2DCell : public Simple2DModel
         /*!
         For both vertex and Voronoi models, it may help to save the relative position of the vertices around a
         cell, either for easy force computation or in the geometry routine, etc.
-        voroCur.data[n_idx(nn,i)] gives the nth vertex, in CCW order, of cell i
+        In vertex models voroCur.data[n_idx(nn,i)] gives the nth vertex, in CCW order, of cell i; Voronoi
+        models store the same information compactly, at voroCur.data[neighborOffsets.data[i]+nn]
         */
         GPUArray<double2> voroCur;
         //!3*Nvertices length array of the position of the last and next vertices along the cell
@@ -3,6 +3,9 @@
 
 #include "std_include.h"
 #include "gpuarray.h"
+#include "regionProfiler.h"
+#include "runtimeMetrics.h"
+#include "checkpointFile.h"
 
 /*! \file Simple2DModel.h
  * \brief defines an interface for models that compute forces
@@ -46,6 +49,8 @@ class Simple2DModel
         virtual double getMaxForce(){return 0.;};
         //!return a reference to the GPUArray of positions
         virtual GPUArray<double2> & returnPositions() = 0;
+        //!return a reference to the GPUArray of periodic image counters of the positions
+        virtual GPUArray<int2> & returnImages() = 0;
         //!return a reference to the GPUArray of the masses
         virtual GPUArray<double> & returnMasses() = 0;
         //!return a reference to the GPUArray of other data (definable as needed in child classes)
@@ -65,9 +70,22 @@ class Simple2DModel
         //!set the time
         virtual void setTime(double time){currentTime = time;};
 
+        //!The number of views of this model's arrays held open on the host (e.g., NumPy views from the python module)
+        int openHostViews = 0;
+
         //!Allow openMP threads
         int ompThreadNum = 1;
         //set number of threads
         virtual void setOmpThreads(int _number){ompThreadNum = _number;};
+
+        //!Report topology and triangulation events to a metrics registry (a null pointer stops reporting)
+        virtual void setMetrics(shared_ptr<runtimeMetrics> _metrics){metrics = _metrics;};
+        //!The registry being reported to, if any
+        shared_ptr<runtimeMetrics> metrics;
+
+        //!Add everything needed to continue the simulation of this model exactly to a checkpoint
+        virtual void writeCheckpoint(checkpointWriter &){};
+        //!Restore a state written by writeCheckpoint
+        virtual void readCheckpoint(checkpointReader &){};
     };
 #endif
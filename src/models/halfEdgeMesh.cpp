@@ -0,0 +1,198 @@
+#include "halfEdgeMesh.h"
+/*! \file halfEdgeMesh.cpp */
+
+/*!
+The half-edges of cell c are the slots of vertexNeighbors that connect consecutive vertices of its
+row of cellVertices; each is given its cell, its destination, its twin, and its neighbors along the
+boundary of the cell
+*/
+void halfEdgeMesh::linkCell(int c, const int *vertexNeighbors, const int *cellVertexNum, const int *cellVertices, Index2D n_idx)
+    {
+    int neighs = cellVertexNum[c];
+    int first = -1;
+    int last = -1;
+    for (int nn = 0; nn < neighs; ++nn)
+        {
+        int v = cellVertices[n_idx(nn,c)];
+        int w = cellVertices[n_idx((nn+1)%neighs,c)];
+        int h = -1;
+        int t = -1;
+        for (int k = 0; k < 3; ++k)
+            {
+            if(vertexNeighbors[3*v+k] == w)
+                h = 3*v+k;
+            if(vertexNeighbors[3*w+k] == v)
+                t = 3*w+k;
+            };
+        if(h < 0 || t < 0)
+            {
+            printf("halfEdgeMesh: vertices %i and %i are consecutive in cell %i but are not connected\n",v,w,c);
+            throw std::exception();
+            };
+        edges[h].vertex = w;
+        edges[h].twin = t;
+        edges[h].cell = c;
+        if(last >= 0)
+            {
+            edges[last].next = h;
+            edges[h].prev = last;
+            }
+        else
+            first = h;
+        last = h;
+        };
+    edges[last].next = first;
+    edges[first].prev = last;
+    cellEdges[c] = first;
+    };
+
+void halfEdgeMesh::build(int Nvertices, int Ncells, const int *vertexNeighbors, const int *cellVertexNum,
+                         const int *cellVertices, Index2D n_idx)
+    {
+    halfEdge unset = {-1,-1,-1,-1,-1};
+    edges.assign(3*Nvertices,unset);
+    cellEdges.assign(Ncells,-1);
+    for (int c = 0; c < Ncells; ++c)
+        linkCell(c,vertexNeighbors,cellVertexNum,cellVertices,n_idx);
+    };
+
+/*!
+Half-edges keep their handles when the flat arrays are rewired, so after a local change (e.g. a cell
+division, which appends vertices and a cell) only the half-edges around the changed cells need to be
+re-derived. Every half-edge whose destination, cell or neighbors changed must bound one of the cells.
+*/
+void halfEdgeMesh::updateCells(const vector<int> &cells, int Nvertices, int Ncells, const int *vertexNeighbors,
+                               const int *cellVertexNum, const int *cellVertices, Index2D n_idx)
+    {
+    halfEdge unset = {-1,-1,-1,-1,-1};
+    edges.resize(3*Nvertices,unset);
+    cellEdges.resize(Ncells,-1);
+    for (size_t ii = 0; ii < cells.size(); ++ii)
+        linkCell(cells[ii],vertexNeighbors,cellVertexNum,cellVertices,n_idx);
+    };
+
+/*!
+With h running from vertex 1 to vertex 2, the convention of vertexModelBase's T1 routines is that
+before the flip cell k (to the left of h) has CCW vertices ..., b, v1, v2, d, ..., cell i (to the left
+of the twin) has ..., c, v2, v1, a, ..., and cells j and l contain only v1 and only v2. Afterwards
+the edge separates cells j and l: j has ..., a, v1, v2, b, ... and l has ..., d, v2, v1, c, .... Only
+the ten half-edges around the two vertices change, and h and its twin keep their handles.
+*/
+void halfEdgeMesh::flipEdge(int h)
+    {
+    int t = edges[h].twin;
+    int v1 = origin(h);
+    int v2 = origin(t);
+    int cellI = edges[t].cell;
+    int cellK = edges[h].cell;
+    //the half-edges v1->a and c->v2 of cell i, and v2->d and b->v1 of cell k
+    int v1a = edges[t].next;
+    int cv2 = edges[t].prev;
+    int v2d = edges[h].next;
+    int bv1 = edges[h].prev;
+    //the half-edges v1->b and v2->c, which bound cells j and l
+    int v1b = edges[bv1].twin;
+    int v2c = edges[cv2].twin;
+    int cellJ = edges[v1b].cell;
+    int cellL = edges[v2c].cell;
+    int b = edges[v1b].vertex;
+    int c = edges[v2c].vertex;
+    int av1 = edges[v1b].prev;
+    int dv2 = edges[v2c].prev;
+    //the half-edges b->x and c->y that follow v1->b and v2->c around cells j and l
+    int afterB = edges[v1b].next;
+    int afterC = edges[v2c].next;
+
+    //cell i: c -> v1 -> a
+    edges[cv2].vertex = v1;
+    edges[cv2].next = v1a;
+    edges[v1a].prev = cv2;
+    //cell k: b -> v2 -> d
+    edges[bv1].vertex = v2;
+    edges[bv1].next = v2d;
+    edges[v2d].prev = bv1;
+    //cell j: a -> v1 -> v2 -> b, where the slot of v2 that led to c now leads to b
+    edges[av1].next = h;
+    edges[h].prev = av1;
+    edges[h].next = v2c;
+    edges[h].cell = cellJ;
+    edges[v2c].vertex = b;
+    edges[v2c].twin = bv1;
+    edges[bv1].twin = v2c;
+    edges[v2c].prev = h;
+    edges[v2c].next = afterB;
+    edges[afterB].prev = v2c;
+    edges[v2c].cell = cellJ;
+    //cell l: d -> v2 -> v1 -> c, where the slot of v1 that led to b now leads to c
+    edges[dv2].next = t;
+    edges[t].prev = dv2;
+    edges[t].next = v1b;
+    edges[t].cell = cellL;
+    edges[v1b].vertex = c;
+    edges[v1b].twin = cv2;
+    edges[cv2].twin = v1b;
+    edges[v1b].prev = t;
+    edges[v1b].next = afterC;
+    edges[afterC].prev = v1b;
+    edges[v1b].cell = cellL;
+    //cells i and k lost an edge, and the slots that bounded j and l swapped cells
+    if(cellEdges[cellI] == t)
+        cellEdges[cellI] = v1a;
+    if(cellEdges[cellK] == h)
+        cellEdges[cellK] = v2d;
+    if(cellEdges[cellJ] == v1b)
+        cellEdges[cellJ] = h;
+    if(cellEdges[cellL] == v2c)
+        cellEdges[cellL] = t;
+    };
+
+/*!
+\param vertices must have room for the vertices of the cell
+\return the number of vertices of cell c
+*/
+int halfEdgeMesh::cellVertexLoop(int c, int v, int *vertices) const
+    {
+    int start = cellHalfEdgeFrom(c,v);
+    if(start < 0)
+        start = cellEdges[c];
+    int h = start;
+    int n = 0;
+    do
+        {
+        vertices[n] = origin(h);
+        n += 1;
+        h = edges[h].next;
+        } while (h != start);
+    return n;
+    };
+
+bool halfEdgeMesh::checkConsistency(int Nvertices, int Ncells, const int *vertexNeighbors, const int *cellVertexNum,
+                                    const int *cellVertices, Index2D n_idx) const
+    {
+    halfEdgeMesh reference;
+    reference.build(Nvertices,Ncells,vertexNeighbors,cellVertexNum,cellVertices,n_idx);
+    if(edges.size() != reference.edges.size() || cellEdges.size() != reference.cellEdges.size())
+        {
+        printf("halfEdgeMesh: sized for %lu half-edges and %lu cells instead of %lu and %lu\n",
+                edges.size(),cellEdges.size(),reference.edges.size(),reference.cellEdges.size());
+        return false;
+        };
+    for (int h = 0; h < (int)edges.size(); ++h)
+        {
+        const halfEdge &e = edges[h];
+        const halfEdge &r = reference.edges[h];
+        if(e.vertex != r.vertex || e.twin != r.twin || e.next != r.next || e.prev != r.prev || e.cell != r.cell)
+            {
+            printf("halfEdgeMesh: half-edge %i is (%i,%i,%i,%i,%i) but should be (%i,%i,%i,%i,%i)\n",h,
+                    e.vertex,e.twin,e.next,e.prev,e.cell,r.vertex,r.twin,r.next,r.prev,r.cell);
+            return false;
+            };
+        };
+    for (int c = 0; c < (int)cellEdges.size(); ++c)
+        if(cellEdges[c] < 0 || edges[cellEdges[c]].cell != c)
+            {
+            printf("halfEdgeMesh: cell %i points to half-edge %i, which is not on its boundary\n",c,cellEdges[c]);
+            return false;
+            };
+    return true;
+    };
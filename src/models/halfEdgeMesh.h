@@ -0,0 +1,93 @@
+#ifndef HALFEDGEMESH_H
+#define HALFEDGEMESH_H
+
+#include "std_include.h"
+#include "indexer.h"
+
+/*! \file halfEdgeMesh.h */
+//!One directed edge of a halfEdgeMesh
+struct halfEdge
+    {
+    //!The vertex the half-edge points to (it leaves vertex h/3)
+    int vertex;
+    //!The half-edge running the other way along the same edge
+    int twin;
+    //!The next half-edge, counter-clockwise, around the same cell
+    int next;
+    //!The previous half-edge around the same cell
+    int prev;
+    //!The cell to the left of the half-edge
+    int cell;
+    };
+
+//!A half-edge (doubly connected edge list) representation of the topology of a three-valent vertex model
+/*!
+The handles are the slots of the flat vertexNeighbors array: half-edge h = 3*v+k leaves vertex v and
+points to vertexNeighbors[3*v+k]. The three half-edges leaving a vertex are therefore stored next to
+each other (and, once the vertices are Hilbert sorted, near those of the neighboring vertices), and a
+half-edge keeps its handle when an edge is rewired, so the mesh can be updated in place by the same
+local operations that change the flat arrays. Each half-edge has the cell to its left, i.e. the cell
+in whose counter-clockwise vertex list its vertices are consecutive.
+
+The mesh is a host-side companion of vertexNeighbors, cellVertexNum and cellVertices, which remain
+the data consumed by the force and geometry kernels: edge flips (T1 transitions) are O(1) here, and the
+vertices of a cell can be found by walking its boundary instead of scanning its row of cellVertices.
+*/
+class halfEdgeMesh
+    {
+    public:
+        //!Build the mesh from the flat topology arrays
+        void build(int Nvertices, int Ncells, const int *vertexNeighbors, const int *cellVertexNum,
+                   const int *cellVertices, Index2D n_idx);
+        //!Resize for a new number of vertices and cells, then re-derive the half-edges around the given cells from the flat arrays
+        void updateCells(const vector<int> &cells, int Nvertices, int Ncells, const int *vertexNeighbors,
+                         const int *cellVertexNum, const int *cellVertices, Index2D n_idx);
+        //!Rewire the edge of half-edge h as in a T1 transition (O(1); see the implementation for the convention)
+        void flipEdge(int h);
+
+        //!The vertex a half-edge leaves
+        int origin(int h) const {return h/3;};
+        //!The vertex a half-edge points to
+        int destination(int h) const {return edges[h].vertex;};
+        int twin(int h) const {return edges[h].twin;};
+        int next(int h) const {return edges[h].next;};
+        int prev(int h) const {return edges[h].prev;};
+        //!The cell to the left of a half-edge
+        int cell(int h) const {return edges[h].cell;};
+        //!A half-edge on the boundary of cell c
+        int cellHalfEdge(int c) const {return cellEdges[c];};
+        //!The half-edge from vertex v to vertex w, or -1 if they are not connected
+        int halfEdgeBetween(int v, int w) const
+            {
+            for (int k = 3*v; k < 3*v+3; ++k)
+                if(edges[k].vertex == w)
+                    return k;
+            return -1;
+            };
+        //!The half-edge of cell c that leaves vertex v, or -1 if v is not a vertex of c
+        int cellHalfEdgeFrom(int c, int v) const
+            {
+            for (int k = 3*v; k < 3*v+3; ++k)
+                if(edges[k].cell == c)
+                    return k;
+            return -1;
+            };
+        //!Write the vertices of cell c, counter-clockwise and starting at vertex v, to vertices; returns their number
+        int cellVertexLoop(int c, int v, int *vertices) const;
+
+        //!The number of half-edges (three per vertex)
+        int getNumberOfHalfEdges() const {return edges.size();};
+        //!Compare the mesh to one freshly built from the flat arrays, printing the first difference
+        bool checkConsistency(int Nvertices, int Ncells, const int *vertexNeighbors, const int *cellVertexNum,
+                              const int *cellVertices, Index2D n_idx) const;
+
+    protected:
+        //!Set the half-edges around one cell from its row of cellVertices
+        void linkCell(int c, const int *vertexNeighbors, const int *cellVertexNum, const int *cellVertices, Index2D n_idx);
+
+        //!All of the half-edges, indexed by handle
+        vector<halfEdge> edges;
+        //!One half-edge on the boundary of each cell
+        vector<int> cellEdges;
+    };
+#endif
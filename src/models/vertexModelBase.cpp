@@ -1,6 +1,7 @@
 #include "vertexModelBase.h"
 #include "vertexModelBase.cuh"
 #include "voronoiQuadraticEnergy.h"
+#include "DelaunayCPU.h"
 /*! \file vertexModelBase.cpp */
 
 /*!
@@ -8,39 +9,22 @@ move vertices according to an inpute GPUarray
 */
 void vertexModelBase::moveDegreesOfFreedom(GPUArray<double2> &displacements,double scale)
     {
+    PROFILE_SCOPE("vertexModelBase::moveDegreesOfFreedom");
     forcesUpToDate = false;
     //handle things either on the GPU or CPU
     if (GPUcompute)
         {
         ArrayHandle<double2> d_d(displacements,access_location::device,access_mode::read);
         ArrayHandle<double2> d_v(vertexPositions,access_location::device,access_mode::readwrite);
-        if (scale == 1.)
-            gpu_move_degrees_of_freedom(d_v.data,d_d.data,Nvertices,*(Box));
-        else
-            gpu_move_degrees_of_freedom(d_v.data,d_d.data,scale,Nvertices,*(Box));
+        ArrayHandle<int2> d_i(vertexImages,access_location::device,access_mode::readwrite);
+        gpu_move_degrees_of_freedom(d_v.data,d_d.data,d_i.data,scale,Nvertices,*(Box));
         }
     else
         {
         ArrayHandle<double2> h_disp(displacements,access_location::host,access_mode::read);
         ArrayHandle<double2> h_v(vertexPositions,access_location::host,access_mode::readwrite);
-        if(scale ==1.)
-            {
-            for (int i = 0; i < Nvertices; ++i)
-                {
-                h_v.data[i].x += h_disp.data[i].x;
-                h_v.data[i].y += h_disp.data[i].y;
-                Box->putInBoxReal(h_v.data[i]);
-                };
-            }
-        else
-            {
-            for (int i = 0; i < Nvertices; ++i)
-                {
-                h_v.data[i].x += scale*h_disp.data[i].x;
-                h_v.data[i].y += scale*h_disp.data[i].y;
-                Box->putInBoxReal(h_v.data[i]);
-                };
-            }
+        ArrayHandle<int2> h_i(vertexImages,access_location::host,access_mode::readwrite);
+        Box->move(h_v.data,h_disp.data,h_i.data,Nvertices,scale);
         };
     };
 
@@ -60,6 +44,21 @@ void vertexModelBase::setRectangularUnitCell(double Lx, double Ly)
     enforceTopology();
     }
 
+/*!
+The per-cell contributions to the vertex forces are needed by the GPU force kernels, and on the CPU only
+when they were asked for with setStoreForceSets, so otherwise the array is left empty
+*/
+void vertexModelBase::resizeVertexForceSets()
+    {
+    if(GPUcompute || storeForceSets)
+        vertexForceSets.resize(3*Nvertices);
+    else if(vertexForceSets.getNumElements() > 0)
+        {
+        vertexForceSets.resize(0);
+        vertexForceSets.shrink_to_fit();
+        };
+    };
+
 /*!
 Take care of all base class initialization functions, this involves setting arrays to the right size, etc.
 */
@@ -81,6 +80,7 @@ void vertexModelBase::initializeVertexModelBase(int n,bool spvInitialize, bool u
     initializeSimple2DActiveCell(Ncells,GPUcompute);
     //derive the vertices from a voronoi tesselation
     setCellsVoronoiTesselation(spvInitialize);
+    resetImages();
 
     setT1Threshold(0.01);
     //initializes per-cell lists
@@ -102,7 +102,7 @@ void vertexModelBase::initializeVertexModelBase(int n,bool spvInitialize, bool u
     initializeEdgeFlipLists();
 
     //initialize per-triple-vertex lists
-    vertexForceSets.resize(3*Nvertices);
+    resizeVertexForceSets();
     voroCur.resize(3*Nvertices);
     voroLastNext.resize(3*Nvertices);
     cellSets.resize(3*Nvertices);
@@ -117,6 +117,7 @@ enforce and update topology of vertex wiring on either the GPU or CPU
 */
 void vertexModelBase::enforceTopology()
     {
+    PROFILE_SCOPE("vertexModelBase::enforceTopology");
     if(GPUcompute)
         {
         //see if vertex motion leads to T1 transitions...ONLY allow one transition per vertex and
@@ -128,6 +129,26 @@ void vertexModelBase::enforceTopology()
         //see if vertex motion leads to T1 transitions
         testAndPerformT1TransitionsCPU();
         };
+    if(metrics)
+        metrics->setGauge(vertexMaxMetric,vertexMax);
+    };
+
+/*!
+Registers vertex/T1Transitions (a counter, and a histogram of the number per call of enforceTopology),
+vertex/cellVertexListGrowth (the number of times vertexMax grew) and the gauge vertex/vertexMax. On the
+GPU the transitions are counted from vertexEdgeFlips, which costs a copy to the host per call when
+metrics are reported.
+*/
+void vertexModelBase::setMetrics(shared_ptr<runtimeMetrics> _metrics)
+    {
+    Simple2DModel::setMetrics(_metrics);
+    if(!metrics)
+        return;
+    T1Metric = metrics->registerCounter("vertex/T1Transitions");
+    T1Histogram = metrics->registerHistogram("vertex/T1TransitionsPerCall",runtimeMetrics::powerOfTwoEdges(max(Ncells,1)));
+    vertexListGrowthMetric = metrics->registerCounter("vertex/cellVertexListGrowth");
+    vertexMaxMetric = metrics->registerGauge("vertex/vertexMax");
+    metrics->setGauge(vertexMaxMetric,vertexMax);
     };
 
 /*!
@@ -139,10 +160,10 @@ timesteps to smooth out the random point set first.
 */
 void vertexModelBase::setCellsVoronoiTesselation(bool spvInitialize)
     {
-    ArrayHandle<double2> h_p(cellPositions,access_location::host,access_mode::readwrite);
     //use the Voronoi class to relax the initial configuration just a bit?
     if(spvInitialize)
         {
+        ArrayHandle<double2> h_p(cellPositions,access_location::host,access_mode::readwrite);
         EOMPtr spp = make_shared<selfPropelledParticleDynamics>(Ncells);
 
         ForcePtr spv = make_shared<VoronoiQuadraticEnergy>(Ncells,1.0,3.8,Reproducible);
@@ -164,50 +185,35 @@ void vertexModelBase::setCellsVoronoiTesselation(bool spvInitialize)
             h_p.data[ii] = h_pp.data[ii];
         };
 
-    //call CGAL to get Delaunay triangulation
-    vector<pair<Point,int> > Psnew(Ncells);
-    for (int ii = 0; ii < Ncells; ++ii)
+    //get the Delaunay triangulation of the cell positions
+    DelaunayCPU delaunay(Box);
+    delaunay.setOmpThreads(ompThreadNum);
+    if(!delaunay.periodicTriangulation(cellPositions))
         {
-        Psnew[ii]=make_pair(Point(h_p.data[ii].x,h_p.data[ii].y),ii);
+        printf("could not construct a consistent Delaunay triangulation of the initial cell positions\n");
+        throw std::exception();
         };
-    double b11,b12,b21,b22;
-    Box->getBoxDims(b11,b12,b21,b22);
-    Iso_rectangle domain(0.0,0.0,b11,b22);
-    PDT T(Psnew.begin(),Psnew.end(),domain);
-    T.convert_to_1_sheeted_covering();
+    vector<int3> &triangles = delaunay.triangles;
+    vector<int> &cellNeighborNum = delaunay.neighborNumber;
+    vector<int> &cellNeighbors = delaunay.neighborList;
+    Index2D &cellNeighborIdx = delaunay.neighborIndexer;
+    ArrayHandle<double2> h_p(cellPositions,access_location::host,access_mode::read);
 
     //set number of vertices
     Nvertices = 2*Ncells;
     vertexPositions.resize(Nvertices);
     ArrayHandle<double2> h_v(vertexPositions,access_location::host,access_mode::overwrite);
 
-    //first, ask CGAL for the circumcenter of the face, and add it to the list of vertices, and make a map between the iterator and the vertex idx
-    map<PDT::Face_handle,int> faceToVoroIdx;
-    int idx = 0;
-    for(PDT::Face_iterator fit = T.faces_begin(); fit != T.faces_end(); ++fit)
+    //each Delaunay triangle is a vertex, placed at its circumcenter
+    for (int tt = 0; tt < Nvertices; ++tt)
         {
-        PDT::Point p(T.dual(fit));
-        h_v.data[idx].x = p.x();
-        h_v.data[idx].y = p.y();
-        faceToVoroIdx[fit] = idx;
-        idx +=1;
-        };
-    //create a list of what vertices are connected to what vertices,
-    //and what cells each vertex is part of
-    vertexNeighbors.resize(3*Nvertices);
-    vertexCellNeighbors.resize(3*Nvertices);
-    ArrayHandle<int> h_vn(vertexNeighbors,access_location::host,access_mode::overwrite);
-    ArrayHandle<int> h_vcn(vertexCellNeighbors,access_location::host,access_mode::overwrite);
-    for(PDT::Face_iterator fit = T.faces_begin(); fit != T.faces_end(); ++fit)
-        {
-        int vidx = faceToVoroIdx[fit];
-        for(int ff =0; ff<3; ++ff)
-            {
-            PDT::Face_handle neighFace = fit->neighbor(ff);
-            int vnidx = faceToVoroIdx[neighFace];
-            h_vn.data[3*vidx+ff] = vnidx;
-            h_vcn.data[3*vidx+ff] = fit->vertex(ff)->info();
-            };
+        double2 pa = h_p.data[triangles[tt].x];
+        double2 rb, rc, center;
+        Box->minDist(h_p.data[triangles[tt].y],pa,rb);
+        Box->minDist(h_p.data[triangles[tt].z],pa,rc);
+        Circumcenter(rb,rc,center);
+        h_v.data[tt] = pa + center;
+        Box->putInBoxReal(h_v.data[tt]);
         };
 
     //now create a list of what vertices are associated with each cell
@@ -216,20 +222,11 @@ void vertexModelBase::setCellsVoronoiTesselation(bool spvInitialize)
     ArrayHandle<int> h_cvn(cellVertexNum,access_location::host,access_mode::overwrite);
     vertexMax = 0;
     int nnum = 0;
-    for(PDT::Vertex_iterator vit = T.vertices_begin(); vit != T.vertices_end(); ++vit)
+    for (int cc = 0; cc < Ncells; ++cc)
         {
-        PDT::Vertex_circulator vc(vit);
-        int base = vc ->info();
-        int neighs = 1;
-        ++vc;
-        while(vc->info() != base)
-            {
-            neighs += 1;
-            ++vc;
-            };
-        h_cvn.data[vit->info()] = neighs;
-        if (neighs > vertexMax) vertexMax = neighs;
-        nnum += neighs;
+        h_cvn.data[cc] = cellNeighborNum[cc];
+        if (cellNeighborNum[cc] > vertexMax) vertexMax = cellNeighborNum[cc];
+        nnum += cellNeighborNum[cc];
         };
     vertexMax += 4;
     vertexMax = 30;
@@ -237,20 +234,43 @@ void vertexModelBase::setCellsVoronoiTesselation(bool spvInitialize)
     cellVertices.resize(vertexMax*Ncells);
     n_idx = Index2D(vertexMax,Ncells);
 
-    //now use face circulators and the map to get the vertices associated with each cell
+    //the triangle (a,b,c) is the vertex of cell a that follows, in CCW order, the Delaunay edge from a to b
     ArrayHandle<int> h_cv(cellVertices,access_location::host, access_mode::overwrite);
-    for(PDT::Vertex_iterator vit = T.vertices_begin(); vit != T.vertices_end(); ++vit)
+    for (int tt = 0; tt < Nvertices; ++tt)
         {
-        int cellIdx = vit->info();
-        PDT::Face_circulator fc(vit);
-        int fidx = 0;
-        for (int ff = 0; ff < h_cvn.data[vit->info()]; ++ff)
+        int corners[3] = {triangles[tt].x,triangles[tt].y,triangles[tt].z};
+        for (int ff = 0; ff < 3; ++ff)
             {
-            h_cv.data[n_idx(fidx,cellIdx)] = faceToVoroIdx[fc];
-            ++fidx;
-            ++fc;
+            int cell = corners[ff];
+            int next = corners[(ff+1)%3];
+            for (int nn = 0; nn < cellNeighborNum[cell]; ++nn)
+                if(cellNeighbors[cellNeighborIdx(nn,cell)] == next)
+                    h_cv.data[n_idx(nn,cell)] = tt;
             };
         };
+
+    //create a list of what vertices are connected to what vertices, and what cells each vertex is part
+    //of: vertexCellNeighbors[3*v+ff] is the ff-th corner of the triangle, and vertexNeighbors[3*v+ff]
+    //is the triangle across the edge opposite that corner
+    vertexNeighbors.resize(3*Nvertices);
+    vertexCellNeighbors.resize(3*Nvertices);
+    ArrayHandle<int> h_vn(vertexNeighbors,access_location::host,access_mode::overwrite);
+    ArrayHandle<int> h_vcn(vertexCellNeighbors,access_location::host,access_mode::overwrite);
+    for (int tt = 0; tt < Nvertices; ++tt)
+        {
+        int corners[3] = {triangles[tt].x,triangles[tt].y,triangles[tt].z};
+        for (int ff = 0; ff < 3; ++ff)
+            {
+            h_vcn.data[3*tt+ff] = corners[ff];
+            //the triangle across the edge (b,c) is the one following the edge from c to b
+            int cell = corners[(ff+2)%3];
+            int other = corners[(ff+1)%3];
+            for (int nn = 0; nn < cellNeighborNum[cell]; ++nn)
+                if(cellNeighbors[cellNeighborIdx(nn,cell)] == other)
+                    h_vn.data[3*tt+ff] = h_cv.data[n_idx(nn,cell)];
+            };
+        };
+    halfEdgesCurrent = false;
    };
 
 /*!
@@ -260,18 +280,36 @@ void vertexModelBase::setCellsVoronoiTesselation(bool spvInitialize)
  */
 void vertexModelBase::spatialSorting()
     {
+    PROFILE_SCOPE("vertexModelBase::spatialSorting");
     //the base vertex model class doesn't need to change any other unusual data structures at the moment
     spatiallySortVerticesAndCellActivity();
     reIndexVertexArray(vertexMasses);
     reIndexVertexArray(vertexVelocities);
+    halfEdgesCurrent = false;
     };
 
 /*!
 Very similar to the function in Voronoi2d.cpp, but optimized since we already have some data structures
-(the vertices)...compute the area and perimeter of the cells
+(the vertices)...compute the area and perimeter of the cells. Cells are independent (each (vertex,cell)
+pair owns one entry of voroCur and voroLastNext), so the loop is split over ompThreadNum threads.
 */
 void vertexModelBase::computeGeometryCPU()
     {
+    if(Box->isBoxSquare())
+        computeGeometryCPUSpecialized<true,false>();
+    else
+        computeGeometryCPUSpecialized<false,false>();
+    };
+
+/*!
+The CPU geometry loop, with the shape of the box fixed at compile time. If centroids is true the same
+walk over the vertices of each cell also accumulates its centroid, which is stored in cellPositions;
+otherwise cellPositions is not touched.
+*/
+template<bool rectangular, bool centroids>
+void vertexModelBase::computeGeometryCPUSpecialized()
+    {
+    periodicBoundaries box = *(Box);
     ArrayHandle<double2> h_v(vertexPositions,access_location::host,access_mode::read);
     ArrayHandle<int> h_nn(cellVertexNum,access_location::host,access_mode::read);
     ArrayHandle<int> h_n(cellVertices,access_location::host,access_mode::read);
@@ -279,8 +317,12 @@ void vertexModelBase::computeGeometryCPU()
     ArrayHandle<double2> h_vc(voroCur,access_location::host,access_mode::readwrite);
     ArrayHandle<double4> h_vln(voroLastNext,access_location::host,access_mode::readwrite);
     ArrayHandle<double2> h_AP(AreaPeri,access_location::host,access_mode::readwrite);
+    unique_ptr<ArrayHandle<double2> > h_p;
+    if(centroids)
+        h_p.reset(new ArrayHandle<double2>(cellPositions,access_location::host,access_mode::overwrite));
 
     //compute the geometry for each cell
+    #pragma omp parallel for num_threads(ompThreadNum)
     for (int i = 0; i < Ncells; ++i)
         {
         int neighs = h_nn.data[i];
@@ -289,10 +331,11 @@ void vertexModelBase::computeGeometryCPU()
         double2 vlast, vcur,vnext;
         double Varea = 0.0;
         double Vperi = 0.0;
+        double2 centroid = make_double2(0.0,0.0);
         //compute the vertex position relative to the cell position
         vlast.x=0.;vlast.y=0.0;
         int vidx = h_n.data[n_idx(neighs-1,i)];
-        Box->minDist(h_v.data[vidx],cellPos,vcur);
+        box.minDist<rectangular>(h_v.data[vidx],cellPos,vcur);
         for (int nn = 0; nn < neighs; ++nn)
             {
             //for easy force calculation, save the current, last, and next vertex position in the approprate spot.
@@ -301,7 +344,7 @@ void vertexModelBase::computeGeometryCPU()
                 if(h_vcn.data[3*vidx+ff]==i)
                     forceSetIdx = 3*vidx+ff;
             vidx = h_n.data[n_idx(nn,i)];
-            Box->minDist(h_v.data[vidx],cellPos,vnext);
+            box.minDist<rectangular>(h_v.data[vidx],cellPos,vnext);
 
             //contribution to cell's area is
             // 0.5* (vcur.x+vnext.x)*(vnext.y-vcur.y)
@@ -309,6 +352,13 @@ void vertexModelBase::computeGeometryCPU()
             double dx = vcur.x-vnext.x;
             double dy = vcur.y-vnext.y;
             Vperi += sqrt(dx*dx+dy*dy);
+            //and to the (unnormalized) centroid
+            if(centroids)
+                {
+                double cross = vcur.x*vnext.y - vnext.x*vcur.y;
+                centroid.x += (vcur.x+vnext.x)*cross;
+                centroid.y += (vcur.y+vnext.y)*cross;
+                };
             //save vertex positions in a convenient form
             h_vc.data[forceSetIdx] = vcur;
             h_vln.data[forceSetIdx] = make_double4(vlast.x,vlast.y,vnext.x,vnext.y);
@@ -318,6 +368,13 @@ void vertexModelBase::computeGeometryCPU()
             };
         h_AP.data[i].x = Varea;
         h_AP.data[i].y = Vperi;
+        if(centroids)
+            {
+            centroid.x = centroid.x / (6.0*Varea) + cellPos.x;
+            centroid.y = centroid.y / (6.0*Varea) + cellPos.y;
+            box.putInBoxReal(centroid);
+            h_p->data[i] = centroid;
+            };
         };
     };
 
@@ -377,44 +434,16 @@ void vertexModelBase::getCellCentroidsGPU()
     };
 
 /*!
-CPU computation of the centroid of every cell
+CPU computation of the centroid of every cell. The centroids are accumulated by the CPU geometry loop,
+so this redoes the whole geometry pass of vertexModelBase::computeGeometryCPU (the areas, perimeters,
+voroCur and voroLastNext are recomputed from the current vertex positions) and also fills cellPositions.
 */
 void vertexModelBase::getCellCentroidsCPU()
     {
-    ArrayHandle<double2> h_p(cellPositions,access_location::host,access_mode::readwrite);
-    ArrayHandle<double2> h_v(vertexPositions,access_location::host,access_mode::read);
-    ArrayHandle<int> h_nn(cellVertexNum,access_location::host,access_mode::read);
-    ArrayHandle<int> h_n(cellVertices,access_location::host,access_mode::read);
-
-    double2 zero = make_double2(0.0,0.0);
-    double2 baseVertex;
-    for (int cell = 0; cell < Ncells; ++cell)
-        {
-        //for convenience, for each cell we will make a vector of the vertices of the cell relative to vertex 0
-        //the vector will be of length (vertices+1), and the first and last entry will be zero.
-        baseVertex = h_v.data[h_n.data[n_idx(0,cell)]];
-        int neighs = h_nn.data[cell];
-        vector<double2> vertices(neighs+1,zero);
-        for (int vv = 1; vv < neighs; ++vv)
-            {
-            int vidx = h_n.data[n_idx(vv,cell)];
-            Box->minDist(h_v.data[vidx],baseVertex,vertices[vv]);
-            };
-        //compute the area and the sums for the centroids
-        double Area = 0.0;
-        double2 centroid = zero;
-        for (int vv = 0; vv < neighs; ++vv)
-            {
-            Area += (vertices[vv].x*vertices[vv+1].y - vertices[vv+1].x*vertices[vv].y);
-            centroid.x += (vertices[vv].x+vertices[vv+1].x) * (vertices[vv].x*vertices[vv+1].y - vertices[vv+1].x*vertices[vv].y);
-            centroid.y += (vertices[vv].y+vertices[vv+1].y) * (vertices[vv].x*vertices[vv+1].y - vertices[vv+1].x*vertices[vv].y);
-            };
-        Area = 0.5*Area;
-        centroid.x = centroid.x / (6.0*Area) + baseVertex.x;
-        centroid.y = centroid.y / (6.0*Area) + baseVertex.y;
-        Box->putInBoxReal(centroid);
-        h_p.data[cell] = centroid;
-        };
+    if(Box->isBoxSquare())
+        computeGeometryCPUSpecialized<true,true>();
+    else
+        computeGeometryCPUSpecialized<false,true>();
     };
 
 /*!
@@ -423,6 +452,7 @@ This function just calls the CPU or GPU routine, as determined by the GPUcompute
 */
 void vertexModelBase::getCellPositions()
     {
+    PROFILE_SCOPE("vertexModelBase::getCellPositions");
     if(GPUcompute)
         getCellPositionsGPU();
     else
@@ -435,22 +465,34 @@ This isn't really used much, anyway, so update this only when the functionality
 */
 void vertexModelBase::getCellPositionsCPU()
     {
+    if(Box->isBoxSquare())
+        getCellPositionsCPUSpecialized<true>();
+    else
+        getCellPositionsCPUSpecialized<false>();
+    };
+
+//!The mean vertex position of every cell, with the shape of the box fixed at compile time
+template<bool rectangular>
+void vertexModelBase::getCellPositionsCPUSpecialized()
+    {
+    periodicBoundaries box = *(Box);
     ArrayHandle<double2> h_p(cellPositions,access_location::host,access_mode::readwrite);
     ArrayHandle<double2> h_v(vertexPositions,access_location::host,access_mode::read);
     ArrayHandle<int> h_nn(cellVertexNum,access_location::host,access_mode::read);
     ArrayHandle<int> h_n(cellVertices,access_location::host,access_mode::read);
 
-    double2 vertex,baseVertex,pos;
+    #pragma omp parallel for num_threads(ompThreadNum)
     for (int cell = 0; cell < Ncells; ++cell)
         {
-        baseVertex = h_v.data[h_n.data[n_idx(0,cell)]];
+        double2 vertex,pos;
+        double2 baseVertex = h_v.data[h_n.data[n_idx(0,cell)]];
         int neighs = h_nn.data[cell];
         pos.x=0.0;pos.y=0.0;
         //compute the vertex position relative to the cell position
         for (int n = 1; n < neighs; ++n)
             {
             int vidx = h_n.data[n_idx(n,cell)];
-            Box->minDist(h_v.data[vidx],baseVertex,vertex);
+            box.minDist<rectangular>(h_v.data[vidx],baseVertex,vertex);
             pos.x += vertex.x;
             pos.y += vertex.y;
             };
@@ -458,7 +500,7 @@ void vertexModelBase::getCellPositionsCPU()
         pos.y /= neighs;
         pos.x += baseVertex.x;
         pos.y += baseVertex.y;
-        Box->putInBoxReal(pos);
+        box.putInBoxReal(pos);
         h_p.data[cell] = pos;
         };
     };
@@ -503,6 +545,26 @@ void vertexModelBase::initializeEdgeFlipLists()
     h_ffe.data[1]=0;
     };
 
+/*!
+The mesh is only rebuilt from scratch when it is requested after something (sorting, a T2 transition,
+GPU T1 transitions, reading a checkpoint...) renumbered or rewired the topology behind its back
+*/
+void vertexModelBase::buildHalfEdgeMesh()
+    {
+    ArrayHandle<int> h_vn(vertexNeighbors,access_location::host,access_mode::read);
+    ArrayHandle<int> h_cvn(cellVertexNum,access_location::host,access_mode::read);
+    ArrayHandle<int> h_cv(cellVertices,access_location::host,access_mode::read);
+    halfEdges.build(Nvertices,Ncells,h_vn.data,h_cvn.data,h_cv.data,n_idx);
+    halfEdgesCurrent = true;
+    };
+
+const halfEdgeMesh & vertexModelBase::getHalfEdgeMesh()
+    {
+    if(!halfEdgesCurrent)
+        buildHalfEdgeMesh();
+    return halfEdges;
+    };
+
 /*!
 when a transition increases the maximum number of vertices around any cell in the system,
 call this function first to copy over the cellVertices structure into a larger array
@@ -510,6 +572,8 @@ call this function first to copy over the cellVertices structure into a larger a
 void vertexModelBase::growCellVerticesList(int newVertexMax)
     {
     cout << "maximum number of vertices per cell grew from " <<vertexMax << " to " << newVertexMax << endl;
+    if(metrics)
+        metrics->increment(vertexListGrowthMetric);
     vertexMax = newVertexMax+1;
     Index2D old_idx = n_idx;
     n_idx = Index2D(vertexMax,Ncells);
@@ -541,6 +605,24 @@ and the vertices to be re-wired...see the comments in "testAndPerformT1Transitio
 */
 void vertexModelBase::getCellVertexSetForT1(int vertex1, int vertex2, int4 &cellSet, int4 &vertexSet, bool &growList)
     {
+    if(useHalfEdges)
+        {
+        //with h running from vertex 1 to vertex 2, everything is a step or two away along the mesh
+        int h = halfEdges.halfEdgeBetween(vertex1,vertex2);
+        int t = halfEdges.twin(h);
+        cellSet.x = halfEdges.cell(t);
+        cellSet.y = halfEdges.cell(halfEdges.twin(halfEdges.next(t)));
+        cellSet.z = halfEdges.cell(h);
+        cellSet.w = halfEdges.cell(halfEdges.twin(halfEdges.next(h)));
+        vertexSet.x = halfEdges.destination(halfEdges.next(t));
+        vertexSet.y = halfEdges.origin(halfEdges.prev(h));
+        vertexSet.z = halfEdges.origin(halfEdges.prev(t));
+        vertexSet.w = halfEdges.destination(halfEdges.next(h));
+        ArrayHandle<int> h_cvn(cellVertexNum,access_location::host,access_mode::read);
+        if(h_cvn.data[cellSet.x] == vertexMax || h_cvn.data[cellSet.y] == vertexMax || h_cvn.data[cellSet.z] == vertexMax || h_cvn.data[cellSet.w] == vertexMax)
+            growList = true;
+        return;
+        };
     int cell1,cell2,cell3,ctest;
     int vlast, vcur, vnext, cneigh;
     ArrayHandle<int> h_cv(cellVertices,access_location::host, access_mode::read);
@@ -703,19 +785,19 @@ void vertexModelBase::performT1TransitionCPU(int vertex1, int vertex2,
             cellVertexArray = ArrayHandle<int>(cellVertices,access_location::host,access_mode::readwrite);
     };
 
-    //Rotate the vertices in the edge and set them at twice their original distance
+    //Rotate the vertices in the edge about its midpoint and set them at twice their original distance.
+    //Each vertex is displaced from its own position, so that its image counter follows it across the boundary
     double2 edge;
     Box->minDist(v1,v2,edge);
-    double2 midpoint;
-    midpoint.x = v2.x + 0.5*edge.x;
-    midpoint.y = v2.y + 0.5*edge.y;
-
-    v1.x = midpoint.x-edge.y;
-    v1.y = midpoint.y+edge.x;
-    v2.x = midpoint.x+edge.y;
-    v2.y = midpoint.y-edge.x;
-    Box->putInBoxReal(v1);
-    Box->putInBoxReal(v2);
+    v1.x += -0.5*edge.x-edge.y;
+    v1.y += -0.5*edge.y+edge.x;
+    v2.x += 0.5*edge.x+edge.y;
+    v2.y += 0.5*edge.y-edge.x;
+    {//scope for the image array handle
+    ArrayHandle<int2> h_vi(vertexImages,access_location::host,access_mode::readwrite);
+    Box->putInBoxReal(v1,h_vi.data[vertex1]);
+    Box->putInBoxReal(v2,h_vi.data[vertex2]);
+    }
     vertexPositionArray.data[vertex1] = v1;
     vertexPositionArray.data[vertex2] = v2;
 
@@ -738,6 +820,23 @@ void vertexModelBase::performT1TransitionCPU(int vertex1, int vertex2,
         if(vertexNeighborArray.data[3*vertex2+vert] == vertexSet.z)
                 vertexNeighborArray.data[3*vertex2+vert] = vertexSet.y;
         };
+    if(useHalfEdges)
+        {
+        //flip the edge in the mesh, and write the four changed cells back to cellVertices by walking
+        //their boundaries (each row keeps its first vertex, unless that vertex left the cell)
+        halfEdges.flipEdge(halfEdges.halfEdgeBetween(vertex1,vertex2));
+        int cells[4] = {cellSet.x,cellSet.y,cellSet.z,cellSet.w};
+        for (int cc = 0; cc < 4; ++cc)
+            {
+            int *row = &cellVertexArray.data[n_idx(0,cells[cc])];
+            int start = row[0];
+            if((cc == 0 && start == vertex2) || (cc == 2 && start == vertex1))
+                start = row[1];
+            cellVertexNumberArray.data[cells[cc]] = halfEdges.cellVertexLoop(cells[cc],start,row);
+            };
+        return;
+        };
+
     //now rewire the cells
     //cell i loses v2 as a neighbor
     int cneigh = cellVertexNumberArray.data[cellSet.x];
@@ -808,6 +907,8 @@ This function also performs the transition and maintains the auxiliary data stru
  */
 void vertexModelBase::testAndPerformT1TransitionsCPU()
     {
+    if(useHalfEdges && !halfEdgesCurrent)
+        buildHalfEdgeMesh();
     ArrayHandle<double2> h_v(vertexPositions,access_location::host,access_mode::readwrite);
     ArrayHandle<int> h_vn(vertexNeighbors,access_location::host,access_mode::readwrite);
 
@@ -816,6 +917,7 @@ void vertexModelBase::testAndPerformT1TransitionsCPU()
     int vertex2;
     //keep track of whether vertexMax needs to be increased
     int vMax = vertexMax;
+    int transitions = 0;
     double2 v1,v2;
     for (int vertex1 = 0; vertex1 < Nvertices; ++vertex1)
         {
@@ -833,10 +935,18 @@ void vertexModelBase::testAndPerformT1TransitionsCPU()
                     {
                     performT1TransitionCPU(vertex1,vertex2,vMax,
                                            h_v,h_vn);
+                    transitions += 1;
                     };//end condition that a T1 transition should occur
                 };
             };//end loop over vertex2
         };//end loop over vertices
+    if(!useHalfEdges && transitions > 0)
+        halfEdgesCurrent = false;
+    if(metrics)
+        {
+        metrics->increment(T1Metric,transitions);
+        metrics->record(T1Histogram,transitions);
+        };
     };
 
 /*!
@@ -917,6 +1027,7 @@ void vertexModelBase::flipEdgesGPU()
         if(h_ffe.data[0] != 0)
             {
             ArrayHandle<double2> d_v(vertexPositions,access_location::device,access_mode::readwrite);
+            ArrayHandle<int2> d_vi(vertexImages,access_location::device,access_mode::readwrite);
             ArrayHandle<int> d_vn(vertexNeighbors,access_location::device,access_mode::readwrite);
             ArrayHandle<int> d_vflipcur(vertexEdgeFlipsCurrent,access_location::device,access_mode::readwrite);
             ArrayHandle<int> d_cvn(cellVertexNum,access_location::device,access_mode::readwrite);
@@ -927,6 +1038,7 @@ void vertexModelBase::flipEdgesGPU()
             
             gpu_vm_flip_edges(d_vflipcur.data,
                                d_v.data,
+                               d_vi.data,
                                d_vn.data,
                                d_vcn.data,
                                d_cvn.data,
@@ -953,7 +1065,17 @@ Because the cellVertexList might need to grow, it's convenient to break this int
 void vertexModelBase::testAndPerformT1TransitionsGPU()
     {
     testEdgesForT1GPU();
+    if(metrics)
+        {
+        ArrayHandle<int> h_vflip(vertexEdgeFlips,access_location::host,access_mode::read);
+        int transitions = 0;
+        for (int ee = 0; ee < 3*Nvertices; ++ee)
+            transitions += h_vflip.data[ee];
+        metrics->increment(T1Metric,transitions);
+        metrics->record(T1Histogram,transitions);
+        };
     flipEdgesGPU();
+    halfEdgesCurrent = false;
     };
 
 /*!
@@ -1078,16 +1200,17 @@ void vertexModelBase::cellDeath(int cellIndex)
     //along with vertex numbers greater than v1 and/or v2
     int v1 = std::min(vertices[1],vertices[2]);
     int v2 = std::max(vertices[1],vertices[2]);
-    for (int cv = 0; cv < cellVertices.getNumElements(); ++cv)
-        {
-        int cellVert = h_cv.data[cv];
-        if (cellVert >= v1)
+    for (int cell = 0; cell < Ncells; ++cell)
+        for (unsigned int cv = n_idx(0,cell); cv < n_idx(h_cvn.data[cell],cell); ++cv)
             {
-            cellVert -= 1;
-            if (cellVert >=v2) cellVert -=1;
-            h_cv.data[cv] = cellVert;
-            }
-        };
+            int cellVert = h_cv.data[cv];
+            if (cellVert >= v1)
+                {
+                cellVert -= 1;
+                if (cellVert >=v2) cellVert -=1;
+                h_cv.data[cv] = cellVert;
+                }
+            };
     for (int vv = 0; vv < vertexNeighbors.getNumElements(); ++vv)
         {
         int vIdx = h_vn.data[vv];
@@ -1115,6 +1238,7 @@ void vertexModelBase::cellDeath(int cellIndex)
     for (int ii = 0; ii < vertexMax; ++ii)
         cvDeletions[ii] = n_idx(ii,cellIndex);
     removeGPUArrayElement(vertexPositions,vpDeletions);
+    removeGPUArrayElement(vertexImages,vpDeletions);
     removeGPUArrayElement(vertexMasses,vpDeletions);
     removeGPUArrayElement(vertexVelocities,vpDeletions);
     removeGPUArrayElement(vertexNeighbors,vnDeletions);
@@ -1155,13 +1279,15 @@ void vertexModelBase::cellDeath(int cellIndex)
     //finally, resize remaining stuff and call parent functions
     vertexForces.resize(Nvertices);
     displacements.resize(Nvertices);
-    vertexForceSets.resize(3*Nvertices);
+    resizeVertexForceSets();
     voroCur.resize(3*Nvertices);
     voroLastNext.resize(3*Nvertices);
 
     initializeEdgeFlipLists(); //function call takes care of EdgeFlips and EdgeFlipsCurrent
     Simple2DActiveCell::cellDeath(cellIndex); //This call decrements Ncells by one
     n_idx = Index2D(vertexMax,Ncells);
+    //every vertex and cell index above the deleted ones shifted, so the mesh is rebuilt when next needed
+    halfEdgesCurrent = false;
 
     //computeGeometry();
     };
@@ -1195,6 +1321,7 @@ void vertexModelBase::cellDivision(const vector<int> &parameters, const vector<d
 
     double2 cellPos;
     double2 newV1Pos,newV2Pos;
+    int2 newV1Image,newV2Image;
     int v1idx, v2idx, v1NextIdx, v2NextIdx;
     int newV1CellNeighbor, newV2CellNeighbor;
     bool increaseVertexMax = false;
@@ -1202,6 +1329,7 @@ void vertexModelBase::cellDivision(const vector<int> &parameters, const vector<d
     vector<int> combinedVertices;
     {//scope for array handles
     ArrayHandle<double2> vP(vertexPositions);
+    ArrayHandle<int2> vI(vertexImages);
     ArrayHandle<int> cellVertNum(cellVertexNum);
     ArrayHandle<int> cv(cellVertices);
     ArrayHandle<int> vcn(vertexCellNeighbors);
@@ -1236,23 +1364,31 @@ void vertexModelBase::cellDivision(const vector<int> &parameters, const vector<d
     disp.x = 0.5*disp.x;
     disp.y = 0.5*disp.y;
     newV1Pos = vP.data[v1idx] + disp;
-    Box->putInBoxReal(newV1Pos);
+    newV1Image = vI.data[v1idx];
+    Box->putInBoxReal(newV1Pos,newV1Image);
     Box->minDist(vP.data[v2NextIdx],vP.data[v2idx],disp);
     disp.x = 0.5*disp.x;
     disp.y = 0.5*disp.y;
     newV2Pos = vP.data[v2idx] + disp;
-    Box->putInBoxReal(newV2Pos);
+    newV2Image = vI.data[v2idx];
+    Box->putInBoxReal(newV2Pos,newV2Image);
 
-    //find the third cell neighbor of the new vertices
+    //find the third cell neighbor of the new vertices: the cells across the split edges
+    bool meshLookup = useHalfEdges && halfEdgesCurrent;
     int ans = -1;
-    for (int vi = 3*v1idx; vi < 3*v1idx+3; ++vi)
-        for (int vj = 3*v1NextIdx; vj < 3*v1NextIdx+3; ++vj)
-            {
-            int c1 = vcn.data[vi];
-            int c2 = vcn.data[vj];
-            if ((c1 == c2) &&(c1 != cellIdx))
-                ans = c1;
-            };
+    if(meshLookup)
+        ans = halfEdges.cell(halfEdges.twin(halfEdges.halfEdgeBetween(v1idx,v1NextIdx)));
+    else
+        {
+        for (int vi = 3*v1idx; vi < 3*v1idx+3; ++vi)
+            for (int vj = 3*v1NextIdx; vj < 3*v1NextIdx+3; ++vj)
+                {
+                int c1 = vcn.data[vi];
+                int c2 = vcn.data[vj];
+                if ((c1 == c2) &&(c1 != cellIdx))
+                    ans = c1;
+                };
+        };
     if (ans >=0)
         newV1CellNeighbor = ans;
     else
@@ -1262,14 +1398,19 @@ void vertexModelBase::cellDivision(const vector<int> &parameters, const vector<d
         };
 
     ans = -1;
-    for (int vi = 3*v2idx; vi < 3*v2idx+3; ++vi)
-        for (int vj = 3*v2NextIdx; vj < 3*v2NextIdx+3; ++vj)
-            {
-            int c1 = vcn.data[vi];
-            int c2 = vcn.data[vj];
-            if ((c1 == c2) &&(c1 != cellIdx))
-                ans = c1;
-            };
+    if(meshLookup)
+        ans = halfEdges.cell(halfEdges.twin(halfEdges.halfEdgeBetween(v2idx,v2NextIdx)));
+    else
+        {
+        for (int vi = 3*v2idx; vi < 3*v2idx+3; ++vi)
+            for (int vj = 3*v2NextIdx; vj < 3*v2NextIdx+3; ++vj)
+                {
+                int c1 = vcn.data[vi];
+                int c2 = vcn.data[vj];
+                if ((c1 == c2) &&(c1 != cellIdx))
+                    ans = c1;
+                };
+        };
     if (ans >=0)
         newV2CellNeighbor = ans;
     else
@@ -1308,12 +1449,13 @@ void vertexModelBase::cellDivision(const vector<int> &parameters, const vector<d
     vertexForces.resize(Nvertices);
     displacements.resize(Nvertices);
     initializeEdgeFlipLists(); //function call takes care of EdgeFlips and EdgeFlipsCurrent
-    vertexForceSets.resize(3*Nvertices);
+    resizeVertexForceSets();
     voroCur.resize(3*Nvertices);
     voroLastNext.resize(3*Nvertices);
 
     //use the copy and grow mechanism where we need to actually set values
     growGPUArray(vertexPositions,2); //(nv)
+    growGPUArray(vertexImages,2); //(nv)
     growGPUArray(vertexMasses,2); //(nv)
     growGPUArray(vertexVelocities,2); //(nv)
     growGPUArray(vertexNeighbors,6); //(3*nv)
@@ -1330,6 +1472,9 @@ void vertexModelBase::cellDivision(const vector<int> &parameters, const vector<d
         ArrayHandle<double2> h_vp(vertexPositions);
         h_vp.data[Nvertices-2] = newV1Pos;
         h_vp.data[Nvertices-1] = newV2Pos;
+        ArrayHandle<int2> h_vi(vertexImages);
+        h_vi.data[Nvertices-2] = newV1Image;
+        h_vi.data[Nvertices-1] = newV2Image;
         ArrayHandle<double2> h_vv(vertexVelocities);
         h_vv.data[Nvertices-2] = make_double2(0.0,0.0);
         h_vv.data[Nvertices-1] = make_double2(0.0,0.0);
@@ -1442,4 +1587,50 @@ void vertexModelBase::cellDivision(const vector<int> &parameters, const vector<d
         h_cvn.data[newV1CellNeighbor] = cn1Size+1;
         h_cvn.data[newV2CellNeighbor] = cn2Size+1;
         };
+
+    //the new vertices and cell are appended, so the rest of the mesh keeps its handles
+    if(useHalfEdges && halfEdgesCurrent)
+        {
+        ArrayHandle<int> h_vn(vertexNeighbors,access_location::host,access_mode::read);
+        ArrayHandle<int> h_cvn(cellVertexNum,access_location::host,access_mode::read);
+        ArrayHandle<int> h_cv(cellVertices,access_location::host,access_mode::read);
+        vector<int> changedCells = {cellIdx,Ncells-1,newV1CellNeighbor,newV2CellNeighbor};
+        halfEdges.updateCells(changedCells,Nvertices,Ncells,h_vn.data,h_cvn.data,h_cv.data,n_idx);
+        };
+    };
+
+/*!
+The topology (vertexNeighbors, vertexCellNeighbors, cellVertices...) is stored by Simple2DCell; the edge
+flip arrays are added so that the GPU T1 routines start from the same state. vertexForceSets is only
+stored while it is in use (see resizeVertexForceSets)
+*/
+void vertexModelBase::writeCheckpoint(checkpointWriter &out)
+    {
+    Simple2DActiveCell::writeCheckpoint(out);
+    out.addArray("vertexEdgeFlips",vertexEdgeFlips);
+    out.addArray("vertexEdgeFlipsCurrent",vertexEdgeFlipsCurrent);
+    if(GPUcompute || storeForceSets)
+        out.addArray("vertexForceSets",vertexForceSets);
+    out.addArray("growCellVertexListAssist",growCellVertexListAssist);
+    out.addArray("finishedFlippingEdges",finishedFlippingEdges);
+    out.addArray("cellEdgeFlips",cellEdgeFlips);
+    out.addArray("cellSets",cellSets);
+    };
+
+void vertexModelBase::readCheckpoint(checkpointReader &in)
+    {
+    Simple2DActiveCell::readCheckpoint(in);
+    in.readArray("vertexEdgeFlips",vertexEdgeFlips);
+    in.readArray("vertexEdgeFlipsCurrent",vertexEdgeFlipsCurrent);
+    if((GPUcompute || storeForceSets) && in.hasRecord("vertexForceSets"))
+        in.readArray("vertexForceSets",vertexForceSets);
+    else
+        resizeVertexForceSets();
+    in.readArray("growCellVertexListAssist",growCellVertexListAssist);
+    in.readArray("finishedFlippingEdges",finishedFlippingEdges);
+    in.readArray("cellEdgeFlips",cellEdgeFlips);
+    in.readArray("cellSets",cellSets);
+    halfEdgesCurrent = false;
+    if(metrics)
+        metrics->setGauge(vertexMaxMetric,vertexMax);
     };
@@ -14,6 +14,7 @@
   Since the cells are NOT guaranteed to be convex, the area of the cell must take into account any
   self-intersections. The strategy is the same as in the CPU branch.
   */
+template<bool rectangular>
 __global__ void vm_geometry_kernel(
                                    const double2* __restrict__ d_vertexPositions,
                                    const int*  __restrict__ d_cellVertexNum,
@@ -40,7 +41,7 @@ __global__ void vm_geometry_kernel(
 
     vlast.x = 0.0; vlast.y=0.0;
     int vidx = d_cellVertices[n_idx(neighs-1,idx)];
-    Box.minDist(d_vertexPositions[vidx],cellPos,vcur);
+    Box.minDist<rectangular>(d_vertexPositions[vidx],cellPos,vcur);
     for (int nn = 0; nn < neighs; ++nn)
         {
         //for easy force calculation, save the current, last, and next voronoi vertex position
@@ -54,7 +55,7 @@ __global__ void vm_geometry_kernel(
             };
 
         vidx = d_cellVertices[n_idx(nn,idx)];
-        Box.minDist(d_vertexPositions[vidx],cellPos,vnext);
+        Box.minDist<rectangular>(d_vertexPositions[vidx],cellPos,vnext);
 
         //compute area contribution. It is
         // 0.5 * (vcur.x+vnext.x)*(vnext.y-vcur.y)
@@ -282,6 +283,7 @@ __global__ void vm_one_T1_per_cell_per_vertex_kernel(
   */
 __global__ void vm_flip_edges_kernel(int* d_vertexEdgeFlipsCurrent,
                                       double2 *d_vertexPositions,
+                                      int2     *d_vertexImages,
                                       int      *d_vertexNeighbors,
                                       int      *d_vertexCellNeighbors,
                                       int      *d_cellVertexNum,
@@ -453,20 +455,17 @@ for (int cn = 0; cn < cneigh; ++cn) printf("%i\t",d_cellVertices[n_idx(cn,cellSe
     if(cellSet.x <0 || cellSet.y < 0 || cellSet.z <0 || cellSet.w <0)
         return;
 
-    //okay, we're ready to go. First, rotate the vertices in the edge and set them at twice their original distance
+    //okay, we're ready to go. First, rotate the vertices in the edge about its midpoint and set them at twice
+    //their original distance, displacing each from its own position so its image counter follows it
     double2 edge;
     double2 v1 = d_vertexPositions[vertex1];
     double2 v2 = d_vertexPositions[vertex2];
     Box.minDist(v1,v2,edge);
 
-    double2 midpoint;
-    midpoint.x = v2.x + 0.5*edge.x;
-    midpoint.y = v2.y + 0.5*edge.y;
-
-    v1.x = midpoint.x-edge.y;v1.y = midpoint.y+edge.x;
-    v2.x = midpoint.x+edge.y;v2.y = midpoint.y-edge.x;
-    Box.putInBoxReal(v1);
-    Box.putInBoxReal(v2);
+    v1.x += -0.5*edge.x-edge.y;v1.y += -0.5*edge.y+edge.x;
+    v2.x += 0.5*edge.x+edge.y;v2.y += 0.5*edge.y-edge.x;
+    Box.putInBoxReal(v1,d_vertexImages[vertex1]);
+    Box.putInBoxReal(v2,d_vertexImages[vertex2]);
     d_vertexPositions[vertex1] = v1;
     d_vertexPositions[vertex2] = v2;
 
@@ -592,7 +591,14 @@ bool gpu_vm_geometry(
     unsigned int nblocks  = N/block_size + 1;
 
 
-    vm_geometry_kernel<<<nblocks,block_size>>>(d_vertexPositions,
+    if(Box.isBoxSquare())
+        vm_geometry_kernel<true><<<nblocks,block_size>>>(d_vertexPositions,
+                                               d_cellVertexNum,d_cellVertices,
+                                               d_vertexCellNeighbors,d_voroCur,
+                                               d_voroLastNext,d_AreaPerimeter,
+                                               N, n_idx, Box);
+    else
+        vm_geometry_kernel<false><<<nblocks,block_size>>>(d_vertexPositions,
                                                d_cellVertexNum,d_cellVertices,
                                                d_vertexCellNeighbors,d_voroCur,
                                                d_voroLastNext,d_AreaPerimeter,
@@ -685,6 +691,7 @@ bool gpu_vm_parse_multiple_flips(
 bool gpu_vm_flip_edges(
                     int      *d_vertexEdgeFlipsCurrent,
                     double2 *d_vertexPositions,
+                    int2     *d_vertexImages,
                     int      *d_vertexNeighbors,
                     int      *d_vertexCellNeighbors,
                     int      *d_cellVertexNum,
@@ -705,7 +712,7 @@ bool gpu_vm_flip_edges(
     unsigned int nblocks  = NvTimes3/block_size + 1;
 
     vm_flip_edges_kernel<<<nblocks,block_size>>>(
-                                                  d_vertexEdgeFlipsCurrent,d_vertexPositions,d_vertexNeighbors,
+                                                  d_vertexEdgeFlipsCurrent,d_vertexPositions,d_vertexImages,d_vertexNeighbors,
                                                   d_vertexCellNeighbors,d_cellVertexNum,d_cellVertices,d_cellEdgeFlips,d_cellSets,
                                                   Box,
                                                   n_idx,NvTimes3);
@@ -76,6 +76,7 @@ bool gpu_vm_parse_multiple_flips(
 bool gpu_vm_flip_edges(
                     int      *d_vertexEdgeFlipsCurrent,
                     double2 *d_vertexPositions,
+                    int2     *d_vertexImages,
                     int      *d_vertexNeighbors,
                     int      *d_vertexCellNeighbors,
                     int      *d_cellVertexNum,
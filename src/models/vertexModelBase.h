@@ -6,6 +6,7 @@
 #include "selfPropelledParticleDynamics.h"
 #include "Simulation.h"
 #include "simpleVertexDatabase.h"
+#include "halfEdgeMesh.h"
 
 /*! \file vertexModelBase.h */
 //!A class that can calculate many geometric and topological features common to vertex models
@@ -32,7 +33,7 @@ class vertexModelBase : public Simple2DActiveCell
         virtual void moveDegreesOfFreedom(GPUArray<double2> & displacements,double scale = 1.);
 
         //!return the forces
-        virtual void getForces(GPUArray<double2> &forces){forces = vertexForces;};
+        virtual void getForces(GPUArray<double2> &forces){forces.copyFrom(vertexForces);};
 
         //!Initialize vertexModelBase, set random orientations for vertex directors, prepare data structures
         void initializeVertexModelBase(int n,bool spvInitialize = false, bool usegpu = true);
@@ -49,17 +50,21 @@ class vertexModelBase : public Simple2DActiveCell
         virtual GPUArray<double2> & returnVelocities(){return vertexVelocities;};
         //!return a reference to the GPUArray of the current positions
         virtual GPUArray<double2> & returnPositions(){return vertexPositions;};
+        //!return a reference to the GPUArray of the periodic image counters of the vertices
+        virtual GPUArray<int2> & returnImages(){return vertexImages;};
         //!return a reference to the GPUArray of the current masses
         virtual GPUArray<double> & returnMasses(){return vertexMasses;};
 
         //!Compute the geometry (area & perimeter) of the cells on the CPU
         virtual void computeGeometryCPU();
+        //!Compute the geometry (and, optionally, the centroids) on the CPU in a box known to be rectangular (or not) at compile time
+        template<bool rectangular, bool centroids> void computeGeometryCPUSpecialized();
         //!Compute the geometry (area & perimeter) of the cells on the GPU
         virtual void computeGeometryGPU();
 
         //!Call the CPU or GPU getCellCentroids function
         void getCellCentroids();
-        //!Get the cell position from the vertices on the CPU
+        //!Get the cell position from the vertices on the CPU (this redoes the whole CPU geometry pass)
         void getCellCentroidsCPU();
         //!Get the cell position from the vertices on the GPU
         void getCellCentroidsGPU();
@@ -67,6 +72,8 @@ class vertexModelBase : public Simple2DActiveCell
         void getCellPositions();
         //!Get the cell position from the average vertex position on the CPU
         void getCellPositionsCPU();
+        //!Average the vertex positions in a box known to be rectangular (or not) at compile time
+        template<bool rectangular> void getCellPositionsCPUSpecialized();
         //!Get the cell position from the average vertex position on the GPU
         void getCellPositionsGPU();
 
@@ -103,14 +110,34 @@ class vertexModelBase : public Simple2DActiveCell
         vertexForceSets[3*i], vertexForceSets[3*i+1], and vertexForceSets[3*i+2] contain the contribution
         to the net force on vertex i due to the three cell neighbors of vertex i
         */
-        //!an array containing the three contributions to the force on each vertex
+        //!an array containing the three contributions to the force on each vertex (empty unless it is used)
         GPUArray<double2> vertexForceSets;
+        //!Should the CPU force routines also fill vertexForceSets? (the GPU routines always do)
+        bool storeForceSets = false;
+        //!Keep (or stop keeping) the per-cell force contributions when forces are computed on the CPU
+        void setStoreForceSets(bool store){storeForceSets = store; resizeVertexForceSets();};
+        //!Size vertexForceSets for the current vertices if the GPU path or storeForceSets needs it, and free it otherwise
+        void resizeVertexForceSets();
 
         //!A threshold defining the edge length below which a T1 transition will occur
         double T1Threshold;
 
         //!Enforce CPU-only operation.
         void setCPU(bool global = true){GPUcompute = false;};
+        //!Enforce GPU operation, whose force kernels always fill vertexForceSets
+        virtual void setGPU(){GPUcompute = true; resizeVertexForceSets();};
+
+        //!Maintain a halfEdgeMesh of the topology, used by the CPU T1 and cell division routines
+        void setUseHalfEdgeMesh(bool use){useHalfEdges = use; halfEdgesCurrent = false;};
+        //!The half-edge mesh of the current topology (built if it is out of date)
+        const halfEdgeMesh & getHalfEdgeMesh();
+
+        //!Report T1 transitions and growth of the cell-vertex list to a metrics registry
+        virtual void setMetrics(shared_ptr<runtimeMetrics> _metrics);
+        //!Add the edge-flip work arrays to the checkpoint
+        virtual void writeCheckpoint(checkpointWriter &out);
+        //!Restore a state written by writeCheckpoint
+        virtual void readCheckpoint(checkpointReader &in);
 
     protected:
         //!sub-function for performing a T1 transition
@@ -143,6 +170,18 @@ class vertexModelBase : public Simple2DActiveCell
         GPUArray<int> cellEdgeFlips;
         //! data structure per cell for not simulataneously flipping nearby edges
         GPUArray<int4> cellSets;
+
+        //!ids of the reported metrics
+        int T1Metric, T1Histogram, vertexListGrowthMetric, vertexMaxMetric;
+
+        //!Rebuild the half-edge mesh from vertexNeighbors, cellVertexNum and cellVertices
+        void buildHalfEdgeMesh();
+        //!The half-edge representation of the topology
+        halfEdgeMesh halfEdges;
+        //!Should the CPU topology routines keep halfEdges up to date (and use it)?
+        bool useHalfEdges = false;
+        //!Does halfEdges match the flat topology arrays? (sorting, T2s and GPU T1s invalidate it)
+        bool halfEdgesCurrent = false;
     //reporting functions
     public:
         //!Handy for debugging T1 transitions...report the vertices owned by cell i
@@ -159,5 +198,6 @@ class vertexModelBase : public Simple2DActiveCell
             cout <<endl;
             };
     friend class simpleVertexDatabase;
+    friend class mappedTrajectoryDatabase;
     };
 #endif
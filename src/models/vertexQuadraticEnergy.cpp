@@ -24,7 +24,7 @@ VertexQuadraticEnergy::VertexQuadraticEnergy(int n,double A0, double P0,bool rep
 
 /*!
 Returns the quadratic energy functional:
-E = \sum_{cells} K_A(A_i-A_i,0)^2 + K_P(P_i-P_i,0)^2
+E = \sum_{cells} K_{A,i}(A_i-A_i,0)^2 + K_{P,i}(P_i-P_i,0)^2
 */
 double VertexQuadraticEnergy::computeEnergy()
     {
@@ -32,11 +32,14 @@ double VertexQuadraticEnergy::computeEnergy()
         computeForces();
     ArrayHandle<double2> h_AP(AreaPeri,access_location::host,access_mode::read);
     ArrayHandle<double2> h_APP(AreaPeriPreferences,access_location::host,access_mode::read);
+    ArrayHandle<double2> h_mod(Moduli,access_location::host,access_mode::read);
     Energy = 0.0;
     for (int nn = 0; nn  < Ncells; ++nn)
         {
-        Energy += KA * (h_AP.data[nn].x-h_APP.data[nn].x)*(h_AP.data[nn].x-h_APP.data[nn].x);
-        Energy += KP * (h_AP.data[nn].y-h_APP.data[nn].y)*(h_AP.data[nn].y-h_APP.data[nn].y);
+        double ka = uniformModuli ? KA : h_mod.data[nn].x;
+        double kp = uniformModuli ? KP : h_mod.data[nn].y;
+        Energy += ka * (h_AP.data[nn].x-h_APP.data[nn].x)*(h_AP.data[nn].x-h_APP.data[nn].x);
+        Energy += kp * (h_AP.data[nn].y-h_APP.data[nn].y)*(h_AP.data[nn].y-h_APP.data[nn].y);
         };
 
     return Energy;
@@ -48,6 +51,7 @@ flags
 */
 void VertexQuadraticEnergy::computeForces()
     {
+    PROFILE_SCOPE("VertexQuadraticEnergy::computeForces");
     if(forcesUpToDate)
        return; 
     forcesUpToDate = true;
@@ -65,49 +69,67 @@ void VertexQuadraticEnergy::computeForces()
     };
 
 /*!
-Use the data pre-computed in the geometry routine to rapidly compute the net force on each vertex
+Compute the net force on each vertex directly from the contributions of its three cells, which are
+added in a fixed order, so the result does not depend on the number of threads. The moduli are a
+template parameter so that the uniform case does not pay for a per-cell read of the Moduli array, and
+the contributions are written to vertexForceSets only if storeSets is true
 */
-void VertexQuadraticEnergy::computeForcesCPU()
+template<bool perCellModuli, bool storeSets>
+void VertexQuadraticEnergy::computeVertexForcesCPU()
     {
     ArrayHandle<int> h_vcn(vertexCellNeighbors,access_location::host,access_mode::read);
     ArrayHandle<double2> h_vc(voroCur,access_location::host,access_mode::read);
     ArrayHandle<double4> h_vln(voroLastNext,access_location::host,access_mode::read);
     ArrayHandle<double2> h_AP(AreaPeri,access_location::host,access_mode::read);
     ArrayHandle<double2> h_APpref(AreaPeriPreferences,access_location::host,access_mode::read);
-
-    ArrayHandle<double2> h_fs(vertexForceSets,access_location::host, access_mode::overwrite);
+    ArrayHandle<double2> h_mod(Moduli,access_location::host,access_mode::read);
     ArrayHandle<double2> h_f(vertexForces,access_location::host, access_mode::overwrite);
+    ArrayHandle<double2> h_fs(vertexForceSets,access_location::host, access_mode::overwrite);
 
-    //first, compute the contribution to the force on each vertex from each of its three cells
-    double2 vlast,vcur,vnext;
-    double2 dEdv;
-    double Adiff, Pdiff;
-    for(int fsidx = 0; fsidx < Nvertices*3; ++fsidx)
+    #pragma omp parallel for simd num_threads(ompThreadNum)
+    for (int v = 0; v < Nvertices; ++v)
         {
-        int cellIdx = h_vcn.data[fsidx];
-        double Adiff = KA*(h_AP.data[cellIdx].x - h_APpref.data[cellIdx].x);
-        double Pdiff = KP*(h_AP.data[cellIdx].y - h_APpref.data[cellIdx].y);
-        vcur = h_vc.data[fsidx];
-        vlast.x = h_vln.data[fsidx].x;  vlast.y = h_vln.data[fsidx].y;
-        vnext.x = h_vln.data[fsidx].z;  vnext.y = h_vln.data[fsidx].w;
-
-        //computeForceSetVertexModel is defined in inc/utility/functions.h
-        computeForceSetVertexModel(vcur,vlast,vnext,Adiff,Pdiff,dEdv);
+        double2 vlast,vnext,dEdv;
+        double2 force = make_double2(0.0,0.0);
+        for (int fsidx = 3*v; fsidx < 3*v+3; ++fsidx)
+            {
+            int cellIdx = h_vcn.data[fsidx];
+            double ka = perCellModuli ? h_mod.data[cellIdx].x : KA;
+            double kp = perCellModuli ? h_mod.data[cellIdx].y : KP;
+            double Adiff = ka*(h_AP.data[cellIdx].x - h_APpref.data[cellIdx].x);
+            double Pdiff = kp*(h_AP.data[cellIdx].y - h_APpref.data[cellIdx].y);
+            vlast.x = h_vln.data[fsidx].x;  vlast.y = h_vln.data[fsidx].y;
+            vnext.x = h_vln.data[fsidx].z;  vnext.y = h_vln.data[fsidx].w;
 
-        h_fs.data[fsidx].x = dEdv.x;
-        h_fs.data[fsidx].y = dEdv.y;
+            //computeForceSetVertexModel is defined in inc/utility/functions.h
+            computeForceSetVertexModel(h_vc.data[fsidx],vlast,vnext,Adiff,Pdiff,dEdv);
+            if(storeSets)
+                h_fs.data[fsidx] = dEdv;
+            force.x += dEdv.x;
+            force.y += dEdv.y;
+            };
+        h_f.data[v] = force;
         };
+    };
 
-    //now sum these up to get the force on each vertex
-    for (int v = 0; v < Nvertices; ++v)
+/*!
+Use the data pre-computed in the geometry routine to rapidly compute the net force on each vertex
+*/
+void VertexQuadraticEnergy::computeForcesCPU()
+    {
+    if(uniformModuli)
         {
-        double2 ftemp = make_double2(0.0,0.0);
-        for (int ff = 0; ff < 3; ++ff)
-            {
-            ftemp.x += h_fs.data[3*v+ff].x;
-            ftemp.y += h_fs.data[3*v+ff].y;
-            };
-        h_f.data[v] = ftemp;
+        if(storeForceSets)
+            computeVertexForcesCPU<false,true>();
+        else
+            computeVertexForcesCPU<false,false>();
+        }
+    else
+        {
+        if(storeForceSets)
+            computeVertexForcesCPU<true,true>();
+        else
+            computeVertexForcesCPU<true,false>();
         };
     };
 
@@ -125,7 +147,8 @@ void VertexQuadraticEnergy::computeForcesGPU()
     ArrayHandle<double2> d_f(vertexForces,access_location::device, access_mode::overwrite);
 
     int nForceSets = voroCur.getNumElements();
-    gpu_avm_force_sets(
+    if(uniformModuli)
+        gpu_avm_force_sets(
                     d_vcn.data,
                     d_vc.data,
                     d_vln.data,
@@ -136,6 +159,22 @@ void VertexQuadraticEnergy::computeForcesGPU()
                     KA,
                     KP
                     );
+    else
+        {
+        ArrayHandle<double2> d_mod(Moduli,access_location::device,access_mode::read);
+        gpu_avm_force_sets(
+                    d_vcn.data,
+                    d_vc.data,
+                    d_vln.data,
+                    d_AP.data,
+                    d_APpref.data,
+                    d_fs.data,
+                    nForceSets,
+                    KA,
+                    KP,
+                    d_mod.data
+                    );
+        };
 
     gpu_avm_sum_force_sets(
                     d_fs.data,
@@ -13,8 +13,9 @@
 
 /*!
   The force on a vertex has a contribution from how moving that vertex affects each of the neighboring
-cells...compute those force sets
+cells...compute those force sets. If perCellModuli is false the d_moduli array is never read
 */
+template<bool perCellModuli>
 __global__ void avm_force_sets_kernel(
                         int      *d_vertexCellNeighbors,
                         double2 *d_voroCur,
@@ -23,7 +24,8 @@ __global__ void avm_force_sets_kernel(
                         double2 *d_AreaPerimeterPreferences,
                         double2 *d_vertexForceSets,
                         int nForceSets,
-                        double KA, double KP)
+                        double KA, double KP,
+                        double2 *d_moduli)
     {
     // read in the cell index that belongs to this thread
     unsigned int fsidx = blockDim.x * blockIdx.x + threadIdx.x;
@@ -33,6 +35,11 @@ __global__ void avm_force_sets_kernel(
     double2 vlast,vnext;
 
     int cellIdx = d_vertexCellNeighbors[fsidx];
+    if(perCellModuli)
+        {
+        KA = d_moduli[cellIdx].x;
+        KP = d_moduli[cellIdx].y;
+        };
     double Adiff = KA*(d_AreaPerimeter[cellIdx].x - d_AreaPerimeterPreferences[cellIdx].x);
     double Pdiff = KP*(d_AreaPerimeter[cellIdx].y - d_AreaPerimeterPreferences[cellIdx].y);
 
@@ -75,16 +82,23 @@ bool gpu_avm_force_sets(
                     double2 *d_AreaPerimeterPreferences,
                     double2 *d_vertexForceSets,
                     int nForceSets,
-                    double KA, double KP)
+                    double KA, double KP,
+                    double2 *d_moduli)
     {
     unsigned int block_size = 128;
     if (nForceSets < 128) block_size = 32;
     unsigned int nblocks  = nForceSets/block_size + 1;
 
-    avm_force_sets_kernel<<<nblocks,block_size>>>(d_vertexCellNeighbors,d_voroCur,d_voroLastNext,
+    if(d_moduli == NULL)
+        avm_force_sets_kernel<false><<<nblocks,block_size>>>(d_vertexCellNeighbors,d_voroCur,d_voroLastNext,
+                                                  d_AreaPerimeter,d_AreaPerimeterPreferences,
+                                                  d_vertexForceSets,
+                                                  nForceSets,KA,KP,d_moduli);
+    else
+        avm_force_sets_kernel<true><<<nblocks,block_size>>>(d_vertexCellNeighbors,d_voroCur,d_voroLastNext,
                                                   d_AreaPerimeter,d_AreaPerimeterPreferences,
                                                   d_vertexForceSets,
-                                                  nForceSets,KA,KP);
+                                                  nForceSets,KA,KP,d_moduli);
     HANDLE_ERROR(cudaGetLastError());
     return cudaSuccess;
     };
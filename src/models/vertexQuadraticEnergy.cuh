@@ -17,6 +17,7 @@ A file providing an interface to the relevant cuda calls for the VertexQuadratic
  * \brief CUDA kernels and callers for 2D vertex models
  */
 
+//!Compute force sets; if d_moduli is NULL every cell uses (KA,KP)
 bool gpu_avm_force_sets(
                     int      *d_vertexCellNeighbors,
                     double2 *d_voroCur,
@@ -25,7 +26,8 @@ bool gpu_avm_force_sets(
                     double2 *d_AreaPerimeterPreferences,
                     double2 *d_vertexForceSets,
                     int nForceSets,
-                    double KA, double KP);
+                    double KA, double KP,
+                    double2 *d_moduli = NULL);
 
 bool gpu_avm_sum_force_sets(
                     double2 *d_vertexForceSets,
@@ -31,5 +31,10 @@ class VertexQuadraticEnergy : public vertexModelBase
         //!Compute the geometry (area & perimeter) of the cells on the GPU
         void computeForcesGPU();
 
+    protected:
+        //!Compute the vertex forces on the CPU, reading per-cell moduli and storing the force sets only if asked to
+        template<bool perCellModuli, bool storeSets>
+        void computeVertexForcesCPU();
+
     };
 #endif
@@ -41,6 +41,7 @@ exclusions, as determined by the flags. Assumes the geometry has NOT yet been co
 */
 void VertexQuadraticEnergyWithTension::computeForces()
     {
+    PROFILE_SCOPE("VertexQuadraticEnergyWithTension::computeForces");
     if(forcesUpToDate)
        return; 
     forcesUpToDate = true;
@@ -62,8 +63,23 @@ void VertexQuadraticEnergyWithTension::computeForces()
     };
 
 /*!
-Use the data pre-computed in the geometry routine to rapidly compute the net force on each vertex...for the cpu part combine the simple and complex tension routines
+Use the data pre-computed in the geometry routine to rapidly compute the net force on each vertex...for the cpu part combine the simple and complex tension routines.
+As in VertexQuadraticEnergy, the three contributions to the force on a vertex are added as they are
+computed (in parallel over vertices), and are only kept in vertexForceSets if storeForceSets is set
 */
+void VertexQuadraticEnergyWithTension::computeVertexTensionForcesCPU()
+    {
+    if(uniformModuli)
+        computeVertexTensionForcesCPU<false>();
+    else
+        computeVertexTensionForcesCPU<true>();
+    };
+
+/*!
+The moduli are a template parameter so that the uniform case does not pay for a per-cell read of the
+Moduli array
+*/
+template<bool perCellModuli>
 void VertexQuadraticEnergyWithTension::computeVertexTensionForcesCPU()
     {
     ArrayHandle<int> h_vcn(vertexCellNeighbors,access_location::host,access_mode::read);
@@ -75,84 +91,80 @@ void VertexQuadraticEnergyWithTension::computeVertexTensionForcesCPU()
     ArrayHandle<int> h_cv(cellVertices,access_location::host, access_mode::read);
     ArrayHandle<int> h_cvn(cellVertexNum,access_location::host,access_mode::read);
     ArrayHandle<double> h_tm(tensionMatrix,access_location::host,access_mode::read);
+    ArrayHandle<double2> h_mod(Moduli,access_location::host,access_mode::read);
 
     ArrayHandle<double2> h_fs(vertexForceSets,access_location::host, access_mode::overwrite);
     ArrayHandle<double2> h_f(vertexForces,access_location::host, access_mode::overwrite);
 
-    //first, compute the contribution to the force on each vertex from each of its three cells
-    double2 vlast,vcur,vnext;
-    double2 dEdv;
-    double Adiff, Pdiff;
-    for(int fsidx = 0; fsidx < Nvertices*3; ++fsidx)
+    #pragma omp parallel for num_threads(ompThreadNum)
+    for (int vCurIdx = 0; vCurIdx < Nvertices; ++vCurIdx)
         {
-        //for the change in the energy of the cell, just repeat the vertexQuadraticEnergy part
-        int cellIdx1 = h_vcn.data[fsidx];
-        double Adiff = KA*(h_AP.data[cellIdx1].x - h_APpref.data[cellIdx1].x);
-        double Pdiff = KP*(h_AP.data[cellIdx1].y - h_APpref.data[cellIdx1].y);
-        vcur = h_vc.data[fsidx];
-        vlast.x = h_vln.data[fsidx].x;  vlast.y = h_vln.data[fsidx].y;
-        vnext.x = h_vln.data[fsidx].z;  vnext.y = h_vln.data[fsidx].w;
-
-        //computeForceSetVertexModel is defined in inc/utility/functions.h
-        computeForceSetVertexModel(vcur,vlast,vnext,Adiff,Pdiff,dEdv);
-        h_fs.data[fsidx].x = dEdv.x;
-        h_fs.data[fsidx].y = dEdv.y;
-
-        //first, determine the index of the cell other than cellIdx1 that contains both vcur and vnext
-        int cellNeighs = h_cvn.data[cellIdx1];
-        //find the index of vcur and vnext
-        int vCurIdx = fsidx/3;
-        int vNextInt = 0;
-        if (h_cv.data[n_idx(cellNeighs-1,cellIdx1)] != vCurIdx)
+        double2 vlast,vcur,vnext;
+        double2 dEdv;
+        double2 force = make_double2(0.0,0.0);
+        for (int cellOfSet = 0; cellOfSet < 3; ++cellOfSet)
             {
-            for (int nn = 0; nn < cellNeighs-1; ++nn)
+            int fsidx = 3*vCurIdx+cellOfSet;
+            //for the change in the energy of the cell, just repeat the vertexQuadraticEnergy part
+            int cellIdx1 = h_vcn.data[fsidx];
+            double ka = perCellModuli ? h_mod.data[cellIdx1].x : KA;
+            double kp = perCellModuli ? h_mod.data[cellIdx1].y : KP;
+            double Adiff = ka*(h_AP.data[cellIdx1].x - h_APpref.data[cellIdx1].x);
+            double Pdiff = kp*(h_AP.data[cellIdx1].y - h_APpref.data[cellIdx1].y);
+            vcur = h_vc.data[fsidx];
+            vlast.x = h_vln.data[fsidx].x;  vlast.y = h_vln.data[fsidx].y;
+            vnext.x = h_vln.data[fsidx].z;  vnext.y = h_vln.data[fsidx].w;
+
+            //computeForceSetVertexModel is defined in inc/utility/functions.h
+            computeForceSetVertexModel(vcur,vlast,vnext,Adiff,Pdiff,dEdv);
+
+            //first, determine the index of the cell other than cellIdx1 that contains both vcur and vnext
+            int cellNeighs = h_cvn.data[cellIdx1];
+            //find the index of vnext
+            int vNextInt = 0;
+            if (h_cv.data[n_idx(cellNeighs-1,cellIdx1)] != vCurIdx)
                 {
-                int idx = h_cv.data[n_idx(nn,cellIdx1)];
-                if (idx == vCurIdx)
-                    vNextInt = nn +1;
+                for (int nn = 0; nn < cellNeighs-1; ++nn)
+                    {
+                    int idx = h_cv.data[n_idx(nn,cellIdx1)];
+                    if (idx == vCurIdx)
+                        vNextInt = nn +1;
+                    };
                 };
-            };
-        int vNextIdx = h_cv.data[n_idx(vNextInt,cellIdx1)];
-
-        //vcur belongs to three cells... which one isn't cellIdx1 and has both vcur and vnext?
-        int cellIdx2 = 0;
-        int cellOfSet = fsidx-3*vCurIdx;
-        for (int cc = 0; cc < 3; ++cc)
-            {
-            if (cellOfSet == cc) continue;
-            int cell2 = h_vcn.data[3*vCurIdx+cc];
-            int cNeighs = h_cvn.data[cell2];
-            for (int nn = 0; nn < cNeighs; ++nn)
-                if (h_cv.data[n_idx(nn,cell2)] == vNextIdx)
-                    cellIdx2 = cell2;
-            }
-        //now, determine the types of the two relevant cells, and add an extra force if needed
-        int cellType1 = h_ct.data[cellIdx1];
-        int cellType2 = h_ct.data[cellIdx2];
-        if(cellType1 != cellType2)
-            {
-            double gammaEdge;
-            if (simpleTension)
-                gammaEdge = gamma;
-            else
-                gammaEdge = h_tm.data[cellTypeIndexer(cellType1,cellType2)];
-            double2 dnext = vcur-vnext;
-            double dnnorm = sqrt(dnext.x*dnext.x+dnext.y*dnext.y);
-            h_fs.data[fsidx].x -= gammaEdge*dnext.x/dnnorm;
-            h_fs.data[fsidx].y -= gammaEdge*dnext.y/dnnorm;
-            };
-        };
+            int vNextIdx = h_cv.data[n_idx(vNextInt,cellIdx1)];
 
-    //now sum these up to get the force on each vertex
-    for (int v = 0; v < Nvertices; ++v)
-        {
-        double2 ftemp = make_double2(0.0,0.0);
-        for (int ff = 0; ff < 3; ++ff)
-            {
-            ftemp.x += h_fs.data[3*v+ff].x;
-            ftemp.y += h_fs.data[3*v+ff].y;
+            //vcur belongs to three cells... which one isn't cellIdx1 and has both vcur and vnext?
+            int cellIdx2 = 0;
+            for (int cc = 0; cc < 3; ++cc)
+                {
+                if (cellOfSet == cc) continue;
+                int cell2 = h_vcn.data[3*vCurIdx+cc];
+                int cNeighs = h_cvn.data[cell2];
+                for (int nn = 0; nn < cNeighs; ++nn)
+                    if (h_cv.data[n_idx(nn,cell2)] == vNextIdx)
+                        cellIdx2 = cell2;
+                }
+            //now, determine the types of the two relevant cells, and add an extra force if needed
+            int cellType1 = h_ct.data[cellIdx1];
+            int cellType2 = h_ct.data[cellIdx2];
+            if(cellType1 != cellType2)
+                {
+                double gammaEdge;
+                if (simpleTension)
+                    gammaEdge = gamma;
+                else
+                    gammaEdge = h_tm.data[cellTypeIndexer(cellType1,cellType2)];
+                double2 dnext = vcur-vnext;
+                double dnnorm = sqrt(dnext.x*dnext.x+dnext.y*dnext.y);
+                dEdv.x -= gammaEdge*dnext.x/dnnorm;
+                dEdv.y -= gammaEdge*dnext.y/dnnorm;
+                };
+            if(storeForceSets)
+                h_fs.data[fsidx] = dEdv;
+            force.x += dEdv.x;
+            force.y += dEdv.y;
             };
-        h_f.data[v] = ftemp;
+        h_f.data[vCurIdx] = force;
         };
     };
 
@@ -181,6 +193,7 @@ void VertexQuadraticEnergyWithTension::computeVertexTensionForceGPU()
     ArrayHandle<double2> d_f(vertexForces,access_location::device, access_mode::overwrite);
 
     int nForceSets = Nvertices*3;
+    ArrayHandle<double2> d_mod(Moduli,access_location::device,access_mode::read);
     gpu_vertexModel_tension_force_sets(
             d_vcn.data,
             d_vc.data,
@@ -197,7 +210,8 @@ void VertexQuadraticEnergyWithTension::computeVertexTensionForceGPU()
             simpleTension,
             gamma,
             nForceSets,
-            KA,KP
+            KA,KP,
+            uniformModuli ? NULL : d_mod.data
             );
 
     gpu_avm_sum_force_sets(d_fs.data, d_f.data,Nvertices);
@@ -11,6 +11,11 @@
     @{
 */
 
+/*!
+The geometric part of the force set is as in the VertexQuadraticEnergy case, with an extra line
+tension along edges between cells of different type. d_moduli is only read if perCellModuli is true
+*/
+template<bool perCellModuli>
 __global__ void vm_tensionForceSets_kernel(
             int *vertexCellNeighbors,
             double2 *voroCur,
@@ -27,7 +32,8 @@ __global__ void vm_tensionForceSets_kernel(
             bool simpleTension,
             double gamma,
             int nForceSets,
-            double KA, double KP)
+            double KA, double KP,
+            double2 *d_moduli)
     
     {
     unsigned int fsidx = blockDim.x * blockIdx.x + threadIdx.x;
@@ -40,6 +46,11 @@ __global__ void vm_tensionForceSets_kernel(
     double2 vlast,vcur,vnext,dEdv;
 
     int cellIdx1 = vertexCellNeighbors[fsidx];
+    if(perCellModuli)
+        {
+        KA = d_moduli[cellIdx1].x;
+        KP = d_moduli[cellIdx1].y;
+        };
     double Adiff = KA*(areaPeri[cellIdx1].x - APPref[cellIdx1].x);
     double Pdiff = KP*(areaPeri[cellIdx1].y - APPref[cellIdx1].y);
     vcur = voroCur[fsidx];
@@ -112,19 +123,30 @@ bool gpu_vertexModel_tension_force_sets(
         bool simpleTension,
         double gamma,
         int nForceSets,
-        double KA, double KP)
+        double KA, double KP,
+        double2 *d_moduli)
 {
     unsigned int block_size = 128;
     if (nForceSets < 128) block_size = 32;
     unsigned int nblocks  = nForceSets/block_size + 1;
 
-    vm_tensionForceSets_kernel<<<nblocks,block_size>>>(
+    if(d_moduli == NULL)
+        vm_tensionForceSets_kernel<false><<<nblocks,block_size>>>(
+            vertexCellNeighbors,voroCur,
+            voroLastNext,areaPeri,APPref,
+            cellType,cellVertices,cellVertexNum,
+            tensionMatrix,forceSets,cellTypeIndexer,
+            n_idx,simpleTension,gamma,
+            nForceSets,KA,KP,d_moduli
+            );
+    else
+        vm_tensionForceSets_kernel<true><<<nblocks,block_size>>>(
             vertexCellNeighbors,voroCur,
             voroLastNext,areaPeri,APPref,
             cellType,cellVertices,cellVertexNum,
             tensionMatrix,forceSets,cellTypeIndexer,
             n_idx,simpleTension,gamma,
-            nForceSets,KA,KP
+            nForceSets,KA,KP,d_moduli
             );
     HANDLE_ERROR(cudaGetLastError());
     return cudaSuccess;
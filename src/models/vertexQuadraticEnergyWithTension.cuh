@@ -14,6 +14,7 @@ A file providing an interface to the relevant cuda calls for the VertexQuadratic
  * \brief CUDA kernels and callers for 2D vertex models
  */
 
+//!Compute force sets including line tensions; if d_moduli is NULL every cell uses (KA,KP)
 bool gpu_vertexModel_tension_force_sets(
             int *vertexCellNeighbors,
             double2 *voroCur,
@@ -30,6 +31,7 @@ bool gpu_vertexModel_tension_force_sets(
             bool simpleTension,
             double gamma,
             int nForceSets,
-            double KA, double KP);
+            double KA, double KP,
+            double2 *d_moduli = NULL);
 
 #endif
@@ -28,6 +28,9 @@ class VertexQuadraticEnergyWithTension : public VertexQuadraticEnergy
 
         //!Compute the net force on particle i on the CPU with multiple tension values
         virtual void computeVertexTensionForcesCPU();
+        //!Compute the net force on each vertex on the CPU, reading per-cell moduli only if perCellModuli is true
+        template<bool perCellModuli>
+        void computeVertexTensionForcesCPU();
         //!call gpu_force_sets kernel caller
         virtual void computeVertexTensionForceGPU();
 
@@ -9,7 +9,7 @@ A simple constructor that sets many of the class member variables to zero
 */
 voronoiModelBase::voronoiModelBase() :
     cellsize(1.25), timestep(0),repPerFrame(0.0),skippedFrames(0),
-    neighMax(0),neighMaxChange(false),GlobalFixes(0),globalOnly(true)
+    neighMax(0),NeighIdxNum(0),neighMaxChange(false),GlobalFixes(0),globalOnly(true)
     {
     //set cellsize to about unity...magic number should be of order 1
     //when the box area is of order N (i.e. on average one particle per bin)
@@ -35,6 +35,7 @@ void voronoiModelBase::initializeVoronoiModelBase(int n, bool gpu)
         external_forces.neverGPU = true;
         exclusions.neverGPU =true;
         NeighIdxs.neverGPU =true;
+        neighborOffsets.neverGPU =true;
         anyCircumcenterTestFailed.neverGPU =true;
         repair.neverGPU =true;
         delSets.neverGPU =true;
@@ -47,6 +48,7 @@ void voronoiModelBase::initializeVoronoiModelBase(int n, bool gpu)
     initializeSimple2DActiveCell(Ncells, gpu);
 
     NeighIdxs.resize(6*(Ncells));
+    neighborOffsets.resize(Ncells);
 
     repair.resize(Ncells);
     displacements.resize(Ncells);
@@ -98,6 +100,53 @@ void voronoiModelBase::alterBox(PeriodicBoxPtr _box)
 
     };
 /*!
+\param b11 the x-component of the first box vector
+\param b12 the x-component of the second box vector
+\param b21 the y-component of the first box vector
+\param b22 the y-component of the second box vector
+Since adding a multiple of the first box vector to the second gives the same periodic lattice, the new second
+box vector is first replaced by the equivalent one closest to the current one; the cells then keep their
+fractional coordinates, so the deformation is affine (and small, for a small change of the box). The box is
+changed in place, so every object sharing it sees the change. Finally, if the second box vector is tilted by
+more than half of the first along it, it is replaced by the equivalent one with the smallest tilt, as with
+Lees-Edwards boundary conditions, and the image counters of the cells are updated. So a steadily sheared box
+can be passed in directly, e.g. deformBox(L,gamma*L,0,L), and for small steps the triangulation is only tested
+and locally repaired, rather than rebuilt.
+*/
+void voronoiModelBase::deformBox(double b11, double b12, double b21, double b22)
+    {
+    forcesUpToDate = false;
+    double o11,o12,o21,o22;
+    Box->getBoxDims(o11,o12,o21,o22);
+    double nearest = rint(((b12-o12)*b11+(b22-o22)*b21)/(b11*b11+b21*b21));
+    b12 -= nearest*b11;
+    b22 -= nearest*b21;
+    int shift = (int)rint((b11*b12+b21*b22)/(b11*b11+b21*b21));
+    b12 -= shift*b11;
+    b22 -= shift*b21;
+    {
+    ArrayHandle<double2> h_p(cellPositions,access_location::host,access_mode::readwrite);
+    ArrayHandle<int2> h_i(cellImages,access_location::host,access_mode::readwrite);
+    periodicBoundaries newBox(b11,b12,b21,b22);
+    for (int ii = 0; ii < Ncells; ++ii)
+        {
+        double2 s;
+        Box->invTrans(h_p.data[ii],s);
+        s.x += shift*s.y;
+        h_i.data[ii].x += shift*h_i.data[ii].y;
+        newBox.Trans(s,h_p.data[ii]);
+        newBox.putInBoxReal(h_p.data[ii],h_i.data[ii]);
+        };
+    }//end array scope
+    if(b12 == 0.0 && b21 == 0.0)
+        Box->setSquare(b11,b22);
+    else
+        Box->setGeneral(b11,b12,b21,b22);
+    enforceTopology();
+    computeGeometry();
+    };
+
+/*!
 change particle positions, change the box, and reset the tesselation structures
 */
 void voronoiModelBase::setRectangularUnitCell(double Lx, double Ly)
@@ -155,24 +204,8 @@ void voronoiModelBase::movePointsCPU(GPUArray<double2> &displacements,double sca
     {
     ArrayHandle<double2> h_p(cellPositions,access_location::host,access_mode::readwrite);
     ArrayHandle<double2> h_d(displacements,access_location::host,access_mode::read);
-    if(scale == 1.)
-        {
-        for (int idx = 0; idx < Ncells; ++idx)
-            {
-            h_p.data[idx].x += h_d.data[idx].x;
-            h_p.data[idx].y += h_d.data[idx].y;
-            Box->putInBoxReal(h_p.data[idx]);
-            };
-        }
-    else
-        {
-        for (int idx = 0; idx < Ncells; ++idx)
-            {
-            h_p.data[idx].x += scale*h_d.data[idx].x;
-            h_p.data[idx].y += scale*h_d.data[idx].y;
-            Box->putInBoxReal(h_p.data[idx]);
-            };
-        }
+    ArrayHandle<int2> h_i(cellImages,access_location::host,access_mode::readwrite);
+    Box->move(h_p.data,h_d.data,h_i.data,Ncells,scale);
     };
 
 /*!
@@ -184,10 +217,8 @@ void voronoiModelBase::movePoints(GPUArray<double2> &displacements,double scale)
     {
     ArrayHandle<double2> d_p(cellPositions,access_location::device,access_mode::readwrite);
     ArrayHandle<double2> d_d(displacements,access_location::device,access_mode::readwrite);
-    if (scale == 1.)
-        gpu_move_degrees_of_freedom(d_p.data,d_d.data,Ncells,*(Box));
-    else
-        gpu_move_degrees_of_freedom(d_p.data,d_d.data,scale,Ncells,*(Box));
+    ArrayHandle<int2> d_i(cellImages,access_location::device,access_mode::readwrite);
+    gpu_move_degrees_of_freedom(d_p.data,d_d.data,d_i.data,scale,Ncells,*(Box));
 
     cudaError_t code = cudaGetLastError();
     if(code!=cudaSuccess)
@@ -205,6 +236,7 @@ Displace cells on either the GPU or CPU, according to the flag
 */
 void voronoiModelBase::moveDegreesOfFreedom(GPUArray<double2> &displacements,double scale)
     {
+    PROFILE_SCOPE("voronoiModelBase::moveDegreesOfFreedom");
     forcesUpToDate = false;
     if (GPUcompute)
         movePoints(displacements,scale);
@@ -217,7 +249,10 @@ Call the delaunayGPU class to get a complete triangulation of the current point
 */
 void voronoiModelBase::globalTriangulationDelGPU(bool verbose)
     {
+    PROFILE_SCOPE("voronoiModelBase::globalTriangulationDelGPU");
     GlobalFixes +=1;
+    if(metrics)
+        metrics->increment(globalFixesMetric);
     completeRetriangulationPerformed += 1;
     int oldNeighMax = delGPU.MaxSize;
     if(neighbors.getNumElements() != Ncells*oldNeighMax)
@@ -225,24 +260,65 @@ void voronoiModelBase::globalTriangulationDelGPU(bool verbose)
 
     delGPU.globalDelaunayTriangulation(cellPositions,neighbors,neighborNum);
 
+    //a change in neighMax only changes the stride of the neighbor list, not the compact arrays
     neighMax = delGPU.MaxSize;
-    n_idx = Index2D(neighMax,Ncells);
-    if(neighbors.getNumElements() != Ncells*neighMax)
-        neighbors.resize( Ncells*neighMax);
-    if(oldNeighMax != neighMax)
-        {
-        resizeAndReset();
-        }
     updateNeighIdxs();
+    resetLists();
     //global rescue if needed
     if(NeighIdxNum != 6* Ncells)
         {
-        cout << "attempting CGAL rescue -- inconsistent local topologies" << endl;
-        globalTriangulationCGAL();
+        cout << "attempting global CPU rescue -- inconsistent local topologies" << endl;
+        if(metrics)
+            metrics->increment(globalRescueMetric);
+        globalTriangulationCPU();
         resizeAndReset();
         }
     }
 
+/*!
+This function calls the DelaunayCPU class to determine the Delaunay triangulation of the entire
+periodic domain, writing the result directly into the neighbor lists. If that fails (which can only
+happen for degenerate point sets) and CGAL is available, the CGAL routine is used instead. In addition
+to performing a triangulation, the function also automatically calls updateNeighIdxs
+*/
+void voronoiModelBase::globalTriangulationCPU(bool verbose)
+    {
+    PROFILE_SCOPE("voronoiModelBase::globalTriangulationCPU");
+    delCPU.setBox(Box);
+    int oldNmax = neighMax;
+    if(!delCPU.globalTriangulation(cellPositions,neighbors,neighborNum,neighMax))
+        {
+#ifdef ENABLE_CGAL
+        globalTriangulationCGAL(verbose);
+        return;
+#else
+        printf("global CPU triangulation failed!\n");
+        char fn[256];
+        sprintf(fn,"failed.txt");
+        ofstream output(fn);
+        writeTriangulation(output);
+        throw std::exception();
+#endif
+        };
+    GlobalFixes +=1;
+    if(metrics)
+        metrics->increment(globalFixesMetric);
+    completeRetriangulationPerformed = 1;
+    if(neighMax != oldNmax)
+        neighMaxChange = true;
+    n_idx = Index2D(neighMax,Ncells);
+    {
+    ArrayHandle<int> h_repair(repair,access_location::host,access_mode::overwrite);
+    for(int nn = 0; nn < Ncells; ++nn)
+        h_repair.data[nn]=0;
+    }
+    updateNeighIdxs();
+    if(verbose)
+        cout << "global new Nmax = " << neighMax << "; total neighbors = " << NeighIdxNum << endl;cout.flush();
+    populateVoroCur();
+    };
+
+#ifdef ENABLE_CGAL
 /*!
 This function calls the DelaunayCGAL class to determine the Delaunay triangulation of the entire
 square periodic domain this method is, obviously, better than the version written by DMS, so
@@ -252,6 +328,8 @@ calls updateNeighIdxs
 void voronoiModelBase::globalTriangulationCGAL(bool verbose)
     {
     GlobalFixes +=1;
+    if(metrics)
+        metrics->increment(globalFixesMetric);
     completeRetriangulationPerformed = 1;
     DelaunayCGAL dcgal;
     ArrayHandle<double2> h_points(cellPositions,access_location::host, access_mode::read);
@@ -320,6 +398,8 @@ void voronoiModelBase::globalTriangulationCGAL(bool verbose)
     populateVoroCur();
     };
 
+#endif
+
 void voronoiModelBase::populateVoroCur()
     {
     if(delGPU.GPUVoroCur.getNumElements() != neighMax*Ncells)
@@ -365,25 +445,28 @@ void voronoiModelBase::populateVoroCur()
     };
 
 /*!
-\post the NeighIdx data structure is updated, which helps cut down on the number of inactive
-threads in the force set computation function
+\post the NeighIdx and neighborOffsets data structures are updated. The former helps cut down on the
+number of inactive threads in the force set computation function, the latter indexes the compact
+per-neighbor arrays, which are grown if the total number of neighbors has increased
 */
 void voronoiModelBase::updateNeighIdxs()
     {
     if (GPUcompute)
         {
         ArrayHandle<int> neighnum(neighborNum,access_location::device,access_mode::read);
-        ArrayHandle<int> neighNumScan(repair,access_location::device,access_mode::overwrite);
+        ArrayHandle<int> neighNumScan(neighborOffsets,access_location::device,access_mode::overwrite);
         ArrayHandle<int2> d_nidx(NeighIdxs,access_location::device,access_mode::overwrite);
         gpu_update_neighIdxs(neighnum.data, neighNumScan.data,d_nidx.data,NeighIdxNum,Ncells);
         }
     else
         {
         ArrayHandle<int> neighnum(neighborNum,access_location::host,access_mode::read);
+        ArrayHandle<int> h_off(neighborOffsets,access_location::host,access_mode::overwrite);
         ArrayHandle<int2> h_nidx(NeighIdxs,access_location::host,access_mode::overwrite);
         int idx = 0;
         for (int ii = 0; ii < Ncells; ++ii)
             {
+            h_off.data[ii] = idx;
             int nmax = neighnum.data[ii];
             for (int nn = 0; nn < nmax; ++nn)
                 {
@@ -394,6 +477,8 @@ void voronoiModelBase::updateNeighIdxs()
             };
         NeighIdxNum = idx;
         }
+    if(delSets.getNumElements() < (unsigned int)NeighIdxNum)
+        resetLists();
     };
 
 /*!
@@ -402,6 +487,7 @@ When sortPeriod < 0, this routine does not get called
 */
 void voronoiModelBase::spatialSorting()
     {
+    PROFILE_SCOPE("voronoiModelBase::spatialSorting");
     spatiallySortCellsAndCellActivity();
     //reTriangulate with the new ordering
     globalTriangulationDelGPU();
@@ -413,12 +499,31 @@ void voronoiModelBase::spatialSorting()
     reIndexCellArray(exclusions);
     };
 
+/*!
+Registers voronoi/globalFixes (complete re-triangulations, as counted by GlobalFixes),
+voronoi/globalRescues (fall-backs to a global CPU triangulation because local topologies were
+inconsistent) and the gauge voronoi/neighMax, and passes the registry on to delGPU, whose
+delaunay/repairedPointsPerCall histogram gives the repairs per frame and how many frames needed none
+*/
+void voronoiModelBase::setMetrics(shared_ptr<runtimeMetrics> _metrics)
+    {
+    Simple2DModel::setMetrics(_metrics);
+    delGPU.setMetrics(_metrics);
+    if(!metrics)
+        return;
+    globalFixesMetric = metrics->registerCounter("voronoi/globalFixes");
+    globalRescueMetric = metrics->registerCounter("voronoi/globalRescues");
+    neighMaxMetric = metrics->registerGauge("voronoi/neighMax");
+    metrics->setGauge(neighMaxMetric,neighMax);
+    };
+
 /*!
 goes through the process of testing and repairing the topology on either the CPU or GPU
 \post and topological changes needed by cell motion are detected and repaired
 */
 void voronoiModelBase::enforceTopology()
     {
+    PROFILE_SCOPE("voronoiModelBase::enforceTopology");
     int oldNeighMax = delGPU.MaxSize;
     if(neighbors.getNumElements() != Ncells*oldNeighMax)
         resizeAndReset();
@@ -430,17 +535,20 @@ void voronoiModelBase::enforceTopology()
     //global rescue if needed
     if(NeighIdxNum != 6* Ncells)
         {
-        cout << "attempting CGAL rescue -- inconsistent local topologies" << endl;
-        globalTriangulationCGAL();
+        cout << "attempting global CPU rescue -- inconsistent local topologies" << endl;
+        if(metrics)
+            metrics->increment(globalRescueMetric);
+        globalTriangulationCPU();
         resizeAndReset();
         }
 
+    //delGPU has already carried the neighbor list over to any new stride, so growth of neighMax is
+    //handled locally and only the indexer needs to be updated
     neighMax = delGPU.MaxSize;
     if(oldNeighMax != neighMax)
-        {
-        resizeAndReset();
-        globalTriangulationDelGPU();
-        }
+        resetLists();
+    if(metrics)
+        metrics->setGauge(neighMaxMetric,neighMax);
 
     allDelSets();
     };
@@ -490,23 +598,39 @@ void voronoiModelBase::writeTriangulation(ofstream &outfile)
 */
 void voronoiModelBase::computeGeometryCPU()
     {
+    if(Box->isBoxSquare())
+        computeGeometryCPUSpecialized<true>();
+    else
+        computeGeometryCPUSpecialized<false>();
+    };
+
+/*!
+The CPU geometry loop, with the shape of the box fixed at compile time so that the minimum-image
+displacements in the inner loop do not branch
+*/
+template<bool rectangular>
+void voronoiModelBase::computeGeometryCPUSpecialized()
+    {
+    periodicBoundaries box = *(Box);
     //read in all the data we'll need
     ArrayHandle<double2> h_p(cellPositions,access_location::host,access_mode::read);
     ArrayHandle<double2> h_AP(AreaPeri,access_location::host,access_mode::readwrite);
     ArrayHandle<int> h_nn(neighborNum,access_location::host,access_mode::read);
     ArrayHandle<int> h_n(neighbors,access_location::host,access_mode::read);
+    ArrayHandle<int> h_off(neighborOffsets,access_location::host,access_mode::read);
 
     ArrayHandle<double2> h_v(voroCur,access_location::host,access_mode::readwrite);
     ArrayHandle<double4> h_vln(voroLastNext,access_location::host,access_mode::overwrite);
 
     /*
-    gpu_compute_voronoi_geometry(h_p.data,h_AP.data,h_nn.data,h_n.data,
+    gpu_compute_voronoi_geometry(h_p.data,h_AP.data,h_nn.data,h_n.data,h_off.data,
                                  h_v.data,h_vln.data,Ncells,n_idx,*(Box),false,ompThreadNum);
     */
     for (int i = 0; i < Ncells; ++i)
         {
         //get Delaunay neighbors of the cell
         int neigh = h_nn.data[i];
+        int offset = h_off.data[i];
         vector<int> ns(neigh);
         for (int nn = 0; nn < neigh; ++nn)
             {
@@ -521,16 +645,15 @@ void voronoiModelBase::computeGeometryCPU()
         double2 rij, rik;
 
         nlastp = h_p.data[ns[ns.size()-1]];
-        Box->minDist(nlastp,pi,rij);
+        box.minDist<rectangular>(nlastp,pi,rij);
         for (int nn = 0; nn < neigh;++nn)
             {
             nnextp = h_p.data[ns[nn]];
-            Box->minDist(nnextp,pi,rik);
+            box.minDist<rectangular>(nnextp,pi,rik);
             Circumcenter(rij,rik,circumcent);
             voro[nn] = circumcent;
             rij=rik;
-            int id = n_idx(nn,i);
-            h_v.data[id] = voro[nn];
+            h_v.data[offset+nn] = voro[nn];
             };
 
         double2 vlast,vnext;
@@ -545,7 +668,7 @@ void voronoiModelBase::computeGeometryCPU()
             double dx = vlast.x-vnext.x;
             double dy = vlast.y-vnext.y;
             Vperi += sqrt(dx*dx+dy*dy);
-            int id = n_idx(nn,i);
+            int id = offset+nn;
             h_vln.data[id].x=vlast.x;
             h_vln.data[id].y=vlast.y;
             h_vln.data[id].z=vnext.x;
@@ -567,6 +690,7 @@ void voronoiModelBase::computeGeometryGPU()
     ArrayHandle<double2> d_AP(AreaPeri,access_location::device,access_mode::readwrite);
     ArrayHandle<int> d_nn(neighborNum,access_location::device,access_mode::read);
     ArrayHandle<int> d_n(neighbors,access_location::device,access_mode::read);
+    ArrayHandle<int> d_off(neighborOffsets,access_location::device,access_mode::read);
     ArrayHandle<double2> d_vc(voroCur,access_location::device,access_mode::readwrite);
     ArrayHandle<double4> d_vln(voroLastNext,access_location::device,access_mode::overwrite);
 
@@ -575,6 +699,7 @@ void voronoiModelBase::computeGeometryGPU()
                         d_AP.data,
                         d_nn.data,
                         d_n.data,
+                        d_off.data,
                         d_vc.data,
                         d_vln.data,
                         Ncells, n_idx,*(Box));
@@ -630,9 +755,11 @@ double2 voronoiModelBase::dAidrj(int i, int j)
     ArrayHandle<int> h_nn(neighborNum,access_location::host,access_mode::read);
     ArrayHandle<int> h_n(neighbors,access_location::host,access_mode::read);
     ArrayHandle<double2> h_v(voroCur,access_location::host,access_mode::readwrite);
+    ArrayHandle<int> h_off(neighborOffsets,access_location::host,access_mode::read);
 
     //how many neighbors does cell i have?
     int neigh = h_nn.data[i];
+    int offset = h_off.data[i];
     vector<int> ns(neigh);
     bool jIsANeighbor = false;
     if (j ==i) jIsANeighbor = true;
@@ -657,11 +784,11 @@ double2 voronoiModelBase::dAidrj(int i, int j)
     //if i ==j, do the loop simply
     if ( i == j)
         {
-        vlast = h_v.data[n_idx(neigh-1,i)];
+        vlast = h_v.data[offset+neigh-1];
         for (int vv = 0; vv < neigh; ++vv)
             {
-            vcur = h_v.data[n_idx(vv,i)];
-            vnext = h_v.data[n_idx((vv+1)%neigh,i)];
+            vcur = h_v.data[offset+vv];
+            vnext = h_v.data[offset+((vv+1)%neigh)];
             double2 dAdv;
             dAdv.x = -0.5*(vlast.y-vnext.y);
             dAdv.y = -0.5*(vnext.x-vlast.x);
@@ -677,11 +804,11 @@ double2 voronoiModelBase::dAidrj(int i, int j)
         };
 
     //otherwise, the interesting case
-    vlast = h_v.data[n_idx(neigh-1,i)];
+    vlast = h_v.data[offset+neigh-1];
     for (int vv = 0; vv < neigh; ++vv)
         {
-        vcur = h_v.data[n_idx(vv,i)];
-        vnext = h_v.data[n_idx((vv+1)%neigh,i)];
+        vcur = h_v.data[offset+vv];
+        vnext = h_v.data[offset+((vv+1)%neigh)];
         if(vv == n1 || vv == n2)
             {
             int indexk;
@@ -717,9 +844,11 @@ double2 voronoiModelBase::dPidrj(int i, int j)
     ArrayHandle<int> h_nn(neighborNum,access_location::host,access_mode::read);
     ArrayHandle<int> h_n(neighbors,access_location::host,access_mode::read);
     ArrayHandle<double2> h_v(voroCur,access_location::host,access_mode::readwrite);
+    ArrayHandle<int> h_off(neighborOffsets,access_location::host,access_mode::read);
 
     //how many neighbors does cell i have?
     int neigh = h_nn.data[i];
+    int offset = h_off.data[i];
     vector<int> ns(neigh);
     bool jIsANeighbor = false;
     if (j ==i) jIsANeighbor = true;
@@ -744,11 +873,11 @@ double2 voronoiModelBase::dPidrj(int i, int j)
     //if i ==j, do the loop simply
     if ( i == j)
         {
-        vlast = h_v.data[n_idx(neigh-1,i)];
+        vlast = h_v.data[offset+neigh-1];
         for (int vv = 0; vv < neigh; ++vv)
             {
-            vcur = h_v.data[n_idx(vv,i)];
-            vnext = h_v.data[n_idx((vv+1)%neigh,i)];
+            vcur = h_v.data[offset+vv];
+            vnext = h_v.data[offset+((vv+1)%neigh)];
             double2 dPdv;
             double2 dlast,dnext;
             dlast.x = vlast.x-vcur.x;
@@ -777,11 +906,11 @@ double2 voronoiModelBase::dPidrj(int i, int j)
         };
 
     //otherwise, the interesting case
-    vlast = h_v.data[n_idx(neigh-1,i)];
+    vlast = h_v.data[offset+neigh-1];
     for (int vv = 0; vv < neigh; ++vv)
         {
-        vcur = h_v.data[n_idx(vv,i)];
-        vnext = h_v.data[n_idx((vv+1)%neigh,i)];
+        vcur = h_v.data[offset+vv];
+        vnext = h_v.data[offset+((vv+1)%neigh)];
         if(vv == n1 || vv == n2)
             {
             int indexk;
@@ -926,35 +1055,45 @@ vector<double> voronoiModelBase::d2Hdridrj(double2 rj, double2 rk, int jj)
     };
 
 /*!
-As the code is modified, all GPUArrays whose size depend on neighMax should be added to this function
-\post voroCur,voroLastNext, delSets, delOther, and forceSets grow to size neighMax*Ncells
+As the code is modified, all GPUArrays whose size depend on neighMax should be added to this function.
+The per-neighbor arrays are stored compactly (see neighborOffsets), so they only depend on the
+total number of neighbors.
+\post neighbors has size neighMax*Ncells, and voroCur, voroLastNext, delSets, delOther, and
+forceSets have size max(6*Ncells,NeighIdxNum)
 */
 void voronoiModelBase::resetLists()
     {
     n_idx = Index2D(neighMax,Ncells);
-    neighbors.resize( Ncells*neighMax);
-    voroCur.resize(neighMax*Ncells);
-    voroLastNext.resize(neighMax*Ncells);
-    delSets.resize(neighMax*Ncells);
-    delOther.resize(neighMax*Ncells);
-    forceSets.resize(neighMax*Ncells);
+    if(neighbors.getNumElements() != (unsigned int)(Ncells*neighMax))
+        neighbors.resize( Ncells*neighMax);
+    int compactSize = max(6*Ncells,NeighIdxNum);
+    if(delSets.getNumElements() != (unsigned int)compactSize)
+        {
+        voroCur.resize(compactSize);
+        voroLastNext.resize(compactSize);
+        delSets.resize(compactSize);
+        delOther.resize(compactSize);
+        forceSets.resize(compactSize);
+        };
     };
 
 /*!
 \param i the cell in question
 \post the delSet and delOther data structure for cell i is updated. Recall that
-delSet.data[n_idx(nn,i)] is an int2; the x and y parts store the index of the previous and next
-Delaunay neighbor, ordered CCW. delOther contains the mutual neighbor of delSet.data[n_idx(nn,i)].y
-and delSet.data[n_idx(nn,i)].z that isn't cell i
+delSet.data[neighborOffsets.data[i]+nn] is an int2; the x and y parts store the index of the previous
+and next Delaunay neighbor, ordered CCW. delOther contains the mutual neighbor of those two points
+that isn't cell i
 */
 bool voronoiModelBase::getDelSets(int i)
     {
     ArrayHandle<int> neighnum(neighborNum,access_location::host,access_mode::read);
     ArrayHandle<int> ns(neighbors,access_location::host,access_mode::read);
+    ArrayHandle<int> h_off(neighborOffsets,access_location::host,access_mode::read);
     ArrayHandle<int2> ds(delSets,access_location::host,access_mode::readwrite);
     ArrayHandle<int> dother(delOther,access_location::host,access_mode::readwrite);
 
     int iNeighs = neighnum.data[i];
+    int offset = h_off.data[i];
     int nm2,nm1,n1,n2;
     nm2 = ns.data[n_idx(iNeighs-3,i)];
     nm1 = ns.data[n_idx(iNeighs-2,i)];
@@ -969,15 +1108,15 @@ bool voronoiModelBase::getDelSets(int i)
             int testPoint = ns.data[n_idx(nn2,n1)];
             if(testPoint == nm1)
                 {
-                dother.data[n_idx(nn,i)] = ns.data[n_idx((nn2+1)%nextNeighs,n1)];
+                dother.data[offset+nn] = ns.data[n_idx((nn2+1)%nextNeighs,n1)];
                 break;
                 };
             };
-        ds.data[n_idx(nn,i)].x= nm1;
-        ds.data[n_idx(nn,i)].y= n1;
+        ds.data[offset+nn].x= nm1;
+        ds.data[offset+nn].y= n1;
 
         //is "delOther" a copy of i or either of the delSet points? if so, the local topology is inconsistent
-        if(nm1 == dother.data[n_idx(nn,i)] || n1 == dother.data[n_idx(nn,i)] || i == dother.data[n_idx(nn,i)])
+        if(nm1 == dother.data[offset+nn] || n1 == dother.data[offset+nn] || i == dother.data[offset+nn])
             return false;
 
         nm2=nm1;
@@ -999,9 +1138,10 @@ void voronoiModelBase::allDelSets()
         {
         ArrayHandle<int> neighnum(neighborNum,access_location::device,access_mode::read);
         ArrayHandle<int> ns(neighbors,access_location::device,access_mode::read);
+        ArrayHandle<int> d_off(neighborOffsets,access_location::device,access_mode::read);
         ArrayHandle<int2> ds(delSets,access_location::device,access_mode::readwrite);
         ArrayHandle<int> dother(delOther,access_location::device,access_mode::readwrite);
-        gpu_all_del_sets(neighnum.data,ns.data,ds.data,dother.data,Ncells,n_idx);
+        gpu_all_del_sets(neighnum.data,ns.data,d_off.data,ds.data,dother.data,Ncells,n_idx);
         }
     else
         {
@@ -1023,6 +1163,7 @@ void voronoiModelBase::resizeAndReset()
     repair.resize(Ncells);
 
     neighborNum.resize(Ncells);
+    neighborOffsets.resize(Ncells);
     NeighIdxs.resize(6*(Ncells));
 
     resetLists();
@@ -1129,8 +1270,15 @@ void voronoiModelBase::cellDivision(const vector<int> &parameters, const vector<
     double maxSeparation = max(norm(p-Int1),norm(p-Int2));
     double2 newCellPos1 = initialCellPosition + separationFraction*maxSeparation*ray;
     double2 newCellPos2 = initialCellPosition - separationFraction*maxSeparation*ray;
-    Box->putInBoxReal(newCellPos1);
-    Box->putInBoxReal(newCellPos2);
+    //both daughters start from the image of the parent
+    int2 newCellImage1, newCellImage2;
+    {
+    ArrayHandle<int2> h_ci(cellImages,access_location::host,access_mode::read);
+    newCellImage1 = h_ci.data[cellIdx];
+    newCellImage2 = h_ci.data[cellIdx];
+    }
+    Box->putInBoxReal(newCellPos1,newCellImage1);
+    Box->putInBoxReal(newCellPos2,newCellImage2);
 
     //This call updates many of the base data structres, but (among other things) does not actually
     //set the new cell position
@@ -1139,6 +1287,72 @@ void voronoiModelBase::cellDivision(const vector<int> &parameters, const vector<
     ArrayHandle<double2> cp(cellPositions);
     cp.data[cellIdx] = newCellPos1;
     cp.data[Ncells-1] = newCellPos2;
+    ArrayHandle<int2> ci(cellImages);
+    ci.data[cellIdx] = newCellImage1;
+    ci.data[Ncells-1] = newCellImage2;
     }
     resizeAndReset();
     };
+
+/*!
+The triangulation itself (neighbors and neighborNum) is stored by Simple2DCell; here the compact
+per-neighbor arrays and the state of delGPU are added, so that a restored model carries on testing and
+locally repairing the same triangulation
+*/
+void voronoiModelBase::writeCheckpoint(checkpointWriter &out)
+    {
+    Simple2DActiveCell::writeCheckpoint(out);
+    out.addValue("neighMax",neighMax);
+    out.addValue("NeighIdxNum",NeighIdxNum);
+    out.addValue("GlobalFixes",GlobalFixes);
+    out.addValue("completeRetriangulationPerformed",completeRetriangulationPerformed);
+    out.addValue("timestep",timestep);
+    out.addValue("repPerFrame",repPerFrame);
+    out.addValue("skippedFrames",skippedFrames);
+    out.addValue("particleExclusions",particleExclusions);
+    out.addValue("neighMaxChange",neighMaxChange);
+    out.addArray("NeighIdxs",NeighIdxs);
+    out.addArray("neighborOffsets",neighborOffsets);
+    out.addArray("delSets",delSets);
+    out.addArray("delOther",delOther);
+    out.addArray("forceSets",forceSets);
+    out.addArray("external_forces",external_forces);
+    out.addArray("exclusions",exclusions);
+    out.addArray("repair",repair);
+    out.addArray("anyCircumcenterTestFailed",anyCircumcenterTestFailed);
+    out.addVector("NeedsFixing",NeedsFixing);
+    string prefix = out.prefix;
+    out.prefix = prefix + "delaunay/";
+    delGPU.writeCheckpoint(out);
+    out.prefix = prefix;
+    };
+
+void voronoiModelBase::readCheckpoint(checkpointReader &in)
+    {
+    Simple2DActiveCell::readCheckpoint(in);
+    in.readValue("neighMax",neighMax);
+    in.readValue("NeighIdxNum",NeighIdxNum);
+    in.readValue("GlobalFixes",GlobalFixes);
+    in.readValue("completeRetriangulationPerformed",completeRetriangulationPerformed);
+    in.readValue("timestep",timestep);
+    in.readValue("repPerFrame",repPerFrame);
+    in.readValue("skippedFrames",skippedFrames);
+    in.readValue("particleExclusions",particleExclusions);
+    in.readValue("neighMaxChange",neighMaxChange);
+    in.readArray("NeighIdxs",NeighIdxs);
+    in.readArray("neighborOffsets",neighborOffsets);
+    in.readArray("delSets",delSets);
+    in.readArray("delOther",delOther);
+    in.readArray("forceSets",forceSets);
+    in.readArray("external_forces",external_forces);
+    in.readArray("exclusions",exclusions);
+    in.readArray("repair",repair);
+    in.readArray("anyCircumcenterTestFailed",anyCircumcenterTestFailed);
+    in.readVector("NeedsFixing",NeedsFixing);
+    string prefix = in.prefix;
+    in.prefix = prefix + "delaunay/";
+    delGPU.readCheckpoint(in);
+    in.prefix = prefix;
+    if(metrics)
+        metrics->setGauge(neighMaxMetric,neighMax);
+    };
@@ -3,6 +3,7 @@
 #include "indexer.h"
 #include "periodicBoundaries.h"
 #include "functions.h"
+#include "exactPredicates.h"
 #include <iostream>
 #include <stdio.h>
 #include "voronoiModelBase.cuh"
@@ -22,6 +23,7 @@
   vertices of that triangle is empty. Use the cell list to ensure that only checks of nearby
   particles are required.
   */
+template<bool rectangular>
 __global__ void gpu_test_circumcenters_kernel(int* __restrict__ d_repair,
                                               const int3* __restrict__ d_circumcircles,
                                               const double2* __restrict__ d_pt,
@@ -33,7 +35,7 @@ __global__ void gpu_test_circumcenters_kernel(int* __restrict__ d_repair,
                                               double boxsize,
                                               periodicBoundaries Box,
                                               Index2D ci,
-                                              Index2D cli,
+                                              const int* __restrict__ d_cell_start,
                                               int *anyFail
                                               )
     {
@@ -44,30 +46,30 @@ __global__ void gpu_test_circumcenters_kernel(int* __restrict__ d_repair,
 
     //the indices of particles forming the circumcircle
     int3 i1 = d_circumcircles[idx];
-    //the vertex we will take to be the origin, and its cell position
+    //the vertex we will take to be the origin
     double2 v = d_pt[i1.x];
-    int ib=Floor(v.x/boxsize);
-    int jb=Floor(v.y/boxsize);
-
 
     double2 pt1,pt2;
-    Box.minDist(d_pt[i1.y],v,pt1);
-    Box.minDist(d_pt[i1.z],v,pt2);
+    Box.minDist<rectangular>(d_pt[i1.y],v,pt1);
+    Box.minDist<rectangular>(d_pt[i1.z],v,pt2);
 
     //get the circumcircle
     double2 Q;
     double rad;
     Circumcircle(pt1,pt2,Q,rad);
 
-    //look through cells for other particles...re-use pt1 and pt2 variables below
+    //look through the cells around the circumcenter for other particles
     bool badParticle = false;
-    int wcheck = Ceil(rad/boxsize);
-
-    if(wcheck > xsize/2) wcheck = xsize/2;
-    rad = rad*rad;
-    for (int ii = ib-wcheck; ii <= ib+wcheck; ++ii)
+    int2 cell = cellListBin(v+Q,xsize,ysize,Box);
+    int ib=cell.x;
+    int jb=cell.y;
+    int2 wcheck = cellListSearchWidth(rad,xsize,ysize,Box);
+    //a slightly generous floating-point test; candidates that pass it are decided exactly
+    rad = rad*rad*(1.0+1e-6);
+    double coordinateError = minDistError(Box);
+    for (int ii = ib-wcheck.x; ii <= ib+wcheck.x; ++ii)
         {
-        for (int jj = jb-wcheck; jj <= jb+wcheck; ++jj)
+        for (int jj = jb-wcheck.y; jj <= jb+wcheck.y; ++jj)
             {
             int cx = ii;
             if(cx < 0) cx += xsize;
@@ -80,15 +82,18 @@ __global__ void gpu_test_circumcenters_kernel(int* __restrict__ d_repair,
 
             for (int pp = 0; pp < d_cell_sizes[bin]; ++pp)
                 {
-                int newidx = d_cell_idx[cli(pp,bin)];
+                int newidx = d_cell_idx[d_cell_start[bin]+pp];
 
-                Box.minDist(d_pt[newidx],v,pt1);
-                Box.minDist(pt1,Q,pt2);
+                double2 disp, fromCenter;
+                Box.minDist<rectangular>(d_pt[newidx],v,disp);
+                Box.minDist<rectangular>(disp,Q,fromCenter);
 
                 //if it's in the circumcircle, check that its not one of the three points
-                if(pt2.x*pt2.x+pt2.y*pt2.y < rad)
+                if(fromCenter.x*fromCenter.x+fromCenter.y*fromCenter.y < rad)
                     {
-                    if (newidx != i1.x && newidx != i1.y && newidx !=i1.z)
+                    if (newidx != i1.x && newidx != i1.y && newidx !=i1.z &&
+                        periodicCircumcircleContains(make_double2(0.0,0.0),pt1,pt2,disp,i1.x,i1.y,i1.z,newidx,
+                                                     d_pt,Box,coordinateError))
                         {
                         badParticle = true;
                         d_repair[newidx] = 1;
@@ -110,11 +115,18 @@ __global__ void gpu_test_circumcenters_kernel(int* __restrict__ d_repair,
     };
 
 
+/*!
+  The circumcenters of consecutive Delaunay neighbors are the Voronoi vertices. The shape of the box is
+  a template parameter, so that in rectangular boxes the minimum-image displacements are computed
+  without any branches
+  */
+template<bool rectangular>
 __host__ __device__ void computeVoronoiGeometryFunction(int idx,
                                           const double2* __restrict__ d_points,
                                           double2* __restrict__ d_AP,
                                           const int* __restrict__ d_nn,
                                           const int* __restrict__ d_n,
+                                          const int* __restrict__ d_off,
                                           double2* __restrict__ d_vc,
                                           double4* __restrict__ d_vln,
                                           Index2D n_idx,
@@ -124,6 +136,7 @@ __host__ __device__ void computeVoronoiGeometryFunction(int idx,
     double2  nnextp, nlastp,pi,rij,rik,vlast,vnext,vfirst;
 
     int neigh = d_nn[idx];
+    int offset = d_off[idx];
     double Varea = 0.0;
     double Vperi= 0.0;
 
@@ -131,28 +144,28 @@ __host__ __device__ void computeVoronoiGeometryFunction(int idx,
     nlastp = d_points[ d_n[n_idx(neigh-1,idx)] ];
     nnextp = d_points[ d_n[n_idx(0,idx)] ];
 
-    Box.minDist(nlastp,pi,rij);
-    Box.minDist(nnextp,pi,rik);
+    Box.minDist<rectangular>(nlastp,pi,rij);
+    Box.minDist<rectangular>(nnextp,pi,rik);
     Circumcenter(rij,rik,vfirst);
     vlast = vfirst;
 
     //set the VoroCur to this voronoi vertex
     //the convention is that nn=0 in this routine should be nn = 1 in the force sets calculation
-    d_vc[n_idx(1,idx)] = vlast;
+    d_vc[offset+1] = vlast;
 
     for (int nn = 1; nn < neigh; ++nn)
         {
         rij = rik;
         int nid = d_n[n_idx(nn,idx)];
         nnextp = d_points[ nid ];
-        Box.minDist(nnextp,pi,rik);
+        Box.minDist<rectangular>(nnextp,pi,rik);
         Circumcenter(rij,rik,vnext);
 
         //fill in the VoroCur structure
 
-        int idc = n_idx(nn+1,idx);
+        int idc = offset+nn+1;
         if(nn == neigh-1)
-            idc = n_idx(0,idx);
+            idc = offset;
 
         d_vc[idc]=vnext;
 
@@ -169,15 +182,15 @@ __host__ __device__ void computeVoronoiGeometryFunction(int idx,
     Vperi += sqrt(dx*dx+dy*dy);
 
     //it's more memory-access friendly to now fill in the VoroLastNext structure separately
-    vlast = d_vc[n_idx(neigh-1,idx)];
-    vfirst = d_vc[n_idx(0,idx)];
+    vlast = d_vc[offset+neigh-1];
+    vfirst = d_vc[offset];
     for (int nn = 0; nn < neigh; ++nn)
         {
-        int idn = n_idx(nn+1,idx);
-        if(nn == neigh-1) idn = n_idx(0,idx);
+        int idn = offset+nn+1;
+        if(nn == neigh-1) idn = offset;
         vnext = d_vc[idn];
 
-        int idc = n_idx(nn,idx);
+        int idc = offset+nn;
         d_vln[idc].x = vlast.x;
         d_vln[idc].y = vlast.y;
         d_vln[idc].z = vnext.x;
@@ -195,10 +208,12 @@ __host__ __device__ void computeVoronoiGeometryFunction(int idx,
   Since the cells are guaranteed to be convex, the area of the cell is the sum of the areas of
   the triangles formed by consecutive Voronoi vertices
   */
+template<bool rectangular>
 __global__ void gpu_compute_voronoi_geometry_kernel(const double2* __restrict__ d_points,
                                           double2* __restrict__ d_AP,
                                           const int* __restrict__ d_nn,
                                           const int* __restrict__ d_n,
+                                          const int* __restrict__ d_off,
                                           double2* __restrict__ d_vc,
                                           double4* __restrict__ d_vln,
                                           int N,
@@ -210,7 +225,7 @@ __global__ void gpu_compute_voronoi_geometry_kernel(const double2* __restrict__
     unsigned int idx = blockDim.x * blockIdx.x + threadIdx.x;
     if (idx >= N)
         return;
-    computeVoronoiGeometryFunction(idx,d_points,d_AP,d_nn,d_n,d_vc,d_vln, n_idx,Box);
+    computeVoronoiGeometryFunction<rectangular>(idx,d_points,d_AP,d_nn,d_n,d_off,d_vc,d_vln, n_idx,Box);
     return;
     };
 
@@ -229,28 +244,19 @@ bool gpu_test_circumcenters(int *d_repair,
                             double boxsize,
                             periodicBoundaries &Box,
                             Index2D &ci,
-                            Index2D &cli,
+                            const int *d_cell_start,
                             int *fail)
     {
     unsigned int block_size = 128;
     if (Nccs < 128) block_size = 32;
     unsigned int nblocks  = Nccs/block_size + 1;
 
-    gpu_test_circumcenters_kernel<<<nblocks,block_size>>>(
-                            d_repair,
-                            d_ccs,
-                            d_pt,
-                            d_cell_sizes,
-                            d_idx,
-                            Nccs,
-                            xsize,
-                            ysize,
-                            boxsize,
-                            Box,
-                            ci,
-                            cli,
-                            fail
-                            );
+    if(Box.isBoxSquare())
+        gpu_test_circumcenters_kernel<true><<<nblocks,block_size>>>(d_repair,d_ccs,d_pt,d_cell_sizes,d_idx,Nccs,
+                                                                   xsize,ysize,boxsize,Box,ci,d_cell_start,fail);
+    else
+        gpu_test_circumcenters_kernel<false><<<nblocks,block_size>>>(d_repair,d_ccs,d_pt,d_cell_sizes,d_idx,Nccs,
+                                                                    xsize,ysize,boxsize,Box,ci,d_cell_start,fail);
 
     HANDLE_ERROR(cudaGetLastError());
     return cudaSuccess;
@@ -261,6 +267,7 @@ bool gpu_compute_voronoi_geometry(const double2 *d_points,
                         double2   *d_AP,
                         const int      *d_nn,
                         const int      *d_n,
+                        const int      *d_off,
                         double2 *d_vc,
                         double4 *d_vln,
                         int      N,
@@ -274,25 +281,23 @@ bool gpu_compute_voronoi_geometry(const double2 *d_points,
     if (N < 128) block_size = 32;
     unsigned int nblocks  = N/block_size + 1;
 
+    bool rectangular = Box.isBoxSquare();
     if(useGPU)
         {
-        gpu_compute_voronoi_geometry_kernel<<<nblocks,block_size>>>(                                        d_points,
-                        d_AP,
-                        d_nn,
-                        d_n,
-                        d_vc,
-                        d_vln,
-                        N,
-                        n_idx,
-                        Box
-                        );
+        if(rectangular)
+            gpu_compute_voronoi_geometry_kernel<true><<<nblocks,block_size>>>(d_points,d_AP,d_nn,d_n,d_off,
+                                                                              d_vc,d_vln,N,n_idx,Box);
+        else
+            gpu_compute_voronoi_geometry_kernel<false><<<nblocks,block_size>>>(d_points,d_AP,d_nn,d_n,d_off,
+                                                                               d_vc,d_vln,N,n_idx,Box);
         HANDLE_ERROR(cudaGetLastError());
         return cudaSuccess;
         }
+    else if(rectangular)
+        ompFunctionLoop(nThreads,N,computeVoronoiGeometryFunction<true>,d_points,d_AP,d_nn,d_n,d_off,d_vc,d_vln,n_idx,Box);
     else
-        ompFunctionLoop(nThreads,N,computeVoronoiGeometryFunction,d_points,d_AP,d_nn,d_n,d_vc,d_vln,n_idx,Box);
-        
-        
+        ompFunctionLoop(nThreads,N,computeVoronoiGeometryFunction<false>,d_points,d_AP,d_nn,d_n,d_off,d_vc,d_vln,n_idx,Box);
+
     return true;
     };
 
@@ -345,6 +350,7 @@ bool gpu_update_neighIdxs(int *neighborNum,
 
 __global__ void gpu_all_del_sets_kernel(int *neighborNum,
                       int *neighbors,
+                      int *neighborOffsets,
                       int2 *delSets,
                       int * delOther,
                       int Ncells,
@@ -355,6 +361,7 @@ __global__ void gpu_all_del_sets_kernel(int *neighborNum,
         return;
 
     int iNeighs = neighborNum[idx];
+    int offset = neighborOffsets[idx];
     int nm1,n1,n2,nextNeighs,testPoint;
     nm1 = neighbors[nIdx(iNeighs-2,idx)];
     n1 = neighbors[nIdx(iNeighs-1,idx)];
@@ -367,12 +374,12 @@ __global__ void gpu_all_del_sets_kernel(int *neighborNum,
             testPoint = neighbors[nIdx(nn2,n1)];
             if(testPoint==nm1)
                 {
-                delOther[nIdx(nn,idx)] = neighbors[nIdx((nn2+1)%nextNeighs,n1)];
+                delOther[offset+nn] = neighbors[nIdx((nn2+1)%nextNeighs,n1)];
                 break;
                 }
             }
-        delSets[nIdx(nn,idx)].x = nm1;
-        delSets[nIdx(nn,idx)].y = n1;
+        delSets[offset+nn].x = nm1;
+        delSets[offset+nn].y = n1;
 
         nm1=n1;
         n1=n2;
@@ -381,6 +388,7 @@ __global__ void gpu_all_del_sets_kernel(int *neighborNum,
 
 bool gpu_all_del_sets(int *neighborNum,
                       int *neighbors,
+                      int *neighborOffsets,
                       int2 *delSets,
                       int * delOther,
                       int Ncells,
@@ -390,7 +398,7 @@ bool gpu_all_del_sets(int *neighborNum,
     if (Ncells < 128) block_size = 32;
     unsigned int nblocks  = Ncells/block_size + 1;
 
-    gpu_all_del_sets_kernel<<<nblocks,block_size>>>(neighborNum,neighbors,delSets,delOther, Ncells,nIdx);
+    gpu_all_del_sets_kernel<<<nblocks,block_size>>>(neighborNum,neighbors,neighborOffsets,delSets,delOther, Ncells,nIdx);
 
     HANDLE_ERROR(cudaGetLastError());
     return cudaSuccess;
@@ -16,7 +16,7 @@ A file providing an interface to the relevant cuda calls for the base voronoi mo
  * \brief CUDA kernels and callers for the voronoiModelBase class
  */
 
-//!update NeighIdx data structure on the gpu
+//!update NeighIdx data structure, and the neighbor offsets (neighNumScan), on the gpu
 bool gpu_update_neighIdxs(int *neighborNum,
                           int *neighNumScan,
                           int2 *neighIdxs,
@@ -25,6 +25,7 @@ bool gpu_update_neighIdxs(int *neighborNum,
 //!update delSets structures on the GPU
 bool gpu_all_del_sets(int *neighborNum,
                       int *neighbors,
+                      int *neighborOffsets,
                       int2 *delSets,
                       int * delOther,
                       int Ncells,
@@ -44,7 +45,7 @@ bool gpu_test_circumcenters(
                             double boxsize,
                             periodicBoundaries &Box,
                             Index2D &ci,
-                            Index2D &cli,
+                            const int *d_cell_start,
                             int *fail
                             );
 
@@ -54,6 +55,7 @@ bool gpu_compute_voronoi_geometry(
                     double2 *d_AP,
                     const int    *d_nn,
                     const int    *d_n,
+                    const int    *d_off,
                     double2 *d_vc,
                     double4 *d_vln,
                     int    N,
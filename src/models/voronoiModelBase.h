@@ -4,7 +4,10 @@
 #include "Simple2DActiveCell.h"
 #include "cellListGPU.cuh"
 #include "cellListGPU.h"
+#ifdef ENABLE_CGAL
 #include "DelaunayCGAL.h"
+#endif
+#include "DelaunayCPU.h"
 #include "DelaunayGPU.h"
 #include "structures.h"
 #include "voronoiModelBase.cuh"
@@ -54,6 +57,8 @@ class voronoiModelBase : public Simple2DActiveCell
         void setExclusions(vector<int> &exes);
         //!set a new simulation box, update the positions of cells based on virtual positions, and then recompute the geometry
         void alterBox(PeriodicBoxPtr _box);
+        //!Affinely deform the box (and the cells with it) to a new box matrix, repairing the triangulation locally
+        void deformBox(double b11, double b12, double b21, double b22);
 
         //virtual functions that need to be implemented
         //!In voronoi models the number of degrees of freedom is the number of cells
@@ -62,12 +67,14 @@ class voronoiModelBase : public Simple2DActiveCell
         //!moveDegrees of Freedom calls either the move points or move points CPU routines
         virtual void moveDegreesOfFreedom(GPUArray<double2> & displacements,double scale = 1.);
         //!return the forces
-        virtual void getForces(GPUArray<double2> &forces){forces = cellForces;};
+        virtual void getForces(GPUArray<double2> &forces){forces.copyFrom(cellForces);};
         //!return a reference to the GPUArray of the current forces
         virtual GPUArray<double2> & returnForces(){return cellForces;};
 
         //!Compute cell geometry on the CPU
         virtual void computeGeometryCPU();
+        //!Compute cell geometry on the CPU in a box known to be rectangular (or not) at compile time
+        template<bool rectangular> void computeGeometryCPUSpecialized();
         //!call gpu_compute_geometry kernel caller
         virtual void computeGeometryGPU();
 
@@ -87,28 +94,38 @@ class voronoiModelBase : public Simple2DActiveCell
         //!update the NieghIdxs data structure
         void updateNeighIdxs();
         //set number of threads
-        virtual void setOmpThreads(int _number){ompThreadNum = _number;delGPU.setOmpThreads(_number);};
+        virtual void setOmpThreads(int _number){ompThreadNum = _number;delGPU.setOmpThreads(_number);delCPU.setOmpThreads(_number);};
+        //!Report global re-triangulations, rescues and the triangulation's own events to a metrics registry
+        virtual void setMetrics(shared_ptr<runtimeMetrics> _metrics);
+        //!Add the triangulation and the per-neighbor arrays (including those of delGPU) to the checkpoint
+        virtual void writeCheckpoint(checkpointWriter &out);
+        //!Restore a state written by writeCheckpoint, without re-triangulating
+        virtual void readCheckpoint(checkpointReader &in);
 
     //protected functions
     protected:
         //!sort points along a Hilbert curve for data locality
         void spatialSorting();
 
+        //!Globally construct the triangulation with the native, multithreaded CPU routine (falling back on CGAL if it is available)
+        void globalTriangulationCPU(bool verbose = false);
+#ifdef ENABLE_CGAL
         //!Globally construct the triangulation via CGAL
         void globalTriangulationCGAL(bool verbose = false);
+#endif
         //!Globally construct the triangulation via DelGPU
         void globalTriangulationDelGPU(bool verbose = false);
 
         //!repair any problems with the triangulation on the CPU
         void repairTriangulation(vector<int> &fixlist);
-        //! after a CGAL triangulation, need to populate delGPU's voroCur structure in order for compute geometry to work
+        //! after a CPU triangulation, need to populate delGPU's voroCur structure in order for compute geometry to work
         void populateVoroCur();
         //! call getDelSets for all particles
         void allDelSets();
 
         //! Maintain the delSets and delOther data structure for particle i
         bool getDelSets(int i);
-        //!resize all neighMax-related arrays
+        //!resize the neighbor list to the current neighMax, and the compact per-neighbor arrays to the current number of neighbors
         void resetLists();
         //!do resize and resetting operations common to cellDivision and cellDeath
         void resizeAndReset();
@@ -131,6 +148,8 @@ class voronoiModelBase : public Simple2DActiveCell
     public:
         //!The class' local Delaunay tester/updater
         DelaunayGPU delGPU;
+        //!The native CPU builder of complete triangulations, used when the local routines fail
+        DelaunayCPU delCPU;
 
         //!Collect statistics of how many triangulation repairs are done per frame, etc.
         double repPerFrame;
@@ -144,6 +163,8 @@ class voronoiModelBase : public Simple2DActiveCell
         GPUArray<int> exclusions;
 
     protected:
+        //!ids of the reported metrics
+        int globalFixesMetric, globalRescueMetric, neighMaxMetric;
         //!The size of the cell list's underlying grid
         double cellsize;            
         //!An upper bound for the maximum number of neighbors that any cell has
@@ -154,6 +175,15 @@ class voronoiModelBase : public Simple2DActiveCell
         GPUArray<int2> NeighIdxs;
         //!A utility integer to help with NeighIdxs
         int NeighIdxNum;
+        //!neighborOffsets.data[i] is the position of the first entry of cell i in the compact per-neighbor arrays
+        /*!
+        delSets, delOther, forceSets, voroCur, and voroLastNext store the entries of cell i contiguously
+        starting at neighborOffsets.data[i] (an exclusive scan of neighborNum), so that their total size is
+        NeighIdxNum (6*Ncells for a periodic triangulation) rather than neighMax*Ncells. Entry k of these
+        arrays corresponds to NeighIdxs.data[k]. Only the neighbors list itself is still padded to neighMax
+        (and read through n_idx), since it is the output format of DelaunayGPU and DelaunayCPU.
+        */
+        GPUArray<int> neighborOffsets;
 
         //!A flag that can be accessed by child classes... serves as notification that any change in the network topology has occured
         GPUArray<int> anyCircumcenterTestFailed;
@@ -179,19 +209,20 @@ class voronoiModelBase : public Simple2DActiveCell
         //!A flag that notifies the existence of any particle exclusions (for which the net force is set to zero by fictitious external forces)
         bool particleExclusions;
 
-        //!delSet.data[n_idx(nn,i)] are the previous and next consecutive delaunay neighbors
+        //!delSet.data[neighborOffsets.data[i]+nn] are the previous and next consecutive delaunay neighbors
         /*! These are orientationally ordered, of point i (for use in computing forces on GPU)
         */
         GPUArray<int2> delSets;
-        //!delOther.data[n_idx(nn,i)] contains the index of the "other" delaunay neighbor.
+        //!delOther.data[neighborOffsets.data[i]+nn] contains the index of the "other" delaunay neighbor.
         /*!
-        i.e., the mutual neighbor of delSet.data[n_idx(nn,i)].y and delSet.data[n_idx(nn,i)].z that isn't point i
+        i.e., the mutual neighbor of the two delSet points of that entry that isn't point i
         */
         GPUArray<int> delOther;
 
         //!In GPU mode, interactions are computed "per voronoi vertex"...forceSets are summed up to get total force on a particle
         GPUArray<double2> forceSets;
     friend class simpleVoronoiDatabase;
+    friend class mappedTrajectoryDatabase;
     };
 
 #endif
@@ -54,6 +54,7 @@ exclusions, as determined by the flags. Assumes the geometry has NOT yet been co
 */
 void VoronoiQuadraticEnergy::computeForces()
     {
+    PROFILE_SCOPE("VoronoiQuadraticEnergy::computeForces");
     if(forcesUpToDate)
        return; 
     forcesUpToDate = true;
@@ -65,8 +66,12 @@ void VoronoiQuadraticEnergy::computeForces()
         }
     else
         {
-        for (int ii = 0; ii < Ncells; ++ii)
-            computeVoronoiForceCPU(ii);
+        if(uniformModuli)
+            for (int ii = 0; ii < Ncells; ++ii)
+                computeVoronoiForceCPU<false>(ii);
+        else
+            for (int ii = 0; ii < Ncells; ++ii)
+                computeVoronoiForceCPU<true>(ii);
         };
     };
 
@@ -100,6 +105,7 @@ void VoronoiQuadraticEnergy::sumForceSets()
     {
 
     ArrayHandle<int> d_nn(neighborNum,access_location::device,access_mode::read);
+    ArrayHandle<int> d_off(neighborOffsets,access_location::device,access_mode::read);
     ArrayHandle<double2> d_forceSets(forceSets,access_location::device,access_mode::read);
     ArrayHandle<double2> d_forces(cellForces,access_location::device,access_mode::overwrite);
 
@@ -107,7 +113,8 @@ void VoronoiQuadraticEnergy::sumForceSets()
                     d_forceSets.data,
                     d_forces.data,
                     d_nn.data,
-                    Ncells,n_idx);
+                    d_off.data,
+                    Ncells);
     };
 
 /*!
@@ -118,6 +125,7 @@ void VoronoiQuadraticEnergy::sumForceSetsWithExclusions()
     {
 
     ArrayHandle<int> d_nn(neighborNum,access_location::device,access_mode::read);
+    ArrayHandle<int> d_off(neighborOffsets,access_location::device,access_mode::read);
     ArrayHandle<double2> d_forceSets(forceSets,access_location::device,access_mode::read);
     ArrayHandle<double2> d_forces(cellForces,access_location::device,access_mode::overwrite);
     ArrayHandle<double2> d_external_forces(external_forces,access_location::device,access_mode::overwrite);
@@ -129,7 +137,8 @@ void VoronoiQuadraticEnergy::sumForceSetsWithExclusions()
                     d_external_forces.data,
                     d_exes.data,
                     d_nn.data,
-                    Ncells,n_idx);
+                    d_off.data,
+                    Ncells);
     };
 
 /*!
@@ -148,7 +157,24 @@ void VoronoiQuadraticEnergy::computeVoronoiForceSetsGPU()
     ArrayHandle<double2> d_vc(voroCur,access_location::device,access_mode::read);
     ArrayHandle<double4> d_vln(voroLastNext,access_location::device,access_mode::read);
 
-    gpu_force_sets(
+    if(uniformModuli)
+        gpu_force_sets(
+                    d_p.data,
+                    d_AP.data,
+                    d_APpref.data,
+                    d_delSets.data,
+                    d_delOther.data,
+                    d_vc.data,
+                    d_vln.data,
+                    d_forceSets.data,
+                    d_nidx.data,
+                    KA,
+                    KP,
+                    NeighIdxNum,*(Box));
+    else
+        {
+        ArrayHandle<double2> d_mod(Moduli,access_location::device,access_mode::read);
+        gpu_force_sets(
                     d_p.data,
                     d_AP.data,
                     d_APpref.data,
@@ -160,13 +186,30 @@ void VoronoiQuadraticEnergy::computeVoronoiForceSetsGPU()
                     d_nidx.data,
                     KA,
                     KP,
-                    NeighIdxNum,n_idx,*(Box));
+                    NeighIdxNum,*(Box),
+                    d_mod.data);
+        };
     };
 
 /*!
 \param i The particle index for which to compute the net force, assuming addition tension terms between unlike particles
 \post the net force on cell i is computed
 */
+void VoronoiQuadraticEnergy::computeVoronoiForceCPU(int i)
+    {
+    if(uniformModuli)
+        computeVoronoiForceCPU<false>(i);
+    else
+        computeVoronoiForceCPU<true>(i);
+    };
+
+/*!
+\param i The particle index for which to compute the net force
+\post the net force on cell i is computed
+The moduli are a template parameter so that the uniform case does not pay for per-cell reads of the
+Moduli array
+*/
+template<bool perCellModuli>
 void VoronoiQuadraticEnergy::computeVoronoiForceCPU(int i)
     {
     double Pthreshold = THRESHOLD;
@@ -177,9 +220,11 @@ void VoronoiQuadraticEnergy::computeVoronoiForceCPU(int i)
     ArrayHandle<double2> h_AP(AreaPeri,access_location::host,access_mode::read);
     ArrayHandle<double2> h_APpref(AreaPeriPreferences,access_location::host,access_mode::read);
     ArrayHandle<double2> h_v(voroCur,access_location::host,access_mode::read);
+    ArrayHandle<double2> h_mod(Moduli,access_location::host,access_mode::read);
 
     ArrayHandle<int> h_nn(neighborNum,access_location::host,access_mode::read);
     ArrayHandle<int> h_n(neighbors,access_location::host,access_mode::read);
+    ArrayHandle<int> h_off(neighborOffsets,access_location::host,access_mode::read);
 
     ArrayHandle<double2> h_external_forces(external_forces,access_location::host,access_mode::overwrite);
     ArrayHandle<int> h_exes(exclusions,access_location::host,access_mode::read);
@@ -206,7 +251,7 @@ void VoronoiQuadraticEnergy::computeVoronoiForceCPU(int i)
     Box->minDist(nlastp,pi,rij);
     for (int nn = 0; nn < neigh;++nn)
         {
-        int id = n_idx(nn,i);
+        int id = h_off.data[i]+nn;
         nnextp = h_p.data[ns[nn]];
         Box->minDist(nnextp,pi,rik);
         voro[nn] = h_v.data[id];
@@ -242,8 +287,10 @@ void VoronoiQuadraticEnergy::computeVoronoiForceCPU(int i)
     double2 forceSum;
     forceSum.x=0.0;forceSum.y=0.0;
 
-    double Adiff = KA*(h_AP.data[i].x - h_APpref.data[i].x);
-    double Pdiff = KP*(h_AP.data[i].y - h_APpref.data[i].y);
+    double2 uniformKAKP = make_double2(KA,KP);
+    double2 moduli = perCellModuli ? h_mod.data[i] : uniformKAKP;
+    double Adiff = moduli.x*(h_AP.data[i].x - h_APpref.data[i].x);
+    double Pdiff = moduli.y*(h_AP.data[i].y - h_APpref.data[i].y);
 
     double2 vcur;
     vlast = voro[neigh-1];
@@ -304,10 +351,12 @@ void VoronoiQuadraticEnergy::computeVoronoiForceCPU(int i)
 
         Circumcenter(r1,r2,r3,vother);
 
-        double Akdiff = KA*(h_AP.data[baseNeigh].x  - h_APpref.data[baseNeigh].x);
-        double Pkdiff = KP*(h_AP.data[baseNeigh].y  - h_APpref.data[baseNeigh].y);
-        double Ajdiff = KA*(h_AP.data[otherNeigh].x - h_APpref.data[otherNeigh].x);
-        double Pjdiff = KP*(h_AP.data[otherNeigh].y - h_APpref.data[otherNeigh].y);
+        double2 modulik = perCellModuli ? h_mod.data[baseNeigh] : uniformKAKP;
+        double2 modulij = perCellModuli ? h_mod.data[otherNeigh] : uniformKAKP;
+        double Akdiff = modulik.x*(h_AP.data[baseNeigh].x  - h_APpref.data[baseNeigh].x);
+        double Pkdiff = modulik.y*(h_AP.data[baseNeigh].y  - h_APpref.data[baseNeigh].y);
+        double Ajdiff = modulij.x*(h_AP.data[otherNeigh].x - h_APpref.data[otherNeigh].x);
+        double Pjdiff = modulij.y*(h_AP.data[otherNeigh].y - h_APpref.data[otherNeigh].y);
 
         double2 dAkdv,dPkdv;
         dAkdv.x = 0.5*(vnext.y-vother.y);
@@ -375,9 +424,12 @@ void VoronoiQuadraticEnergy::computeVoronoiForceCPU(int i)
         }
     };
 
+template void VoronoiQuadraticEnergy::computeVoronoiForceCPU<false>(int i);
+template void VoronoiQuadraticEnergy::computeVoronoiForceCPU<true>(int i);
+
 /*!
 Returns the quadratic energy functional:
-E = \sum_{cells} K_A(A_i-A_i,0)^2 + K_P(P_i-P_i,0)^2
+E = \sum_{cells} K_{A,i}(A_i-A_i,0)^2 + K_{P,i}(P_i-P_i,0)^2
 */
 double VoronoiQuadraticEnergy::computeEnergy()
     {
@@ -385,11 +437,14 @@ double VoronoiQuadraticEnergy::computeEnergy()
         computeForces();
     ArrayHandle<double2> h_AP(AreaPeri,access_location::host,access_mode::read);
     ArrayHandle<double2> h_APP(AreaPeriPreferences,access_location::host,access_mode::read);
+    ArrayHandle<double2> h_mod(Moduli,access_location::host,access_mode::read);
     Energy = 0.0;
     for (int nn = 0; nn  < Ncells; ++nn)
         {
-        Energy += KA * (h_AP.data[nn].x-h_APP.data[nn].x)*(h_AP.data[nn].x-h_APP.data[nn].x);
-        Energy += KP * (h_AP.data[nn].y-h_APP.data[nn].y)*(h_AP.data[nn].y-h_APP.data[nn].y);
+        double ka = uniformModuli ? KA : h_mod.data[nn].x;
+        double kp = uniformModuli ? KP : h_mod.data[nn].y;
+        Energy += ka * (h_AP.data[nn].x-h_APP.data[nn].x)*(h_AP.data[nn].x-h_APP.data[nn].x);
+        Energy += kp * (h_AP.data[nn].y-h_APP.data[nn].y)*(h_AP.data[nn].y-h_APP.data[nn].y);
         };
     return Energy;
     };
@@ -427,8 +482,10 @@ double VoronoiQuadraticEnergy::getSigmaXY()
     ArrayHandle<double4> h_vln(voroLastNext,access_location::host,access_mode::read);
     ArrayHandle<int> h_nn(neighborNum,access_location::host,access_mode::read);
     ArrayHandle<int> h_n(neighbors,access_location::host,access_mode::read);
+    ArrayHandle<int> h_off(neighborOffsets,access_location::host,access_mode::read);
     ArrayHandle<double2> h_AP(AreaPeri,access_location::host,access_mode::read);
     ArrayHandle<double2> h_APpref(AreaPeriPreferences,access_location::host,access_mode::read);
+    ArrayHandle<double2> h_mod(Moduli,access_location::host,access_mode::read);
 
     //compute the contribution from each cell
     for (int i = 0; i < Ncells; ++i)
@@ -436,6 +493,7 @@ double VoronoiQuadraticEnergy::getSigmaXY()
         double2 pi = h_p.data[i];
         //get Delaunay neighbors of the cell
         int neigh = h_nn.data[i];
+        int offset = h_off.data[i];
         vector<int> ns(neigh);
         vector<double2> voro(neigh);
         vector<double2> voroLast(neigh);
@@ -443,15 +501,15 @@ double VoronoiQuadraticEnergy::getSigmaXY()
         for (int nn = 0; nn < neigh; ++nn)
             {
             //There is an indexing offset in the relevant voroCur, LastNext data structures between GPU and CPU
-            int id = n_idx(nn,i);
-            ns[nn]=h_n.data[id];
+            ns[nn]=h_n.data[n_idx(nn,i)];
+            int id = offset+nn;
             int newIndex = nn;
             if(GPUcompute)
                 {
                 newIndex = nn+1;
                 if(newIndex == neigh)
                     newIndex = 0;
-                id =n_idx(newIndex,i);
+                id = offset+newIndex;
                 }
 
             voro[nn] = h_v.data[id];
@@ -465,7 +523,7 @@ double VoronoiQuadraticEnergy::getSigmaXY()
             int newIndex = nn + loopOffset;
             if(newIndex == neigh)
                 newIndex = 0;
-            int id = n_idx(newIndex,i);
+            int id = offset+newIndex;
 
             if(!GPUcompute)
                 {
@@ -481,9 +539,9 @@ double VoronoiQuadraticEnergy::getSigmaXY()
                 voroLast[nn].y = h_vln.data[id].y;
                 int id2;
                 if (newIndex+1 == neigh)
-                    id2 = n_idx(0,i);
+                    id2 = offset;
                 else
-                    id2 = n_idx(newIndex+1,i);
+                    id2 = offset+newIndex+1;
                 voroNext[nn].x = h_vln.data[id].z;
                 voroNext[nn].y = h_vln.data[id].w;
                 };
@@ -494,8 +552,8 @@ double VoronoiQuadraticEnergy::getSigmaXY()
         double2 vlast,vnext,vcur;
         nlastp = h_p.data[ns[neigh-1]];
         Box->minDist(nlastp,pi,rij);
-        double Adiff = KA*(h_AP.data[i].x - h_APpref.data[i].x);
-        double Pdiff = KP*(h_AP.data[i].y - h_APpref.data[i].y);
+        double Adiff = (uniformModuli ? KA : h_mod.data[i].x)*(h_AP.data[i].x - h_APpref.data[i].x);
+        double Pdiff = (uniformModuli ? KP : h_mod.data[i].y)*(h_AP.data[i].y - h_APpref.data[i].y);
         double dAdg = 0.0;
         double dPdg = 0.0;
         vlast = voro[neigh-1];
@@ -682,11 +740,15 @@ Matrix2x2 VoronoiQuadraticEnergy::d2Edridrj(int i, int j, neighborType neighbor,
     ArrayHandle<int> h_nn(neighborNum,access_location::host,access_mode::read);
     ArrayHandle<int> h_n(neighbors,access_location::host,access_mode::read);
     ArrayHandle<double2> h_v(voroCur,access_location::host,access_mode::readwrite);
+    ArrayHandle<int> h_off(neighborOffsets,access_location::host,access_mode::read);
     ArrayHandle<double2> h_AP(AreaPeri,access_location::host,access_mode::read);
     ArrayHandle<double2> h_APpref(AreaPeriPreferences,access_location::host,access_mode::read);
+    ArrayHandle<double2> h_mod(Moduli,access_location::host,access_mode::read);
+    double2 uniformKAKP = make_double2(KA,KP);
 
     //how many neighbors does cell i have?
     int neigh = h_nn.data[i];
+    int offset = h_off.data[i];
     vector<int> ns(neigh);
     for (int nn = 0; nn < neigh; ++nn)
         {
@@ -699,9 +761,10 @@ Matrix2x2 VoronoiQuadraticEnergy::d2Edridrj(int i, int j, neighborType neighbor,
     int cellG, cellB,cellGp1,cellBm1;
     cellB = ns[neigh-1];
     cellBm1 = ns[neigh-2];
-    vlast = h_v.data[n_idx(neigh-1,i)];
-    double dEdA = 2*KA*(h_AP.data[i].x - h_APpref.data[i].x);
-    double dEdP = 2*KP*(h_AP.data[i].y - h_APpref.data[i].y);
+    vlast = h_v.data[offset+neigh-1];
+    double2 moduliI = uniformModuli ? uniformKAKP : h_mod.data[i];
+    double dEdA = 2*moduliI.x*(h_AP.data[i].x - h_APpref.data[i].x);
+    double dEdP = 2*moduliI.y*(h_AP.data[i].y - h_APpref.data[i].y);
     double2 dAadrj = dAidrj(i,j);
     double2 dPadrj = dPidrj(i,j);
 
@@ -709,8 +772,8 @@ Matrix2x2 VoronoiQuadraticEnergy::d2Edridrj(int i, int j, neighborType neighbor,
     double area = 1.0;
     double peri = 1.0;
 
-    answer += area*unstress*2.0*KA*dyad(dAidrj(i,i),dAadrj);
-    answer += peri*unstress*2.0*KP*dyad(dPidrj(i,i),dPadrj);
+    answer += area*unstress*2.0*moduliI.x*dyad(dAidrj(i,i),dAadrj);
+    answer += peri*unstress*2.0*moduliI.y*dyad(dPidrj(i,i),dPadrj);
     for (int vv = 0; vv < neigh; ++vv)
         {
         cellG = ns[vv];
@@ -741,8 +804,8 @@ Matrix2x2 VoronoiQuadraticEnergy::d2Edridrj(int i, int j, neighborType neighbor,
         double2 vother;
         Circumcenter(rB,rG,rD,vother);
 
-        vcur = h_v.data[n_idx(vv,i)];
-        vnext = h_v.data[n_idx((vv+1)%neigh,i)];
+        vcur = h_v.data[offset+vv];
+        vnext = h_v.data[offset+(vv+1)%neigh];
 
         Matrix2x2 dvidri = dHdri(h_p.data[i],h_p.data[cellB],h_p.data[cellG]);
         Matrix2x2 dvidrj(0.0,0.0,0.0,0.0);
@@ -838,15 +901,16 @@ Matrix2x2 VoronoiQuadraticEnergy::d2Edridrj(int i, int j, neighborType neighbor,
         //now we compute terms related to cells gamma and beta
 
         //cell gamma terms
-        double dEGdP = 2.0*KP*(h_AP.data[cellG].y - h_APpref.data[cellG].y);
-        double dEGdA = 2.0*KA*(h_AP.data[cellG].x  - h_APpref.data[cellG].x);
+        double2 moduliG = uniformModuli ? uniformKAKP : h_mod.data[cellG];
+        double dEGdP = 2.0*moduliG.y*(h_AP.data[cellG].y - h_APpref.data[cellG].y);
+        double dEGdA = 2.0*moduliG.x*(h_AP.data[cellG].x  - h_APpref.data[cellG].x);
         //area part
         double2 dAGdv;
         dAGdv.x = -0.5*(vnext.y-vother.y);
         dAGdv.y = -0.5*(vother.x-vnext.x);
         double2 dAGdrj = dAidrj(cellG,j);
         //first term
-        answer += area*unstress*2.*KA*dyad(dAGdv*dvidri,dAGdrj);
+        answer += area*unstress*2.*moduliG.x*dyad(dAGdv*dvidri,dAGdrj);
         //second term
         d2Advidrj=d2Areadvdr(dvodrj,dvip1drj);
         tempMatrix=d2Advidrj*dvidri;
@@ -873,7 +937,7 @@ Matrix2x2 VoronoiQuadraticEnergy::d2Edridrj(int i, int j, neighborType neighbor,
 
         //first term
         double2 dPGdrj = dPidrj(cellG,j);
-        answer += peri*unstress*2.*KP*dyad(dPGdv*dvidri,dPGdrj);
+        answer += peri*unstress*2.*moduliG.y*dyad(dPGdv*dvidri,dPGdrj);
         //second term
         d2Pdvidrj = d2Peridvdr(dvidrj,dvip1drj,dvodrj,vnext,vcur,vother);
         tempMatrix=d2Pdvidrj*dvidri;
@@ -887,8 +951,9 @@ Matrix2x2 VoronoiQuadraticEnergy::d2Edridrj(int i, int j, neighborType neighbor,
         answer += peri*stress*dEGdP*tempMatrix;
 
         //cell beta terms
-        double dEBdP = 2.0*KP*(h_AP.data[cellB].y - h_APpref.data[cellB].y);
-        double dEBdA = 2.0*KA*(h_AP.data[cellB].x - h_APpref.data[cellB].x);
+        double2 moduliB = uniformModuli ? uniformKAKP : h_mod.data[cellB];
+        double dEBdP = 2.0*moduliB.y*(h_AP.data[cellB].y - h_APpref.data[cellB].y);
+        double dEBdA = 2.0*moduliB.x*(h_AP.data[cellB].x - h_APpref.data[cellB].x);
         //
         //area terms
         double2 dABdv;
@@ -897,7 +962,7 @@ Matrix2x2 VoronoiQuadraticEnergy::d2Edridrj(int i, int j, neighborType neighbor,
         double2 dABdrj = dAidrj(cellB,j);
 
         //first term
-        answer += area*unstress*2.*KA*dyad(dABdv*dvidri,dABdrj);
+        answer += area*unstress*2.*moduliB.x*dyad(dABdv*dvidri,dABdrj);
         //second term
         d2Advidrj=d2Areadvdr(dvim1drj,dvodrj);
         tempMatrix=d2Advidrj*dvidri;
@@ -924,7 +989,7 @@ Matrix2x2 VoronoiQuadraticEnergy::d2Edridrj(int i, int j, neighborType neighbor,
 
         //first term
         double2 dPBdrj = dPidrj(cellB,j);
-        answer += peri*unstress*2.*KP*dyad(dPBdv*dvidri,dPBdrj);
+        answer += peri*unstress*2.*moduliB.y*dyad(dPBdv*dvidri,dPBdrj);
         //second term
         d2Pdvidrj = d2Peridvdr(dvidrj,dvodrj,dvim1drj,vother,vcur,vlast);
         tempMatrix=d2Pdvidrj*dvidri;
@@ -27,8 +27,8 @@
 __global__ void gpu_sum_forces_kernel(const double2* __restrict__ d_forceSets,
                                       double2* __restrict__ d_forces,
                                       const int* __restrict__      d_nn,
-                                      int     N,
-                                      Index2D n_idx
+                                      const int* __restrict__      d_off,
+                                      int     N
                                      )
     {
     // read in the particle that belongs to this thread
@@ -37,11 +37,12 @@ __global__ void gpu_sum_forces_kernel(const double2* __restrict__ d_forceSets,
         return;
 
     int neigh = d_nn[idx];
+    int offset = d_off[idx];
     double2 temp;
     temp.x=0.0;temp.y=0.0;
     for (int nn = 0; nn < neigh; ++nn)
         {
-        double2 val = d_forceSets[n_idx(nn,idx)];
+        double2 val = d_forceSets[offset+nn];
         temp.x+=val.x;
         temp.y+=val.y;
         };
@@ -58,8 +59,8 @@ __global__ void gpu_sum_forces_with_exclusions_kernel(const double2* __restrict_
                                       double2* __restrict__ d_external_forces,
                                       const int* __restrict__ d_exes,
                                       const int* __restrict__ d_nn,
-                                      int     N,
-                                      Index2D n_idx
+                                      const int* __restrict__ d_off,
+                                      int     N
                                      )
     {
     // read in the particle that belongs to this thread
@@ -68,11 +69,12 @@ __global__ void gpu_sum_forces_with_exclusions_kernel(const double2* __restrict_
         return;
 
     int neigh = d_nn[idx];
+    int offset = d_off[idx];
     double2 temp;
     temp.x=0.0;temp.y=0.0;
     for (int nn = 0; nn < neigh; ++nn)
         {
-        double2 val = d_forceSets[n_idx(nn,idx)];
+        double2 val = d_forceSets[offset+nn];
         temp.x+=val.x;
         temp.y+=val.y;
         };
@@ -91,8 +93,11 @@ __global__ void gpu_sum_forces_with_exclusions_kernel(const double2* __restrict_
 
 /*!
   the force on a particle is decomposable into the force contribution from each of its voronoi
-  vertices...calculate those sets of forces
+  vertices...calculate those sets of forces. The moduli of each cell are read from d_moduli only if
+  perCellModuli is true. The per-neighbor arrays are stored compactly, in the same order as d_nidx,
+  so each thread reads and writes entry tidx of them. The shape of the box is also a template parameter
   */
+template<bool perCellModuli, bool rectangular>
 __global__ void gpu_force_sets_kernel(const double2* __restrict__ d_points,
                                       const double2* __restrict__ d_AP,
                                       const double2*  __restrict__ d_APpref,
@@ -104,8 +109,8 @@ __global__ void gpu_force_sets_kernel(const double2* __restrict__ d_points,
                                       const int2* __restrict__ d_nidx,
                                       double   KA,
                                       double   KP,
+                                      const double2* __restrict__ d_moduli,
                                       int     computations,
-                                      Index2D n_idx,
                                       periodicBoundaries Box
                                      )
     {
@@ -113,10 +118,9 @@ __global__ void gpu_force_sets_kernel(const double2* __restrict__ d_points,
     if (tidx >= computations)
         return;
 
-    //which particle are we evaluating, and which neighbor
+    //which particle are we evaluating
     int pidx = d_nidx[tidx].x;
-    int nn = d_nidx[tidx].y;
-    int nidx=n_idx(nn,pidx);
+    int nidx = tidx;
 
     //local variables declared...
     double2 dAdv,dPdv;
@@ -139,9 +143,9 @@ __global__ void gpu_force_sets_kernel(const double2* __restrict__ d_points,
 
     neighs = d_delSets[nidx];
 
-    Box.minDist(d_points[neighs.x],dlast,dnext);
-    Box.minDist(d_points[neighs.y],dlast,dcl);
-    Box.minDist(d_points[d_delOther[nidx]],dlast,dnc);
+    Box.minDist<rectangular>(d_points[neighs.x],dlast,dnext);
+    Box.minDist<rectangular>(d_points[neighs.y],dlast,dcl);
+    Box.minDist<rectangular>(d_points[d_delOther[nidx]],dlast,dnc);
 
     //first, compute the derivative of the main voro point w/r/t pidx's position
     Matrix2x2 dhdr;
@@ -182,8 +186,8 @@ __global__ void gpu_force_sets_kernel(const double2* __restrict__ d_points,
 
     dPdv.x = dlast.x/dlnorm - dnext.x/dnnorm;
     dPdv.y = dlast.y/dlnorm - dnext.y/dnnorm;
-    Adiff = KA*(d_AP[pidx].x - d_APpref[pidx].x);
-    Pdiff = KP*(d_AP[pidx].y - d_APpref[pidx].y);
+    Adiff = (perCellModuli ? d_moduli[pidx].x : KA)*(d_AP[pidx].x - d_APpref[pidx].x);
+    Pdiff = (perCellModuli ? d_moduli[pidx].y : KP)*(d_AP[pidx].y - d_APpref[pidx].y);
 
     //replace all "multiply-by-two's" with a single one at the end...saves 10 mult operations
     dEdv.x  = Adiff*dAdv.x + Pdiff*dPdv.x;
@@ -201,8 +205,8 @@ __global__ void gpu_force_sets_kernel(const double2* __restrict__ d_points,
 #endif
     dPdv.x = -dnc.x/dncnorm - dnext.x/dnnorm;
     dPdv.y = -dnc.y/dncnorm - dnext.y/dnnorm;
-    Adiff = KA*(d_AP[neighs.y].x - d_APpref[neighs.y].x);
-    Pdiff = KP*(d_AP[neighs.y].y - d_APpref[neighs.y].y);
+    Adiff = (perCellModuli ? d_moduli[neighs.y].x : KA)*(d_AP[neighs.y].x - d_APpref[neighs.y].x);
+    Pdiff = (perCellModuli ? d_moduli[neighs.y].y : KP)*(d_AP[neighs.y].y - d_APpref[neighs.y].y);
 
     dEdv.x  += Adiff*dAdv.x + Pdiff*dPdv.x;
     dEdv.y  += Adiff*dAdv.y + Pdiff*dPdv.y;
@@ -216,8 +220,8 @@ __global__ void gpu_force_sets_kernel(const double2* __restrict__ d_points,
     //dlnorm = dnnorm;
     dPdv.x = -dnext.x/dnnorm + dcl.x/dclnorm;
     dPdv.y = -dnext.y/dnnorm + dcl.y/dclnorm;
-    Adiff = KA*(d_AP[neighs.x].x - d_APpref[neighs.x].x);
-    Pdiff = KP*(d_AP[neighs.x].y - d_APpref[neighs.x].y);
+    Adiff = (perCellModuli ? d_moduli[neighs.x].x : KA)*(d_AP[neighs.x].x - d_APpref[neighs.x].x);
+    Pdiff = (perCellModuli ? d_moduli[neighs.x].y : KP)*(d_AP[neighs.x].y - d_APpref[neighs.x].y);
 
     dEdv.x  += Adiff*dAdv.x + Pdiff*dPdv.x;
     dEdv.y  += Adiff*dAdv.y + Pdiff*dPdv.y;
@@ -248,30 +252,27 @@ bool gpu_force_sets(double2 *d_points,
                     double  KA,
                     double  KP,
                     int    NeighIdxNum,
-                    Index2D &n_idx,
-                    periodicBoundaries &Box
+                    periodicBoundaries &Box,
+                    double2 *d_moduli
                     )
     {
     unsigned int block_size = 128;
     if (NeighIdxNum < 128) block_size = 32;
     unsigned int nblocks  = NeighIdxNum/block_size + 1;
 
-    gpu_force_sets_kernel<<<nblocks,block_size>>>(
-                                                d_points,
-                                                d_AP,
-                                                d_APpref,
-                                                d_delSets,
-                                                d_delOther,
-                                                d_vc,
-                                                d_vln,
-                                                d_forceSets,
-                                                d_nidx,
-                                                KA,
-                                                KP,
-                                                NeighIdxNum,
-                                                n_idx,
-                                                Box
-                                                );
+    bool rectangular = Box.isBoxSquare();
+    if(d_moduli == NULL && rectangular)
+        gpu_force_sets_kernel<false,true><<<nblocks,block_size>>>(d_points,d_AP,d_APpref,d_delSets,d_delOther,
+                                                d_vc,d_vln,d_forceSets,d_nidx,KA,KP,d_moduli,NeighIdxNum,Box);
+    else if(d_moduli == NULL)
+        gpu_force_sets_kernel<false,false><<<nblocks,block_size>>>(d_points,d_AP,d_APpref,d_delSets,d_delOther,
+                                                d_vc,d_vln,d_forceSets,d_nidx,KA,KP,d_moduli,NeighIdxNum,Box);
+    else if(rectangular)
+        gpu_force_sets_kernel<true,true><<<nblocks,block_size>>>(d_points,d_AP,d_APpref,d_delSets,d_delOther,
+                                                d_vc,d_vln,d_forceSets,d_nidx,KA,KP,d_moduli,NeighIdxNum,Box);
+    else
+        gpu_force_sets_kernel<true,false><<<nblocks,block_size>>>(d_points,d_AP,d_APpref,d_delSets,d_delOther,
+                                                d_vc,d_vln,d_forceSets,d_nidx,KA,KP,d_moduli,NeighIdxNum,Box);
     HANDLE_ERROR(cudaGetLastError());
     return cudaSuccess;
     };
@@ -282,8 +283,8 @@ bool gpu_sum_force_sets(
                         double2 *d_forceSets,
                         double2 *d_forces,
                         int    *d_nn,
-                        int     N,
-                        Index2D &n_idx
+                        int    *d_off,
+                        int     N
                         )
     {
     unsigned int block_size = 128;
@@ -294,8 +295,8 @@ bool gpu_sum_force_sets(
                                             d_forceSets,
                                             d_forces,
                                             d_nn,
-                                            N,
-                                            n_idx
+                                            d_off,
+                                            N
             );
     HANDLE_ERROR(cudaGetLastError());
     return cudaSuccess;
@@ -309,8 +310,8 @@ bool gpu_sum_force_sets_with_exclusions(
                         double2 *d_external_forces,
                         int    *d_exes,
                         int    *d_nn,
-                        int     N,
-                        Index2D &n_idx
+                        int    *d_off,
+                        int     N
                         )
     {
     unsigned int block_size = 128;
@@ -323,8 +324,8 @@ bool gpu_sum_force_sets_with_exclusions(
                                             d_external_forces,
                                             d_exes,
                                             d_nn,
-                                            N,
-                                            n_idx
+                                            d_off,
+                                            N
             );
     HANDLE_ERROR(cudaGetLastError());
     return cudaSuccess;
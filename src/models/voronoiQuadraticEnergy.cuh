@@ -16,7 +16,7 @@ A file providing an interface to the relevant cuda calls for the Voronoi2D class
  * \brief CUDA kernels and callers for the Voronoi2D class
  */
 
-//!Compute the contribution to the net force on vertex i from each of i's voronoi vertices
+//!Compute the contribution to the net force on vertex i from each of i's voronoi vertices; if d_moduli is NULL every cell uses (KA,KP)
 bool gpu_force_sets(
                     double2 *d_points,
                     double2 *d_AP,
@@ -30,16 +30,16 @@ bool gpu_force_sets(
                     double  KA,
                     double  KP,
                     int    NeighIdxNum,
-                    Index2D &n_idx,
-                    periodicBoundaries &Box
+                    periodicBoundaries &Box,
+                    double2 *d_moduli = NULL
                     );
 //!Add up the force contributions to get the net force on each particle
 bool gpu_sum_force_sets(
                     double2 *d_forceSets,
                     double2 *d_forces,
                     int    *d_nn,
-                    int     N,
-                    Index2D &n_idx
+                    int    *d_off,
+                    int     N
                     );
 
 //!Add up the force constributions, but in the condidtion where some exclusions exist
@@ -49,8 +49,8 @@ bool gpu_sum_force_sets_with_exclusions(
                     double2 *d_external_forces,
                     int    *d_exes,
                     int    *d_nn,
-                    int     N,
-                    Index2D &n_idx
+                    int    *d_off,
+                    int     N
                     );
 
 /** @} */ //end of group declaration
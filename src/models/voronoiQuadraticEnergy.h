@@ -43,6 +43,9 @@ class VoronoiQuadraticEnergy : public voronoiModelBase
         //CPU functions
         //!Compute the net force on particle i on the CPU
         virtual void computeVoronoiForceCPU(int i);
+        //!Compute the net force on particle i on the CPU, reading per-cell moduli only if perCellModuli is true
+        template<bool perCellModuli>
+        void computeVoronoiForceCPU(int i);
 
         //GPU functions
         //!call gpu_force_sets kernel caller
@@ -41,6 +41,7 @@ exclusions, as determined by the flags. Assumes the geometry has NOT yet been co
 */
 void VoronoiQuadraticEnergyWithTension::computeForces()
     {
+    PROFILE_SCOPE("VoronoiQuadraticEnergyWithTension::computeForces");
     if(forcesUpToDate)
        return; 
     forcesUpToDate = true;
@@ -56,19 +57,31 @@ void VoronoiQuadraticEnergyWithTension::computeForces()
             {
             if (simpleTension)
                 {
-                for (int ii = 0; ii < Ncells; ++ii)
-                    computeVoronoiSimpleTensionForceCPU(ii);
+                if(uniformModuli)
+                    for (int ii = 0; ii < Ncells; ++ii)
+                        computeVoronoiSimpleTensionForceCPU<false>(ii);
+                else
+                    for (int ii = 0; ii < Ncells; ++ii)
+                        computeVoronoiSimpleTensionForceCPU<true>(ii);
                 }
             else
                 {
-                for (int ii = 0; ii < Ncells; ++ii)
-                    computeVoronoiTensionForceCPU(ii);
+                if(uniformModuli)
+                    for (int ii = 0; ii < Ncells; ++ii)
+                        computeVoronoiTensionForceCPU<false>(ii);
+                else
+                    for (int ii = 0; ii < Ncells; ++ii)
+                        computeVoronoiTensionForceCPU<true>(ii);
                 };
             }
         else
             {
-            for (int ii = 0; ii < Ncells; ++ii)
-                computeVoronoiForceCPU(ii);
+            if(uniformModuli)
+                for (int ii = 0; ii < Ncells; ++ii)
+                    computeVoronoiForceCPU<false>(ii);
+            else
+                for (int ii = 0; ii < Ncells; ++ii)
+                    computeVoronoiForceCPU<true>(ii);
             };
         };
     };
@@ -94,7 +107,7 @@ void VoronoiQuadraticEnergyWithTension::ComputeForceSetsGPU()
 
 /*!
 Returns the quadratic energy functional:
-E = \sum_{cells} K_A(A_i-A_i,0)^2 + K_P(P_i-P_i,0)^2 + \sum_{[i]\neq[j]} \gamma_{[i][j]}l_{ij}
+E = \sum_{cells} K_{A,i}(A_i-A_i,0)^2 + K_{P,i}(P_i-P_i,0)^2 + \sum_{[i]\neq[j]} \gamma_{[i][j]}l_{ij}
 */
 double VoronoiQuadraticEnergyWithTension::computeEnergy()
     {
@@ -103,11 +116,14 @@ double VoronoiQuadraticEnergyWithTension::computeEnergy()
     //first, compute the area and perimeter pieces...which are easy
     ArrayHandle<double2> h_AP(AreaPeri,access_location::host,access_mode::read);
     ArrayHandle<double2> h_APP(AreaPeriPreferences,access_location::host,access_mode::read);
+    ArrayHandle<double2> h_mod(Moduli,access_location::host,access_mode::read);
     Energy = 0.0;
     for (int nn = 0; nn  < Ncells; ++nn)
         {
-        Energy += KA * (h_AP.data[nn].x-h_APP.data[nn].x)*(h_AP.data[nn].x-h_APP.data[nn].x);
-        Energy += KP * (h_AP.data[nn].y-h_APP.data[nn].y)*(h_AP.data[nn].y-h_APP.data[nn].y);
+        double ka = uniformModuli ? KA : h_mod.data[nn].x;
+        double kp = uniformModuli ? KP : h_mod.data[nn].y;
+        Energy += ka * (h_AP.data[nn].x-h_APP.data[nn].x)*(h_AP.data[nn].x-h_APP.data[nn].x);
+        Energy += kp * (h_AP.data[nn].y-h_APP.data[nn].y)*(h_AP.data[nn].y-h_APP.data[nn].y);
         };
 
     //now, the potential line tension terms
@@ -116,6 +132,7 @@ double VoronoiQuadraticEnergyWithTension::computeEnergy()
 
     ArrayHandle<int> h_nn(neighborNum,access_location::host,access_mode::read);
     ArrayHandle<int> h_n(neighbors,access_location::host,access_mode::read);
+    ArrayHandle<int> h_off(neighborOffsets,access_location::host,access_mode::read);
     ArrayHandle<double> h_tm(tensionMatrix,access_location::host,access_mode::read);
     for (int cell = 0; cell < Ncells; ++cell)
         {
@@ -126,7 +143,7 @@ double VoronoiQuadraticEnergyWithTension::computeEnergy()
         for (int nn = 0; nn < neigh; ++nn)
             {
             ns[nn] = h_n.data[n_idx(nn,cell)];
-            voro[nn] = h_v.data[n_idx(nn,cell)];
+            voro[nn] = h_v.data[h_off.data[cell]+nn];
             };
 
         double2 vlast, vnext,vcur;
@@ -173,6 +190,7 @@ void VoronoiQuadraticEnergyWithTension::computeVoronoiSimpleTensionForceSetsGPU(
     ArrayHandle<int> d_ct(cellType,access_location::device,access_mode::read);
     ArrayHandle<double2> d_vc(voroCur,access_location::device,access_mode::read);
     ArrayHandle<double4> d_vln(voroLastNext,access_location::device,access_mode::read);
+    ArrayHandle<double2> d_mod(Moduli,access_location::device,access_mode::read);
 
     gpu_VoronoiSimpleTension_force_sets(
                     d_p.data,
@@ -188,7 +206,8 @@ void VoronoiQuadraticEnergyWithTension::computeVoronoiSimpleTensionForceSetsGPU(
                     KA,
                     KP,
                     gamma,
-                    NeighIdxNum,n_idx,*(Box));
+                    NeighIdxNum,*(Box),
+                    uniformModuli ? NULL : d_mod.data);
     };
 
 /*!
@@ -209,6 +228,7 @@ void VoronoiQuadraticEnergyWithTension::computeVoronoiTensionForceSetsGPU()
     ArrayHandle<double4> d_vln(voroLastNext,access_location::device,access_mode::read);
 
     ArrayHandle<double> d_tm(tensionMatrix,access_location::device,access_mode::read);
+    ArrayHandle<double2> d_mod(Moduli,access_location::device,access_mode::read);
 
     gpu_VoronoiTension_force_sets(
                     d_p.data,
@@ -225,12 +245,28 @@ void VoronoiQuadraticEnergyWithTension::computeVoronoiTensionForceSetsGPU()
                     cellTypeIndexer,
                     KA,
                     KP,
-                    NeighIdxNum,n_idx,*(Box));
+                    NeighIdxNum,*(Box),
+                    uniformModuli ? NULL : d_mod.data);
+    };
+/*!
+\param i The particle index for which to compute the net force, assuming addition tension terms between unlike particles
+\post the net force on cell i is computed
+*/
+void VoronoiQuadraticEnergyWithTension::computeVoronoiSimpleTensionForceCPU(int i)
+    {
+    if(uniformModuli)
+        computeVoronoiSimpleTensionForceCPU<false>(i);
+    else
+        computeVoronoiSimpleTensionForceCPU<true>(i);
     };
+
 /*!
 \param i The particle index for which to compute the net force, assuming addition tension terms between unlike particles
 \post the net force on cell i is computed
+The moduli are a template parameter so that the uniform case does not pay for per-cell reads of the
+Moduli array
 */
+template<bool perCellModuli>
 void VoronoiQuadraticEnergyWithTension::computeVoronoiSimpleTensionForceCPU(int i)
     {
     double Pthreshold = THRESHOLD;
@@ -241,9 +277,11 @@ void VoronoiQuadraticEnergyWithTension::computeVoronoiSimpleTensionForceCPU(int
     ArrayHandle<double2> h_AP(AreaPeri,access_location::host,access_mode::read);
     ArrayHandle<double2> h_APpref(AreaPeriPreferences,access_location::host,access_mode::read);
     ArrayHandle<double2> h_v(voroCur,access_location::host,access_mode::read);
+    ArrayHandle<double2> h_mod(Moduli,access_location::host,access_mode::read);
 
     ArrayHandle<int> h_nn(neighborNum,access_location::host,access_mode::read);
     ArrayHandle<int> h_n(neighbors,access_location::host,access_mode::read);
+    ArrayHandle<int> h_off(neighborOffsets,access_location::host,access_mode::read);
 
     ArrayHandle<double2> h_external_forces(external_forces,access_location::host,access_mode::overwrite);
     ArrayHandle<int> h_exes(exclusions,access_location::host,access_mode::read);
@@ -270,7 +308,7 @@ void VoronoiQuadraticEnergyWithTension::computeVoronoiSimpleTensionForceCPU(int
     Box->minDist(nlastp,pi,rij);
     for (int nn = 0; nn < neigh;++nn)
         {
-        int id = n_idx(nn,i);
+        int id = h_off.data[i]+nn;
         nnextp = h_p.data[ns[nn]];
         Box->minDist(nnextp,pi,rik);
         voro[nn] = h_v.data[id];
@@ -308,8 +346,10 @@ void VoronoiQuadraticEnergyWithTension::computeVoronoiSimpleTensionForceCPU(int
     double2 forceSum;
     forceSum.x=0.0;forceSum.y=0.0;
 
-    double Adiff = KA*(h_AP.data[i].x - h_APpref.data[i].x);
-    double Pdiff = KP*(h_AP.data[i].y - h_APpref.data[i].y);
+    double2 uniformKAKP = make_double2(KA,KP);
+    double2 moduli = perCellModuli ? h_mod.data[i] : uniformKAKP;
+    double Adiff = moduli.x*(h_AP.data[i].x - h_APpref.data[i].x);
+    double Pdiff = moduli.y*(h_AP.data[i].y - h_APpref.data[i].y);
 
     double2 vcur;
     vlast = voro[neigh-1];
@@ -384,10 +424,12 @@ void VoronoiQuadraticEnergyWithTension::computeVoronoiSimpleTensionForceCPU(int
 
         Circumcenter(r1,r2,r3,vother);
 
-        double Akdiff = KA*(h_AP.data[baseNeigh].x  - h_APpref.data[baseNeigh].x);
-        double Pkdiff = KP*(h_AP.data[baseNeigh].y  - h_APpref.data[baseNeigh].y);
-        double Ajdiff = KA*(h_AP.data[otherNeigh].x - h_APpref.data[otherNeigh].x);
-        double Pjdiff = KP*(h_AP.data[otherNeigh].y - h_APpref.data[otherNeigh].y);
+        double2 modulik = perCellModuli ? h_mod.data[baseNeigh] : uniformKAKP;
+        double2 modulij = perCellModuli ? h_mod.data[otherNeigh] : uniformKAKP;
+        double Akdiff = modulik.x*(h_AP.data[baseNeigh].x  - h_APpref.data[baseNeigh].x);
+        double Pkdiff = modulik.y*(h_AP.data[baseNeigh].y  - h_APpref.data[baseNeigh].y);
+        double Ajdiff = modulij.x*(h_AP.data[otherNeigh].x - h_APpref.data[otherNeigh].x);
+        double Pjdiff = modulij.y*(h_AP.data[otherNeigh].y - h_APpref.data[otherNeigh].y);
 
         double2 dAkdv,dPkdv,dTkdv;
         dTkdv.x = 0.0;
@@ -485,6 +527,21 @@ void VoronoiQuadraticEnergyWithTension::computeVoronoiSimpleTensionForceCPU(int
 \param i The particle index for which to compute the net force, assuming addition tension terms between unlike particles
 \post the net force on cell i is computed
 */
+void VoronoiQuadraticEnergyWithTension::computeVoronoiTensionForceCPU(int i)
+    {
+    if(uniformModuli)
+        computeVoronoiTensionForceCPU<false>(i);
+    else
+        computeVoronoiTensionForceCPU<true>(i);
+    };
+
+/*!
+\param i The particle index for which to compute the net force, assuming addition tension terms between unlike particles
+\post the net force on cell i is computed
+The moduli are a template parameter so that the uniform case does not pay for per-cell reads of the
+Moduli array
+*/
+template<bool perCellModuli>
 void VoronoiQuadraticEnergyWithTension::computeVoronoiTensionForceCPU(int i)
     {
     double Pthreshold = THRESHOLD;
@@ -495,9 +552,11 @@ void VoronoiQuadraticEnergyWithTension::computeVoronoiTensionForceCPU(int i)
     ArrayHandle<double2> h_AP(AreaPeri,access_location::host,access_mode::read);
     ArrayHandle<double2> h_APpref(AreaPeriPreferences,access_location::host,access_mode::read);
     ArrayHandle<double2> h_v(voroCur,access_location::host,access_mode::read);
+    ArrayHandle<double2> h_mod(Moduli,access_location::host,access_mode::read);
 
     ArrayHandle<int> h_nn(neighborNum,access_location::host,access_mode::read);
     ArrayHandle<int> h_n(neighbors,access_location::host,access_mode::read);
+    ArrayHandle<int> h_off(neighborOffsets,access_location::host,access_mode::read);
 
     ArrayHandle<double2> h_external_forces(external_forces,access_location::host,access_mode::overwrite);
     ArrayHandle<int> h_exes(exclusions,access_location::host,access_mode::read);
@@ -525,7 +584,7 @@ void VoronoiQuadraticEnergyWithTension::computeVoronoiTensionForceCPU(int i)
     Box->minDist(nlastp,pi,rij);
     for (int nn = 0; nn < neigh;++nn)
         {
-        int id = n_idx(nn,i);
+        int id = h_off.data[i]+nn;
         nnextp = h_p.data[ns[nn]];
         Box->minDist(nnextp,pi,rik);
         voro[nn] = h_v.data[id];
@@ -563,8 +622,10 @@ void VoronoiQuadraticEnergyWithTension::computeVoronoiTensionForceCPU(int i)
     double2 forceSum;
     forceSum.x=0.0;forceSum.y=0.0;
 
-    double Adiff = KA*(h_AP.data[i].x - h_APpref.data[i].x);
-    double Pdiff = KP*(h_AP.data[i].y - h_APpref.data[i].y);
+    double2 uniformKAKP = make_double2(KA,KP);
+    double2 moduli = perCellModuli ? h_mod.data[i] : uniformKAKP;
+    double Adiff = moduli.x*(h_AP.data[i].x - h_APpref.data[i].x);
+    double Pdiff = moduli.y*(h_AP.data[i].y - h_APpref.data[i].y);
 
     double2 vcur;
     vlast = voro[neigh-1];
@@ -644,10 +705,12 @@ void VoronoiQuadraticEnergyWithTension::computeVoronoiTensionForceCPU(int i)
 
         Circumcenter(r1,r2,r3,vother);
 
-        double Akdiff = KA*(h_AP.data[baseNeigh].x  - h_APpref.data[baseNeigh].x);
-        double Pkdiff = KP*(h_AP.data[baseNeigh].y  - h_APpref.data[baseNeigh].y);
-        double Ajdiff = KA*(h_AP.data[otherNeigh].x - h_APpref.data[otherNeigh].x);
-        double Pjdiff = KP*(h_AP.data[otherNeigh].y - h_APpref.data[otherNeigh].y);
+        double2 modulik = perCellModuli ? h_mod.data[baseNeigh] : uniformKAKP;
+        double2 modulij = perCellModuli ? h_mod.data[otherNeigh] : uniformKAKP;
+        double Akdiff = modulik.x*(h_AP.data[baseNeigh].x  - h_APpref.data[baseNeigh].x);
+        double Pkdiff = modulik.y*(h_AP.data[baseNeigh].y  - h_APpref.data[baseNeigh].y);
+        double Ajdiff = modulij.x*(h_AP.data[otherNeigh].x - h_APpref.data[otherNeigh].x);
+        double Pjdiff = modulij.y*(h_AP.data[otherNeigh].y - h_APpref.data[otherNeigh].y);
 
         double2 dAkdv,dPkdv,dTkdv;
         dTkdv.x = 0.0;
@@ -744,3 +807,8 @@ void VoronoiQuadraticEnergyWithTension::computeVoronoiTensionForceCPU(int i)
             };
         }
     };
+
+template void VoronoiQuadraticEnergyWithTension::computeVoronoiSimpleTensionForceCPU<false>(int i);
+template void VoronoiQuadraticEnergyWithTension::computeVoronoiSimpleTensionForceCPU<true>(int i);
+template void VoronoiQuadraticEnergyWithTension::computeVoronoiTensionForceCPU<false>(int i);
+template void VoronoiQuadraticEnergyWithTension::computeVoronoiTensionForceCPU<true>(int i);
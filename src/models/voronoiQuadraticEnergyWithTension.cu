@@ -21,6 +21,7 @@
 */
 
 //!the force on a particle is decomposable into the force contribution from each of its voronoi vertices...calculate those sets of forces with an additional tension term between cells of different type
+template<bool perCellModuli>
 __global__ void gpu_VoronoiTension_force_sets_kernel(const double2* __restrict__ d_points,
                                           const double2* __restrict__ d_AP,
                                           const double2* __restrict__ d_APpref,
@@ -35,8 +36,8 @@ __global__ void gpu_VoronoiTension_force_sets_kernel(const double2* __restrict__
                                           Index2D cellTypeIndexer,
                                           double   KA,
                                           double   KP,
+                                          const double2* __restrict__ d_moduli,
                                           int     computations,
-                                          Index2D n_idx,
                                           periodicBoundaries Box
                                         )
     {
@@ -44,10 +45,9 @@ __global__ void gpu_VoronoiTension_force_sets_kernel(const double2* __restrict__
     if (tidx >= computations)
         return;
 
-    //which particle are we evaluating, and which neighbor
+    //which particle are we evaluating; the per-neighbor arrays are stored in the same order as d_nidx
     int pidx = d_nidx[tidx].x;
-    int nn = d_nidx[tidx].y;
-    int nidx=n_idx(nn,pidx);
+    int nidx = tidx;
 
     //Great...access the Delaunay neighbors and the relevant other point
     double2 pi   = d_points[pidx];
@@ -125,8 +125,8 @@ __global__ void gpu_VoronoiTension_force_sets_kernel(const double2* __restrict__
         dTdv.y += d_tensionMatrix[cellTypeIndexer(typeJ,typeI)]*dlast.y/dlnorm;
         };
 
-    Adiff = KA*(d_AP[pidx].x - d_APpref[pidx].x);
-    Pdiff = KP*(d_AP[pidx].y - d_APpref[pidx].y);
+    Adiff = (perCellModuli ? d_moduli[pidx].x : KA)*(d_AP[pidx].x - d_APpref[pidx].x);
+    Pdiff = (perCellModuli ? d_moduli[pidx].y : KP)*(d_AP[pidx].y - d_APpref[pidx].y);
 
     //defer a global factor of two to the very end...saves six multiplications...
     dEdv.x  =  Adiff*dAdv.x + Pdiff*dPdv.x + 0.5*dTdv.x;
@@ -142,8 +142,8 @@ __global__ void gpu_VoronoiTension_force_sets_kernel(const double2* __restrict__
         dnnorm = THRESHOLD;
     dPdv.x = dnc.x/dncnorm - dnext.x/dnnorm;
     dPdv.y = dnc.y/dncnorm - dnext.y/dnnorm;
-    Adiff = KA*(d_AP[neighs.y].x - d_APpref[neighs.y].x);
-    Pdiff = KP*(d_AP[neighs.y].y - d_APpref[neighs.y].y);
+    Adiff = (perCellModuli ? d_moduli[neighs.y].x : KA)*(d_AP[neighs.y].x - d_APpref[neighs.y].x);
+    Pdiff = (perCellModuli ? d_moduli[neighs.y].y : KP)*(d_AP[neighs.y].y - d_APpref[neighs.y].y);
     dTdv.x = 0.0; dTdv.y = 0.0;
     if(Tik)
         {
@@ -167,8 +167,8 @@ __global__ void gpu_VoronoiTension_force_sets_kernel(const double2* __restrict__
     dlnorm = dnnorm;
     dPdv.x = dlast.x/dlnorm - dcl.x/dclnorm;
     dPdv.y = dlast.y/dlnorm - dcl.y/dclnorm;
-    Adiff = KA*(d_AP[neighs.x].x - d_APpref[neighs.x].x);
-    Pdiff = KP*(d_AP[neighs.x].y - d_APpref[neighs.x].y);
+    Adiff = (perCellModuli ? d_moduli[neighs.x].x : KA)*(d_AP[neighs.x].x - d_APpref[neighs.x].x);
+    Pdiff = (perCellModuli ? d_moduli[neighs.x].y : KP)*(d_AP[neighs.x].y - d_APpref[neighs.x].y);
     dTdv.x = 0.0; dTdv.y = 0.0;
     if(Tij)
         {
@@ -193,6 +193,7 @@ __global__ void gpu_VoronoiTension_force_sets_kernel(const double2* __restrict__
     };
 
 //!the force on a particle is decomposable into the force contribution from each of its voronoi vertices...calculate those sets of forces with an additional tension term between cells of different type
+template<bool perCellModuli>
 __global__ void gpu_VoronoiSimpleTension_force_sets_kernel(const double2* __restrict__ d_points,
                                           const double2* __restrict__ d_AP,
                                           const double2* __restrict__ d_APpref,
@@ -205,9 +206,9 @@ __global__ void gpu_VoronoiSimpleTension_force_sets_kernel(const double2* __rest
                                           const int* __restrict__ d_cellTypes,
                                           double   KA,
                                           double   KP,
+                                          const double2* __restrict__ d_moduli,
                                           double   gamma,
                                           int     computations,
-                                          Index2D n_idx,
                                           periodicBoundaries Box
                                         )
     {
@@ -215,10 +216,9 @@ __global__ void gpu_VoronoiSimpleTension_force_sets_kernel(const double2* __rest
     if (tidx >= computations)
         return;
 
-    //which particle are we evaluating, and which neighbor
+    //which particle are we evaluating; the per-neighbor arrays are stored in the same order as d_nidx
     int pidx = d_nidx[tidx].x;
-    int nn = d_nidx[tidx].y;
-    int nidx=n_idx(nn,pidx);
+    int nidx = tidx;
 
     //Great...access the Delaunay neighbors and the relevant other point
     double2 pi   = d_points[pidx];
@@ -292,8 +292,8 @@ __global__ void gpu_VoronoiSimpleTension_force_sets_kernel(const double2* __rest
         dTdv.y += dlast.y/dlnorm;
         };
 
-    Adiff = KA*(d_AP[pidx].x - d_APpref[pidx].x);
-    Pdiff = KP*(d_AP[pidx].y - d_APpref[pidx].y);
+    Adiff = (perCellModuli ? d_moduli[pidx].x : KA)*(d_AP[pidx].x - d_APpref[pidx].x);
+    Pdiff = (perCellModuli ? d_moduli[pidx].y : KP)*(d_AP[pidx].y - d_APpref[pidx].y);
 
     //defer a global factor of two to the very end...saves six multiplications...
     dEdv.x  =  Adiff*dAdv.x + Pdiff*dPdv.x + 0.5*gamma*dTdv.x;
@@ -309,8 +309,8 @@ __global__ void gpu_VoronoiSimpleTension_force_sets_kernel(const double2* __rest
         dnnorm = THRESHOLD;
     dPdv.x = dnc.x/dncnorm - dnext.x/dnnorm;
     dPdv.y = dnc.y/dncnorm - dnext.y/dnnorm;
-    Adiff = KA*(d_AP[neighs.y].x - d_APpref[neighs.y].x);
-    Pdiff = KP*(d_AP[neighs.y].y - d_APpref[neighs.y].y);
+    Adiff = (perCellModuli ? d_moduli[neighs.y].x : KA)*(d_AP[neighs.y].x - d_APpref[neighs.y].x);
+    Pdiff = (perCellModuli ? d_moduli[neighs.y].y : KP)*(d_AP[neighs.y].y - d_APpref[neighs.y].y);
     dTdv.x = 0.0; dTdv.y = 0.0;
     if(Tik)
         {
@@ -334,8 +334,8 @@ __global__ void gpu_VoronoiSimpleTension_force_sets_kernel(const double2* __rest
     dlnorm = dnnorm;
     dPdv.x = dlast.x/dlnorm - dcl.x/dclnorm;
     dPdv.y = dlast.y/dlnorm - dcl.y/dclnorm;
-    Adiff = KA*(d_AP[neighs.x].x - d_APpref[neighs.x].x);
-    Pdiff = KP*(d_AP[neighs.x].y - d_APpref[neighs.x].y);
+    Adiff = (perCellModuli ? d_moduli[neighs.x].x : KA)*(d_AP[neighs.x].x - d_APpref[neighs.x].x);
+    Pdiff = (perCellModuli ? d_moduli[neighs.x].y : KP)*(d_AP[neighs.x].y - d_APpref[neighs.x].y);
     dTdv.x = 0.0; dTdv.y = 0.0;
     if(Tij)
         {
@@ -376,15 +376,16 @@ bool gpu_VoronoiTension_force_sets(double2 *d_points,
                     double  KA,
                     double  KP,
                     int    NeighIdxNum,
-                    Index2D &n_idx,
-                    periodicBoundaries &Box
+                    periodicBoundaries &Box,
+                    double2 *d_moduli
                     )
     {
     unsigned int block_size = 128;
     if (NeighIdxNum < 128) block_size = 32;
     unsigned int nblocks  = NeighIdxNum/block_size + 1;
 
-    gpu_VoronoiTension_force_sets_kernel<<<nblocks,block_size>>>(
+    if(d_moduli == NULL)
+        gpu_VoronoiTension_force_sets_kernel<false><<<nblocks,block_size>>>(
                                                 d_points,
                                                 d_AP,
                                                 d_APpref,
@@ -399,8 +400,28 @@ bool gpu_VoronoiTension_force_sets(double2 *d_points,
                                                 cellTypeIndexer,
                                                 KA,
                                                 KP,
+                                                d_moduli,
+                                                NeighIdxNum,
+                                                Box
+                                                );
+    else
+        gpu_VoronoiTension_force_sets_kernel<true><<<nblocks,block_size>>>(
+                                                d_points,
+                                                d_AP,
+                                                d_APpref,
+                                                d_delSets,
+                                                d_delOther,
+                                                d_vc,
+                                                d_vln,
+                                                d_forceSets,
+                                                d_nidx,
+                                                d_cellTypes,
+                                                d_tensionMatrix,
+                                                cellTypeIndexer,
+                                                KA,
+                                                KP,
+                                                d_moduli,
                                                 NeighIdxNum,
-                                                n_idx,
                                                 Box
                                                 );
     HANDLE_ERROR(cudaGetLastError());
@@ -422,15 +443,35 @@ bool gpu_VoronoiSimpleTension_force_sets(double2 *d_points,
                     double  KP,
                     double  gamma,
                     int    NeighIdxNum,
-                    Index2D &n_idx,
-                    periodicBoundaries &Box
+                    periodicBoundaries &Box,
+                    double2 *d_moduli
                     )
     {
     unsigned int block_size = 128;
     if (NeighIdxNum < 128) block_size = 32;
     unsigned int nblocks  = NeighIdxNum/block_size + 1;
 
-    gpu_VoronoiSimpleTension_force_sets_kernel<<<nblocks,block_size>>>(
+    if(d_moduli == NULL)
+        gpu_VoronoiSimpleTension_force_sets_kernel<false><<<nblocks,block_size>>>(
+                                                d_points,
+                                                d_AP,
+                                                d_APpref,
+                                                d_delSets,
+                                                d_delOther,
+                                                d_vc,
+                                                d_vln,
+                                                d_forceSets,
+                                                d_nidx,
+                                                d_cellTypes,
+                                                KA,
+                                                KP,
+                                                d_moduli,
+                                                gamma,
+                                                NeighIdxNum,
+                                                Box
+                                                );
+    else
+        gpu_VoronoiSimpleTension_force_sets_kernel<true><<<nblocks,block_size>>>(
                                                 d_points,
                                                 d_AP,
                                                 d_APpref,
@@ -443,9 +484,9 @@ bool gpu_VoronoiSimpleTension_force_sets(double2 *d_points,
                                                 d_cellTypes,
                                                 KA,
                                                 KP,
+                                                d_moduli,
                                                 gamma,
                                                 NeighIdxNum,
-                                                n_idx,
                                                 Box
                                                 );
     HANDLE_ERROR(cudaGetLastError());
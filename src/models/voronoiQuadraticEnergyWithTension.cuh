@@ -17,7 +17,7 @@ A file providing an interface to the relevant cuda calls for the Voronoi2D class
  * \brief CUDA kernels and callers for the Voronoi2D class
  */
 
-//!Compute the contribution to the net force on vertex i from each of i's voronoi vertices with general tensions
+//!Compute the contribution to the net force on vertex i from each of i's voronoi vertices with general tensions; if d_moduli is NULL every cell uses (KA,KP)
 bool gpu_VoronoiTension_force_sets(
                     double2 *d_points,
                     double2 *d_AP,
@@ -34,11 +34,11 @@ bool gpu_VoronoiTension_force_sets(
                     double  KA,
                     double  KP,
                     int    NeighIdxNum,
-                    Index2D &n_idx,
-                    periodicBoundaries &Box
+                    periodicBoundaries &Box,
+                    double2 *d_moduli = NULL
                     );
 
-//!Compute the contribution to the net force on vertex i from each of i's voronoi vertices
+//!Compute the contribution to the net force on vertex i from each of i's voronoi vertices with a single tension; if d_moduli is NULL every cell uses (KA,KP)
 bool gpu_VoronoiSimpleTension_force_sets(
                     double2 *d_points,
                     double2 *d_AP,
@@ -54,8 +54,8 @@ bool gpu_VoronoiSimpleTension_force_sets(
                     double  KP,
                     double  gamma,
                     int    NeighIdxNum,
-                    Index2D &n_idx,
-                    periodicBoundaries &Box
+                    periodicBoundaries &Box,
+                    double2 *d_moduli = NULL
                     );
 
 /** @} */ //end of group declaration
@@ -42,11 +42,17 @@ class VoronoiQuadraticEnergyWithTension : public VoronoiQuadraticEnergy
 
         //!Compute the net force on particle i on the CPU with only a single tension value
         virtual void computeVoronoiSimpleTensionForceCPU(int i);
+        //!Compute the net force on particle i on the CPU with only a single tension value, reading per-cell moduli only if perCellModuli is true
+        template<bool perCellModuli>
+        void computeVoronoiSimpleTensionForceCPU(int i);
 
         //!call gpu_force_sets kernel caller
         virtual void computeVoronoiSimpleTensionForceSetsGPU();
         //!Compute the net force on particle i on the CPU with multiple tension values
         virtual void computeVoronoiTensionForceCPU(int i);
+        //!Compute the net force on particle i on the CPU with multiple tension values, reading per-cell moduli only if perCellModuli is true
+        template<bool perCellModuli>
+        void computeVoronoiTensionForceCPU(int i);
         //!call gpu_force_sets kernel caller
         virtual void computeVoronoiTensionForceSetsGPU();
 
@@ -0,0 +1,1142 @@
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#define NPY_NO_DEPRECATED_API NPY_1_7_API_VERSION
+#include <numpy/arrayobject.h>
+
+#include "std_include.h"
+#include "Simulation.h"
+#include "voronoiQuadraticEnergy.h"
+#include "vertexQuadraticEnergy.h"
+#include "brownianParticleDynamics.h"
+#include "langevinDynamics.h"
+#include "NoseHooverChainNVT.h"
+#include "selfPropelledParticleDynamics.h"
+#include "EnergyMinimizerFIRE2D.h"
+#include "mappedTrajectoryDatabase.h"
+
+/*! \file cellGPUModule.cpp */
+/*!
+The cellGPU python module: thin bindings of Simulation, the Voronoi and vertex models, the equations of
+motion, and mappedTrajectoryDatabase, written against the python and NumPy C APIs (so that building it
+needs nothing beyond the python development headers and NumPy). Arrays of a model are not copied into
+python; instead, a hostArrayView acquires an ArrayHandle on the host copy of a GPUArray and presents that
+memory as a NumPy array, e.g.
+
+    with model.positions(cellGPU.access_mode.readwrite) as x:
+        x[:,0] += 0.1
+
+The access mode has the same meaning as for an ArrayHandle: read gives a read-only array; readwrite
+and overwrite give writable ones (overwrite does not bring the data back from the device first). The
+NumPy array is only valid while the view is open -- when the view is closed it becomes read-only, and
+it must not be used afterwards, since the simulation may move, resize, or reallocate the memory.
+For the same reason a Simulation refuses to take a time step while a view of its configuration (or of a
+model one of its updaters acts on) is open; each model counts its own open views (openHostViews), so
+views of an unrelated model do not block it.
+
+Every bound class is a python type whose instances hold a shared pointer to the root of the class
+hierarchy (Simple2DModel, updater, Simulation or mappedTrajectoryDatabase), and methods are bound by
+member-function pointer; C++ exceptions raised by a call become python RuntimeErrors.
+*/
+
+//!A python object wrapping a cellGPU object
+struct wrappedObject
+    {
+    PyObject_HEAD
+    //!The object, as a pointer to the root of its class hierarchy
+    shared_ptr<void> object;
+    //!Python objects that must outlive this one (the simulation holds only weak pointers)
+    vector<PyObject *> keptAlive;
+    };
+
+//!The roots of the bound class hierarchies; rootType<T> picks the one T derives from
+Simple2DModel *rootOf(Simple2DModel *);
+updater *rootOf(updater *);
+Simulation *rootOf(Simulation *);
+mappedTrajectoryDatabase *rootOf(mappedTrajectoryDatabase *);
+template<typename T> using rootType = typename std::remove_pointer<decltype(rootOf((T *)NULL))>::type;
+
+//!The python type bound to a C++ class, if there is one
+template<typename T> struct pythonType {static PyTypeObject *type;};
+template<typename T> PyTypeObject *pythonType<T>::type = NULL;
+
+//!The C++ object behind a python object of the type bound to T (or of a subclass); NULL with a python error set otherwise
+template<typename T>
+static shared_ptr<T> unwrap(PyObject *o)
+    {
+    typedef rootType<T> root;
+    PyTypeObject *type = pythonType<T>::type ? pythonType<T>::type : pythonType<root>::type;
+    if(!PyObject_TypeCheck(o,type))
+        {
+        PyErr_Format(PyExc_TypeError,"expected a %s, not a %s",type->tp_name,Py_TYPE(o)->tp_name);
+        return NULL;
+        };
+    shared_ptr<T> result = dynamic_pointer_cast<T>(static_pointer_cast<root>(((wrappedObject *)o)->object));
+    if(!result)
+        PyErr_Format(PyExc_RuntimeError,"this %s has not been initialized",Py_TYPE(o)->tp_name);
+    return result;
+    };
+
+//!Store a newly constructed object in its python object
+template<typename T>
+static void wrap(PyObject *self, shared_ptr<T> object)
+    {
+    shared_ptr<rootType<T> > root = object;
+    ((wrappedObject *)self)->object = root;
+    };
+
+//!Keep another python object alive for as long as self lives
+static void keepAlive(PyObject *self, PyObject *other)
+    {
+    Py_INCREF(other);
+    ((wrappedObject *)self)->keptAlive.push_back(other);
+    };
+
+static PyObject *wrappedNew(PyTypeObject *type, PyObject *, PyObject *)
+    {
+    PyObject *self = type->tp_alloc(type,0);
+    if(self)
+        {
+        new (&((wrappedObject *)self)->object) shared_ptr<void>();
+        new (&((wrappedObject *)self)->keptAlive) vector<PyObject *>();
+        };
+    return self;
+    };
+
+static void wrappedDealloc(PyObject *self)
+    {
+    wrappedObject *w = (wrappedObject *)self;
+    PyTypeObject *type = Py_TYPE(self);
+    w->object.~shared_ptr<void>();
+    for (PyObject *o : w->keptAlive)
+        Py_DECREF(o);
+    w->keptAlive.~vector<PyObject *>();
+    type->tp_free(self);
+    Py_DECREF(type);
+    };
+
+//!Conversion of python arguments to C++ ones; false, with a python error set, on failure
+template<typename T> struct fromPython;
+template<> struct fromPython<double>
+    {
+    static bool convert(PyObject *o, double &v)
+        {
+        v = PyFloat_AsDouble(o);
+        return !(v == -1.0 && PyErr_Occurred());
+        };
+    };
+template<> struct fromPython<int>
+    {
+    static bool convert(PyObject *o, int &v)
+        {
+        long l = PyLong_AsLong(o);
+        if(l == -1 && PyErr_Occurred())
+            return false;
+        if(l < INT_MIN || l > INT_MAX)
+            {
+            PyErr_SetString(PyExc_OverflowError,"integer argument out of range");
+            return false;
+            };
+        v = (int)l;
+        return true;
+        };
+    };
+template<> struct fromPython<bool>
+    {
+    static bool convert(PyObject *o, bool &v)
+        {
+        int truth = PyObject_IsTrue(o);
+        v = truth == 1;
+        return truth >= 0;
+        };
+    };
+template<> struct fromPython<string>
+    {
+    static bool convert(PyObject *o, string &v)
+        {
+        const char *s = PyUnicode_AsUTF8(o);
+        if(s)
+            v = s;
+        return s != NULL;
+        };
+    };
+template<> struct fromPython<vector<int> >
+    {
+    static bool convert(PyObject *o, vector<int> &v)
+        {
+        PyObject *sequence = PySequence_Fast(o,"expected a sequence of integers");
+        if(!sequence)
+            return false;
+        Py_ssize_t n = PySequence_Fast_GET_SIZE(sequence);
+        v.resize(n);
+        bool converted = true;
+        for (Py_ssize_t ii = 0; ii < n && converted; ++ii)
+            converted = fromPython<int>::convert(PySequence_Fast_GET_ITEM(sequence,ii),v[ii]);
+        Py_DECREF(sequence);
+        return converted;
+        };
+    };
+template<typename T> struct fromPython<shared_ptr<T> >
+    {
+    static bool convert(PyObject *o, shared_ptr<T> &v)
+        {
+        v = unwrap<T>(o);
+        return (bool)v;
+        };
+    };
+
+//!Conversion of C++ results to python objects
+static PyObject *toPython(double v){return PyFloat_FromDouble(v);};
+static PyObject *toPython(int v){return PyLong_FromLong(v);};
+static PyObject *toPython(bool v){return PyBool_FromLong(v);};
+
+//!Call f, converting its result to python and a C++ exception to a RuntimeError
+template<typename F>
+static PyObject *guardedCall(F f)
+    {
+    try
+        {
+        if constexpr (std::is_void<decltype(f())>::value)
+            {
+            f();
+            Py_RETURN_NONE;
+            }
+        else
+            return toPython(f());
+        }
+    catch(std::exception &e)
+        {
+        PyErr_SetString(PyExc_RuntimeError,e.what());
+        return NULL;
+        };
+    };
+
+template<typename M> struct memberFunction;
+template<typename C, typename R, typename... A>
+struct memberFunction<R (C::*)(A...)>
+    {
+    typedef C owner;
+    typedef std::tuple<typename std::decay<A>::type...> arguments;
+    };
+
+template<typename M> struct memberData;
+template<typename C, typename T>
+struct memberData<T C::*>
+    {
+    typedef C owner;
+    typedef T type;
+    };
+
+template<typename Tuple, size_t... I>
+static bool convertArguments(PyObject *args, Tuple &values, std::index_sequence<I...>)
+    {
+    return (fromPython<typename std::tuple_element<I,Tuple>::type>::convert(PyTuple_GET_ITEM(args,I),std::get<I>(values)) && ...);
+    };
+
+//!A python method calling a member function, with positional arguments only
+template<auto method>
+static PyObject *boundMethod(PyObject *self, PyObject *args)
+    {
+    typedef memberFunction<decltype(method)> traits;
+    typedef typename traits::arguments arguments;
+    const size_t count = std::tuple_size<arguments>::value;
+    if((size_t)PyTuple_GET_SIZE(args) != count)
+        {
+        PyErr_Format(PyExc_TypeError,"expected %zu arguments, got %zd",count,PyTuple_GET_SIZE(args));
+        return NULL;
+        };
+    auto object = unwrap<typename traits::owner>(self);
+    arguments values;
+    if(!object || !convertArguments(args,values,std::make_index_sequence<count>()))
+        return NULL;
+    return guardedCall([&]()
+        {
+        return std::apply([&](auto &... a){return ((*object).*method)(a...);},values);
+        });
+    };
+
+//!A read-only python attribute reading a data member
+template<auto member>
+static PyObject *boundMember(PyObject *self, void *)
+    {
+    auto object = unwrap<typename memberData<decltype(member)>::owner>(self);
+    if(!object)
+        return NULL;
+    return toPython((*object).*member);
+    };
+
+#define METHOD(name,function,doc) {name,(PyCFunction)boundMethod<function>,METH_VARARGS,doc}
+#define KEYWORD_METHOD(name,function,doc) {name,(PyCFunction)(void(*)(void))function,METH_VARARGS|METH_KEYWORDS,doc}
+#define MEMBER(name,member,doc) {name,boundMember<member>,NULL,doc,NULL}
+
+//!Construct a T in the python object self, as the __init__ of its type
+template<typename T, typename... A>
+static int construct(PyObject *self, A... args)
+    {
+    try
+        {
+        wrap(self,make_shared<T>(args...));
+        return 0;
+        }
+    catch(std::exception &e)
+        {
+        PyErr_SetString(PyExc_RuntimeError,e.what());
+        return -1;
+        };
+    };
+
+//!Create the python type bound to T, deriving from the one bound to Base, and add it to the module
+template<typename T, typename Base = void>
+static bool addType(PyObject *module, const char *qualifiedName, const char *doc, PyMethodDef *methods,
+                    PyGetSetDef *members = NULL, initproc init = NULL)
+    {
+    vector<PyType_Slot> slots;
+    slots.push_back({Py_tp_dealloc,(void *)wrappedDealloc});
+    slots.push_back({Py_tp_doc,(void *)doc});
+    if(methods)
+        slots.push_back({Py_tp_methods,methods});
+    if(members)
+        slots.push_back({Py_tp_getset,members});
+    //types without a constructor are only bases of the ones that have one
+    unsigned int flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE;
+    if(init)
+        {
+        slots.push_back({Py_tp_new,(void *)wrappedNew});
+        slots.push_back({Py_tp_init,(void *)init});
+        }
+    else
+        flags |= Py_TPFLAGS_DISALLOW_INSTANTIATION;
+    slots.push_back({0,NULL});
+    PyType_Spec spec = {qualifiedName,(int)sizeof(wrappedObject),0,flags,slots.data()};
+
+    PyObject *bases = NULL;
+    if constexpr (!std::is_void<Base>::value)
+        bases = PyTuple_Pack(1,(PyObject *)pythonType<Base>::type);
+    PyObject *type = PyType_FromSpecWithBases(&spec,bases);
+    Py_XDECREF(bases);
+    if(!type)
+        return false;
+    pythonType<T>::type = (PyTypeObject *)type;
+    Py_INCREF(type);
+    if(PyModule_AddObject(module,strrchr(qualifiedName,'.')+1,type) < 0)
+        {
+        Py_DECREF(type);
+        return false;
+        };
+    return true;
+    };
+
+//!Changing a model while python holds its memory would break the ArrayHandle contract
+static bool noOpenViews(const Simple2DModel &model)
+    {
+    if(model.openHostViews > 0)
+        {
+        PyErr_SetString(PyExc_RuntimeError,"close every view of the model's arrays before changing it");
+        return false;
+        };
+    return true;
+    };
+
+//!Check the configuration of a simulation and the models its updaters act on
+static bool noOpenViews(Simulation &s)
+    {
+    if(auto configuration = s.cellConfiguration.lock())
+        if(!noOpenViews(*configuration))
+            return false;
+    for (auto &weakUpdater : s.updaters)
+        {
+        auto upd = weakUpdater.lock();
+        if(upd && upd->model && !noOpenViews(*upd->model))
+            return false;
+        };
+    return true;
+    };
+
+/////////////////////////////////////////////////////////////////////////////
+// views of model arrays
+/////////////////////////////////////////////////////////////////////////////
+
+//!How an element of a GPUArray maps onto NumPy: a scalar type and a number of components
+template<typename T> struct numpyLayout;
+template<> struct numpyLayout<double> {static const int type = NPY_DOUBLE; static const int components = 1;};
+template<> struct numpyLayout<int> {static const int type = NPY_INT; static const int components = 1;};
+template<> struct numpyLayout<double2> {static const int type = NPY_DOUBLE; static const int components = 2;};
+template<> struct numpyLayout<int2> {static const int type = NPY_INT; static const int components = 2;};
+
+//!The part of a hostArrayView that does not depend on the element type
+class hostArrayViewBase
+    {
+    public:
+        virtual ~hostArrayViewBase(){};
+        //!Acquire the host data and return it as a NumPy array whose base is self
+        virtual PyObject *open(PyObject *self) = 0;
+        //!Release the host data; the last NumPy array handed out becomes read-only
+        virtual void close() = 0;
+        virtual bool isOpen() = 0;
+    };
+
+//!A NumPy view of the host copy of a GPUArray, valid while the view is open
+/*!
+The view holds a reference to the python object that owns the array (so that the model outlives the
+view), and an ArrayHandle while it is open, during which it counts towards the model's openHostViews.
+The NumPy arrays it hands out keep the view alive. An array of N*columns elements is shown with shape
+(N,columns), and double2/int2 elements add a last axis of length 2.
+*/
+template<typename T>
+class hostArrayView : public hostArrayViewBase
+    {
+    public:
+        hostArrayView(GPUArray<T> &_array, access_mode::Enum _mode, PyObject *_owner, Simple2DModel &_model, int _columns = 1)
+            : array(&_array), mode(_mode), owner(_owner), model(&_model), columns(_columns)
+            {
+            Py_INCREF(owner);
+            };
+        ~hostArrayView()
+            {
+            close();
+            Py_DECREF(owner);
+            };
+
+        virtual PyObject *open(PyObject *self)
+            {
+            if(handle)
+                {
+                PyErr_SetString(PyExc_RuntimeError,"this view of a model array is already open");
+                return NULL;
+                };
+            try
+                {
+                handle.reset(new ArrayHandle<T>(*array,access_location::host,mode));
+                }
+            catch(std::exception &e)
+                {
+                PyErr_SetString(PyExc_RuntimeError,e.what());
+                return NULL;
+                };
+            model->openHostViews += 1;
+
+            npy_intp shape[3];
+            int dimensions = 0;
+            int elements = array->getNumElements();
+            if(columns > 1 && elements % columns == 0)
+                {
+                shape[dimensions++] = elements/columns;
+                shape[dimensions++] = columns;
+                }
+            else
+                shape[dimensions++] = elements;
+            if(numpyLayout<T>::components > 1)
+                shape[dimensions++] = numpyLayout<T>::components;
+            int flags = NPY_ARRAY_C_CONTIGUOUS | NPY_ARRAY_ALIGNED;
+            if(mode != access_mode::read)
+                flags |= NPY_ARRAY_WRITEABLE;
+            PyObject *result = PyArray_New(&PyArray_Type,dimensions,shape,numpyLayout<T>::type,NULL,
+                                           (void *)handle->data,0,flags,NULL);
+            if(!result)
+                {
+                close();
+                return NULL;
+                };
+            Py_INCREF(self);
+            if(PyArray_SetBaseObject((PyArrayObject *)result,self) < 0 || !(opened = PyWeakref_NewRef(result,NULL)))
+                {
+                Py_DECREF(result);
+                close();
+                return NULL;
+                };
+            return result;
+            };
+
+        virtual void close()
+            {
+            if(!handle)
+                return;
+            if(opened)
+                {
+                PyObject *result = PyWeakref_GetObject(opened);
+                if(result && result != Py_None)
+                    PyArray_CLEARFLAGS((PyArrayObject *)result,NPY_ARRAY_WRITEABLE);
+                Py_CLEAR(opened);
+                };
+            handle.reset();
+            model->openHostViews -= 1;
+            };
+
+        virtual bool isOpen(){return (bool)handle;};
+
+    protected:
+        GPUArray<T> *array;
+        access_mode::Enum mode;
+        PyObject *owner;
+        Simple2DModel *model;
+        int columns;
+        unique_ptr<ArrayHandle<T> > handle;
+        //!A weak reference to the last NumPy array handed out
+        PyObject *opened = NULL;
+    };
+
+//!The python object of a hostArrayView
+struct hostArrayViewObject
+    {
+    PyObject_HEAD
+    hostArrayViewBase *view;
+    };
+static PyTypeObject *hostArrayViewType = NULL;
+
+static void hostArrayViewDealloc(PyObject *self)
+    {
+    PyTypeObject *type = Py_TYPE(self);
+    delete ((hostArrayViewObject *)self)->view;
+    type->tp_free(self);
+    Py_DECREF(type);
+    };
+
+static PyObject *hostArrayViewOpen(PyObject *self, PyObject *)
+    {
+    return ((hostArrayViewObject *)self)->view->open(self);
+    };
+
+static PyObject *hostArrayViewClose(PyObject *self, PyObject *)
+    {
+    ((hostArrayViewObject *)self)->view->close();
+    Py_RETURN_NONE;
+    };
+
+static PyObject *hostArrayViewIsOpen(PyObject *self, void *)
+    {
+    return PyBool_FromLong(((hostArrayViewObject *)self)->view->isOpen());
+    };
+
+static PyMethodDef hostArrayViewMethods[] = {
+    {"open",hostArrayViewOpen,METH_NOARGS,"acquire the host data and return it as a NumPy array"},
+    {"close",hostArrayViewClose,METH_NOARGS,"release the host data"},
+    {"__enter__",hostArrayViewOpen,METH_NOARGS,NULL},
+    {"__exit__",hostArrayViewClose,METH_VARARGS,NULL},
+    {NULL}
+    };
+static PyGetSetDef hostArrayViewMembers[] = {
+    {"isOpen",hostArrayViewIsOpen,NULL,"is the host data acquired?",NULL},
+    {NULL}
+    };
+
+//!Return a view of one GPUArray of the model wrapped by owner; the access mode is the optional argument "mode"
+template<typename T>
+static PyObject *makeArrayView(GPUArray<T> &array, PyObject *args, PyObject *kwargs, PyObject *owner, Simple2DModel &model, int columns = 1)
+    {
+    static const char *keywords[] = {"mode",NULL};
+    int mode = access_mode::read;
+    if(!PyArg_ParseTupleAndKeywords(args,kwargs,"|i",(char **)keywords,&mode))
+        return NULL;
+    if(mode != access_mode::read && mode != access_mode::readwrite && mode != access_mode::overwrite)
+        {
+        PyErr_SetString(PyExc_ValueError,"mode must be a cellGPU.access_mode");
+        return NULL;
+        };
+    PyObject *self = hostArrayViewType->tp_alloc(hostArrayViewType,0);
+    if(self)
+        ((hostArrayViewObject *)self)->view = new hostArrayView<T>(array,(access_mode::Enum)mode,owner,model,columns);
+    return self;
+    };
+
+//!A python method returning a view of a GPUArray data member of a model
+template<auto array, int columns = 1>
+static PyObject *arrayMember(PyObject *self, PyObject *args, PyObject *kwargs)
+    {
+    auto model = unwrap<typename memberData<decltype(array)>::owner>(self);
+    if(!model)
+        return NULL;
+    return makeArrayView((*model).*array,args,kwargs,self,*model,columns);
+    };
+
+//!A python method returning a view of the GPUArray returned by a member function of a model
+template<auto accessor>
+static PyObject *arrayAccessor(PyObject *self, PyObject *args, PyObject *kwargs)
+    {
+    auto model = unwrap<typename memberFunction<decltype(accessor)>::owner>(self);
+    if(!model)
+        return NULL;
+    return makeArrayView(((*model).*accessor)(),args,kwargs,self,*model);
+    };
+
+#define ARRAY_MEMBER(name,...) KEYWORD_METHOD(name,(arrayMember<__VA_ARGS__>),"(mode=access_mode.read) a hostArrayView of the " name " of the model")
+#define ARRAY_ACCESSOR(name,accessor) KEYWORD_METHOD(name,arrayAccessor<accessor>,"(mode=access_mode.read) a hostArrayView of the " name " of the model")
+
+/////////////////////////////////////////////////////////////////////////////
+// models
+/////////////////////////////////////////////////////////////////////////////
+
+static PyMethodDef modelMethods[] = {
+    METHOD("getNumberOfDegreesOfFreedom",&Simple2DModel::getNumberOfDegreesOfFreedom,NULL),
+    METHOD("computeForces",&Simple2DModel::computeForces,NULL),
+    METHOD("reportq",&Simple2DModel::reportq,NULL),
+    {NULL}
+    };
+static PyGetSetDef modelMembers[] = {
+    MEMBER("currentTime",&Simple2DModel::currentTime,NULL),
+    MEMBER("openHostViews",&Simple2DModel::openHostViews,"the number of views of this model's arrays that are open"),
+    {NULL}
+    };
+
+static PyObject *cellSetCellPreferencesWithRandomAreas(PyObject *self, PyObject *args, PyObject *kwargs)
+    {
+    static const char *keywords[] = {"p0","aMin","aMax",NULL};
+    double p0, aMin = 0.8, aMax = 1.2;
+    if(!PyArg_ParseTupleAndKeywords(args,kwargs,"d|dd",(char **)keywords,&p0,&aMin,&aMax))
+        return NULL;
+    auto cell = unwrap<Simple2DCell>(self);
+    if(!cell)
+        return NULL;
+    return guardedCall([&](){cell->setCellPreferencesWithRandomAreas(p0,aMin,aMax);});
+    };
+
+static PyObject *cellBox(PyObject *self, PyObject *)
+    {
+    auto cell = unwrap<Simple2DCell>(self);
+    if(!cell)
+        return NULL;
+    double x11,x12,x21,x22;
+    cell->Box->getBoxDims(x11,x12,x21,x22);
+    return Py_BuildValue("(dddd)",x11,x12,x21,x22);
+    };
+
+static PyObject *cellNeighbors(PyObject *self, PyObject *args, PyObject *kwargs)
+    {
+    auto cell = unwrap<Simple2DCell>(self);
+    if(!cell)
+        return NULL;
+    return makeArrayView(cell->neighbors,args,kwargs,self,*cell,cell->n_idx.getW());
+    };
+
+static PyMethodDef cellMethods[] = {
+    METHOD("computeGeometry",&Simple2DCell::computeGeometry,NULL),
+    METHOD("computeEnergy",&Simple2DCell::computeEnergy,NULL),
+    METHOD("computeKineticEnergy",&Simple2DCell::computeKineticEnergy,NULL),
+    METHOD("setRectangularUnitCell",&Simple2DCell::setRectangularUnitCell,NULL),
+    METHOD("setCellPreferencesUniform",&Simple2DCell::setCellPreferencesUniform,NULL),
+    KEYWORD_METHOD("setCellPreferencesWithRandomAreas",cellSetCellPreferencesWithRandomAreas,"(p0, aMin=0.8, aMax=1.2)"),
+    METHOD("setModuliUniform",&Simple2DCell::setModuliUniform,NULL),
+    METHOD("setCellTypeUniform",&Simple2DCell::setCellTypeUniform,NULL),
+    METHOD("setCellType",&Simple2DCell::setCellType,NULL),
+    METHOD("setCellVelocitiesMaxwellBoltzmann",&Simple2DCell::setCellVelocitiesMaxwellBoltzmann,NULL),
+    METHOD("setRandomSeed",&Simple2DCell::setRandomSeed,NULL),
+    {"box",cellBox,METH_NOARGS,"the box matrix (x11, x12, x21, x22)"},
+    ARRAY_ACCESSOR("positions",&Simple2DCell::returnPositions),
+    ARRAY_ACCESSOR("images",&Simple2DCell::returnImages),
+    ARRAY_ACCESSOR("velocities",&Simple2DCell::returnVelocities),
+    ARRAY_ACCESSOR("forces",&Simple2DCell::returnForces),
+    ARRAY_ACCESSOR("masses",&Simple2DCell::returnMasses),
+    ARRAY_MEMBER("cellPositions",&Simple2DCell::cellPositions),
+    ARRAY_MEMBER("vertexPositions",&Simple2DCell::vertexPositions),
+    ARRAY_MEMBER("cellTypes",&Simple2DCell::cellType),
+    ARRAY_ACCESSOR("areaPeri",&Simple2DCell::returnAreaPeri),
+    ARRAY_ACCESSOR("areaPeriPreferences",&Simple2DCell::returnAreaPeriPreferences),
+    ARRAY_ACCESSOR("moduli",&Simple2DCell::returnModuli),
+    ARRAY_MEMBER("neighborNum",&Simple2DCell::neighborNum),
+    KEYWORD_METHOD("neighbors",cellNeighbors,"(mode=access_mode.read) neighbors of every cell, with shape (Ncells, maximum number of neighbors)"),
+    {NULL}
+    };
+static PyGetSetDef cellMembers[] = {
+    MEMBER("Ncells",&Simple2DCell::Ncells,NULL),
+    MEMBER("Nvertices",&Simple2DCell::Nvertices,NULL),
+    {NULL}
+    };
+
+static PyMethodDef activeCellMethods[] = {
+    METHOD("setv0Dr",&Simple2DActiveCell::setv0Dr,NULL),
+    METHOD("setCellDirectorsRandomly",&Simple2DActiveCell::setCellDirectorsRandomly,NULL),
+    ARRAY_MEMBER("cellDirectors",&Simple2DActiveCell::cellDirectors),
+    ARRAY_MEMBER("motility",&Simple2DActiveCell::Motility),
+    {NULL}
+    };
+
+static int initVoronoiQuadraticEnergy(PyObject *self, PyObject *args, PyObject *kwargs)
+    {
+    static const char *keywords[] = {"n","A0","P0","reproducible","usegpu",NULL};
+    int n, reproducible = 0, usegpu = 1;
+    double A0, P0;
+    if(!PyArg_ParseTupleAndKeywords(args,kwargs,"idd|pp",(char **)keywords,&n,&A0,&P0,&reproducible,&usegpu))
+        return -1;
+    return construct<VoronoiQuadraticEnergy,int,double,double,bool,bool>(self,n,A0,P0,reproducible,usegpu);
+    };
+
+static PyObject *vertexCellVertices(PyObject *self, PyObject *args, PyObject *kwargs)
+    {
+    auto vertex = unwrap<vertexModelBase>(self);
+    if(!vertex)
+        return NULL;
+    return makeArrayView(vertex->returnCellVertices(),args,kwargs,self,*vertex,vertex->n_idx.getW());
+    };
+
+static PyMethodDef vertexMethods[] = {
+    METHOD("setT1Threshold",&vertexModelBase::setT1Threshold,NULL),
+    METHOD("setStoreForceSets",&vertexModelBase::setStoreForceSets,NULL),
+    METHOD("setUseHalfEdgeMesh",&vertexModelBase::setUseHalfEdgeMesh,NULL),
+    METHOD("getCellCentroids",&vertexModelBase::getCellCentroids,NULL),
+    METHOD("getCellPositions",&vertexModelBase::getCellPositions,NULL),
+    ARRAY_MEMBER("cellVertexNum",&vertexModelBase::cellVertexNum),
+    KEYWORD_METHOD("cellVertices",vertexCellVertices,"(mode=access_mode.read) vertices of every cell, with shape (Ncells, maximum number of vertices)"),
+    KEYWORD_METHOD("vertexNeighbors",(arrayMember<&vertexModelBase::vertexNeighbors,3>),"(mode=access_mode.read) the three vertices connected to every vertex"),
+    KEYWORD_METHOD("vertexCellNeighbors",(arrayMember<&vertexModelBase::vertexCellNeighbors,3>),"(mode=access_mode.read) the three cells every vertex touches"),
+    {NULL}
+    };
+
+static int initVertexQuadraticEnergy(PyObject *self, PyObject *args, PyObject *kwargs)
+    {
+    static const char *keywords[] = {"n","A0","P0","reproducible","runSPVToInitialize","usegpu",NULL};
+    int n, reproducible = 0, runSPVToInitialize = 0, usegpu = 1;
+    double A0, P0;
+    if(!PyArg_ParseTupleAndKeywords(args,kwargs,"idd|ppp",(char **)keywords,&n,&A0,&P0,&reproducible,&runSPVToInitialize,&usegpu))
+        return -1;
+    return construct<VertexQuadraticEnergy,int,double,double,bool,bool,bool>(self,n,A0,P0,reproducible,runSPVToInitialize,usegpu);
+    };
+
+/////////////////////////////////////////////////////////////////////////////
+// equations of motion
+/////////////////////////////////////////////////////////////////////////////
+
+static PyMethodDef updaterMethods[] = {
+    METHOD("setPeriod",&updater::setPeriod,NULL),
+    METHOD("setPhase",&updater::setPhase,NULL),
+    METHOD("setDeltaT",&updater::setDeltaT,NULL),
+    {NULL}
+    };
+
+static int initBrownianParticleDynamics(PyObject *self, PyObject *args, PyObject *kwargs)
+    {
+    static const char *keywords[] = {"N","usegpu",NULL};
+    int N, usegpu = 1;
+    if(!PyArg_ParseTupleAndKeywords(args,kwargs,"i|p",(char **)keywords,&N,&usegpu))
+        return -1;
+    return construct<brownianParticleDynamics,int,bool>(self,N,usegpu);
+    };
+static PyMethodDef brownianMethods[] = {
+    METHOD("setT",&brownianParticleDynamics::setT,NULL),
+    METHOD("setMu",&brownianParticleDynamics::setMu,NULL),
+    {NULL}
+    };
+
+static int initLangevinDynamics(PyObject *self, PyObject *args, PyObject *kwargs)
+    {
+    static const char *keywords[] = {"N","temperature","gamma","usegpu",NULL};
+    int N, usegpu = 1;
+    double temperature = 1.0, gamma = 1.0;
+    if(!PyArg_ParseTupleAndKeywords(args,kwargs,"i|ddp",(char **)keywords,&N,&temperature,&gamma,&usegpu))
+        return -1;
+    return construct<langevinDynamics,int,double,double,bool>(self,N,temperature,gamma,usegpu);
+    };
+static PyMethodDef langevinMethods[] = {
+    METHOD("setT",&langevinDynamics::setT,NULL),
+    METHOD("setGamma",&langevinDynamics::setGamma,NULL),
+    {NULL}
+    };
+
+static int initNoseHooverChainNVT(PyObject *self, PyObject *args, PyObject *kwargs)
+    {
+    static const char *keywords[] = {"N","M","useGPU",NULL};
+    int N, M = 2, useGPU = 1;
+    if(!PyArg_ParseTupleAndKeywords(args,kwargs,"i|ip",(char **)keywords,&N,&M,&useGPU))
+        return -1;
+    return construct<NoseHooverChainNVT,int,int,bool>(self,N,M,useGPU);
+    };
+static PyMethodDef noseHooverMethods[] = {
+    METHOD("setT",&NoseHooverChainNVT::setT,NULL),
+    {NULL}
+    };
+
+static int initSelfPropelledParticleDynamics(PyObject *self, PyObject *args, PyObject *kwargs)
+    {
+    static const char *keywords[] = {"N","usegpu",NULL};
+    int N, usegpu = 1;
+    if(!PyArg_ParseTupleAndKeywords(args,kwargs,"i|p",(char **)keywords,&N,&usegpu))
+        return -1;
+    return construct<selfPropelledParticleDynamics,int,bool>(self,N,usegpu);
+    };
+static PyMethodDef selfPropelledMethods[] = {
+    METHOD("setMu",&selfPropelledParticleDynamics::setMu,NULL),
+    {NULL}
+    };
+
+static int initEnergyMinimizerFIRE(PyObject *self, PyObject *args, PyObject *kwargs)
+    {
+    static const char *keywords[] = {"system","useGPU",NULL};
+    PyObject *system;
+    int useGPU = 1;
+    if(!PyArg_ParseTupleAndKeywords(args,kwargs,"O|p",(char **)keywords,&system,&useGPU))
+        return -1;
+    shared_ptr<Simple2DModel> model = unwrap<Simple2DModel>(system);
+    if(!model)
+        return -1;
+    return construct<EnergyMinimizerFIRE,shared_ptr<Simple2DModel>,bool>(self,model,useGPU);
+    };
+static PyMethodDef fireMethods[] = {
+    METHOD("setMaximumIterations",&EnergyMinimizerFIRE::setMaximumIterations,NULL),
+    METHOD("setForceCutoff",&EnergyMinimizerFIRE::setForceCutoff,NULL),
+    METHOD("setAlphaStart",&EnergyMinimizerFIRE::setAlphaStart,NULL),
+    METHOD("setDeltaTMax",&EnergyMinimizerFIRE::setDeltaTMax,NULL),
+    METHOD("setDeltaTInc",&EnergyMinimizerFIRE::setDeltaTInc,NULL),
+    METHOD("setDeltaTDec",&EnergyMinimizerFIRE::setDeltaTDec,NULL),
+    METHOD("setAlphaDec",&EnergyMinimizerFIRE::setAlphaDec,NULL),
+    METHOD("setNMin",&EnergyMinimizerFIRE::setNMin,NULL),
+    METHOD("getMaxForce",&EnergyMinimizerFIRE::getMaxForce,NULL),
+    {NULL}
+    };
+
+/////////////////////////////////////////////////////////////////////////////
+// the simulation
+/////////////////////////////////////////////////////////////////////////////
+
+static int initSimulation(PyObject *self, PyObject *args, PyObject *kwargs)
+    {
+    static const char *keywords[] = {NULL};
+    if(!PyArg_ParseTupleAndKeywords(args,kwargs,"",(char **)keywords))
+        return -1;
+    return construct<Simulation>(self);
+    };
+
+//!The simulation keeps only weak pointers to its configuration and updaters, so python keeps them alive
+static PyObject *simulationSetConfiguration(PyObject *self, PyObject *args)
+    {
+    PyObject *configuration;
+    if(!PyArg_ParseTuple(args,"O",&configuration))
+        return NULL;
+    auto sim = unwrap<Simulation>(self);
+    if(!sim)
+        return NULL;
+    auto model = unwrap<Simple2DCell>(configuration);
+    if(!model)
+        return NULL;
+    keepAlive(self,configuration);
+    return guardedCall([&](){sim->setConfiguration(model);});
+    };
+
+static PyObject *simulationAddUpdater(PyObject *self, PyObject *args)
+    {
+    PyObject *upd, *configuration;
+    if(!PyArg_ParseTuple(args,"OO",&upd,&configuration))
+        return NULL;
+    auto sim = unwrap<Simulation>(self);
+    if(!sim)
+        return NULL;
+    auto u = unwrap<updater>(upd);
+    if(!u)
+        return NULL;
+    auto model = unwrap<Simple2DCell>(configuration);
+    if(!model)
+        return NULL;
+    keepAlive(self,upd);
+    return guardedCall([&](){sim->addUpdater(u,model);});
+    };
+
+//!Take time steps without holding the GIL
+static PyObject *advance(PyObject *self, int steps)
+    {
+    auto sim = unwrap<Simulation>(self);
+    if(!sim || !noOpenViews(*sim))
+        return NULL;
+    string error;
+    Py_BEGIN_ALLOW_THREADS
+    try
+        {
+        for (int tt = 0; tt < steps; ++tt)
+            sim->performTimestep();
+        }
+    catch(std::exception &e)
+        {
+        error = e.what();
+        };
+    Py_END_ALLOW_THREADS
+    if(!error.empty())
+        {
+        PyErr_SetString(PyExc_RuntimeError,error.c_str());
+        return NULL;
+        };
+    Py_RETURN_NONE;
+    };
+
+static PyObject *simulationPerformTimestep(PyObject *self, PyObject *)
+    {
+    return advance(self,1);
+    };
+
+static PyObject *simulationPerformTimesteps(PyObject *self, PyObject *args)
+    {
+    int steps;
+    if(!PyArg_ParseTuple(args,"i",&steps))
+        return NULL;
+    return advance(self,steps);
+    };
+
+static PyObject *simulationWriteCheckpoint(PyObject *self, PyObject *args, PyObject *kwargs)
+    {
+    static const char *keywords[] = {"fileName","background",NULL};
+    const char *fileName;
+    int background = 1;
+    if(!PyArg_ParseTupleAndKeywords(args,kwargs,"s|p",(char **)keywords,&fileName,&background))
+        return NULL;
+    auto sim = unwrap<Simulation>(self);
+    if(!sim || !noOpenViews(*sim))
+        return NULL;
+    return guardedCall([&](){sim->writeCheckpoint(fileName,background);});
+    };
+
+static PyObject *simulationReadCheckpoint(PyObject *self, PyObject *args)
+    {
+    const char *fileName;
+    if(!PyArg_ParseTuple(args,"s",&fileName))
+        return NULL;
+    auto sim = unwrap<Simulation>(self);
+    if(!sim || !noOpenViews(*sim))
+        return NULL;
+    return guardedCall([&](){sim->readCheckpoint(fileName);});
+    };
+
+static PyMethodDef simulationMethods[] = {
+    {"setConfiguration",simulationSetConfiguration,METH_VARARGS,NULL},
+    {"addUpdater",simulationAddUpdater,METH_VARARGS,"(updater, model)"},
+    METHOD("setIntegrationTimestep",&Simulation::setIntegrationTimestep,NULL),
+    METHOD("setCPUOperation",&Simulation::setCPUOperation,NULL),
+    METHOD("setReproducible",&Simulation::setReproducible,NULL),
+    METHOD("setRandomSeed",&Simulation::setRandomSeed,NULL),
+    METHOD("setSortPeriod",&Simulation::setSortPeriod,NULL),
+    METHOD("setCurrentTime",&Simulation::setCurrentTime,NULL),
+    METHOD("setOmpThreads",&Simulation::setOmpThreads,NULL),
+    {"performTimestep",simulationPerformTimestep,METH_NOARGS,NULL},
+    {"performTimesteps",simulationPerformTimesteps,METH_VARARGS,"advance the simulation by the given number of time steps, without holding the GIL"},
+    KEYWORD_METHOD("writeCheckpoint",simulationWriteCheckpoint,"(fileName, background=True)"),
+    {"readCheckpoint",simulationReadCheckpoint,METH_VARARGS,NULL},
+    METHOD("waitForCheckpoint",&Simulation::waitForCheckpoint,NULL),
+    {NULL}
+    };
+static PyGetSetDef simulationMembers[] = {
+    MEMBER("integerTimestep",&Simulation::integerTimestep,NULL),
+    MEMBER("Time",&Simulation::Time,NULL),
+    {NULL}
+    };
+
+/////////////////////////////////////////////////////////////////////////////
+// trajectories
+/////////////////////////////////////////////////////////////////////////////
+
+static int initMappedTrajectoryDatabase(PyObject *self, PyObject *args, PyObject *kwargs)
+    {
+    static const char *keywords[] = {"fn","mode","storeTopology",NULL};
+    const char *fn = "trajectory.cgt";
+    int mode = fileMode::readonly, storeTopology = 1;
+    if(!PyArg_ParseTupleAndKeywords(args,kwargs,"|sip",(char **)keywords,&fn,&mode,&storeTopology))
+        return -1;
+    return construct<mappedTrajectoryDatabase,string,fileMode::Enum,bool>(self,fn,(fileMode::Enum)mode,storeTopology);
+    };
+
+static PyObject *databaseWriteState(PyObject *self, PyObject *args, PyObject *kwargs)
+    {
+    static const char *keywords[] = {"state","time",NULL};
+    PyObject *state;
+    double time = -1.0;
+    if(!PyArg_ParseTupleAndKeywords(args,kwargs,"O|d",(char **)keywords,&state,&time))
+        return NULL;
+    auto db = unwrap<mappedTrajectoryDatabase>(self);
+    if(!db)
+        return NULL;
+    auto cell = unwrap<Simple2DCell>(state);
+    if(!cell || !noOpenViews(*cell))
+        return NULL;
+    return guardedCall([&](){db->writeState(cell,time);});
+    };
+
+static PyObject *databaseReadState(PyObject *self, PyObject *args, PyObject *kwargs)
+    {
+    static const char *keywords[] = {"state","rec","geometry",NULL};
+    PyObject *state;
+    int rec, geometry = 1;
+    if(!PyArg_ParseTupleAndKeywords(args,kwargs,"Oi|p",(char **)keywords,&state,&rec,&geometry))
+        return NULL;
+    auto db = unwrap<mappedTrajectoryDatabase>(self);
+    if(!db)
+        return NULL;
+    auto cell = unwrap<Simple2DCell>(state);
+    if(!cell || !noOpenViews(*cell))
+        return NULL;
+    return guardedCall([&](){db->readState(cell,rec,geometry);});
+    };
+
+//!Store a zero-copy, read-only NumPy array of a span of the mapped file, kept alive by the database, in a dict
+template<typename T>
+static bool addFrameArray(PyObject *frame, const char *key, const trajectorySpan<T> &span, int columns, PyObject *self)
+    {
+    npy_intp shape[3];
+    int dimensions = 0;
+    shape[dimensions++] = span.size/columns;
+    if(columns > 1)
+        shape[dimensions++] = columns;
+    if(numpyLayout<T>::components > 1)
+        shape[dimensions++] = numpyLayout<T>::components;
+    PyObject *result = PyArray_New(&PyArray_Type,dimensions,shape,numpyLayout<T>::type,NULL,(void *)span.data,0,
+                                   NPY_ARRAY_C_CONTIGUOUS | NPY_ARRAY_ALIGNED,NULL);
+    if(!result)
+        return false;
+    Py_INCREF(self);
+    bool added = PyArray_SetBaseObject((PyArrayObject *)result,self) == 0 && PyDict_SetItemString(frame,key,result) == 0;
+    Py_DECREF(result);
+    return added;
+    };
+
+static PyObject *databaseFrame(PyObject *self, PyObject *args, PyObject *kwargs)
+    {
+    static const char *keywords[] = {"rec",NULL};
+    int rec = -1;
+    if(!PyArg_ParseTupleAndKeywords(args,kwargs,"|i",(char **)keywords,&rec))
+        return NULL;
+    auto db = unwrap<mappedTrajectoryDatabase>(self);
+    if(!db)
+        return NULL;
+    trajectoryFrame f;
+    try
+        {
+        f = db->getFrame(rec);
+        }
+    catch(std::exception &e)
+        {
+        PyErr_SetString(PyExc_RuntimeError,e.what());
+        return NULL;
+        };
+    PyObject *frame = Py_BuildValue("{s:d,s:(dddd)}","time",f.time,"box",f.box[0],f.box[1],f.box[2],f.box[3]);
+    if(!frame)
+        return NULL;
+    bool added = addFrameArray(frame,"positions",f.positions,1,self)
+              && addFrameArray(frame,"images",f.images,1,self)
+              && addFrameArray(frame,"velocities",f.velocities,1,self)
+              && addFrameArray(frame,"types",f.types,1,self)
+              && addFrameArray(frame,"cellPositions",f.cellPositions,1,self);
+    if(added && !f.neighborNum.empty())
+        added = addFrameArray(frame,"neighborNum",f.neighborNum,1,self)
+             && addFrameArray(frame,"neighborOffsets",f.neighborOffsets,1,self)
+             && addFrameArray(frame,"neighbors",f.neighbors,1,self);
+    if(added && !f.cellVertexNum.empty())
+        added = addFrameArray(frame,"vertexNeighbors",f.vertexNeighbors,3,self)
+             && addFrameArray(frame,"vertexCellNeighbors",f.vertexCellNeighbors,3,self)
+             && addFrameArray(frame,"cellVertexNum",f.cellVertexNum,1,self)
+             && addFrameArray(frame,"cellVertexOffsets",f.cellVertexOffsets,1,self)
+             && addFrameArray(frame,"cellVertices",f.cellVertices,1,self);
+    if(!added)
+        {
+        Py_DECREF(frame);
+        return NULL;
+        };
+    return frame;
+    };
+
+static PyMethodDef databaseMethods[] = {
+    KEYWORD_METHOD("writeState",databaseWriteState,"(state, time=-1.0)"),
+    KEYWORD_METHOD("readState",databaseReadState,"(state, rec, geometry=True)"),
+    METHOD("flush",&mappedTrajectoryDatabase::flush,NULL),
+    METHOD("numberOfFrames",&mappedTrajectoryDatabase::numberOfFrames,NULL),
+    METHOD("frameTime",&mappedTrajectoryDatabase::frameTime,NULL),
+    KEYWORD_METHOD("frame",databaseFrame,"(rec=-1) read-only NumPy views of every stored quantity of a frame, ordered by tag"),
+    METHOD("exportToHDF5",&mappedTrajectoryDatabase::exportToHDF5,NULL),
+    METHOD("isVertexModel",&mappedTrajectoryDatabase::isVertexModel,NULL),
+    METHOD("hasTopology",&mappedTrajectoryDatabase::hasTopology,NULL),
+    {NULL}
+    };
+
+/////////////////////////////////////////////////////////////////////////////
+// the module
+/////////////////////////////////////////////////////////////////////////////
+
+//!Add an enum.IntEnum with the given members to the module
+static bool addEnum(PyObject *module, const char *name, const vector<pair<const char *,int> > &values)
+    {
+    PyObject *enumModule = PyImport_ImportModule("enum");
+    if(!enumModule)
+        return false;
+    PyObject *members = PyList_New(0);
+    for (auto &v : values)
+        {
+        PyObject *member = Py_BuildValue("(si)",v.first,v.second);
+        PyList_Append(members,member);
+        Py_XDECREF(member);
+        };
+    PyObject *result = PyObject_CallMethod(enumModule,"IntEnum","sO",name,members);
+    Py_DECREF(members);
+    Py_DECREF(enumModule);
+    if(!result)
+        return false;
+    PyObject *moduleName = PyModule_GetNameObject(module);
+    if(moduleName)
+        PyObject_SetAttrString(result,"__module__",moduleName);
+    Py_XDECREF(moduleName);
+    if(PyModule_AddObject(module,name,result) < 0)
+        {
+        Py_DECREF(result);
+        return false;
+        };
+    return true;
+    };
+
+static struct PyModuleDef cellGPUModule = {
+    PyModuleDef_HEAD_INIT,
+    "cellGPU",
+    "python bindings of cellGPU, with zero-copy NumPy views of model arrays",
+    -1,
+    NULL
+    };
+
+PyMODINIT_FUNC PyInit_cellGPU(void)
+    {
+    import_array();
+    PyObject *m = PyModule_Create(&cellGPUModule);
+    if(!m)
+        return NULL;
+
+    PyType_Slot viewSlots[] = {
+        {Py_tp_dealloc,(void *)hostArrayViewDealloc},
+        {Py_tp_methods,hostArrayViewMethods},
+        {Py_tp_getset,hostArrayViewMembers},
+        {Py_tp_doc,(void *)"a NumPy view of the host data of a model array, valid while open"},
+        {0,NULL}
+        };
+    PyType_Spec viewSpec = {"cellGPU.hostArrayView",(int)sizeof(hostArrayViewObject),0,
+                            Py_TPFLAGS_DEFAULT | Py_TPFLAGS_DISALLOW_INSTANTIATION,viewSlots};
+    hostArrayViewType = (PyTypeObject *)PyType_FromSpec(&viewSpec);
+    Py_XINCREF(hostArrayViewType);
+
+    bool ok = hostArrayViewType != NULL
+        && PyModule_AddObject(m,"hostArrayView",(PyObject *)hostArrayViewType) == 0
+        && addEnum(m,"access_mode",{{"read",access_mode::read},{"readwrite",access_mode::readwrite},
+                                    {"overwrite",access_mode::overwrite}})
+        && addEnum(m,"fileMode",{{"readonly",fileMode::readonly},{"readwrite",fileMode::readwrite},
+                                 {"replace",fileMode::replace}})
+        //models
+        && addType<Simple2DModel>(m,"cellGPU.Simple2DModel","the base of all models",modelMethods,modelMembers)
+        && addType<Simple2DCell,Simple2DModel>(m,"cellGPU.Simple2DCell","a model of cells in a periodic box",cellMethods,cellMembers)
+        && addType<Simple2DActiveCell,Simple2DCell>(m,"cellGPU.Simple2DActiveCell","cells with directors and motility",activeCellMethods)
+        && addType<voronoiModelBase,Simple2DActiveCell>(m,"cellGPU.voronoiModelBase","the base of Voronoi models",NULL)
+        && addType<VoronoiQuadraticEnergy,voronoiModelBase>(m,"cellGPU.VoronoiQuadraticEnergy",
+                "VoronoiQuadraticEnergy(n, A0, P0, reproducible=False, usegpu=True)",NULL,NULL,initVoronoiQuadraticEnergy)
+        && addType<vertexModelBase,Simple2DActiveCell>(m,"cellGPU.vertexModelBase","the base of vertex models",vertexMethods)
+        && addType<VertexQuadraticEnergy,vertexModelBase>(m,"cellGPU.VertexQuadraticEnergy",
+                "VertexQuadraticEnergy(n, A0, P0, reproducible=False, runSPVToInitialize=False, usegpu=True)",NULL,NULL,initVertexQuadraticEnergy)
+        //equations of motion
+        && addType<updater>(m,"cellGPU.updater","the base of all updaters",updaterMethods)
+        && addType<updaterWithNoise,updater>(m,"cellGPU.updaterWithNoise","an updater with a noise source",NULL)
+        && addType<simpleEquationOfMotion,updaterWithNoise>(m,"cellGPU.simpleEquationOfMotion","the base of the equations of motion",NULL)
+        && addType<brownianParticleDynamics,simpleEquationOfMotion>(m,"cellGPU.brownianParticleDynamics",
+                "brownianParticleDynamics(N, usegpu=True)",brownianMethods,NULL,initBrownianParticleDynamics)
+        && addType<langevinDynamics,simpleEquationOfMotion>(m,"cellGPU.langevinDynamics",
+                "langevinDynamics(N, temperature=1.0, gamma=1.0, usegpu=True)",langevinMethods,NULL,initLangevinDynamics)
+        && addType<NoseHooverChainNVT,simpleEquationOfMotion>(m,"cellGPU.NoseHooverChainNVT",
+                "NoseHooverChainNVT(N, M=2, useGPU=True)",noseHooverMethods,NULL,initNoseHooverChainNVT)
+        && addType<selfPropelledParticleDynamics,simpleEquationOfMotion>(m,"cellGPU.selfPropelledParticleDynamics",
+                "selfPropelledParticleDynamics(N, usegpu=True)",selfPropelledMethods,NULL,initSelfPropelledParticleDynamics)
+        && addType<EnergyMinimizerFIRE,simpleEquationOfMotion>(m,"cellGPU.EnergyMinimizerFIRE",
+                "EnergyMinimizerFIRE(system, useGPU=True)",fireMethods,NULL,initEnergyMinimizerFIRE)
+        //the simulation, and trajectories
+        && addType<Simulation>(m,"cellGPU.Simulation","Simulation()",simulationMethods,simulationMembers,initSimulation)
+        && addType<mappedTrajectoryDatabase>(m,"cellGPU.mappedTrajectoryDatabase",
+                "mappedTrajectoryDatabase(fn='trajectory.cgt', mode=fileMode.readonly, storeTopology=True)",
+                databaseMethods,NULL,initMappedTrajectoryDatabase);
+    if(!ok)
+        {
+        Py_DECREF(m);
+        return NULL;
+        };
+    return m;
+    };
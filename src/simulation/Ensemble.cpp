@@ -0,0 +1,87 @@
+#include "Ensemble.h"
+#include <exception>
+/*! \file Ensemble.cpp */
+
+/*!
+\param sim a Simulation whose configuration and updaters have already been set
+\param configuration the configuration of sim
+\param ownedUpdaters updaters of sim that the ensemble should keep alive
+\param seed passed to sim->setRandomSeed; a negative value uses the index of the replica
+*/
+int Ensemble::addReplica(SimulationPtr sim, ForcePtr configuration, vector<UpdaterPtr> ownedUpdaters, int seed)
+    {
+    replica newReplica;
+    newReplica.simulation = sim;
+    newReplica.configuration = configuration;
+    newReplica.updaters = ownedUpdaters;
+    newReplica.seed = (seed < 0) ? replicas.size() : seed;
+    sim->setRandomSeed(newReplica.seed);
+    replicas.push_back(newReplica);
+
+    //schedule the largest replicas first, so that the last ones to finish are small
+    schedule.resize(replicas.size());
+    for (size_t rr = 0; rr < replicas.size(); ++rr)
+        schedule[rr] = rr;
+    stable_sort(schedule.begin(),schedule.end(),[this](int a, int b)
+        {
+        return replicas[a].configuration->getNumberOfDegreesOfFreedom() > replicas[b].configuration->getNumberOfDegreesOfFreedom();
+        });
+    return replicas.size()-1;
+    };
+
+vector<ForcePtr> Ensemble::getConfigurations()
+    {
+    vector<ForcePtr> configurations(replicas.size());
+    for (size_t rr = 0; rr < replicas.size(); ++rr)
+        configurations[rr] = replicas[rr].configuration;
+    return configurations;
+    };
+
+vector<int> Ensemble::getSeeds()
+    {
+    vector<int> seeds(replicas.size());
+    for (size_t rr = 0; rr < replicas.size(); ++rr)
+        seeds[rr] = replicas[rr].seed;
+    return seeds;
+    };
+
+/*!
+Exceptions cannot leave an openMP region, so a replica that throws is stopped and the first exception
+(in replica order) is rethrown once every other replica has finished its steps
+*/
+void Ensemble::performTimesteps(int steps)
+    {
+    PROFILE_SCOPE("Ensemble::performTimesteps");
+    int numberOfReplicas = replicas.size();
+    bool gpu = false;
+    for (int rr = 0; rr < numberOfReplicas; ++rr)
+        if(replicas[rr].simulation->USE_GPU)
+            gpu = true;
+    int teamSize = gpu ? 1 : min(threads,max(1,numberOfReplicas));
+    vector<exception_ptr> failures(numberOfReplicas);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    #pragma omp parallel for schedule(dynamic,1) num_threads(teamSize)
+    for (int ss = 0; ss < numberOfReplicas; ++ss)
+        {
+        int rr = schedule[ss];
+        try
+            {
+            for (int tt = 0; tt < steps; ++tt)
+                replicas[rr].simulation->performTimestep();
+            }
+        catch(...)
+            {
+            failures[rr] = current_exception();
+            };
+        };
+
+    lastWallTime = chrono::duration<double>(chrono::steady_clock::now()-start).count();
+    lastThroughput = (lastWallTime > 0) ? (double)steps*numberOfReplicas/lastWallTime : 0.0;
+    for (int rr = 0; rr < numberOfReplicas; ++rr)
+        if(failures[rr])
+            {
+            printf("replica %i (seed %i) failed during Ensemble::performTimesteps\n",rr,replicas[rr].seed);
+            rethrow_exception(failures[rr]);
+            };
+    };
@@ -0,0 +1,87 @@
+#ifndef ENSEMBLE_H
+#define ENSEMBLE_H
+
+#include "std_include.h"
+#include "Simulation.h"
+
+/*! \file Ensemble.h */
+//!Advance many independent Simulations (replicas) concurrently
+/*!
+Parameter sweeps tend to use many small systems, none of which can keep a many-core CPU busy through
+the openMP loops inside a single model. An Ensemble instead runs whole replicas in parallel, one replica
+per thread at a time: performTimesteps(n) hands out replicas dynamically (largest first) to a team of
+openMP threads, each of which advances its replica by n time steps before taking the next one, so
+throughput scales with the number of threads as long as there are at least as many replicas.
+
+Typical use:
+\code
+Ensemble ensemble(threads);
+for each (p0, v0, seed)
+    {
+    //build a model, an equation of motion and a Simulation as usual (CPU operation, reproducible)
+    ensemble.addReplica(sim,model,{eom},seed);
+    }
+ensembleDatabase output(ensemble.getConfigurations(),"sweep.h5",fileMode::replace);
+for (int frame = 0; frame < frames; ++frame)
+    {
+    ensemble.performTimesteps(stepsPerFrame);
+    output.writeState(ensemble.getConfigurations());
+    }
+\endcode
+Each replica is seeded (Simulation::setRandomSeed) when it is added, so replicas with different seeds
+have independent, reproducible noise. Since a Simulation only keeps weak pointers, the Ensemble holds
+the configuration and any updaters passed to addReplica.
+
+Replicas must not share anything that is modified during a time step (boxes, models, updaters, or a
+runtimeMetrics registry). The openMP loops of each replica run with that replica's own thread count;
+with the default of one thread per replica, the replicas are the only source of parallelism. Ensembles
+are meant for CPU operation; on a GPU, replicas are simply advanced one after the other.
+*/
+class Ensemble
+    {
+    public:
+        //!An ensemble whose replicas will be advanced by the given number of threads
+        Ensemble(int _threads = 1){setThreads(_threads);};
+
+        //!Add a replica; seed < 0 uses the replica's index. Returns the index of the replica
+        int addReplica(SimulationPtr sim, ForcePtr configuration, vector<UpdaterPtr> ownedUpdaters = vector<UpdaterPtr>(), int seed = -1);
+        //!The number of replicas
+        int size(){return replicas.size();};
+
+        //!Set the number of replicas advanced concurrently
+        void setThreads(int _threads){threads = max(1,_threads);};
+        int getThreads(){return threads;};
+
+        //!Advance every replica by the given number of time steps
+        void performTimesteps(int steps);
+
+        //!The Simulation of replica r
+        SimulationPtr getSimulation(int r){return replicas[r].simulation;};
+        //!The configuration of replica r
+        ForcePtr getConfiguration(int r){return replicas[r].configuration;};
+        //!The configurations of every replica, in order
+        vector<ForcePtr> getConfigurations();
+        //!The seed of every replica, in order
+        vector<int> getSeeds();
+
+        //!wall-clock time of the last call to performTimesteps, in seconds
+        double lastWallTime = 0.0;
+        //!replica time steps per second during the last call to performTimesteps
+        double lastThroughput = 0.0;
+
+    protected:
+        //!Everything needed to keep one replica alive and running
+        struct replica
+            {
+            SimulationPtr simulation;
+            ForcePtr configuration;
+            vector<UpdaterPtr> updaters;
+            int seed;
+            };
+        vector<replica> replicas;
+        //!replica indices, in decreasing order of their number of degrees of freedom
+        vector<int> schedule;
+        //!the number of replicas advanced concurrently
+        int threads;
+    };
+#endif
@@ -10,6 +10,16 @@ sortPeriod(-1)
     Box = make_shared<periodicBoundaries>();
     };
 
+/*!
+Add a pointer to the list of updaters, connecting it to the metrics registry if there is one
+*/
+void Simulation::addUpdater(UpdaterPtr _upd)
+    {
+    if(metrics)
+        _upd->setMetrics(metrics);
+    updaters.push_back(_upd);
+    };
+
 /*!
 Add a pointer to the list of updaters, and give that updater a reference to the
 model...
@@ -17,7 +27,34 @@ model...
 void Simulation::addUpdater(UpdaterPtr _upd, ForcePtr _config)
     {
     _upd->set2DModel(_config);
-    updaters.push_back(_upd);
+    addUpdater(_upd);
+    };
+
+shared_ptr<runtimeMetrics> Simulation::getMetrics()
+    {
+    if(!metrics)
+        setMetrics(make_shared<runtimeMetrics>());
+    return metrics;
+    };
+
+/*!
+The configuration and every updater added so far are given the registry (ones added later get it when
+they are added), and from then on performTimestep calls endStep at the end of every time step
+*/
+void Simulation::setMetrics(shared_ptr<runtimeMetrics> _metrics)
+    {
+    metrics = _metrics;
+    if(metrics)
+        spatialSortMetric = metrics->registerCounter("simulation/spatialSorts");
+    auto cellConf = cellConfiguration.lock();
+    if(cellConf)
+        cellConf->setMetrics(metrics);
+    for (size_t u = 0; u < updaters.size(); ++u)
+        {
+        auto upd = updaters[u].lock();
+        if(upd)
+            upd->setMetrics(metrics);
+        };
     };
 
 /*!
@@ -45,6 +82,8 @@ void Simulation::setConfiguration(ForcePtr _config)
     {
     cellConfiguration = _config;
     Box = _config->Box;
+    if(metrics)
+        _config->setMetrics(metrics);
     };
 
 /*!
@@ -126,6 +165,26 @@ void Simulation::setReproducible(bool reproducible)
         };
     };
 
+/*!
+The configuration and each updater are seeded with successive integers generated by a seed_seq
+initialized with seed, so that nearby seeds (e.g. the replica numbers of an Ensemble) still give unrelated
+streams. This only affects components that use the reproducible generators, so it should be combined
+with setReproducible(true)
+*/
+void Simulation::setRandomSeed(int seed)
+    {
+    vector<unsigned int> componentSeeds(updaters.size()+1);
+    seed_seq sequence{seed};
+    sequence.generate(componentSeeds.begin(),componentSeeds.end());
+    auto cellConf = cellConfiguration.lock();
+    cellConf->setRandomSeed(componentSeeds[0] & 0x7fffffff);
+    for (size_t u = 0; u < updaters.size(); ++u)
+        {
+        auto upd = updaters[u].lock();
+        upd->setRandomSeed(componentSeeds[u+1] & 0x7fffffff);
+        };
+    };
+
 /*!
 Calls the configuration to displace the degrees of freedom
 */
@@ -152,6 +211,7 @@ spatial sorting routine.
 */
 void Simulation::performTimestep()
     {
+    PROFILE_SCOPE("Simulation::performTimestep");
     integerTimestep += 1;
     Time += integrationTimestep;
 
@@ -167,6 +227,9 @@ void Simulation::performTimestep()
     //check if spatial sorting needs to occur
     if (sortPeriod > 0 && integerTimestep % sortPeriod == 0)
         {
+        PROFILE_SCOPE("Simulation::spatialSorting");
+        if(metrics)
+            metrics->increment(spatialSortMetric);
         cellConf->spatialSorting();
         for (int u = 0; u < updaters.size(); ++u)
             {
@@ -175,4 +238,82 @@ void Simulation::performTimestep()
             };
         };
     cellConf->setTime(Time);
+    if(metrics)
+        metrics->endStep();
+    };
+
+/*!
+The state of the simulation clock, the configuration (records starting with "model/"), and each updater
+("updater0/", "updater1/", ...) is copied into memory, so the simulation can be advanced as soon as this
+returns; if background is true the file itself is then written on another thread (see waitForCheckpoint).
+Only the state is stored, not the set-up: parameters of the equations of motion (temperatures,
+mobilities...), the choice of model and of updaters, etc. are not in the checkpoint.
+*/
+void Simulation::writeCheckpoint(const string &fileName, bool background)
+    {
+    PROFILE_SCOPE("Simulation::writeCheckpoint");
+    waitForCheckpoint();
+    shared_ptr<checkpointWriter> out = make_shared<checkpointWriter>();
+    out->prefix = "simulation/";
+    out->addValue("integerTimestep",integerTimestep);
+    out->addValue("Time",Time);
+    out->addValue("integrationTimestep",integrationTimestep);
+    out->addValue("numberOfUpdaters",(int)updaters.size());
+    out->prefix = "model/";
+    auto cellConf = cellConfiguration.lock();
+    cellConf->writeCheckpoint(*out);
+    for (size_t u = 0; u < updaters.size(); ++u)
+        {
+        out->prefix = "updater" + to_string(u) + "/";
+        auto upd = updaters[u].lock();
+        upd->writeCheckpoint(*out);
+        };
+    if(background)
+        pendingCheckpoint = async(launch::async,[out,fileName]{out->write(fileName);});
+    else
+        out->write(fileName);
+    };
+
+/*!
+Errors of a background write are reported here, rather than by the writeCheckpoint call that started it
+*/
+void Simulation::waitForCheckpoint()
+    {
+    if(pendingCheckpoint.valid())
+        pendingCheckpoint.get();
+    };
+
+/*!
+\pre this Simulation has the same kind of configuration, with the same number of degrees of freedom, and
+the same updaters (in the same order, with the same parameters, and set to the CPU or GPU in the same way)
+as the one that wrote the checkpoint
+\post the simulation continues exactly as the original one would have; in particular no re-triangulation
+or other reconstruction of the topology is done
+*/
+void Simulation::readCheckpoint(const string &fileName)
+    {
+    PROFILE_SCOPE("Simulation::readCheckpoint");
+    waitForCheckpoint();
+    checkpointReader in(fileName);
+    in.prefix = "simulation/";
+    int numberOfUpdaters;
+    in.readValue("numberOfUpdaters",numberOfUpdaters);
+    if(numberOfUpdaters != (int)updaters.size())
+        {
+        printf("the checkpoint %s was written by a simulation with %i updaters, but this one has %lu\n",
+               fileName.c_str(),numberOfUpdaters,updaters.size());
+        throw std::exception();
+        };
+    in.readValue("integerTimestep",integerTimestep);
+    in.readValue("Time",Time);
+    in.readValue("integrationTimestep",integrationTimestep);
+    in.prefix = "model/";
+    auto cellConf = cellConfiguration.lock();
+    cellConf->readCheckpoint(in);
+    for (size_t u = 0; u < updaters.size(); ++u)
+        {
+        in.prefix = "updater" + to_string(u) + "/";
+        auto upd = updaters[u].lock();
+        upd->readCheckpoint(in);
+        };
     };
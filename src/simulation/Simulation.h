@@ -6,6 +6,8 @@
 #include "simpleEquationOfMotion.h"
 #include "updater.h"
 #include "periodicBoundaries.h"
+#include "checkpointFile.h"
+#include <future>
 
 /*! \file Simulation.h */
 
@@ -38,7 +40,7 @@ class Simulation : public enable_shared_from_this<Simulation>
         vector<WeakUpdaterPtr> updaters;
 
         //!Add an updater
-        void addUpdater(UpdaterPtr _upd){updaters.push_back(_upd);};
+        void addUpdater(UpdaterPtr _upd);
         //!Add an updater with a reference to a configuration
         void addUpdater(UpdaterPtr _upd, ForcePtr _config);
 
@@ -56,6 +58,8 @@ class Simulation : public enable_shared_from_this<Simulation>
         void setCPUOperation(bool setcpu);
         //!Enforce reproducible dynamics
         void setReproducible(bool reproducible);
+        //!Give the configuration and every updater its own reproducible random stream derived from seed
+        void setRandomSeed(int seed);
 
         //!Set the time between spatial sorting operations.
         void setSortPeriod(int sp){sortPeriod = sp;};
@@ -78,7 +82,25 @@ class Simulation : public enable_shared_from_this<Simulation>
         //set number of threads
         virtual void setOmpThreads(int _number);
 
+        //!The metrics registry of the simulation, created (and handed to the configuration and updaters) on first use
+        shared_ptr<runtimeMetrics> getMetrics();
+        //!Report to the given registry (which may be shared with other simulations); a null pointer stops reporting
+        void setMetrics(shared_ptr<runtimeMetrics> _metrics);
+
+        //!Write everything needed to continue this simulation exactly to a binary checkpoint
+        void writeCheckpoint(const string &fileName, bool background = true);
+        //!Continue from a checkpoint written by a simulation set up in the same way as this one
+        void readCheckpoint(const string &fileName);
+        //!Wait until a checkpoint being written in the background is on disk
+        void waitForCheckpoint();
+
     protected:
+        //!The checkpoint currently being written in the background, if any
+        future<void> pendingCheckpoint;
+        //!The registry the configuration and updaters report to, if any
+        shared_ptr<runtimeMetrics> metrics;
+        //!id of the spatial sorting counter
+        int spatialSortMetric;
         //! Determines how frequently the spatial sorter be called...once per sortPeriod Timesteps. When sortPeriod < 0 no sorting occurs
         int sortPeriod;
         //!A flag that determins if a spatial sorting is due to occur this Timestep
@@ -80,6 +80,7 @@ void EnergyMinimizerFIRE::initializeFromModel()
  */
 void EnergyMinimizerFIRE::velocityVerlet()
     {
+    PROFILE_SCOPE("EnergyMinimizerFIRE::velocityVerlet");
     if (GPUcompute)
         velocityVerletGPU();
     else
@@ -91,6 +92,7 @@ void EnergyMinimizerFIRE::velocityVerlet()
  */
 void EnergyMinimizerFIRE::fireStep()
     {
+    PROFILE_SCOPE("EnergyMinimizerFIRE::fireStep");
     if (GPUcompute)
         fireStepGPU();
     else
@@ -134,14 +136,17 @@ void EnergyMinimizerFIRE::velocityVerletCPU()
         ArrayHandle<double2> h_f(force);
         ArrayHandle<double2> h_v(velocity);
         ArrayHandle<double2> h_d(displacements);
-        for (int i = 0; i < N; ++i)
+        //treat the double2 arrays as flat streams of 2N doubles so that the loop vectorizes
+        double *f = (double *) h_f.data;
+        double *v = (double *) h_v.data;
+        double *d = (double *) h_d.data;
+        #pragma omp simd
+        for (int i = 0; i < 2*N; ++i)
             {
             //update displacement
-            h_d.data[i].x = deltaT*h_v.data[i].x+0.5*deltaT*deltaT*h_f.data[i].x;
-            h_d.data[i].y = deltaT*h_v.data[i].y+0.5*deltaT*deltaT*h_f.data[i].y;
+            d[i] = deltaT*v[i]+0.5*deltaT*deltaT*f[i];
             //do first half of velocity update
-            h_v.data[i].x += 0.5*deltaT*h_f.data[i].x;
-            h_v.data[i].y += 0.5*deltaT*h_f.data[i].y;
+            v[i] += 0.5*deltaT*f[i];
             };
         };
     //move particles, then update the forces
@@ -153,11 +158,11 @@ void EnergyMinimizerFIRE::velocityVerletCPU()
     //update second half of velocity vector based on new forces
     ArrayHandle<double2> h_f(force);
     ArrayHandle<double2> h_v(velocity);
-    for (int i = 0; i < N; ++i)
-        {
-        h_v.data[i].x += 0.5*deltaT*h_f.data[i].x;
-        h_v.data[i].y += 0.5*deltaT*h_f.data[i].y;
-        };
+    double *f = (double *) h_f.data;
+    double *v = (double *) h_v.data;
+    #pragma omp simd
+    for (int i = 0; i < 2*N; ++i)
+        v[i] += 0.5*deltaT*f[i];
     };
 
 /*!
@@ -230,18 +235,24 @@ void EnergyMinimizerFIRE::fireStepCPU()
         ArrayHandle<double2> h_v(velocity);
         double forceNorm = 0.0;
         double velocityNorm = 0.0;
+        double power = 0.0;
+        double fMax = 0.0;
+        #pragma omp simd reduction(+:power,forceNorm,velocityNorm) reduction(max:fMax)
         for (int i = 0; i < N; ++i)
             {
-            Power += dot(h_f.data[i],h_v.data[i]);
+            power += dot(h_f.data[i],h_v.data[i]);
             double fdot = dot(h_f.data[i],h_f.data[i]);
-            if (fdot > forceMax) forceMax = fdot;
+            fMax = max(fMax,fdot);
             forceNorm += fdot;
             velocityNorm += dot(h_v.data[i],h_v.data[i]);
             };
+        Power = power;
+        forceMax = fMax;
         double scaling = 0.0;
         if(forceNorm > 0.)
             scaling = sqrt(velocityNorm/forceNorm);
         //adjust the velocity according to the FIRE algorithm
+        #pragma omp simd
         for (int i = 0; i < N; ++i)
             {
             h_v.data[i].x = (1.0-alpha)*h_v.data[i].x + alpha*scaling*h_f.data[i].x;
@@ -278,21 +289,66 @@ void EnergyMinimizerFIRE::fireStepCPU()
  */
 void EnergyMinimizerFIRE::minimize()
     {
+    PROFILE_SCOPE("EnergyMinimizerFIRE::minimize");
     if (N != State->getNumberOfDegreesOfFreedom())
         initializeFromModel();
     //initialize the forces?
     State->computeForces();
     State->getForces(force);
     forceMax = 110.0;
+    int initialIterations = iterations;
     while( (iterations < maxIterations) && (sqrt(forceMax) > forceCutoff) )
         {
         iterations +=1;
         velocityVerlet();
         fireStep();
         };
+    if(metrics)
+        {
+        metrics->increment(iterationsMetric,iterations-initialIterations);
+        metrics->setGauge(maximumForceMetric,sqrt(forceMax));
+        };
         printf("step %i max force:%.3g \tpower: %.3g\t alpha %.3g\t dt %g \n",iterations,sqrt(forceMax),Power,alpha,deltaT);
     };
 
+void EnergyMinimizerFIRE::setMetrics(shared_ptr<runtimeMetrics> _metrics)
+    {
+    metrics = _metrics;
+    if(!metrics)
+        return;
+    iterationsMetric = metrics->registerCounter("FIRE/iterations");
+    maximumForceMetric = metrics->registerGauge("FIRE/maximumForce");
+    };
+
+/*!
+FIRE keeps its own deltaT (adapted during a minimization) in addition to that of the equation of motion
+*/
+void EnergyMinimizerFIRE::writeCheckpoint(checkpointWriter &out)
+    {
+    simpleEquationOfMotion::writeCheckpoint(out);
+    out.addValue("FIRE/iterations",iterations);
+    out.addValue("FIRE/NSinceNegativePower",NSinceNegativePower);
+    out.addValue("FIRE/deltaT",deltaT);
+    out.addValue("FIRE/alpha",alpha);
+    out.addValue("FIRE/Power",Power);
+    out.addValue("FIRE/forceMax",forceMax);
+    out.addArray("FIRE/velocity",velocity);
+    out.addArray("FIRE/force",force);
+    };
+
+void EnergyMinimizerFIRE::readCheckpoint(checkpointReader &in)
+    {
+    simpleEquationOfMotion::readCheckpoint(in);
+    in.readValue("FIRE/iterations",iterations);
+    in.readValue("FIRE/NSinceNegativePower",NSinceNegativePower);
+    in.readValue("FIRE/deltaT",deltaT);
+    in.readValue("FIRE/alpha",alpha);
+    in.readValue("FIRE/Power",Power);
+    in.readValue("FIRE/forceMax",forceMax);
+    in.readArray("FIRE/velocity",velocity);
+    in.readArray("FIRE/force",force);
+    };
+
 /*!
 A utility function to help test the parallel reduction routines
  */
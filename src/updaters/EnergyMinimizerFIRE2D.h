@@ -78,7 +78,17 @@ class EnergyMinimizerFIRE : public simpleEquationOfMotion
         //!Return the maximum force
         double getMaxForce(){return forceMax;};
 
+        //!Report FIRE/iterations and the gauge FIRE/maximumForce to a metrics registry
+        virtual void setMetrics(shared_ptr<runtimeMetrics> _metrics);
+
+        //!Add the adaptive time step, mixing parameter, and velocities to the checkpoint
+        virtual void writeCheckpoint(checkpointWriter &out);
+        //!Restore a state written by writeCheckpoint
+        virtual void readCheckpoint(checkpointReader &in);
+
     protected:
+        //!ids of the reported metrics
+        int iterationsMetric, maximumForceMetric;
         //!The number of iterations performed
         int iterations;
         //!The maximum number of iterations allowed
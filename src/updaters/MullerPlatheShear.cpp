@@ -34,6 +34,7 @@ slabs' desired direction. Swap the x-momenta of the two worst offenders
 */
 void MullerPlatheShear::performUpdate()
     {
+    PROFILE_SCOPE("MullerPlatheShear::performUpdate");
     //first, try to identify the right-fastest and left-fastest particles in the two slabs
     int p1idx = -1;
     int p2idx = -1;
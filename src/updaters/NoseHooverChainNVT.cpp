@@ -65,6 +65,7 @@ outside of the normal timestep loops.
 */
 void NoseHooverChainNVT::integrateEquationsOfMotion()
     {
+    PROFILE_SCOPE("NoseHooverChainNVT::integrateEquationsOfMotion");
     Timestep += 1;
     if (State->getNumberOfDegreesOfFreedom() != Ndof)
         {
@@ -93,6 +94,24 @@ void NoseHooverChainNVT::reportBathData()
         printf("%f\t%f\t%f\t%f\n",bath.data[i].x,bath.data[i].y,bath.data[i].z,bath.data[i].w);
     };
 
+/*!
+The bath positions and velocities evolve with the chain, and the kinetic energy and velocity scale factor
+computed in one step are used at the start of the next
+*/
+void NoseHooverChainNVT::writeCheckpoint(checkpointWriter &out)
+    {
+    simpleEquationOfMotion::writeCheckpoint(out);
+    out.addArray("BathVariables",BathVariables);
+    out.addArray("kineticEnergyScaleFactor",kineticEnergyScaleFactor);
+    };
+
+void NoseHooverChainNVT::readCheckpoint(checkpointReader &in)
+    {
+    simpleEquationOfMotion::readCheckpoint(in);
+    in.readArray("BathVariables",BathVariables);
+    in.readArray("kineticEnergyScaleFactor",kineticEnergyScaleFactor);
+    };
+
 /*!
 The implementation here closely follows algorithms 30 - 32 in Frenkel & Smit, generalized to the
 case where the chain length is not necessarily always 2
@@ -141,12 +160,15 @@ void NoseHooverChainNVT::propagatePositionsVelocities()
     ArrayHandle<double2> h_f(State->returnForces(),access_location::host,access_mode::read);
     ArrayHandle<double2> h_v(State->returnVelocities(),access_location::host,access_mode::readwrite);
     ArrayHandle<double> h_m(State->returnMasses(),access_location::host,access_mode::read);
+    double kineticEnergy = 0.0;
+    #pragma omp simd reduction(+:kineticEnergy)
     for (int ii = 0; ii < Ndof; ++ii)
         {
         h_v.data[ii] = h_v.data[ii] + (deltaT/h_m.data[ii])*h_f.data[ii];
         h_disp.data[ii] = deltaT2*h_v.data[ii];
-        h_kes.data[0] += 0.5*h_m.data[ii]*dot(h_v.data[ii],h_v.data[ii]);
+        kineticEnergy += 0.5*h_m.data[ii]*dot(h_v.data[ii],h_v.data[ii]);
         }
+    h_kes.data[0] += kineticEnergy;
     };
     State->moveDegreesOfFreedom(displacements);
     };
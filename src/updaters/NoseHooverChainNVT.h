@@ -43,6 +43,10 @@ class NoseHooverChainNVT : public simpleEquationOfMotion
 
         //!Report the current status of the bath
         void reportBathData();
+        //!Add the bath variables to the checkpoint
+        virtual void writeCheckpoint(checkpointWriter &out);
+        //!Restore a state written by writeCheckpoint
+        virtual void readCheckpoint(checkpointReader &in);
 
     protected:
         //!The targeted temperature
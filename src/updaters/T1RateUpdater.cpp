@@ -0,0 +1,71 @@
+#include "T1RateUpdater.h"
+/*! \file T1RateUpdater.cpp */
+
+void T1RateUpdater::getContacts(vector<long long> &contacts)
+    {
+    int Ncells = cellModel->Ncells;
+    vector<int> idxToTag(Ncells);
+    for (int tag = 0; tag < Ncells; ++tag)
+        idxToTag[cellModel->tagToIdx[tag]] = tag;
+    contacts.clear();
+    bool vertexModel = (&degreeOfFreedomTags() == &cellModel->tagToIdxVertex);
+    if(vertexModel)
+        {
+        int Nvertices = cellModel->Nvertices;
+        ArrayHandle<int> h_vcn(cellModel->vertexCellNeighbors,access_location::host,access_mode::read);
+        contacts.reserve(3*Nvertices);
+        for (int vv = 0; vv < Nvertices; ++vv)
+            for (int aa = 0; aa < 3; ++aa)
+                {
+                long long t1 = idxToTag[h_vcn.data[3*vv+aa]];
+                long long t2 = idxToTag[h_vcn.data[3*vv+(aa+1)%3]];
+                contacts.push_back(min(t1,t2)*Ncells+max(t1,t2));
+                };
+        }
+    else
+        {
+        ArrayHandle<int> h_nn(cellModel->neighborNum,access_location::host,access_mode::read);
+        ArrayHandle<int> h_n(cellModel->neighbors,access_location::host,access_mode::read);
+        for (int ii = 0; ii < Ncells; ++ii)
+            for (int nn = 0; nn < h_nn.data[ii]; ++nn)
+                {
+                int jj = h_n.data[cellModel->n_idx(nn,ii)];
+                if(jj <= ii)
+                    continue;
+                long long t1 = idxToTag[ii];
+                long long t2 = idxToTag[jj];
+                contacts.push_back(min(t1,t2)*Ncells+max(t1,t2));
+                };
+        };
+    sort(contacts.begin(),contacts.end());
+    contacts.erase(unique(contacts.begin(),contacts.end()),contacts.end());
+    };
+
+void T1RateUpdater::analyze()
+    {
+    vector<long long> contacts;
+    getContacts(contacts);
+    int Ncells = cellModel->Ncells;
+    lastT1 = 0;
+    if(!previousContacts.empty() && Ncells == previousNcells)
+        {
+        vector<long long> newContacts;
+        set_difference(contacts.begin(),contacts.end(),previousContacts.begin(),previousContacts.end(),
+                       back_inserter(newContacts));
+        lastT1 = newContacts.size();
+        totalT1 += lastT1;
+        //only intervals whose T1s were counted enter the rate
+        timesteps += Period;
+        cellTimesteps += (double)Ncells*Period;
+        };
+    previousContacts.swap(contacts);
+    previousNcells = Ncells;
+    };
+
+void T1RateUpdater::getSummary(vector<double> &summary)
+    {
+    summary.resize(3);
+    summary[0] = totalT1;
+    summary[1] = (cellTimesteps > 0) ? totalT1/cellTimesteps : 0.0;
+    summary[2] = lastT1;
+    };
@@ -0,0 +1,44 @@
+#ifndef T1RateUpdater_H
+#define T1RateUpdater_H
+
+#include "analysisUpdater.h"
+
+/*! \file T1RateUpdater.h */
+//!Count neighbor exchanges (T1 transitions) while a simulation runs
+/*!
+Each analysis builds the sorted list of cell-cell contacts, labeled by cell tag: the Delaunay neighbors
+in Voronoi models, and every pair of cells sharing a vertex in vertex models. Every contact present now
+but absent at the previous analysis is counted as one T1 transition (each T1 creates exactly one new
+contact and removes one). Transitions that are undone before the next analysis are missed, so the
+Period should be short compared to the time between rearrangements of a given cell. If the number of
+cells changes, the contact list is rebuilt without counting, and that interval is left out of the rate.
+The summary is (total T1s, total T1s per cell per timestep, T1s since the previous analysis).
+*/
+class T1RateUpdater : public analysisUpdater
+    {
+    public:
+        T1RateUpdater(int period, int phase = 0) : analysisUpdater(period,phase){};
+
+        virtual void analyze();
+        virtual int getSummarySize(){return 3;};
+        virtual void getSummary(vector<double> &summary);
+        virtual void reset(){samples = 0; totalT1 = 0; timesteps = 0; cellTimesteps = 0.0;};
+
+        //!The number of T1 transitions counted since the last reset
+        long long totalT1 = 0;
+        //!the number counted in the most recent analysis
+        int lastT1 = 0;
+
+    protected:
+        //!fill the sorted list of contacts, each encoded as (smaller tag)*Ncells + (larger tag)
+        void getContacts(vector<long long> &contacts);
+        //!The contacts at the previous analysis
+        vector<long long> previousContacts;
+        //!the number of cells at the previous analysis
+        int previousNcells = 0;
+        //!timesteps over which T1s were counted since the last reset
+        long long timesteps = 0;
+        //!the sum of Ncells*timesteps since the last reset
+        double cellTimesteps = 0.0;
+    };
+#endif
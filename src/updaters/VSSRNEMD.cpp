@@ -40,6 +40,7 @@ slices of the simulation box
 */
 void VSSRNEMD::performUpdate()
     {
+    PROFILE_SCOPE("VSSRNEMD::performUpdate");
     ArrayHandle<double2> h_p(model->returnPositions(),access_location::host,access_mode::read);
     ArrayHandle<double> h_m(model->returnMasses(),access_location::host,access_mode::read);
     ArrayHandle<double2> h_v(model->returnVelocities());
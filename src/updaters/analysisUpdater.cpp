@@ -0,0 +1,84 @@
+#include "analysisUpdater.h"
+#include "vectorValueDatabase.h"
+/*! \file analysisUpdater.cpp */
+
+void analysisUpdater::set2DModel(shared_ptr<Simple2DModel> _model)
+    {
+    model = _model;
+    cellModel = dynamic_pointer_cast<Simple2DCell>(_model);
+    if(!cellModel)
+        {
+        printf("analysis updaters require a model derived from Simple2DCell\n");
+        throw std::exception();
+        };
+    };
+
+void analysisUpdater::performUpdate()
+    {
+    PROFILE_SCOPE("analysisUpdater::performUpdate");
+    analyze();
+    samples += 1;
+    if(flushEvery > 0 && samples % flushEvery == 0)
+        {
+        flush();
+        if(resetAfterFlush)
+            reset();
+        };
+    };
+
+/*!
+\param filename the hdf5 file to (re)create
+\param _flushEvery the summary is written every _flushEvery analyses (i.e., every Period*_flushEvery timesteps)
+\param _resetAfterFlush if true, each record is an average over just the analyses since the previous one
+*/
+void analysisUpdater::setOutput(string filename, int _flushEvery, bool _resetAfterFlush)
+    {
+    database = make_shared<valueVectorDatabase>(filename,getSummarySize(),fileMode::replace);
+    flushEvery = _flushEvery;
+    resetAfterFlush = _resetAfterFlush;
+    };
+
+void analysisUpdater::flush()
+    {
+    if(!database)
+        {
+        printf("analysisUpdater::flush called without an output file (see setOutput)\n");
+        throw std::exception();
+        };
+    vector<double> summary;
+    getSummary(summary);
+    summary.resize(getSummarySize(),0.0);
+    database->writeState(model->currentTime,summary);
+    };
+
+/*!
+The degrees of freedom of the model are the vertices if returnPositions hands back the vertex positions,
+and the cells otherwise
+*/
+vector<int> & analysisUpdater::degreeOfFreedomTags()
+    {
+    if(&(cellModel->returnPositions()) == &(cellModel->vertexPositions))
+        return cellModel->tagToIdxVertex;
+    return cellModel->tagToIdx;
+    };
+
+void analysisUpdater::getTaggedPositions(vector<double2> &positions, bool unwrapped)
+    {
+    vector<int> &tagToIdx = degreeOfFreedomTags();
+    int N = tagToIdx.size();
+    positions.resize(N);
+    if(unwrapped)
+        {
+        GPUArray<double2> unwrappedPositions;
+        cellModel->getUnwrappedPositions(unwrappedPositions);
+        ArrayHandle<double2> h_u(unwrappedPositions,access_location::host,access_mode::read);
+        for (int tag = 0; tag < N; ++tag)
+            positions[tag] = h_u.data[tagToIdx[tag]];
+        }
+    else
+        {
+        ArrayHandle<double2> h_p(cellModel->returnPositions(),access_location::host,access_mode::read);
+        for (int tag = 0; tag < N; ++tag)
+            positions[tag] = h_p.data[tagToIdx[tag]];
+        };
+    };
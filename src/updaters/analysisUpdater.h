@@ -0,0 +1,65 @@
+#ifndef analysisUpdater_H
+#define analysisUpdater_H
+
+#include "std_include.h"
+#include "updater.h"
+#include "Simple2DCell.h"
+
+class valueVectorDatabase;
+
+/*! \file analysisUpdater.h */
+//!A base class for updaters that accumulate an analysis in memory while a simulation runs
+/*!
+Rather than writing full trajectories and analyzing them afterwards, an analysisUpdater is added to a
+Simulation (with addUpdater, and a Period and Phase, like any other updater). Every time it is called
+it reads the current state of the model directly and updates some in-memory accumulators. A compact
+summary (a fixed-length vector of doubles) can be requested at any time with getSummary, or written
+automatically every flushEvery calls to a valueVectorDatabase, one record per flush with the
+simulation time as the value.
+Quantities that follow particular cells or vertices use the tags of the model, so spatial sorting does
+not affect them.
+*/
+class analysisUpdater : public updater
+    {
+    public:
+        //!set the period and phase with which the analysis is performed
+        analysisUpdater(int period, int phase = 0){Period = period; Phase = phase;};
+
+        //!keep a Simple2DCell pointer to the model as well as the base Simple2DModel one
+        virtual void set2DModel(shared_ptr<Simple2DModel> _model);
+        //!perform the analysis, and flush the summary if needed
+        virtual void performUpdate();
+
+        //!update the in-memory accumulators with the current state of the model
+        virtual void analyze() = 0;
+        //!the (fixed) length of the summary vector
+        virtual int getSummarySize() = 0;
+        //!fill the summary vector with the current results
+        virtual void getSummary(vector<double> &summary) = 0;
+        //!zero the accumulators
+        virtual void reset(){samples = 0;};
+
+        //!write the summary to the given file every flushEvery analyses; optionally reset the accumulators after each flush
+        void setOutput(string filename, int _flushEvery, bool _resetAfterFlush = false);
+        //!write the current summary to the output file
+        void flush();
+
+        //!The number of times analyze has been called since the last reset
+        int samples = 0;
+
+    protected:
+        //!A pointer to the model as a Simple2DCell, giving access to tags and image counters
+        shared_ptr<Simple2DCell> cellModel;
+        //!the output database, if any
+        shared_ptr<valueVectorDatabase> database;
+        //!the number of analyses between flushes (<= 0 means never flush automatically)
+        int flushEvery = 0;
+        //!Reset after flushing?
+        bool resetAfterFlush = false;
+
+        //!the tag-to-index map of the degrees of freedom of the model (cells or vertices)
+        vector<int> & degreeOfFreedomTags();
+        //!positions of the degrees of freedom, ordered by tag, and unwrapped if requested
+        void getTaggedPositions(vector<double2> &positions, bool unwrapped = false);
+    };
+#endif
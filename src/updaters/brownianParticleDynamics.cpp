@@ -46,6 +46,7 @@ Advances brownian dynamics by one time step
 */
 void brownianParticleDynamics::integrateEquationsOfMotion()
     {
+    PROFILE_SCOPE("brownianParticleDynamics::integrateEquationsOfMotion");
     Timestep += 1;
     if (cellModel->getNumberOfDegreesOfFreedom() != Ndof)
         {
@@ -0,0 +1,89 @@
+#include "dynamicsUpdater.h"
+/*! \file dynamicsUpdater.cpp */
+
+/*!
+The lag schedule is exactly the one multiOriginDynamics will use, so that the summary size is known
+before the first frame
+*/
+dynamicsUpdater::dynamicsUpdater(int period, int _originSpacing, int _maximumOrigins, double _lagExponent,
+                                 double _k, double _overlapCutoff, int phase)
+    : analysisUpdater(period,phase)
+    {
+    originSpacing = _originSpacing;
+    maximumOrigins = _maximumOrigins;
+    lagExponent = _lagExponent;
+    k = _k;
+    overlapCutoff = _overlapCutoff;
+    logSpacedIntegers lags(1,lagExponent);
+    while(lags.nextSave <= originSpacing*maximumOrigins)
+        {
+        lagSchedule.push_back(lags.nextSave);
+        lags.update();
+        };
+    };
+
+void dynamicsUpdater::setTaggedPositions()
+    {
+    vector<double2> positions;
+    getTaggedPositions(positions,true);
+    fillGPUArrayWithVector(positions,taggedPositions);
+    };
+
+/*!
+multiOriginDynamics follows a fixed set of particles, so if cells were added or removed since the time
+origins were set, they are discarded and this analysis sets the first origin of a fresh run
+*/
+void dynamicsUpdater::analyze()
+    {
+    setTaggedPositions();
+    int Ndof = taggedPositions.getNumElements();
+    if(dynamics && Ndof != dynamicsNdof)
+        {
+        printf("dynamicsUpdater: the number of degrees of freedom changed from %i to %i; discarding all time origins\n",
+               dynamicsNdof,Ndof);
+        dynamics.reset();
+        };
+    if(!dynamics)
+        {
+        dynamicsNdof = Ndof;
+        dynamics = make_shared<multiOriginDynamics>(taggedPositions,cellModel->Box,originSpacing,maximumOrigins,
+                                                    lagExponent,k,overlapCutoff);
+        dynamics->setPositionsUnwrapped(true);
+        return;
+        };
+    dynamics->update(taggedPositions);
+    };
+
+int dynamicsUpdater::getSummarySize()
+    {
+    return 6*lagSchedule.size();
+    };
+
+void dynamicsUpdater::getSummary(vector<double> &summary)
+    {
+    int nLags = lagSchedule.size();
+    summary.assign(6*nLags,0.0);
+    for (int ll = 0; ll < nLags; ++ll)
+        summary[ll] = (double)lagSchedule[ll]*Period;
+    if(!dynamics)
+        return;
+    vector<int> lags;
+    vector<double> msd,fs,overlap,chi4Fs,chi4Overlap;
+    dynamics->getDynamics(lags,msd,fs,overlap,chi4Fs,chi4Overlap);
+    int ll = 0;
+    for (int ii = 0; ii < (int)lags.size(); ++ii)
+        {
+        while(ll < nLags && lagSchedule[ll] != lags[ii])
+            ll += 1;
+        if(ll == nLags)
+            {
+            printf("dynamicsUpdater: lag %i is not in the lag schedule\n",lags[ii]);
+            throw std::exception();
+            };
+        summary[nLags+ll] = msd[ii];
+        summary[2*nLags+ll] = fs[ii];
+        summary[3*nLags+ll] = overlap[ii];
+        summary[4*nLags+ll] = chi4Fs[ii];
+        summary[5*nLags+ll] = chi4Overlap[ii];
+        };
+    };
@@ -0,0 +1,50 @@
+#ifndef dynamicsUpdater_H
+#define dynamicsUpdater_H
+
+#include "analysisUpdater.h"
+#include "multiOriginDynamics.h"
+
+/*! \file dynamicsUpdater.h */
+//!Accumulate time-origin averaged MSD, F_s, overlap and chi_4 while a simulation runs
+/*!
+A thin wrapper around multiOriginDynamics. The first analysis sets the first time origin; every later
+one adds a frame. Positions are handed over in tag order and already unwrapped with the model's image
+counters, so neither spatial sorting nor the time between analyses limits the result. If the number of
+cells changes (by cell division or death), all time origins are discarded and the analysis
+at which the change is seen sets the first origin of a fresh run.
+The summary has one entry per scheduled lag for each of: the lag in timesteps (i.e., in frames times the
+Period), MSD, F_s, overlap, chi_4(F_s) and chi_4(overlap). Lags that have not yet been sampled are
+reported as zero.
+*/
+class dynamicsUpdater : public analysisUpdater
+    {
+    public:
+        //!set the period, the origin and lag schedule of multiOriginDynamics, and the phase
+        dynamicsUpdater(int period, int _originSpacing = 10, int _maximumOrigins = 100, double _lagExponent = 0.05,
+                        double _k = 6.28319, double _overlapCutoff = 0.5, int phase = 0);
+
+        virtual void analyze();
+        virtual int getSummarySize();
+        virtual void getSummary(vector<double> &summary);
+        //!Discard all time origins; the next analysis starts afresh
+        virtual void reset(){samples = 0; dynamics.reset();};
+
+        //!The underlying analysis object (null until the first analysis)
+        shared_ptr<multiOriginDynamics> dynamics;
+
+    protected:
+        int originSpacing;
+        int maximumOrigins;
+        double lagExponent;
+        double k;
+        double overlapCutoff;
+        //!the number of degrees of freedom when the current time origins were set
+        int dynamicsNdof = 0;
+        //!the full lag schedule, in frames
+        vector<int> lagSchedule;
+        //!scratch space for the tag-ordered positions
+        GPUArray<double2> taggedPositions;
+        //!copy the tag-ordered, unwrapped positions into taggedPositions
+        void setTaggedPositions();
+    };
+#endif
@@ -51,6 +51,7 @@ Advances brownian dynamics by one time step
 */
 void gradientDescent::integrateEquationsOfMotion()
     {
+    PROFILE_SCOPE("gradientDescent::integrateEquationsOfMotion");
     Timestep += 1;
     if (cellModel->getNumberOfDegreesOfFreedom() != Ndof)
         {
@@ -120,11 +121,11 @@ void gradientDescent::integrateEquationsOfMotionCPU()
     ArrayHandle<double2> h_f(cellModel->returnForces(),access_location::host,access_mode::read);
     ArrayHandle<double2> h_disp(displacements,access_location::host,access_mode::overwrite);
 
-    for (int ii = 0; ii < Ndof; ++ii)
-        {
-        h_disp.data[ii].x = deltaT*h_f.data[ii].x;
-        h_disp.data[ii].y = deltaT*h_f.data[ii].y;
-        };
+    double *f = (double *) h_f.data;
+    double *disp = (double *) h_disp.data;
+    #pragma omp simd
+    for (int ii = 0; ii < 2*Ndof; ++ii)
+        disp[ii] = deltaT*f[ii];
     };//end array handle scope
     cellModel->moveDegreesOfFreedom(displacements);
     cellModel->enforceTopology();
@@ -69,6 +69,7 @@ Advances langevin dynamics by one time step
 */
 void langevinDynamics::integrateEquationsOfMotion()
     {
+    PROFILE_SCOPE("langevinDynamics::integrateEquationsOfMotion");
     Timestep += 1;
     if (cellModel->getNumberOfDegreesOfFreedom() != Ndof)
         {
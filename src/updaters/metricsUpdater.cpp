@@ -0,0 +1,64 @@
+#include "metricsUpdater.h"
+/*! \file metricsUpdater.cpp */
+
+void metricsUpdater::setColumns()
+    {
+    if(!metrics)
+        {
+        printf("metricsUpdater needs a metrics registry (see Simulation::getMetrics)\n");
+        throw std::exception();
+        };
+    vector<string> names = metrics->columnNames();
+    if(columns.empty())
+        columns = names;
+    //later registrations change the positions of the columns in a snapshot, so look them up again
+    unordered_map<string,int> position;
+    for (size_t cc = 0; cc < names.size(); ++cc)
+        position[names[cc]] = cc;
+    columnIndex.resize(columns.size());
+    for (size_t cc = 0; cc < columns.size(); ++cc)
+        columnIndex[cc] = position[columns[cc]];
+    snapshotSize = names.size();
+    };
+
+int metricsUpdater::getSummarySize()
+    {
+    if(columns.empty())
+        setColumns();
+    return columns.size();
+    };
+
+void metricsUpdater::setCSVOutput(string filename)
+    {
+    csv = make_shared<ofstream>(filename.c_str());
+    if(!csv->is_open())
+        {
+        printf("could not open %s for writing\n",filename.c_str());
+        throw std::exception();
+        };
+    getSummarySize();
+    *csv << "time";
+    for (size_t cc = 0; cc < columns.size(); ++cc)
+        *csv << "," << columns[cc];
+    *csv << "\n";
+    };
+
+void metricsUpdater::analyze()
+    {
+    int size = getSummarySize();
+    vector<double> row;
+    metrics->snapshot(row);
+    if(row.size() != (size_t)snapshotSize)
+        setColumns();
+    lastRow.resize(size);
+    for (int cc = 0; cc < size; ++cc)
+        lastRow[cc] = row[columnIndex[cc]];
+    if(csv)
+        {
+        *csv << setprecision(12) << model->currentTime;
+        for (int cc = 0; cc < size; ++cc)
+            *csv << "," << lastRow[cc];
+        *csv << "\n";
+        csv->flush();
+        };
+    };
@@ -0,0 +1,48 @@
+#ifndef metricsUpdater_H
+#define metricsUpdater_H
+
+#include "analysisUpdater.h"
+
+/*! \file metricsUpdater.h */
+//!Periodically write the runtime metrics of a simulation to a valueVectorDatabase or a CSV file
+/*!
+The updater reads the runtimeMetrics registry it is given by the Simulation (so it must be added with
+addUpdater after getMetrics or setMetrics has been called, or be given a registry with setMetrics).
+Every analysis takes a snapshot of the registry (see runtimeMetrics::snapshot): the number of steps and
+the wall-clock time since the previous analysis, the counter increments and histogram counts over that
+interval, and the current gauges. That row is the summary, so setOutput(filename,1) writes one record per
+analysis with the simulation time as the value, and setCSVOutput writes the same rows, preceded by a
+header of column names, to a text file.
+The columns are fixed by the first analysis, and getColumnNames lists them; metrics registered after
+that are left out of the output. The updater should be added last, so that each row covers whole time
+steps.
+*/
+class metricsUpdater : public analysisUpdater
+    {
+    public:
+        metricsUpdater(int period, int phase = 0) : analysisUpdater(period,phase){};
+
+        virtual void analyze();
+        virtual int getSummarySize();
+        virtual void getSummary(vector<double> &summary){summary = lastRow;};
+
+        //!Also write every row to a CSV file, with the simulation time in the first column
+        void setCSVOutput(string filename);
+        //!The names of the summary entries
+        vector<string> getColumnNames(){getSummarySize(); return columns;};
+
+    protected:
+        //!fix the columns (the registry's columns at the time of the first call)
+        void setColumns();
+        //!the names of the output columns
+        vector<string> columns;
+        //!the position of each output column in a full snapshot
+        vector<int> columnIndex;
+        //!the registry's number of columns when columnIndex was built
+        int snapshotSize = 0;
+        //!the most recent row
+        vector<double> lastRow;
+        //!The CSV output, if any
+        shared_ptr<ofstream> csv;
+    };
+#endif
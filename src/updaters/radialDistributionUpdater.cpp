@@ -0,0 +1,143 @@
+#include "radialDistributionUpdater.h"
+/*! \file radialDistributionUpdater.cpp */
+
+radialDistributionUpdater::radialDistributionUpdater(int period, double _binWidth, double _rMax, int phase)
+    : analysisUpdater(period,phase)
+    {
+    binWidth = _binWidth;
+    rMax = _rMax;
+    };
+
+void radialDistributionUpdater::initializeBins()
+    {
+    double b11,b12,b21,b22;
+    cellModel->Box->getBoxDims(b11,b12,b21,b22);
+    double largestDistance = 0.5*min(b11,b22);
+    if(rMax <= 0 || rMax > largestDistance)
+        rMax = largestDistance;
+    totalBins = floor(rMax/binWidth);
+    gSum.assign(totalBins,0.0);
+    };
+
+int radialDistributionUpdater::getSummarySize()
+    {
+    if(totalBins == 0)
+        initializeBins();
+    return 2*totalBins;
+    };
+
+void radialDistributionUpdater::reset()
+    {
+    samples = 0;
+    gSum.assign(totalBins,0.0);
+    };
+
+/*!
+Pairs are counted either by brute force or, if at least three grid cells of size >= rMax fit along each
+direction of a rectangular box, by looping over each point's own and neighboring grid cells (the grid is
+laid out along x and y, which only matches the periodic images of a rectangular box). Each thread keeps its own histogram.
+*/
+void radialDistributionUpdater::analyze()
+    {
+    if(totalBins == 0)
+        initializeBins();
+    double b11,b12,b21,b22;
+    cellModel->Box->getBoxDims(b11,b12,b21,b22);
+    int gridX = floor(b11/rMax);
+    int gridY = floor(b22/rMax);
+    bool useGrid = (gridX >= 3 && gridY >= 3 && cellModel->Box->isBoxSquare());
+
+    ArrayHandle<double2> h_p(cellModel->returnPositions(),access_location::host,access_mode::read);
+    int N = cellModel->getNumberOfDegreesOfFreedom();
+
+    //sort the points into grid cells (a counting sort into CSR form)
+    vector<int> gridStart, gridMembers;
+    if(useGrid)
+        {
+        vector<int> gridOf(N);
+        gridStart.assign(gridX*gridY+1,0);
+        for (int ii = 0; ii < N; ++ii)
+            {
+            int cx = min(gridX-1,(int)floor(h_p.data[ii].x/b11*gridX));
+            int cy = min(gridY-1,(int)floor(h_p.data[ii].y/b22*gridY));
+            gridOf[ii] = cx + gridX*cy;
+            gridStart[gridOf[ii]+1] += 1;
+            };
+        for (int cc = 0; cc < gridX*gridY; ++cc)
+            gridStart[cc+1] += gridStart[cc];
+        gridMembers.resize(N);
+        vector<int> filled(gridStart.begin(),gridStart.end()-1);
+        for (int ii = 0; ii < N; ++ii)
+            gridMembers[filled[gridOf[ii]]++] = ii;
+        };
+
+    double rMax2 = (double)totalBins*binWidth*totalBins*binWidth;
+    int nThreads = 1;
+    #pragma omp parallel
+    {
+    #pragma omp single
+    nThreads = omp_get_num_threads();
+    }
+    threadCounts.resize(nThreads);
+    #pragma omp parallel
+    {
+    vector<double> &counts = threadCounts[omp_get_thread_num()];
+    counts.assign(totalBins,0.0);
+    double2 dist;
+    #pragma omp for schedule(dynamic,64)
+    for (int ii = 0; ii < N; ++ii)
+        {
+        double2 pi = h_p.data[ii];
+        if(!useGrid)
+            {
+            for (int jj = ii+1; jj < N; ++jj)
+                {
+                cellModel->Box->minDist(pi,h_p.data[jj],dist);
+                double d2 = dist.x*dist.x+dist.y*dist.y;
+                if(d2 < rMax2)
+                    counts[(int)floor(sqrt(d2)/binWidth)] += 1.0;
+                };
+            continue;
+            };
+        int cx = min(gridX-1,(int)floor(pi.x/b11*gridX));
+        int cy = min(gridY-1,(int)floor(pi.y/b22*gridY));
+        for (int dy = -1; dy <= 1; ++dy)
+            for (int dx = -1; dx <= 1; ++dx)
+                {
+                int gx = (cx+dx+gridX)%gridX;
+                int gy = (cy+dy+gridY)%gridY;
+                int gridCell = gx+gridX*gy;
+                for (int mm = gridStart[gridCell]; mm < gridStart[gridCell+1]; ++mm)
+                    {
+                    int jj = gridMembers[mm];
+                    if(jj <= ii)
+                        continue;
+                    cellModel->Box->minDist(pi,h_p.data[jj],dist);
+                    double d2 = dist.x*dist.x+dist.y*dist.y;
+                    if(d2 < rMax2)
+                        counts[(int)floor(sqrt(d2)/binWidth)] += 1.0;
+                    };
+                };
+        };
+    }
+
+    //normalize exactly as structuralFeatures does, and add to the running sum
+    for (int bb = 0; bb < totalBins; ++bb)
+        {
+        double count = 0.0;
+        for (int tt = 0; tt < nThreads; ++tt)
+            count += threadCounts[tt][bb];
+        double annulusArea = PI*(((bb+1)*binWidth)*((bb+1)*binWidth)-(bb*binWidth)*(bb*binWidth));
+        gSum[bb] += (2.0*count/N) / annulusArea;
+        };
+    };
+
+void radialDistributionUpdater::getSummary(vector<double> &summary)
+    {
+    summary.resize(2*totalBins);
+    for (int bb = 0; bb < totalBins; ++bb)
+        {
+        summary[bb] = (bb+0.5)*binWidth;
+        summary[totalBins+bb] = (samples > 0) ? gSum[bb]/samples : 0.0;
+        };
+    };
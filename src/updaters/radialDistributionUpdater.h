@@ -0,0 +1,40 @@
+#ifndef radialDistributionUpdater_H
+#define radialDistributionUpdater_H
+
+#include "analysisUpdater.h"
+
+/*! \file radialDistributionUpdater.h */
+//!Accumulate the radial distribution function of the degrees of freedom while a simulation runs
+/*!
+Each analysis bins all pair separations smaller than rMax (by default, and at most, half of the
+smallest box length) directly from the model's position array. When the box is large compared to rMax
+the points are first sorted into a coarse grid with cell size >= rMax, so that the cost is O(N) rather
+than the O(N^2) of structuralFeatures::computeRadialDistributionFunction; the normalization is the same.
+The summary is the list of bin centers followed by the time-averaged g(r) in each bin.
+*/
+class radialDistributionUpdater : public analysisUpdater
+    {
+    public:
+        //!set the period, bin width, largest distance (<= 0 means half the box), and phase
+        radialDistributionUpdater(int period, double _binWidth = 0.1, double _rMax = -1.0, int phase = 0);
+
+        virtual void analyze();
+        virtual int getSummarySize();
+        virtual void getSummary(vector<double> &summary);
+        virtual void reset();
+
+    protected:
+        //!set the number of bins from the box (done the first time it is needed)
+        void initializeBins();
+        //!the width of each bin
+        double binWidth;
+        //!the requested largest distance
+        double rMax;
+        //!the number of bins
+        int totalBins = 0;
+        //!the sum over analyses of the normalized g(r) of each frame
+        vector<double> gSum;
+        //!per-thread pair counts
+        vector<vector<double> > threadCounts;
+    };
+#endif
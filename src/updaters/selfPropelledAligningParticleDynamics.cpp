@@ -6,14 +6,17 @@
 An extremely simple constructor that does nothing, but enforces default GPU operation
 \param the number of points in the system (cells or particles)
 */
-selfPropelledAligningParticleDynamics::selfPropelledAligningParticleDynamics(int _N)
+selfPropelledAligningParticleDynamics::selfPropelledAligningParticleDynamics(int _N, bool usegpu)
     {
     Timestep = 0;
     deltaT = 0.01;
     GPUcompute = false;
+    if(!usegpu)
+        displacements.neverGPU=true;
     mu = 1.0;
     J=0.0;
     Ndof = _N;
+    noise.initializeGPURNG = usegpu;
     noise.initialize(Ndof);
     displacements.resize(Ndof);
     };
@@ -43,6 +46,7 @@ Advances self-propelled dynamics with random noise in the director by one time s
 */
 void selfPropelledAligningParticleDynamics::integrateEquationsOfMotion()
     {
+    PROFILE_SCOPE("selfPropelledAligningParticleDynamics::integrateEquationsOfMotion");
     Timestep += 1;
     if (activeModel->getNumberOfDegreesOfFreedom() != Ndof)
         {
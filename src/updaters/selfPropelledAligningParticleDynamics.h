@@ -20,8 +20,8 @@ class selfPropelledAligningParticleDynamics : public simpleEquationOfMotion
         //!base constructor sets the default time step size
         selfPropelledAligningParticleDynamics(){deltaT = 0.01; GPUcompute =true;Timestep = 0;};
 
-        //!additionally set the number of particles andinitialize things
-        selfPropelledAligningParticleDynamics(int N);
+        //!additionally set the number of particles andinitialize things (usegpu = false allocates no GPU random number generators)
+        selfPropelledAligningParticleDynamics(int N, bool usegpu = true);
 
         //!the fundamental function that models will call, using vectors of different data structures
         virtual void integrateEquationsOfMotion();
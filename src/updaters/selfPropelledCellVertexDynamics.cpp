@@ -6,12 +6,16 @@
 /*!
 An extremely simple constructor that does nothing, but enforces default GPU operation
 \param the number of points in the system (cells or particles)
+\param usegpu if false, the object never touches the GPU (as needed on machines without one)
 */
-selfPropelledCellVertexDynamics::selfPropelledCellVertexDynamics(int _Ncells, int _Nvertices)
+selfPropelledCellVertexDynamics::selfPropelledCellVertexDynamics(int _Ncells, int _Nvertices, bool usegpu)
     {
     Timestep = 0;
     deltaT = 0.01;
-    GPUcompute = true;
+    GPUcompute = usegpu;
+    if(!GPUcompute)
+        displacements.neverGPU=true;
+    noise.initializeGPURNG = GPUcompute;
     mu = 1.0;
     Ndof = _Nvertices;
     Nvertices = _Nvertices;
@@ -25,6 +29,7 @@ Advances self-propelled dynamics with random noise in the director by one time s
 */
 void selfPropelledCellVertexDynamics::integrateEquationsOfMotion()
     {
+    PROFILE_SCOPE("selfPropelledCellVertexDynamics::integrateEquationsOfMotion");
     Timestep += 1;
     if (activeModel->getNumberOfDegreesOfFreedom() != Nvertices)
         {
@@ -13,7 +13,7 @@ class selfPropelledCellVertexDynamics : public selfPropelledParticleDynamics
     {
     public:
         //!base constructor sets default time step size
-        selfPropelledCellVertexDynamics(int Ncells,int Nvertices);
+        selfPropelledCellVertexDynamics(int Ncells,int Nvertices, bool usegpu = true);
 
         //!the fundamental function that models will call, using vectors of different data structures
         virtual void integrateEquationsOfMotion();
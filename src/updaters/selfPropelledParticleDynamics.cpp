@@ -5,14 +5,18 @@
 /*!
 An extremely simple constructor that does nothing, but enforces default GPU operation
 \param the number of points in the system (cells or particles)
+\param usegpu if false, the object never touches the GPU (as needed on machines without one)
 */
-selfPropelledParticleDynamics::selfPropelledParticleDynamics(int _N)
+selfPropelledParticleDynamics::selfPropelledParticleDynamics(int _N, bool usegpu)
     {
     Timestep = 0;
     deltaT = 0.01;
-    GPUcompute = true;
+    GPUcompute = usegpu;
+    if(!GPUcompute)
+        displacements.neverGPU=true;
     mu = 1.0;
     Ndof = _N;
+    noise.initializeGPURNG = GPUcompute;
     noise.initialize(Ndof);
     displacements.resize(Ndof);
     };
@@ -42,6 +46,7 @@ Advances self-propelled dynamics with random noise in the director by one time s
 */
 void selfPropelledParticleDynamics::integrateEquationsOfMotion()
     {
+    PROFILE_SCOPE("selfPropelledParticleDynamics::integrateEquationsOfMotion");
     Timestep += 1;
     if (activeModel->getNumberOfDegreesOfFreedom() != Ndof)
         {
@@ -16,8 +16,8 @@ class selfPropelledParticleDynamics : public simpleEquationOfMotion
         //!base constructor sets the default time step size
         selfPropelledParticleDynamics(){deltaT = 0.01; GPUcompute =true;Timestep = 0;};
 
-        //!additionally set the number of particles andinitialize things
-        selfPropelledParticleDynamics(int N);
+        //!additionally set the number of particles andinitialize things (usegpu = false allocates no GPU random number generators)
+        selfPropelledParticleDynamics(int N, bool usegpu = true);
 
         //!the fundamental function that models will call, using vectors of different data structures
         virtual void integrateEquationsOfMotion();
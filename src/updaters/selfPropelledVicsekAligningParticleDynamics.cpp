@@ -6,11 +6,14 @@
 An extremely simple constructor that does nothing, but enforces default GPU operation
 \param the number of points in the system (cells or particles)
 */
-selfPropelledVicsekAligningParticleDynamics::selfPropelledVicsekAligningParticleDynamics(int _N, double _eta, double _tau)
+selfPropelledVicsekAligningParticleDynamics::selfPropelledVicsekAligningParticleDynamics(int _N, double _eta, double _tau, bool usegpu)
     {
     Timestep = 0;
     deltaT = 0.01;
     GPUcompute = false;
+    if(!usegpu)
+        displacements.neverGPU=true;
+    noise.initializeGPURNG = usegpu;
     mu = 1.0;
     Eta= _eta;
     tau = _tau;
@@ -44,6 +47,7 @@ Advances self-propelled dynamics with random noise in the director by one time s
 */
 void selfPropelledVicsekAligningParticleDynamics::integrateEquationsOfMotion()
     {
+    PROFILE_SCOPE("selfPropelledVicsekAligningParticleDynamics::integrateEquationsOfMotion");
     Timestep += 1;
     if (activeModel->getNumberOfDegreesOfFreedom() != Ndof)
         {
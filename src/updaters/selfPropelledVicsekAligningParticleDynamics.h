@@ -20,8 +20,8 @@ class selfPropelledVicsekAligningParticleDynamics : public simpleEquationOfMotio
         //!base constructor sets the default time step size
         selfPropelledVicsekAligningParticleDynamics(){deltaT = 0.01; GPUcompute =true;Timestep = 0;};
 
-        //!additionally set the number of particles andinitialize things
-        selfPropelledVicsekAligningParticleDynamics(int N, double _eta = 0.0, double _tau = 1.0);
+        //!additionally set the number of particles andinitialize things (usegpu = false allocates no GPU random number generators)
+        selfPropelledVicsekAligningParticleDynamics(int N, double _eta = 0.0, double _tau = 1.0, bool usegpu = true);
 
         //!the fundamental function that models will call, using vectors of different data structures
         virtual void integrateEquationsOfMotion();
@@ -28,6 +28,7 @@ void setTotalLinearMomentum::setMomentumTarget(double px, double py)
 
 void setTotalLinearMomentum::performUpdate()
     {
+    PROFILE_SCOPE("setTotalLinearMomentum::performUpdate");
     int N = model->getNumberOfDegreesOfFreedom();
     if(N!=pArray.getNumElements())
         {
@@ -49,6 +49,21 @@ class simpleEquationOfMotion : public updaterWithNoise
         //! performUpdate just maps to integrateEquationsOfMotion
         virtual void performUpdate(){integrateEquationsOfMotion();};
 
+        //!Add the step counter and time step to the checkpoint of the noise source
+        virtual void writeCheckpoint(checkpointWriter &out)
+            {
+            updaterWithNoise::writeCheckpoint(out);
+            out.addValue("Timestep",Timestep);
+            out.addValue("deltaT",deltaT);
+            };
+        //!Restore a state written by writeCheckpoint
+        virtual void readCheckpoint(checkpointReader &in)
+            {
+            updaterWithNoise::readCheckpoint(in);
+            in.readValue("Timestep",Timestep);
+            in.readValue("deltaT",deltaT);
+            };
+
     protected:
         //! Count the number of integration timesteps
         int Timestep;
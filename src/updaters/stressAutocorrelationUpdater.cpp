@@ -0,0 +1,63 @@
+#include "stressAutocorrelationUpdater.h"
+#include "voronoiQuadraticEnergy.h"
+/*! \file stressAutocorrelationUpdater.cpp */
+
+/*!
+Samples are spaced by Period timesteps, which is the time unit of the correlator
+*/
+stressAutocorrelationUpdater::stressAutocorrelationUpdater(int period, int _p, int _m, int _maximumLevels, int phase)
+    : analysisUpdater(period,phase), correlator(1,_p,_m,period)
+    {
+    p = _p;
+    m = _m;
+    maximumLevels = _maximumLevels;
+    };
+
+void stressAutocorrelationUpdater::set2DModel(shared_ptr<Simple2DModel> _model)
+    {
+    analysisUpdater::set2DModel(_model);
+    if(!dynamic_pointer_cast<VoronoiQuadraticEnergy>(_model))
+        {
+        printf("stressAutocorrelationUpdater requires a model derived from VoronoiQuadraticEnergy\n");
+        throw std::exception();
+        };
+    };
+
+/*!
+getSigmaXY is the stress sigma_xy = (1/A) dE/dgamma, while computeKineticPressure returns the kinetic part
+of the pressure tensor, (1/A) sum_i m_i v_ix v_iy; the kinetic part of the stress is minus the latter
+*/
+double stressAutocorrelationUpdater::computeSigmaXY()
+    {
+    double sigmaXY = dynamic_pointer_cast<VoronoiQuadraticEnergy>(model)->getSigmaXY();
+    if(includeKinetic)
+        sigmaXY -= cellModel->computeKineticPressure().y;
+    return sigmaXY;
+    };
+
+void stressAutocorrelationUpdater::analyze()
+    {
+    double sigmaXY = computeSigmaXY();
+    correlator.add(&sigmaXY);
+    };
+
+/*!
+The zeroth level contributes p lags, every higher one p - p/m
+*/
+int stressAutocorrelationUpdater::getSummarySize()
+    {
+    return 2*(p + (maximumLevels-1)*(p-p/m));
+    };
+
+void stressAutocorrelationUpdater::getSummary(vector<double> &summary)
+    {
+    int nTimes = getSummarySize()/2;
+    summary.assign(2*nTimes,0.0);
+    vector<double> times, values;
+    correlator.evaluate(times,values,normalize);
+    for (int tt = 0; tt < (int)times.size() && tt < nTimes; ++tt)
+        {
+        summary[tt] = times[tt];
+        summary[nTimes+tt] = values[tt];
+        };
+    };
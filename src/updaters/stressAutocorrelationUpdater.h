@@ -0,0 +1,49 @@
+#ifndef stressAutocorrelationUpdater_H
+#define stressAutocorrelationUpdater_H
+
+#include "analysisUpdater.h"
+#include "multiChannelCorrelator.h"
+
+/*! \file stressAutocorrelationUpdater.h */
+//!Accumulate the autocorrelation of the global shear stress while a simulation runs
+/*!
+Each analysis adds the current sigma_xy to a multiple-tau correlator (a multiChannelCorrelator with one
+channel). The potential contribution is that of VoronoiQuadraticEnergy::getSigmaXY, so this updater
+requires a model derived from it; the kinetic contribution (see Simple2DCell::computeKineticPressure),
+which is only meaningful for inertial dynamics, can optionally be included (with the sign of a stress,
+i.e. minus the kinetic pressure).
+The summary holds a fixed number of correlator times (in timesteps) followed by the values of
+<sigma_xy(t) sigma_xy(0)>; entries beyond the times sampled so far are zero.
+*/
+class stressAutocorrelationUpdater : public analysisUpdater
+    {
+    public:
+        //!set the period, the correlator parameters (points per level, averaging number, number of levels reported) and the phase
+        stressAutocorrelationUpdater(int period, int _p = 16, int _m = 2, int _maximumLevels = 20, int phase = 0);
+
+        virtual void set2DModel(shared_ptr<Simple2DModel> _model);
+        virtual void analyze();
+        virtual int getSummarySize();
+        virtual void getSummary(vector<double> &summary);
+        virtual void reset(){samples = 0; correlator.initialize();};
+
+        //!the current sigma_xy, including the kinetic part if requested
+        double computeSigmaXY();
+
+        //!include the kinetic part of the stress?
+        void setIncludeKinetic(bool _includeKinetic){includeKinetic = _includeKinetic;};
+        //!subtract the square of the mean stress from the correlation function?
+        void setNormalize(bool _normalize){normalize = _normalize;};
+
+        //!the underlying correlator
+        multiChannelCorrelator correlator;
+
+    protected:
+        int p;
+        int m;
+        //!The number of correlator levels that fit in the summary
+        int maximumLevels;
+        bool includeKinetic = false;
+        bool normalize = false;
+    };
+#endif
@@ -0,0 +1,137 @@
+#include "structureFactorUpdater.h"
+/*! \file structureFactorUpdater.cpp */
+
+structureFactorUpdater::structureFactorUpdater(int period, double _intKMax, double _dk, int phase)
+    : analysisUpdater(period,phase)
+    {
+    intKMax = _intKMax;
+    dk = _dk;
+    };
+
+/*!
+The annuli are those of structuralFeatures::computeStructureFactor
+*/
+void structureFactorUpdater::initializeLattice()
+    {
+    double L,b2,b3,b4;
+    cellModel->Box->getBoxDims(L,b2,b3,b4);
+    deltaK = 2*PI/L;
+    maxLatticeInt = floor(L*intKMax);
+    if(maxLatticeInt < 1)
+        {
+        printf("structureFactorUpdater: intKMax is too small for this box\n");
+        throw std::exception();
+        };
+    SKSum.assign(maxLatticeInt*maxLatticeInt,0.0);
+    annulusOf.assign(maxLatticeInt*maxLatticeInt,-1);
+    annulusCenter.clear();
+    annulusCount.clear();
+    double binWidth = deltaK*dk;
+    double kmax = (maxLatticeInt-1)*deltaK;
+    for (double rmin = deltaK-0.5*binWidth; rmin< kmax-binWidth; rmin +=binWidth)
+        {
+        double rmax = rmin + binWidth;
+        int inSum = 0;
+        int annulus = annulusCenter.size();
+        for (int ii = 0; ii < maxLatticeInt; ++ii)
+            for (int jj = 0; jj < maxLatticeInt; ++jj)
+                {
+                double2 K = make_double2(ii*deltaK,jj*deltaK);
+                if(inAnnulus(K,rmin,rmax))
+                    {
+                    inSum += 1;
+                    annulusOf[ii*maxLatticeInt+jj] = annulus;
+                    };
+                };
+        if(inSum > 0)
+            {
+            annulusCenter.push_back(rmin+0.5*binWidth);
+            annulusCount.push_back(inSum);
+            };
+        };
+    };
+
+int structureFactorUpdater::getSummarySize()
+    {
+    if(maxLatticeInt == 0)
+        initializeLattice();
+    return 2*annulusCenter.size();
+    };
+
+void structureFactorUpdater::reset()
+    {
+    samples = 0;
+    SKSum.assign(maxLatticeInt*maxLatticeInt,0.0);
+    };
+
+/*!
+Each thread accumulates rho(K) on the full lattice for its share of the points; the partial sums are
+then merged.
+*/
+void structureFactorUpdater::analyze()
+    {
+    if(maxLatticeInt == 0)
+        initializeLattice();
+    int M = maxLatticeInt;
+    ArrayHandle<double2> h_p(cellModel->returnPositions(),access_location::host,access_mode::read);
+    int N = cellModel->getNumberOfDegreesOfFreedom();
+
+    vector<double> rhoRe(M*M,0.0), rhoIm(M*M,0.0);
+    #pragma omp parallel
+    {
+    vector<double> tRe(M*M,0.0), tIm(M*M,0.0);
+    vector<double> cx(M), sx(M), cy(M), sy(M);
+    #pragma omp for schedule(static)
+    for (int nn = 0; nn < N; ++nn)
+        {
+        double2 p = h_p.data[nn];
+        double c1x = cos(deltaK*p.x), s1x = sin(deltaK*p.x);
+        double c1y = cos(deltaK*p.y), s1y = sin(deltaK*p.y);
+        cx[0] = 1.0; sx[0] = 0.0; cy[0] = 1.0; sy[0] = 0.0;
+        for (int ii = 1; ii < M; ++ii)
+            {
+            cx[ii] = cx[ii-1]*c1x - sx[ii-1]*s1x;
+            sx[ii] = sx[ii-1]*c1x + cx[ii-1]*s1x;
+            cy[ii] = cy[ii-1]*c1y - sy[ii-1]*s1y;
+            sy[ii] = sy[ii-1]*c1y + cy[ii-1]*s1y;
+            };
+        for (int ii = 0; ii < M; ++ii)
+            {
+            double a = cx[ii], b = sx[ii];
+            double *re = &tRe[ii*M];
+            double *im = &tIm[ii*M];
+            #pragma omp simd
+            for (int jj = 0; jj < M; ++jj)
+                {
+                re[jj] += a*cy[jj] - b*sy[jj];
+                im[jj] += b*cy[jj] + a*sy[jj];
+                };
+            };
+        };
+    #pragma omp critical
+    {
+    for (int kk = 0; kk < M*M; ++kk)
+        {
+        rhoRe[kk] += tRe[kk];
+        rhoIm[kk] += tIm[kk];
+        };
+    }
+    }
+    for (int kk = 0; kk < M*M; ++kk)
+        SKSum[kk] += (rhoRe[kk]*rhoRe[kk]+rhoIm[kk]*rhoIm[kk])/N;
+    };
+
+void structureFactorUpdater::getSummary(vector<double> &summary)
+    {
+    int nAnnuli = annulusCenter.size();
+    summary.assign(2*nAnnuli,0.0);
+    for (int aa = 0; aa < nAnnuli; ++aa)
+        summary[aa] = annulusCenter[aa];
+    if(samples == 0)
+        return;
+    for (int kk = 0; kk < maxLatticeInt*maxLatticeInt; ++kk)
+        if(annulusOf[kk] >= 0)
+            summary[nAnnuli+annulusOf[kk]] += SKSum[kk];
+    for (int aa = 0; aa < nAnnuli; ++aa)
+        summary[nAnnuli+aa] /= (annulusCount[aa]*samples);
+    };
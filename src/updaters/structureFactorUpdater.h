@@ -0,0 +1,47 @@
+#ifndef structureFactorUpdater_H
+#define structureFactorUpdater_H
+
+#include "analysisUpdater.h"
+
+/*! \file structureFactorUpdater.h */
+//!Accumulate the (isotropic) structure factor of the degrees of freedom while a simulation runs
+/*!
+Uses the same lattice of wavevectors, K = (2 Pi/L)(i,j) with 0 <= i,j < floor(L*intKMax), and the same
+annular averaging as structuralFeatures::computeStructureFactor. Each analysis adds |rho(K)|^2/N on the
+lattice to a running sum; rho(K) is built with the recurrence exp(i(n+1) dk x) = exp(i n dk x) exp(i dk x),
+so that only two complex exponentials per point are evaluated. The summary is the list of annulus
+centers followed by the time-averaged S(k); annuli that contain no lattice points are dropped, as in
+structuralFeatures, so the summary size is fixed by the box.
+*/
+class structureFactorUpdater : public analysisUpdater
+    {
+    public:
+        //!set the period, the largest wavevector (in units of the lattice), the annulus width (in units of 2 Pi/L), and the phase
+        structureFactorUpdater(int period, double _intKMax = 1.0, double _dk = 0.5, int phase = 0);
+
+        virtual void analyze();
+        virtual int getSummarySize();
+        virtual void getSummary(vector<double> &summary);
+        virtual void reset();
+
+    protected:
+        //!set up the wavevector lattice and the annuli from the box (done the first time it is needed)
+        void initializeLattice();
+        //!maximum lattice index, as a multiple of L
+        double intKMax;
+        //!annulus width, in units of the lattice spacing
+        double dk;
+        //!the lattice spacing
+        double deltaK;
+        //!the number of lattice points in each direction
+        int maxLatticeInt = 0;
+        //!the sum over analyses of S(K) on the lattice, SK[i*maxLatticeInt+j]
+        vector<double> SKSum;
+        //!the center of each (non-empty) annulus
+        vector<double> annulusCenter;
+        //!the annulus of each lattice point (-1 if it is in none)
+        vector<int> annulusOf;
+        //!the number of lattice points in each annulus
+        vector<int> annulusCount;
+    };
+#endif
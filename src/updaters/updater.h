@@ -42,6 +42,8 @@ class updater
 
         //!Allow for a reproducibility call to be made
         virtual void setReproducible(bool rep){};
+        //!Seed any source of noise the updater has (used to give replicas of a simulation independent streams)
+        virtual void setRandomSeed(int seed){};
 
         //!Enforce GPU-only operation. This is the default mode, so this method need not be called most of the time.
         virtual void setGPU(){GPUcompute = true;};
@@ -60,7 +62,17 @@ class updater
         int ompThreadNum = 1;
         //set number of threads
         virtual void setOmpThreads(int _number){ompThreadNum = _number;};
+
+        //!Report the updater's own events to a metrics registry (a null pointer stops reporting)
+        virtual void setMetrics(shared_ptr<runtimeMetrics> _metrics){metrics = _metrics;};
+
+        //!Add whatever internal state the updater needs to continue exactly to a checkpoint
+        virtual void writeCheckpoint(checkpointWriter &){};
+        //!Restore a state written by writeCheckpoint
+        virtual void readCheckpoint(checkpointReader &){};
     protected:
+        //!The registry metrics are reported to, if any
+        shared_ptr<runtimeMetrics> metrics;
         //!The period of the updater... the updater will work every Period timesteps
         int Period;
         //!The phase of the updater... the updater will work every Period timesteps offset by a phase
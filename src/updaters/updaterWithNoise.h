@@ -26,6 +26,23 @@ class updaterWithNoise : public updater
             if (GPUcompute)
                 noise.initializeGPURNGs(1337,0);
             };
+        //!Seed the reproducible random number generators (on the CPU, and on the GPU if it is in use)
+        virtual void setRandomSeed(int seed)
+            {
+            noise.setReproducibleSeed(seed);
+            if (GPUcompute && noise.Reproducible)
+                noise.initializeGPURNGs(seed,0);
+            };
+        //!Add the state of the noise source to a checkpoint
+        virtual void writeCheckpoint(checkpointWriter &out)
+            {
+            noise.writeCheckpoint(out,"noise");
+            };
+        //!Restore the state of the noise source
+        virtual void readCheckpoint(checkpointReader &in)
+            {
+            noise.readCheckpoint(in,"noise");
+            };
         //!re-index the any RNGs associated with the e.o.m.
         void reIndexRNG(GPUArray<curandState> &array)
             {
@@ -13,6 +13,7 @@ velocityVerlet::velocityVerlet(int nPoint, bool  usegpu)
 
 void velocityVerlet::integrateEquationsOfMotion()
     {
+    PROFILE_SCOPE("velocityVerlet::integrateEquationsOfMotion");
     Timestep += 1;
     if (State->getNumberOfDegreesOfFreedom() != Ndof)
         {
@@ -36,14 +37,17 @@ void velocityVerlet::integrateEquationsOfMotionCPU()
     ArrayHandle<double2> h_f(State->returnForces());
     ArrayHandle<double2> h_v(State->returnVelocities());
     ArrayHandle<double2> h_d(displacements);
-    for (int i = 0; i < Ndof; ++i)
+    //treat the double2 arrays as flat streams of 2*Ndof doubles so that the loop vectorizes
+    double *f = (double *) h_f.data;
+    double *v = (double *) h_v.data;
+    double *d = (double *) h_d.data;
+    #pragma omp simd
+    for (int i = 0; i < 2*Ndof; ++i)
         {
         //update displacement
-        h_d.data[i].x = deltaT*h_v.data[i].x+0.5*deltaT*deltaT*h_f.data[i].x;
-        h_d.data[i].y = deltaT*h_v.data[i].y+0.5*deltaT*deltaT*h_f.data[i].y;
+        d[i] = deltaT*v[i]+0.5*deltaT*deltaT*f[i];
         //do first half of velocity update
-        h_v.data[i].x += 0.5*deltaT*h_f.data[i].x;
-        h_v.data[i].y += 0.5*deltaT*h_f.data[i].y;
+        v[i] += 0.5*deltaT*f[i];
         };
         };//end arrayhandle scope
 
@@ -55,11 +59,11 @@ void velocityVerlet::integrateEquationsOfMotionCPU()
     //update second half of velocity vector based on new forces
     ArrayHandle<double2> h_f(State->returnForces());
     ArrayHandle<double2> h_v(State->returnVelocities());
-    for (int i = 0; i < Ndof; ++i)
-        {
-        h_v.data[i].x += 0.5*deltaT*h_f.data[i].x;
-        h_v.data[i].y += 0.5*deltaT*h_f.data[i].y;
-        };
+    double *f = (double *) h_f.data;
+    double *v = (double *) h_v.data;
+    #pragma omp simd
+    for (int i = 0; i < 2*Ndof; ++i)
+        v[i] += 0.5*deltaT*f[i];
     };
 
 void velocityVerlet::integrateEquationsOfMotionGPU()
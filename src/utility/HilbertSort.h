@@ -22,7 +22,8 @@ which is released under the GNU LGPL license
 This structure can help sort scalar2's according to their position along a hilbert curve of order M...
 This sorting can improve data locality (i.e. particles that are close to each other in physical space reside
 close to each other in memory). This is a small boost for CPU-based code, but can be very important
-for the efficiency of GPU-based execution.
+for the efficiency of GPU-based execution. The curve is laid over the fractional coordinates of the box, so
+general (e.g. sheared) boxes are handled.
 */
 struct HilbertSorter
     {
@@ -34,9 +35,11 @@ struct HilbertSorter
             Box.getBoxDims(x11,x12,x21,x22);
             box.setGeneral(x11,x12,x21,x22);
 
+            //the curve is laid over the fractional coordinates, so resolve the longer box vector
+            double longestSide = max(sqrt(x11*x11+x21*x21),sqrt(x12*x12+x22*x22));
             int mm = 1;
             int temp = 2;
-            while ((double)temp < x11)
+            while ((double)temp < longestSide)
                 {
                 temp *=2;
                 mm +=1;
@@ -93,10 +96,13 @@ struct HilbertSorter
             double2 virtualPos;
             box.invTrans(point,virtualPos);
 
+            //points on the boundary of a tilted unit cell can round to just outside of it
+            virtualPos.x -= floor(virtualPos.x);
+            virtualPos.y -= floor(virtualPos.y);
             int n = int_power(2,M);
             int x,y;
-            x = (int) floor(n*virtualPos.x);
-            y = (int) floor(n*virtualPos.y);
+            x = max(0,min(n-1,(int) floor(n*virtualPos.x)));
+            y = max(0,min(n-1,(int) floor(n*virtualPos.y)));
 
             //call Burkardt code
             int d = xy2d(M,x,y);
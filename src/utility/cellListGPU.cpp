@@ -51,7 +51,7 @@ void cellListGPU::setParticles(const vector<double> &points)
     if(true)
         {
         ArrayHandle<double2> h_handle(particles,access_location::host,access_mode::overwrite);
-        for (int ii = 0; ii < points.size()/2; ++ii)
+        for (size_t ii = 0; ii < points.size()/2; ++ii)
             {
             h_handle.data[ii].x = points[2*ii];
             h_handle.data[ii].y = points[2*ii+1];
@@ -70,7 +70,7 @@ void cellListGPU::setParticles(const vector<double2> &points)
     if(true)
         {
         ArrayHandle<double2> h_handle(particles,access_location::host,access_mode::overwrite);
-        for (int ii = 0; ii < points.size(); ++ii)
+        for (size_t ii = 0; ii < points.size(); ++ii)
             {
             h_handle.data[ii] = points[ii];
             };
@@ -92,7 +92,8 @@ void cellListGPU::setBox(periodicBoundaries &bx)
 
 /*!
 \param a the approximate side length of all of the cells.
-This routine currently picks an even integer of cells, close to the desired size, that fit in the box.
+This routine currently picks an even integer of cells, close to the desired size, that fit in the box. In a
+general (e.g. sheared) box the bins are parallelograms, and a is their approximate width between opposite sides.
  */
 void cellListGPU::setGridSize(double a)
     {
@@ -101,26 +102,25 @@ void cellListGPU::setGridSize(double a)
         particles.neverGPU = true;
         cell_sizes.neverGPU = true;
         idxs.neverGPU = true;
-        assist.neverGPU = true;
+        cell_start.neverGPU = true;
+        binRanks.neverGPU = true;
         };
 
-    double b11,b12,b21,b22;
-    Box->getBoxDims(b11,b12,b21,b22);
-    xsize = (int)floor(b11/a);
+    //the bins tile the fractional coordinates, so their real-space widths are set by the box heights
+    double hx,hy;
+    Box->getBoxHeights(hx,hy);
+    xsize = (int)floor(hx/a);
     if(xsize%2==1) xsize +=1;
-    ysize = (int)floor(b22/a);
+    ysize = (int)floor(hy/a);
     if(ysize%2==1) ysize +=1;
 
-    boxsize = b11/xsize;
+    boxsize = hx/xsize;
 
     totalCells = xsize*ysize;
     cell_sizes.resize(totalCells); //number of elements in each cell...initialize to zero
 
     cell_indexer = Index2D(xsize,ysize);
 
-    //estimate Nmax
-    if(ceil(Np/totalCells)+1 > Nmax)
-        Nmax = ceil(Np/totalCells)+1;
     if(GPUcompute)
         resetCellSizes();
     else
@@ -128,64 +128,48 @@ void cellListGPU::setGridSize(double a)
     };
 
 /*!
-Sets all cell sizes to zero, all cell indices to zero, and resets the "assist" utility structure,
+Sets all cell sizes to zero and makes sure the offset and index arrays have the right size,
 all on the CPU (so that no expensive copies are needed)
  */
 void cellListGPU::resetCellSizesCPU()
     {
     //set all cell sizes to zero
     totalCells=xsize*ysize;
-    if(cell_sizes.getNumElements() != totalCells)
+    if(cell_sizes.getNumElements() != (unsigned int)totalCells)
         cell_sizes.resize(totalCells);
 
     ArrayHandle<unsigned int> h_cell_sizes(cell_sizes,access_location::host,access_mode::overwrite);
     for (int i = 0; i <totalCells; ++i)
         h_cell_sizes.data[i]=0;
 
-    //set all cell indexes to zero
-    cell_list_indexer = Index2D(Nmax,totalCells);
-    if(idxs.getNumElements() != cell_list_indexer.getNumElements())
-        idxs.resize(cell_list_indexer.getNumElements());
-
-    ArrayHandle<int> h_idx(idxs,access_location::host,access_mode::overwrite);
-    for (int i = 0; i < cell_list_indexer.getNumElements(); ++i)
-        h_idx.data[i]=0;
-
-    if(assist.getNumElements()!= 2)
-        assist.resize(2);
-    ArrayHandle<int> h_assist(assist,access_location::host,access_mode::overwrite);
-    h_assist.data[0]=Nmax;
-    h_assist.data[1] = 0;
+    //one offset per cell, plus the total; one index per particle
+    if(cell_start.getNumElements() != (unsigned int)totalCells+1)
+        cell_start.resize(totalCells+1);
+    if(idxs.getNumElements() != (unsigned int)Np)
+        idxs.resize(Np);
     };
 
 
 /*!
-Sets all cell sizes to zero, all cell indices to zero, and resets the "assist" utility structure,
+Sets all cell sizes to zero and makes sure the offset, index, and scratch arrays have the right size,
 all on the GPU so that arrays don't need to be copied back to the host
 */
 void cellListGPU::resetCellSizes()
     {
     //set all cell sizes to zero
     totalCells=xsize*ysize;
-    if(cell_sizes.getNumElements() != totalCells)
+    if(cell_sizes.getNumElements() != (unsigned int)totalCells)
         cell_sizes.resize(totalCells);
     ArrayHandle<unsigned int> csizes(cell_sizes,access_location::device,access_mode::overwrite);
     gpu_set_array<unsigned int>(csizes.data, 0,totalCells);
 
-    //set all cell indexes to zero
-    cell_list_indexer = Index2D(Nmax,totalCells);
-    if(idxs.getNumElements() != cell_list_indexer.getNumElements())
-        idxs.resize(cell_list_indexer.getNumElements());
-    ArrayHandle<int> cidxs(idxs,access_location::device,access_mode::overwrite);
-    gpu_set_array<int>(cidxs.data,0,cell_list_indexer.getNumElements());
-
-    /* no longer using assist structure on the gpu
-    if(assist.getNumElements()!= 2)
-        assist.resize(2);
-    ArrayHandle<int> h_assist(assist,access_location::host,access_mode::overwrite);
-    h_assist.data[0]=Nmax;
-    h_assist.data[1] = 0;
-    */
+    //one offset per cell, plus the total; one index per particle
+    if(cell_start.getNumElements() != (unsigned int)totalCells+1)
+        cell_start.resize(totalCells+1);
+    if(idxs.getNumElements() != (unsigned int)Np)
+        idxs.resize(Np);
+    if(binRanks.getNumElements() != (unsigned int)Np)
+        binRanks.resize(Np);
     };
 
 /*!
@@ -195,10 +179,8 @@ returns the cell index that (x,y) would be contained in for the current cell lis
  */
 int cellListGPU::positionToCellIndex(double x, double y)
     {
-    int cell_idx = 0;
-    int binx = max(0,min(xsize-1,(int)floor(x/boxsize)));
-    int biny = max(0,min(ysize-1,(int)floor(y/boxsize)));
-    return cell_indexer(binx,biny);
+    int2 cell = cellListBin(make_double2(x,y),xsize,ysize,*(Box));
+    return cell_indexer(cell.x,cell.y);
     };
 
 /*!
@@ -255,147 +237,90 @@ This puts the points the cellList currently knows about into cells
  */
 void cellListGPU::compute()
     {
-    //will loop through particles and put them in cells...
-    //if there are more than Nmax particles in any cell, will need to recompute.
-    bool recompute = true;
-    ArrayHandle<double2> h_pt(particles,access_location::host,access_mode::read);
-    int ibin, jbin;
-    int nmax = Nmax;
-    int computations = 0;
-    while (recompute)
-        {
-        //reset particles per cell, reset cell_list_indexer, resize idxs
-        resetCellSizesCPU();
-        ArrayHandle<unsigned int> h_cell_sizes(cell_sizes,access_location::host,access_mode::readwrite);
-        ArrayHandle<int> h_idx(idxs,access_location::host,access_mode::readwrite);
-        recompute=false;
-
-        for (int nn = 0; nn < Np; ++nn)
-            {
-            if (recompute) continue;
-            ibin = floor(h_pt.data[nn].x/boxsize);
-            jbin = floor(h_pt.data[nn].y/boxsize);
-            int bin = cell_indexer(ibin,jbin);
-            int offset = h_cell_sizes.data[bin];
-            if (offset < Nmax)
-                {
-                int clpos = cell_list_indexer(offset,bin);
-                h_idx.data[cell_list_indexer(offset,bin)]=nn;
-                }
-            else
-                {
-                nmax = max(Nmax,offset+1);
-                Nmax=nmax;
-                recompute=true;
-                };
-            h_cell_sizes.data[bin]++;
-            };
-        computations++;
-        };
-    cell_list_indexer = Index2D(Nmax,totalCells);
+    compute(particles);
     };
 
-
 /*!
 \param points the set of points to assign to cells
+A two-pass counting sort. Each thread histograms the bins of a contiguous range of particles, the
+histograms are turned into per-thread write offsets within each bin and a prefix sum over the bins gives
+cell_start, and then each thread scatters its particles into idxs. Since the ranges are contiguous and in
+thread order, the particles in every bin end up in increasing index order, independently of the number of
+threads.
  */
 void cellListGPU::compute(GPUArray<double2> &points)
     {
-    //will loop through particles and put them in cells...
-    //if there are more than Nmax particles in any cell, will need to recompute.
-    bool recompute = true;
+    resetCellSizesCPU();
     ArrayHandle<double2> h_pt(points,access_location::host,access_mode::read);
-    int ibin, jbin;
-    int nmax = Nmax;
-    int computations = 0;
-    while (recompute)
+    ArrayHandle<unsigned int> h_cell_sizes(cell_sizes,access_location::host,access_mode::readwrite);
+    ArrayHandle<int> h_start(cell_start,access_location::host,access_mode::overwrite);
+    ArrayHandle<int> h_idx(idxs,access_location::host,access_mode::overwrite);
+
+    //don't spread small systems over many threads
+    int threads = max(1,min(ompThreadNum,Np/4096+1));
+    if(threadCounts.size() < (size_t)threads*totalCells)
+        threadCounts.resize(threads*totalCells);
+    if(particleBins.size() < (size_t)Np)
+        particleBins.resize(Np);
+    int maximumOccupation = 0;
+    periodicBoundaries box = *(Box);
+
+    #pragma omp parallel num_threads(threads) reduction(max:maximumOccupation)
+    {
+    int nThreads = omp_get_num_threads();
+    int tid = omp_get_thread_num();
+    int first = (int)(((long)tid*Np)/nThreads);
+    int last = (int)(((long)(tid+1)*Np)/nThreads);
+    int *counts = &threadCounts[tid*totalCells];
+    for (int bin = 0; bin < totalCells; ++bin)
+        counts[bin] = 0;
+    for (int nn = first; nn < last; ++nn)
         {
-        //reset particles per cell, reset cell_list_indexer, resize idxs
-        resetCellSizesCPU();
-        ArrayHandle<unsigned int> h_cell_sizes(cell_sizes,access_location::host,access_mode::readwrite);
-        ArrayHandle<int> h_idx(idxs,access_location::host,access_mode::readwrite);
-        recompute=false;
+        int2 cell = cellListBin(h_pt.data[nn],xsize,ysize,box);
+        int bin = cell_indexer(cell.x,cell.y);
+        particleBins[nn] = bin;
+        counts[bin] += 1;
+        };
+    #pragma omp barrier
 
-        for (int nn = 0; nn < Np; ++nn)
+    //per-thread offsets within each bin, and the bin sizes
+    #pragma omp for schedule(static)
+    for (int bin = 0; bin < totalCells; ++bin)
+        {
+        int total = 0;
+        for (int tt = 0; tt < nThreads; ++tt)
             {
-            if (recompute) continue;
-            ibin = floor(h_pt.data[nn].x/boxsize);
-            jbin = floor(h_pt.data[nn].y/boxsize);
-
-            int bin = cell_indexer(ibin,jbin);
-            int offset = h_cell_sizes.data[bin];
-            if (offset < Nmax)
-                {
-                int clpos = cell_list_indexer(offset,bin);
-                h_idx.data[cell_list_indexer(offset,bin)]=nn;
-                }
-            else
-                {
-                nmax = max(Nmax,offset+1);
-                Nmax=nmax;
-                recompute=true;
-                };
-            h_cell_sizes.data[bin]++;
+            int c = threadCounts[tt*totalCells+bin];
+            threadCounts[tt*totalCells+bin] = total;
+            total += c;
             };
-        computations++;
+        h_cell_sizes.data[bin] = total;
+        maximumOccupation = max(maximumOccupation,total);
         };
-    cell_list_indexer = Index2D(Nmax,totalCells);
-    };
 
+    #pragma omp single
+        {
+        h_start.data[0] = 0;
+        for (int bin = 0; bin < totalCells; ++bin)
+            h_start.data[bin+1] = h_start.data[bin] + h_cell_sizes.data[bin];
+        }
+
+    for (int nn = first; nn < last; ++nn)
+        {
+        int bin = particleBins[nn];
+        h_idx.data[h_start.data[bin] + counts[bin]] = nn;
+        counts[bin] += 1;
+        };
+    }
+    Nmax = maximumOccupation;
+    };
 
 /*!
 Assign known points to cells on the GPU
  */
 void cellListGPU::computeGPU()
     {
-    bool recompute = true;
-    int maximumCellOccupation = Nmax;
-
-    while (recompute)
-        {
-        //cout << "computing cell list on the gpu with Nmax = " << Nmax << endl;
-        resetCellSizes();
-
-        //scope for arrayhandles
-        if (true)
-            {
-            //get particle data
-            ArrayHandle<double2> d_pt(particles,access_location::device,access_mode::read);
-
-            //get cell list arrays...readwrite so things are properly zeroed out
-            ArrayHandle<unsigned int> d_cell_sizes(cell_sizes,access_location::device,access_mode::readwrite);
-            ArrayHandle<int> d_idx(idxs,access_location::device,access_mode::readwrite);
-
-            //call the gpu function
-            gpu_compute_cell_list(d_pt.data,        //particle positions...broken
-                          d_cell_sizes.data,//particles per cell
-                          d_idx.data,       //cell list
-                          Np,               //number of particles
-                          Nmax,             //maximum particles per cell
-                          xsize,            //number of cells in x direction
-                          ysize,            // ""     ""      "" y directions
-                          boxsize,          //size of each grid cell
-                          (*Box),
-                          cell_indexer,
-                          cell_list_indexer,
-                          maximumCellOccupation
-                          );
-            }
-        //get cell list arrays
-        recompute = false;
-        if(maximumCellOccupation > Nmax)
-            {
-            Nmax =maximumCellOccupation;
-            if (Nmax%2 == 0 )
-                Nmax +=2;
-            else
-                Nmax +=1;
-            recompute = true;
-            }
-        //bool loopcheck=false;
-        };
-    cell_list_indexer = Index2D(Nmax,totalCells);
-
+    computeGPU(particles);
     };
 
 /*!
@@ -403,49 +328,29 @@ void cellListGPU::computeGPU()
  */
 void cellListGPU::computeGPU(GPUArray<double2> &points)
     {
-    bool recompute = true;
-    int maximumCellOccupation = Nmax;
-
-    while (recompute)
+    resetCellSizes();
+    int maximumCellOccupation = 0;
+    //scope for arrayhandles
+    if (true)
         {
-        //cout << "computing cell list on the gpu with Nmax = " << Nmax << endl;
-        resetCellSizes();
-        //scope for arrayhandles
-        if (true)
-            {
-            //get particle data
-            ArrayHandle<double2> d_pt(points,access_location::device,access_mode::read);
-
-            //get cell list arrays...readwrite so things are properly zeroed out
-            ArrayHandle<unsigned int> d_cell_sizes(cell_sizes,access_location::device,access_mode::readwrite);
-            ArrayHandle<int> d_idx(idxs,access_location::device,access_mode::readwrite);
-
-            //call the gpu function
-            gpu_compute_cell_list(d_pt.data,        //particle positions...broken
-                          d_cell_sizes.data,//particles per cell
-                          d_idx.data,       //cell list
-                          Np,               //number of particles
-                          Nmax,             //maximum particles per cell
-                          xsize,            //number of cells in x direction
-                          ysize,            // ""     ""      "" y directions
-                          boxsize,          //size of each grid cell
-                          (*Box),
-                          cell_indexer,
-                          cell_list_indexer,
-                          maximumCellOccupation
-                          );
-            }
-        //get cell list arrays
-        recompute = false;
-        if(maximumCellOccupation > Nmax)
-            {
-            Nmax =maximumCellOccupation;
-            if (Nmax%2 == 0 )
-                Nmax +=2;
-            else
-                Nmax +=1;
-            recompute = true;
-            }
+        ArrayHandle<double2> d_pt(points,access_location::device,access_mode::read);
+        ArrayHandle<unsigned int> d_cell_sizes(cell_sizes,access_location::device,access_mode::readwrite);
+        ArrayHandle<int> d_cell_start(cell_start,access_location::device,access_mode::overwrite);
+        ArrayHandle<int> d_idx(idxs,access_location::device,access_mode::overwrite);
+        ArrayHandle<int2> d_binRanks(binRanks,access_location::device,access_mode::overwrite);
+
+        gpu_compute_cell_list(d_pt.data,          //particle positions
+                              d_cell_sizes.data,  //particles per cell
+                              d_cell_start.data,  //offset of each cell in the cell list
+                              d_idx.data,         //cell list
+                              d_binRanks.data,    //scratch space
+                              Np,                 //number of particles
+                              xsize,              //number of cells in x direction
+                              ysize,              // ""     ""      "" y directions
+                              (*Box),
+                              cell_indexer,
+                              maximumCellOccupation
+                              );
         }
-    cell_list_indexer = Index2D(Nmax,totalCells);
+    Nmax = maximumCellOccupation;
     };
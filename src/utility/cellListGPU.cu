@@ -6,6 +6,7 @@
 #include <stdio.h>
 #include <thrust/device_vector.h>
 #include <thrust/reduce.h>
+#include <thrust/scan.h>
 #include <thrust/functional.h>
 #include <thrust/execution_policy.h>
 
@@ -17,19 +18,16 @@
 */
 
 /*!
-  Assign particles to bins, keep track of the number of particles per bin, etc.
+  Count the particles in every bin; each particle records its bin and its position within that bin
   */
-__global__ void gpu_compute_cell_list_kernel(double2 *d_pt,
+__global__ void gpu_cell_list_count_kernel(const double2 *d_pt,
                                               unsigned int *d_cell_sizes,
-                                              int *d_idx,
+                                              int2 *d_binRanks,
                                               int Np,
-                                              unsigned int Nmax,
                                               int xsize,
                                               int ysize,
-                                              double boxsize,
                                               periodicBoundaries Box,
-                                              Index2D ci,
-                                              Index2D cli
+                                              Index2D ci
                                               )
     {
     // read in the particle that belongs to this thread
@@ -37,19 +35,28 @@ __global__ void gpu_compute_cell_list_kernel(double2 *d_pt,
     if (idx >= Np)
         return;
 
-    double2 pos = d_pt[idx];
-
-    int ibin = max(0,min(xsize-1,(int)floor(pos.x/boxsize)));
-    int jbin = max(0,min(xsize-1,(int)floor(pos.y/boxsize)));
-    int bin = ci(ibin,jbin);
+    int2 cell = cellListBin(d_pt[idx],xsize,ysize,Box);
+    int bin = ci(cell.x,cell.y);
 
     unsigned int offset = atomicAdd(&(d_cell_sizes[bin]), 1);
-    if (offset <= Nmax+1)
-        {
-        unsigned int write_pos = min(cli(offset, bin),cli.getNumElements()-1);
-        d_idx[write_pos] = idx;
-        }
+    d_binRanks[idx] = make_int2(bin,(int)offset);
+    return;
+    };
 
+/*!
+  Scatter the particle indices into the compact cell list, once the bin offsets are known
+  */
+__global__ void gpu_cell_list_scatter_kernel(const int2 *d_binRanks,
+                                              const int *d_cell_start,
+                                              int *d_idx,
+                                              int Np
+                                              )
+    {
+    unsigned int idx = blockDim.x * blockIdx.x + threadIdx.x;
+    if (idx >= Np)
+        return;
+    int2 binRank = d_binRanks[idx];
+    d_idx[d_cell_start[binRank.x]+binRank.y] = idx;
     return;
     };
 
@@ -121,17 +128,16 @@ bool gpu_zero_array(int *arr,
 
 
 
-bool gpu_compute_cell_list(double2 *d_pt,
+bool gpu_compute_cell_list(const double2 *d_pt,
                                   unsigned int *d_cell_sizes,
+                                  int *d_cell_start,
                                   int *d_idx,
+                                  int2 *d_binRanks,
                                   int Np,
-                                  int &Nmax,
                                   int xsize,
                                   int ysize,
-                                  double boxsize,
                                   periodicBoundaries &Box,
                                   Index2D &ci,
-                                  Index2D &cli,
                                   int &maximumCellOccupation
                                   )
     {
@@ -140,25 +146,30 @@ bool gpu_compute_cell_list(double2 *d_pt,
     if (Np < 128) block_size = 16;
     unsigned int nblocks  = Np/block_size + 1;
 
-
-    unsigned int nmax = (unsigned int) Nmax;
-    gpu_compute_cell_list_kernel<<<nblocks, block_size>>>(d_pt,
+    gpu_cell_list_count_kernel<<<nblocks, block_size>>>(d_pt,
                                                           d_cell_sizes,
-                                                          d_idx,
+                                                          d_binRanks,
                                                           Np,
-                                                          nmax,
                                                           xsize,
                                                           ysize,
-                                                          boxsize,
                                                           Box,
-                                                          ci,
-                                                          cli
+                                                          ci
                                                           );
+    HANDLE_ERROR(cudaGetLastError());
+    int vecSize = xsize*ysize;
     {
+    //cell_start[0] = 0, and cell_start[bin+1] is the running total of the cell sizes
     thrust::device_ptr<unsigned int> dpCS(d_cell_sizes);
-    int vecSize = xsize*ysize;
+    thrust::device_ptr<int> dpStart(d_cell_start);
+    HANDLE_ERROR(cudaMemset(d_cell_start,0,sizeof(int)));
+    thrust::inclusive_scan(dpCS,dpCS+vecSize,dpStart+1);
     maximumCellOccupation = thrust::reduce(dpCS,dpCS+vecSize,0,thrust::maximum<unsigned int>());
     }
+    gpu_cell_list_scatter_kernel<<<nblocks, block_size>>>(d_binRanks,
+                                                          d_cell_start,
+                                                          d_idx,
+                                                          Np
+                                                          );
     HANDLE_ERROR(cudaGetLastError());
     return cudaSuccess;
     }
@@ -6,6 +6,12 @@
 #include "indexer.h"
 #include "periodicBoundaries.h"
 
+#ifdef __NVCC__
+#define HOSTDEVICE __host__ __device__ inline
+#else
+#define HOSTDEVICE inline __attribute__((always_inline))
+#endif
+
 /*! \file cellListGPU.cuh
 */
 
@@ -14,18 +20,44 @@
  * \brief CUDA kernels and callers for the cellListGPU class
  */
 
-//!Find the set indices of points in every cell bucket in the grid
-bool gpu_compute_cell_list(double2 *d_pt,
+/*!
+The bins of the cell list tile the fractional coordinates of the periodic box, so in real space they are
+parallelograms aligned with the box vectors. This returns the (x,y) bin containing a position
+*/
+HOSTDEVICE int2 cellListBin(const double2 &p, int xsize, int ysize, periodicBoundaries &Box)
+    {
+    double2 s;
+    Box.invTrans(p,s);
+    s.x -= floor(s.x);
+    s.y -= floor(s.y);
+    return make_int2(max(0,min(xsize-1,(int)floor(s.x*xsize))),
+                     max(0,min(ysize-1,(int)floor(s.y*ysize))));
+    };
+
+/*!
+Every point within a distance r of a position lies within the returned number of bins (in each
+direction) of the bin containing it; the widths are capped at half the number of bins
+*/
+HOSTDEVICE int2 cellListSearchWidth(double r, int xsize, int ysize, periodicBoundaries &Box)
+    {
+    double hx,hy;
+    Box.getBoxHeights(hx,hy);
+    int wx = (int)ceil(r*xsize/hx);
+    int wy = (int)ceil(r*ysize/hy);
+    return make_int2(min(wx,xsize/2),min(wy,ysize/2));
+    };
+
+//!Sort the indices of the points into the compact bucket structure with a counting sort
+bool gpu_compute_cell_list(const double2 *d_pt,
                                   unsigned int *d_cell_sizes,
+                                  int *d_cell_start,
                                   int *d_idx,
+                                  int2 *d_binRanks,
                                   int Np,
-                                  int &Nmax,
                                   int xsize,
                                   int ysize,
-                                  double boxsize,
                                   periodicBoundaries &Box,
                                   Index2D &ci,
-                                  Index2D &cli,
                                   int &maximumCellOccupation
                                   );
 //!convenience function to zero out an array on the GPU
@@ -39,4 +71,6 @@ bool gpu_zero_array(unsigned int *arr,
 
 /** @} */ //end of group declaration
 
+#undef HOSTDEVICE
+
 #endif
@@ -11,8 +11,14 @@
 //! Construct simple cell/bucket structures on the GPU, using kernels in \ref cellListGPUKernels
 /*!
  * A class that can sort points into a grid of buckets. This enables local searches for particle neighbors, etc.
- * Note that at the moment this class (and some of the classes above it) can only handle square boxes. This is
- * not a fundamental limitation, though.
+ * The buckets tile the fractional coordinates of the periodic box, so general (e.g. sheared) boxes are handled;
+ * see cellListBin and cellListSearchWidth in cellListGPU.cuh.
+ *
+ * The buckets are stored in a compact (CSR) layout, built by a two-pass counting sort: the particles in
+ * bucket "bin" are idxs[cell_start[bin]] ... idxs[cell_start[bin+1]-1], so idxs has exactly one entry per
+ * particle and the sort never has to be restarted because some bucket is unexpectedly full. On the CPU
+ * the counting is done with per-thread histograms and the result is stable (the particles in each bucket are
+ * in increasing index order); on the GPU the order within a bucket is set by atomic operations.
  */
 class cellListGPU
     {
@@ -34,16 +40,18 @@ class cellListGPU
         void setBox(PeriodicBoxPtr bx){Box=bx;};
         //!Set the number of particles to put in the buckets
         void setNp(int nn);
+        //!Set the number of threads to ask openMP to use during CPU computations
+        void setOmpThreads(int _number){ompThreadNum = _number;};
 
         //!call setGridSize if the particles and box already set, as this doubles as a general initialization of data structures
         void setGridSize(double a);
-        //!Get am upper bound on the maximum number of particles in a given bucket
+        //!Get the maximum number of particles in any bucket, as of the last computation
         int getNmax() {return Nmax;};
         //!The number of cells in the x-direction
         int getXsize() {return xsize;};
         //!The number of cells in the y-direction
         int getYsize() {return ysize;};
-        //!Returns the length of the square that forms the base grid size
+        //!Returns the width of the bins in the x-direction (the length of the square that forms the base grid, in a square box)
         double getBoxsize() {return boxsize;};
 
         //!If the grid is already initialized, given a spatial position return the cell index
@@ -67,6 +75,11 @@ class cellListGPU
             {
             return idxs;
             };
+        //!Return the array of offsets of each cell in the array of indices
+        const GPUArray<int>& getCellStartArray() const
+            {
+            return cell_start;
+            };
 
         //!Compute the cell list on the CPU, given the current particle positions in the GPUArray of particles
         void compute();
@@ -91,24 +104,30 @@ class cellListGPU
 
         //! Indexes the cells in the grid themselves (so the bin corresponding to the (j,i) position of the grid is bin=cell_indexer(i,j))
         Index2D cell_indexer;
-        //!Indexes elements in the cell list
-        Index2D cell_list_indexer;
 
         //!The particles that some methods act on
         GPUArray<double2> particles;
         //! An array containing the number of elements in each cell
         GPUArray<unsigned int> cell_sizes;
-        //!An array containing the indices of particles in various cells. So, idx[cell_list_indexer(nn,bin)] gives the index of the nth particle in the bin "bin" of the cell list
+        //!An array containing the indices of particles in various cells. So, idxs[cell_start[bin]+nn] gives the index of the nth particle in the bin "bin" of the cell list
         GPUArray<int> idxs;
+        //!The offset in idxs of the first particle of each bin; cell_start[totalCells] is the number of particles
+        GPUArray<int> cell_start;
 
         bool GPUcompute = true;
 
     protected:
-        //!first index is Nmax, second is whether to recompute
-        GPUArray<int> assist;
+        //!GPU scratch space: the bin of each particle, and its position within that bin
+        GPUArray<int2> binRanks;
+        //!CPU scratch space: the bin of each particle
+        vector<int> particleBins;
+        //!CPU scratch space: per-thread histograms of the bins, turned into per-thread write offsets
+        vector<int> threadCounts;
+        //!number of openMP threads to use
+        int ompThreadNum = 1;
         //!The number of particles to put in cells
         int Np;
-        //! The linear size of each grid cell
+        //! The linear size of each grid cell (its width across the first fractional coordinate, for general boxes)
         double boxsize;
         //!The number of bins in the x-direction
         int xsize;
@@ -0,0 +1,172 @@
+#include "checkpointFile.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/*! \file checkpointFile.cpp */
+
+//!Records start at multiples of this many bytes
+static const size_t checkpointAlignment = 64;
+
+static size_t alignedSize(size_t bytes)
+    {
+    return ((bytes + checkpointAlignment - 1)/checkpointAlignment)*checkpointAlignment;
+    };
+
+void checkpointWriter::addRecord(const string &name, const void *data, size_t bytes, int elementSize)
+    {
+    string fullName = prefix + name;
+    if(fullName.size() >= sizeof(checkpointTableEntry().name))
+        {
+        printf("checkpoint record name %s is too long\n",fullName.c_str());
+        throw std::exception();
+        };
+    records.push_back(record());
+    record &r = records.back();
+    r.name = fullName;
+    r.elementSize = elementSize;
+    r.data.resize(bytes);
+    if(bytes > 0)
+        memcpy(r.data.data(),data,bytes);
+    };
+
+size_t checkpointWriter::fileSize()
+    {
+    size_t size = alignedSize(sizeof(checkpointHeader) + records.size()*sizeof(checkpointTableEntry));
+    for (size_t rr = 0; rr < records.size(); ++rr)
+        size += alignedSize(records[rr].data.size());
+    return size;
+    };
+
+/*!
+The file is written to fileName.partial, which is then renamed to fileName, so a crash during the write
+never leaves a truncated checkpoint in place of a good one
+*/
+void checkpointWriter::write(const string &fileName)
+    {
+    checkpointHeader header;
+    memset(&header,0,sizeof(header));
+    memcpy(header.magic,"cellGPUc",8);
+    header.version = checkpointFormatVersion;
+    header.numberOfRecords = records.size();
+    header.fileSize = fileSize();
+
+    vector<checkpointTableEntry> entries(records.size());
+    size_t offset = alignedSize(sizeof(checkpointHeader) + records.size()*sizeof(checkpointTableEntry));
+    for (size_t rr = 0; rr < records.size(); ++rr)
+        {
+        memset(&entries[rr],0,sizeof(checkpointTableEntry));
+        strncpy(entries[rr].name,records[rr].name.c_str(),sizeof(entries[rr].name)-1);
+        entries[rr].offset = offset;
+        entries[rr].bytes = records[rr].data.size();
+        entries[rr].elementSize = records[rr].elementSize;
+        offset += alignedSize(records[rr].data.size());
+        };
+
+    string partialName = fileName + ".partial";
+    FILE *output = fopen(partialName.c_str(),"wb");
+    if(output == NULL)
+        {
+        printf("could not open %s for writing\n",partialName.c_str());
+        throw std::exception();
+        };
+    vector<char> padding(checkpointAlignment,0);
+    bool success = fwrite(&header,sizeof(header),1,output) == 1;
+    if(!entries.empty())
+        success = success && fwrite(entries.data(),sizeof(checkpointTableEntry),entries.size(),output) == entries.size();
+    size_t position = sizeof(checkpointHeader) + records.size()*sizeof(checkpointTableEntry);
+    success = success && fwrite(padding.data(),1,alignedSize(position)-position,output) == alignedSize(position)-position;
+    for (size_t rr = 0; rr < records.size() && success; ++rr)
+        {
+        size_t bytes = records[rr].data.size();
+        if(bytes > 0)
+            success = fwrite(records[rr].data.data(),1,bytes,output) == bytes;
+        size_t pad = alignedSize(bytes)-bytes;
+        success = success && fwrite(padding.data(),1,pad,output) == pad;
+        };
+    success = (fclose(output) == 0) && success;
+    if(!success || rename(partialName.c_str(),fileName.c_str()) != 0)
+        {
+        printf("failed to write the checkpoint %s\n",fileName.c_str());
+        throw std::exception();
+        };
+    };
+
+checkpointReader::checkpointReader(const string &fileName) : mapping(NULL), mappingSize(0)
+    {
+    int descriptor = open(fileName.c_str(),O_RDONLY);
+    if(descriptor < 0)
+        {
+        printf("could not open the checkpoint %s\n",fileName.c_str());
+        throw std::exception();
+        };
+    struct stat status;
+    fstat(descriptor,&status);
+    mappingSize = status.st_size;
+    if(mappingSize >= sizeof(checkpointHeader))
+        {
+        void *mapped = mmap(NULL,mappingSize,PROT_READ,MAP_PRIVATE,descriptor,0);
+        if(mapped != MAP_FAILED)
+            mapping = (char *)mapped;
+        };
+    close(descriptor);
+    if(mapping == NULL)
+        {
+        printf("could not map the checkpoint %s\n",fileName.c_str());
+        throw std::exception();
+        };
+
+    checkpointHeader header;
+    memcpy(&header,mapping,sizeof(header));
+    if(memcmp(header.magic,"cellGPUc",8) != 0 || header.fileSize != mappingSize ||
+       sizeof(checkpointHeader) + header.numberOfRecords*sizeof(checkpointTableEntry) > mappingSize)
+        {
+        munmap(mapping,mappingSize);
+        printf("%s is not a (complete) cellGPU checkpoint\n",fileName.c_str());
+        throw std::exception();
+        };
+    version = header.version;
+    if(version > checkpointFormatVersion)
+        {
+        munmap(mapping,mappingSize);
+        printf("%s was written in checkpoint format %u, but only formats up to %u can be read\n",
+               fileName.c_str(),version,checkpointFormatVersion);
+        throw std::exception();
+        };
+    const checkpointTableEntry *entries = (const checkpointTableEntry *)(mapping + sizeof(checkpointHeader));
+    for (unsigned int rr = 0; rr < header.numberOfRecords; ++rr)
+        {
+        checkpointTableEntry entry = entries[rr];
+        entry.name[sizeof(entry.name)-1] = '\0';
+        if(entry.offset + entry.bytes > mappingSize)
+            {
+            munmap(mapping,mappingSize);
+            printf("the record %s of %s lies outside the file\n",entry.name,fileName.c_str());
+            throw std::exception();
+            };
+        table[string(entry.name)] = entry;
+        };
+    };
+
+checkpointReader::~checkpointReader()
+    {
+    munmap(mapping,mappingSize);
+    };
+
+const void *checkpointReader::recordData(const string &name, size_t &elements, int elementSize)
+    {
+    unordered_map<string,checkpointTableEntry>::iterator it = table.find(prefix+name);
+    if(it == table.end())
+        {
+        printf("the checkpoint has no record %s%s\n",prefix.c_str(),name.c_str());
+        throw std::exception();
+        };
+    if(it->second.elementSize != (unsigned int)elementSize)
+        {
+        printf("checkpoint record %s%s has elements of %u bytes, but %i were expected\n",
+               prefix.c_str(),name.c_str(),it->second.elementSize,elementSize);
+        throw std::exception();
+        };
+    elements = it->second.bytes/elementSize;
+    return mapping + it->second.offset;
+    };
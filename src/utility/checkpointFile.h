@@ -0,0 +1,171 @@
+#ifndef checkpointFile_H
+#define checkpointFile_H
+
+#include "std_include.h"
+#include "gpuarray.h"
+#include <unordered_map>
+
+/*! \file checkpointFile.h */
+
+//!The version of the checkpoint format written by checkpointWriter
+const unsigned int checkpointFormatVersion = 1;
+
+/*!
+A checkpoint is a flat collection of named binary records (the raw bytes of GPUArrays, vectors, and
+scalars, plus a few strings), laid out so that the file can be memory mapped and every record used in
+place:
+
+    header   char magic[8] = "cellGPUc" | uint32 version | uint32 number of records | uint64 file size
+    table    one 128 byte entry per record: char name[104] | uint64 offset | uint64 bytes | uint32 element size | uint32 (unused)
+    data     the records, each starting at a multiple of 64 bytes
+
+Everything is stored in the byte order of the machine that wrote it. Records are looked up by name, so
+components can add records in later versions without breaking older checkpoints (see hasRecord).
+*/
+struct checkpointHeader
+    {
+    char magic[8];
+    unsigned int version;
+    unsigned int numberOfRecords;
+    unsigned long long fileSize;
+    };
+//!An entry of the table of records of a checkpoint file
+struct checkpointTableEntry
+    {
+    char name[104];
+    unsigned long long offset;
+    unsigned long long bytes;
+    unsigned int elementSize;
+    unsigned int unused;
+    };
+
+//!Collects the records of a checkpoint in memory and writes them to a file
+/*!
+Every add function copies its data immediately, so once a writer has been filled the simulation can
+carry on while write() runs on another thread. Record names are prefixed with the current value of
+prefix, so that, e.g., every updater of a Simulation can use the same short names for its records.
+*/
+class checkpointWriter
+    {
+    public:
+        //!Prepended to the names of the records added from now on
+        string prefix;
+
+        //!Add a record of bytes bytes made of elements of elementSize bytes
+        void addRecord(const string &name, const void *data, size_t bytes, int elementSize);
+        //!Add a single value of any plain type
+        template<typename T> void addValue(const string &name, const T &value)
+            {
+            addRecord(name,&value,sizeof(T),sizeof(T));
+            };
+        //!Add the contents of a vector of plain types
+        template<typename T> void addVector(const string &name, const vector<T> &values)
+            {
+            addRecord(name,values.data(),sizeof(T)*values.size(),sizeof(T));
+            };
+        //!Add the contents of a GPUArray (which is copied to the host if necessary)
+        template<typename T> void addArray(const string &name, GPUArray<T> &array)
+            {
+            if(array.getNumElements() == 0)
+                {
+                addRecord(name,NULL,0,sizeof(T));
+                return;
+                };
+            ArrayHandle<T> h(array,access_location::host,access_mode::read);
+            addRecord(name,h.data,sizeof(T)*array.getNumElements(),sizeof(T));
+            };
+        //!Add a string
+        void addString(const string &name, const string &value)
+            {
+            addRecord(name,value.data(),value.size(),1);
+            };
+
+        //!The total size of the file that write will produce
+        size_t fileSize();
+        //!Write every record to fileName (through a temporary file, so that an existing checkpoint is only replaced by a complete one)
+        void write(const string &fileName);
+
+    protected:
+        struct record
+            {
+            string name;
+            int elementSize;
+            vector<char> data;
+            };
+        vector<record> records;
+    };
+
+//!Memory maps a checkpoint file and gives access to its records
+/*!
+The read functions copy a record into a value, vector, or GPUArray (resizing the latter two as
+needed), checking that the element sizes match; recordData gives a pointer into the mapping itself.
+Names are prefixed with prefix, as in checkpointWriter. Asking for a record that is not in the file
+is an error, so optional records should be checked with hasRecord first.
+*/
+class checkpointReader
+    {
+    public:
+        //!Map the file and read its table of records
+        checkpointReader(const string &fileName);
+        ~checkpointReader();
+
+        //!Prepended to the names of the records looked up from now on
+        string prefix;
+        //!The format version of the file
+        unsigned int version;
+
+        //!Is there a record with this name?
+        bool hasRecord(const string &name){return table.find(prefix+name) != table.end();};
+        //!A pointer to the record in the mapped file, and the number of elements of elementSize bytes in it
+        const void *recordData(const string &name, size_t &elements, int elementSize);
+
+        //!Read a single value
+        template<typename T> void readValue(const string &name, T &value)
+            {
+            size_t elements;
+            const void *data = recordData(name,elements,sizeof(T));
+            if(elements != 1)
+                {
+                printf("checkpoint record %s%s holds %zu values, not one\n",prefix.c_str(),name.c_str(),elements);
+                throw std::exception();
+                };
+            memcpy(&value,data,sizeof(T));
+            };
+        //!Read a vector, resizing it to the record
+        template<typename T> void readVector(const string &name, vector<T> &values)
+            {
+            size_t elements;
+            const void *data = recordData(name,elements,sizeof(T));
+            values.resize(elements);
+            if(elements > 0)
+                memcpy(values.data(),data,sizeof(T)*elements);
+            };
+        //!Read a GPUArray, resizing it to the record
+        template<typename T> void readArray(const string &name, GPUArray<T> &array)
+            {
+            size_t elements;
+            const void *data = recordData(name,elements,sizeof(T));
+            if(array.getNumElements() != elements)
+                array.resize(elements);
+            if(elements == 0)
+                return;
+            ArrayHandle<T> h(array,access_location::host,access_mode::overwrite);
+            memcpy(h.data,data,sizeof(T)*elements);
+            };
+        //!Read a string
+        void readString(const string &name, string &value)
+            {
+            size_t elements;
+            const char *data = (const char *) recordData(name,elements,1);
+            value.assign(data,elements);
+            };
+
+    protected:
+        //!The mapped file
+        char *mapping;
+        //!The size of the mapping
+        size_t mappingSize;
+        //!name -> table entry
+        unordered_map<string,checkpointTableEntry> table;
+    };
+#endif
@@ -0,0 +1,448 @@
+#ifndef EXACTPREDICATES_H
+#define EXACTPREDICATES_H
+
+#include "functions.h"
+#include "periodicBoundaries.h"
+
+#ifdef __NVCC__
+#define HOSTDEVICE __host__ __device__ inline
+//!the slow, exact paths are left to the compiler's discretion to inline
+#define EXACTHOSTDEVICE __host__ __device__ inline
+//!the exact fallbacks must never be inlined into (and enlarge or slow down) the fast paths
+#define EXPANSIONHOSTDEVICE __host__ __device__ inline __noinline__
+#else
+#define HOSTDEVICE inline __attribute__((always_inline))
+#define EXACTHOSTDEVICE inline
+#define EXPANSIONHOSTDEVICE inline __attribute__((noinline))
+#endif
+
+/*! \file exactPredicates.h */
+
+/** @defgroup exactPredicates exact predicates
+ * @{
+ \brief Adaptive-precision orientation and in-circle tests, following Shewchuk
+
+ Each predicate is first evaluated in ordinary double precision; the result is returned if its magnitude
+ exceeds a rigorous bound on the rounding error. Otherwise the determinant is recomputed exactly with
+ floating-point expansion arithmetic (sums of non-overlapping doubles). The exact path is only taken for
+ (nearly) degenerate inputs: collinear or cocircular points, such as those of perfect lattices.
+
+ On the device the exact in-circle test is limited to inputs whose coordinate differences are exactly
+ representable (e.g., lattices, or nearby points); other near-degenerate inputs return the rounded
+ estimate, to keep the per-thread stack small. The host versions are always exact.
+
+ inCircleSign and the periodic versions additionally break exact ties with a symbolic perturbation of
+ the lifted points, keyed on a rank (usually the particle index) for each point, so every exactly
+ cocircular configuration is resolved the same way by every caller. periodicInCircleSign also makes
+ the inputs of near-degenerate tests independent of the caller, so that one-rings constructed
+ independently (each in the frame of its own particle) always agree with each other.
+ */
+
+//!the machine epsilon for the double-precision predicates, 2^{-53}
+#define PREDICATE_EPSILON 1.1102230246251565e-16
+//!relative error bound of the rounded orientation determinant
+#define ORIENT_ERRBOUND ((3.0+16.0*PREDICATE_EPSILON)*PREDICATE_EPSILON)
+//!relative error bound of the rounded in-circle determinant
+#define INCIRCLE_ERRBOUND ((10.0+96.0*PREDICATE_EPSILON)*PREDICATE_EPSILON)
+
+//!x+y = a+b exactly, with x the rounded sum
+HOSTDEVICE void twoSum(const double a, const double b, double &x, double &y)
+    {
+    x = a+b;
+    double bVirtual = x-a;
+    double aVirtual = x-bVirtual;
+    y = (a-aVirtual)+(b-bVirtual);
+    };
+
+//!x+y = a-b exactly, with x the rounded difference
+HOSTDEVICE void twoDiff(const double a, const double b, double &x, double &y)
+    {
+    x = a-b;
+    double bVirtual = a-x;
+    double aVirtual = x+bVirtual;
+    y = (a-aVirtual)+(bVirtual-b);
+    };
+
+//!x+y = a*b exactly, with x the rounded product
+HOSTDEVICE void twoProduct(const double a, const double b, double &x, double &y)
+    {
+    x = a*b;
+    y = fma(a,b,-x);
+    };
+
+/*!
+h = e+f for two non-overlapping expansions (components in increasing order of magnitude); zero
+components are dropped. h must have room for elen+flen components. Returns the length of h
+*/
+EXACTHOSTDEVICE int expansionSum(int elen, const double *e, int flen, const double *f, double *h)
+    {
+    if(elen == 0)
+        {
+        for (int ii = 0; ii < flen; ++ii)
+            h[ii] = f[ii];
+        return flen;
+        };
+    if(flen == 0)
+        {
+        for (int ii = 0; ii < elen; ++ii)
+            h[ii] = e[ii];
+        return elen;
+        };
+    double Q, Qnew, hh, enow, fnow;
+    int eindex = 0, findex = 0, hindex = 0;
+    enow = e[0];
+    fnow = f[0];
+    if((fnow > enow) == (fnow > -enow))
+        {
+        Q = enow;
+        if(++eindex < elen) enow = e[eindex];
+        }
+    else
+        {
+        Q = fnow;
+        if(++findex < flen) fnow = f[findex];
+        };
+    if((eindex < elen) && (findex < flen))
+        {
+        if((fnow > enow) == (fnow > -enow))
+            {
+            Qnew = enow+Q;
+            hh = Q-(Qnew-enow);
+            if(++eindex < elen) enow = e[eindex];
+            }
+        else
+            {
+            Qnew = fnow+Q;
+            hh = Q-(Qnew-fnow);
+            if(++findex < flen) fnow = f[findex];
+            };
+        Q = Qnew;
+        if(hh != 0.0)
+            h[hindex++] = hh;
+        while((eindex < elen) && (findex < flen))
+            {
+            if((fnow > enow) == (fnow > -enow))
+                {
+                twoSum(Q,enow,Qnew,hh);
+                if(++eindex < elen) enow = e[eindex];
+                }
+            else
+                {
+                twoSum(Q,fnow,Qnew,hh);
+                if(++findex < flen) fnow = f[findex];
+                };
+            Q = Qnew;
+            if(hh != 0.0)
+                h[hindex++] = hh;
+            };
+        };
+    while(eindex < elen)
+        {
+        twoSum(Q,enow,Qnew,hh);
+        if(++eindex < elen) enow = e[eindex];
+        Q = Qnew;
+        if(hh != 0.0)
+            h[hindex++] = hh;
+        };
+    while(findex < flen)
+        {
+        twoSum(Q,fnow,Qnew,hh);
+        if(++findex < flen) fnow = f[findex];
+        Q = Qnew;
+        if(hh != 0.0)
+            h[hindex++] = hh;
+        };
+    if((Q != 0.0) || (hindex == 0))
+        h[hindex++] = Q;
+    return hindex;
+    };
+
+//!h = b*e for a non-overlapping expansion e; h must have room for 2*elen components. Returns the length of h
+EXACTHOSTDEVICE int scaleExpansion(int elen, const double *e, const double b, double *h)
+    {
+    double Q, sum, hh, product1, product0;
+    int hindex = 0;
+    twoProduct(e[0],b,Q,hh);
+    if(hh != 0)
+        h[hindex++] = hh;
+    for (int eindex = 1; eindex < elen; ++eindex)
+        {
+        twoProduct(e[eindex],b,product1,product0);
+        twoSum(Q,product0,sum,hh);
+        if(hh != 0)
+            h[hindex++] = hh;
+        twoSum(product1,sum,Q,hh);
+        if(hh != 0)
+            h[hindex++] = hh;
+        };
+    if((Q != 0.0) || (hindex == 0))
+        h[hindex++] = Q;
+    return hindex;
+    };
+
+/*!
+h = e*f; h and scratch must each have room for 2*elen*flen components, and e can have at most 32
+components. Returns the length of h
+*/
+EXACTHOSTDEVICE int expansionProduct(int elen, const double *e, int flen, const double *f, double *h, double *scratch)
+    {
+    double partial[2*2*2*2*2*2];
+    int hlen = 0;
+    for (int ii = 0; ii < flen; ++ii)
+        {
+        int plen = scaleExpansion(elen,e,f[ii],partial);
+        int newlen = expansionSum(hlen,h,plen,partial,scratch);
+        for (int jj = 0; jj < newlen; ++jj)
+            h[jj] = scratch[jj];
+        hlen = newlen;
+        };
+    return hlen;
+    };
+
+//!The exact orientation determinant, evaluated with expansions of the exact coordinate differences
+EXPANSIONHOSTDEVICE double orient2DExact(const double2 &x1, const double2 &x2, const double2 &x3)
+    {
+    //(x2-x1) cross (x3-x1), with each difference as a two-component expansion
+    double ax[2], ay[2], bx[2], by[2];
+    twoDiff(x2.x,x1.x,ax[1],ax[0]);
+    twoDiff(x2.y,x1.y,ay[1],ay[0]);
+    twoDiff(x3.x,x1.x,bx[1],bx[0]);
+    twoDiff(x3.y,x1.y,by[1],by[0]);
+    int axlen = (ax[0] == 0.0) ? 1 : 2;
+    int aylen = (ay[0] == 0.0) ? 1 : 2;
+    int bxlen = (bx[0] == 0.0) ? 1 : 2;
+    int bylen = (by[0] == 0.0) ? 1 : 2;
+    double *axp = (axlen == 1) ? ax+1 : ax;
+    double *ayp = (aylen == 1) ? ay+1 : ay;
+    double *bxp = (bxlen == 1) ? bx+1 : bx;
+    double *byp = (bylen == 1) ? by+1 : by;
+
+    double left[8], right[8], scratch[8], det[16];
+    int llen = expansionProduct(axlen,axp,bylen,byp,left,scratch);
+    int rlen = expansionProduct(aylen,ayp,bxlen,bxp,right,scratch);
+    for (int ii = 0; ii < rlen; ++ii)
+        right[ii] = -right[ii];
+    int dlen = expansionSum(llen,left,rlen,right,det);
+    return det[dlen-1];
+    };
+
+//!Twice the signed area of the triangle (x1,x2,x3), with a correct sign: positive if the points are in CCW order
+HOSTDEVICE double orient2DAdaptive(const double2 &x1, const double2 &x2, const double2 &x3)
+    {
+    double detleft = (x2.x-x1.x)*(x3.y-x1.y);
+    double detright = (x2.y-x1.y)*(x3.x-x1.x);
+    double det = detleft-detright;
+    if(fabs(det) > ORIENT_ERRBOUND*(fabs(detleft)+fabs(detright)))
+        return det;
+    return orient2DExact(x1,x2,x3);
+    };
+
+/*!
+The exact in-circle determinant. The coordinate differences (relative to x4) are expansions of at most
+D components; D=1 is exact only when every difference is exactly representable
+*/
+template<int D>
+EXPANSIONHOSTDEVICE double inCircleExpansion(const double *dx, const double *dy, const int *dxlen, const int *dylen)
+    {
+    //lift[i] = dx_i^2+dy_i^2, cross[i] = dx_j dy_k - dx_k dy_j
+    double squares[2][2*D*D], lift[4*D*D], cross[4*D*D], scratch[32*D*D*D*D];
+    double term[32*D*D*D*D], sum[96*D*D*D*D], det[96*D*D*D*D];
+    int detlen = 0;
+    for (int ii = 0; ii < 3; ++ii)
+        {
+        int jj = (ii+1)%3;
+        int kk = (ii+2)%3;
+        const double *xi = dx+D*ii, *yi = dy+D*ii;
+        const double *xj = dx+D*jj, *yj = dy+D*jj;
+        const double *xk = dx+D*kk, *yk = dy+D*kk;
+        int s0 = expansionProduct(dxlen[ii],xi,dxlen[ii],xi,squares[0],scratch);
+        int s1 = expansionProduct(dylen[ii],yi,dylen[ii],yi,squares[1],scratch);
+        int liftlen = expansionSum(s0,squares[0],s1,squares[1],lift);
+        s0 = expansionProduct(dxlen[jj],xj,dylen[kk],yk,squares[0],scratch);
+        s1 = expansionProduct(dxlen[kk],xk,dylen[jj],yj,squares[1],scratch);
+        for (int pp = 0; pp < s1; ++pp)
+            squares[1][pp] = -squares[1][pp];
+        int crosslen = expansionSum(s0,squares[0],s1,squares[1],cross);
+        int termlen = expansionProduct(crosslen,cross,liftlen,lift,term,scratch);
+        int sumlen = expansionSum(detlen,det,termlen,term,sum);
+        for (int pp = 0; pp < sumlen; ++pp)
+            det[pp] = sum[pp];
+        detlen = sumlen;
+        };
+    return det[detlen-1];
+    };
+
+//!The exact in-circle determinant of inCircle
+EXPANSIONHOSTDEVICE double inCircleExact(const double2 &x1, const double2 &x2, const double2 &x3, const double2 &x4)
+    {
+    //differences stored as {head, tail}, and as {tail, head} expansions below
+    double hx[3], hy[3], tx[3], ty[3];
+    twoDiff(x1.x,x4.x,hx[0],tx[0]); twoDiff(x1.y,x4.y,hy[0],ty[0]);
+    twoDiff(x2.x,x4.x,hx[1],tx[1]); twoDiff(x2.y,x4.y,hy[1],ty[1]);
+    twoDiff(x3.x,x4.x,hx[2],tx[2]); twoDiff(x3.y,x4.y,hy[2],ty[2]);
+    int lenx[3], leny[3];
+    bool exactDifferences = true;
+    for (int ii = 0; ii < 3; ++ii)
+        if(tx[ii] != 0.0 || ty[ii] != 0.0)
+            exactDifferences = false;
+    if(exactDifferences)
+        {
+        for (int ii = 0; ii < 3; ++ii)
+            {
+            lenx[ii] = 1;
+            leny[ii] = 1;
+            };
+        return inCircleExpansion<1>(hx,hy,lenx,leny);
+        };
+#ifdef __CUDA_ARCH__
+    return (hx[0]*hx[0]+hy[0]*hy[0])*(hx[1]*hy[2]-hx[2]*hy[1])
+         + (hx[1]*hx[1]+hy[1]*hy[1])*(hx[2]*hy[0]-hx[0]*hy[2])
+         + (hx[2]*hx[2]+hy[2]*hy[2])*(hx[0]*hy[1]-hx[1]*hy[0]);
+#else
+    double dx[6], dy[6];
+    for (int ii = 0; ii < 3; ++ii)
+        {
+        lenx[ii] = 0;
+        if(tx[ii] != 0.0)
+            dx[2*ii+lenx[ii]++] = tx[ii];
+        dx[2*ii+lenx[ii]++] = hx[ii];
+        leny[ii] = 0;
+        if(ty[ii] != 0.0)
+            dy[2*ii+leny[ii]++] = ty[ii];
+        dy[2*ii+leny[ii]++] = hy[ii];
+        };
+    return inCircleExpansion<2>(dx,dy,lenx,leny);
+#endif
+    };
+
+//!Positive if x4 lies inside the circumcircle of the CCW-ordered triangle (x1,x2,x3), negative if outside, zero if cocircular
+HOSTDEVICE double inCircleAdaptive(const double2 &x1, const double2 &x2, const double2 &x3, const double2 &x4)
+    {
+    double adx = x1.x-x4.x; double ady = x1.y-x4.y;
+    double bdx = x2.x-x4.x; double bdy = x2.y-x4.y;
+    double cdx = x3.x-x4.x; double cdy = x3.y-x4.y;
+
+    double bdxcdy = bdx*cdy, cdxbdy = cdx*bdy;
+    double cdxady = cdx*ady, adxcdy = adx*cdy;
+    double adxbdy = adx*bdy, bdxady = bdx*ady;
+    double alift = adx*adx+ady*ady;
+    double blift = bdx*bdx+bdy*bdy;
+    double clift = cdx*cdx+cdy*cdy;
+    double det = alift*(bdxcdy-cdxbdy) + blift*(cdxady-adxcdy) + clift*(adxbdy-bdxady);
+    double permanent = (fabs(bdxcdy)+fabs(cdxbdy))*alift + (fabs(cdxady)+fabs(adxcdy))*blift
+                     + (fabs(adxbdy)+fabs(bdxady))*clift;
+    double errbound = INCIRCLE_ERRBOUND*permanent;
+    if(det > errbound || -det > errbound)
+        return det;
+    return inCircleExact(x1,x2,x3,x4);
+    };
+
+//!the sign of a double, as an int
+HOSTDEVICE int predicateSign(const double x)
+    {
+    return (x > 0.0) ? 1 : ((x < 0.0) ? -1 : 0);
+    };
+
+/*!
+The sign of inCircleAdaptive, with exact ties broken by raising the lifted coordinate of each point by
+an infinitesimal that grows with its rank; the highest-ranked point whose perturbation changes the
+determinant decides the sign. Returns zero only if the points are not in general position in a way no
+perturbation of the lifts can resolve (e.g., repeated points)
+*/
+HOSTDEVICE int inCircleSign(const double2 &x1, const double2 &x2, const double2 &x3, const double2 &x4,
+                            int r1, int r2, int r3, int r4)
+    {
+    int sign = predicateSign(inCircleAdaptive(x1,x2,x3,x4));
+    if(sign != 0)
+        return sign;
+    //the derivative of the determinant with respect to the lift of each point
+    int ranks[4] = {r1,r2,r3,r4};
+    bool used[4] = {false,false,false,false};
+    for (int ii = 0; ii < 4; ++ii)
+        {
+        int which = -1;
+        for (int jj = 0; jj < 4; ++jj)
+            if(!used[jj] && (which < 0 || ranks[jj] > ranks[which]))
+                which = jj;
+        used[which] = true;
+        switch(which)
+            {
+            case 0: sign = predicateSign(orient2DAdaptive(x2,x3,x4)); break;
+            case 1: sign = predicateSign(orient2DAdaptive(x3,x1,x4)); break;
+            case 2: sign = predicateSign(orient2DAdaptive(x1,x2,x4)); break;
+            default: sign = -predicateSign(orient2DAdaptive(x1,x2,x3)); break;
+            };
+        if(sign != 0)
+            return sign;
+        };
+    return 0;
+    };
+
+/*!
+The in-circle sign (as inCircleSign) of four particles of a periodic point set. The xi are their positions
+relative to a common origin, as computed by the caller (e.g., with minDist), each coordinate carrying an
+absolute error of at most coordinateError. If the sign is certain despite those errors it is returned
+directly. Otherwise the test is repeated exactly on positions relative to the lowest-indexed particle:
+every caller then evaluates any given four particles in the same frame, with bitwise identical inputs, so
+near-degenerate configurations are decided identically no matter which particle's one-ring (or which
+block of a partitioned triangulation) the test comes from. Virtual points (negative indices) are always
+evaluated in the caller's frame
+*/
+HOSTDEVICE int periodicInCircleSign(const double2 &x1, const double2 &x2, const double2 &x3, const double2 &x4,
+                                    int i1, int i2, int i3, int i4, const double2 *positions,
+                                    periodicBoundaries &Box, double coordinateError)
+    {
+    double adx = x1.x-x4.x; double ady = x1.y-x4.y;
+    double bdx = x2.x-x4.x; double bdy = x2.y-x4.y;
+    double cdx = x3.x-x4.x; double cdy = x3.y-x4.y;
+    double alift = adx*adx+ady*ady;
+    double blift = bdx*bdx+bdy*bdy;
+    double clift = cdx*cdx+cdy*cdy;
+    double det = alift*(bdx*cdy-cdx*bdy) + blift*(cdx*ady-adx*cdy) + clift*(adx*bdy-bdx*ady);
+    //with S the sum of the lifts, the permanent of the determinant is at most S^2/2, and every difference
+    //is at most sqrt(S). Each difference is off by at most twice the coordinate error, which changes each
+    //of the three lift*cross terms by at most 16 S^{3/2} (2 coordinateError); the factor of two more covers
+    //the errors of both frames
+    double S = alift+blift+clift;
+    double errbound = S*(0.5*INCIRCLE_ERRBOUND*S + 256.0*coordinateError*sqrt(S));
+    if(det > errbound || -det > errbound)
+        return (det > 0) ? 1 : -1;
+
+    if(i1 < 0 || i2 < 0 || i3 < 0 || i4 < 0)
+        return inCircleSign(x1,x2,x3,x4,i1,i2,i3,i4);
+    int reference = min(min(i1,i2),min(i3,i4));
+    double2 origin = positions[reference];
+    double2 y1, y2, y3, y4;
+    Box.minDist(positions[i1],origin,y1);
+    Box.minDist(positions[i2],origin,y2);
+    Box.minDist(positions[i3],origin,y3);
+    Box.minDist(positions[i4],origin,y4);
+    return inCircleSign(y1,y2,y3,y4,i1,i2,i3,i4);
+    };
+
+/*!
+Is the particle at x4 strictly inside the (symbolically perturbed) circumcircle of the triangle of particles
+at (x1,x2,x3), regardless of the orientation of the triangle? Positions and indices are as in
+periodicInCircleSign
+*/
+HOSTDEVICE bool periodicCircumcircleContains(const double2 &x1, const double2 &x2, const double2 &x3, const double2 &x4,
+                                             int i1, int i2, int i3, int i4, const double2 *positions,
+                                             periodicBoundaries &Box, double coordinateError)
+    {
+    int orientation = predicateSign(orient2DAdaptive(x1,x2,x3));
+    return orientation*periodicInCircleSign(x1,x2,x3,x4,i1,i2,i3,i4,positions,Box,coordinateError) > 0;
+    };
+
+//!A bound on the absolute error of the coordinates of relative positions computed with minDist (or of periodic images)
+HOSTDEVICE double minDistError(periodicBoundaries &Box)
+    {
+    double xx,xy,yx,yy;
+    Box.getBoxDims(xx,xy,yx,yy);
+    return 32.0*PREDICATE_EPSILON*(fabs(xx)+fabs(xy)+fabs(yx)+fabs(yy));
+    };
+
+/** @} */ //end of group declaration
+#undef HOSTDEVICE
+#undef EXACTHOSTDEVICE
+#undef EXPANSIONHOSTDEVICE
+#endif
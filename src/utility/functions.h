@@ -82,22 +82,13 @@ template<typename T>
 inline __attribute__((always_inline)) void removeGPUArrayElement(GPUArray<T> &data, int index)
     {
     int n = data.getNumElements();
-    GPUArray<T> newData;
-    newData.resize(n-1);
-    {//scope for array handles
-    ArrayHandle<T> h(data,access_location::host,access_mode::read);
-    ArrayHandle<T> h1(newData,access_location::host,access_mode::overwrite);
-    int idx = 0;
-    for (int i = 0; i < n; ++i)
-        {
-        if (i != index)
-            {
-            h1.data[idx] = h.data[i];
-            idx += 1;
-            };
-        };
+    {//scope for array handle
+    ArrayHandle<T> h(data,access_location::host,access_mode::readwrite);
+    for (int i = index; i < n-1; ++i)
+        h.data[i] = h.data[i+1];
     };
-    data = newData;
+    //shrinking keeps the allocation
+    data.resize(n-1);
     };
 
 //!shrink a GPUArray by removing the elements [i1,i2,...in] of a vector and shifting any elements j > i_i into place
@@ -105,30 +96,25 @@ template<typename T>
 inline __attribute__((always_inline)) void removeGPUArrayElement(GPUArray<T> &data, vector<int> indices)
     {
     std::sort(indices.begin(),indices.end());
+    if(indices.size() == 0)
+        return;
     int n = data.getNumElements();
-    GPUArray<T> newData;
-    newData.resize(n-indices.size());
-    {//scope for array handles
-    ArrayHandle<T> h(data,access_location::host,access_mode::read);
-    ArrayHandle<T> h1(newData,access_location::host,access_mode::overwrite);
-    int idx = 0;
-    int vectorIndex = 0;
-    for (int i = 0; i < n; ++i)
+    int idx = indices[0];
+    {//scope for array handle
+    ArrayHandle<T> h(data,access_location::host,access_mode::readwrite);
+    size_t vectorIndex = 0;
+    for (int i = indices[0]; i < n; ++i)
         {
-        if (i != indices[vectorIndex])
-            {
-            h1.data[idx] = h.data[i];
-            idx += 1;
-            }
+        if (vectorIndex < indices.size() && i == indices[vectorIndex])
+            vectorIndex += 1;
         else
             {
-            vectorIndex += 1;
-            if (vectorIndex >= indices.size())
-                vectorIndex -= 1;
+            h.data[idx] = h.data[i];
+            idx += 1;
             };
         };
     };
-    data = newData;
+    data.resize(n-indices.size());
     };
 
 //!print a double2 to screen
@@ -137,20 +123,29 @@ inline __attribute__((always_inline)) void printdouble2(double2 a)
     printf("%f\t%f\n",a.x,a.y);
     };
 
-//!grow a GPUArray, leaving the current elements the same but with extra capacity at the end of the array
+//!grow a GPUArray, leaving the current elements the same and zeroing the extra elements at the end of the array
 template<typename T>
 inline __attribute__((always_inline)) void growGPUArray(GPUArray<T> &data, int extraElements)
     {
-    int n = data.getNumElements();
+    //resize keeps the data and grows the capacity geometrically, so repeated growth is amortized O(1)
+    data.resize(data.getNumElements()+extraElements);
+    };
+
+//!change the row width of a GPUArray accessed by an Index2D(width,rows), keeping the first min(oldWidth,newWidth) entries of every row in place
+template<typename T>
+inline __attribute__((always_inline)) void restrideGPUArray(GPUArray<T> &data, int oldWidth, int newWidth, int rows)
+    {
     GPUArray<T> newData;
-    newData.resize(n+extraElements);
+    newData.neverGPU = data.neverGPU;
+    newData.resize(newWidth*rows);
+    int w = min(oldWidth,newWidth);
     {//scope for array handles
-    ArrayHandle<T> h(data,access_location::host,access_mode::readwrite);
+    ArrayHandle<T> h(data,access_location::host,access_mode::read);
     ArrayHandle<T> hnew(newData,access_location::host,access_mode::overwrite);
-    for (int i = 0; i < n; ++i)
-        hnew.data[i] = h.data[i];
+    for (int r = 0; r < rows; ++r)
+        for (int i = 0; i < w; ++i)
+            hnew.data[r*newWidth+i] = h.data[r*oldWidth+i];
     };
-    //no need to resize?
     data.swap(newData);
     };
 
@@ -201,6 +196,23 @@ HOSTDEVICE bool ccw(const double2 &x1, const double2 &x2, const double2 &x3)
     return (x3.y-x1.y)*(x2.x-x1.x) > (x2.y-x1.y)*(x3.x-x1.x);
     };
 
+//!Twice the signed area of the triangle (x1,x2,x3)...positive if the points are in CCW order
+HOSTDEVICE double orient2D(const double2 &x1, const double2 &x2, const double2 &x3)
+    {
+    return (x2.x-x1.x)*(x3.y-x1.y) - (x2.y-x1.y)*(x3.x-x1.x);
+    };
+
+//!Positive if x4 lies inside the circumcircle of the CCW-ordered triangle (x1,x2,x3), negative if outside
+HOSTDEVICE double inCircle(const double2 &x1, const double2 &x2, const double2 &x3, const double2 &x4)
+    {
+    double adx = x1.x-x4.x; double ady = x1.y-x4.y;
+    double bdx = x2.x-x4.x; double bdy = x2.y-x4.y;
+    double cdx = x3.x-x4.x; double cdy = x3.y-x4.y;
+    return (adx*adx+ady*ady)*(bdx*cdy-cdx*bdy)
+         + (bdx*bdx+bdy*bdy)*(cdx*ady-adx*cdy)
+         + (cdx*cdx+cdy*cdy)*(adx*bdy-bdx*ady);
+    };
+
 //!The dot product between two vectors of length two.
 HOSTDEVICE double dot(const double2 &p1, const double2 &p2)
     {
@@ -23,7 +23,12 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS ``AS IS'' AND
 This file defines two helpful classes for working with data on both th CPU and GPU.
 GPUArray<T> is a templated array that carries around with it some data, as well as
 information about where that data was last modified and/or accessed. It can be
-dynamically resized, but does not have vector methods like push_back.
+dynamically resized, but does not have vector methods like push_back. Like a vector, it keeps
+a capacity: growing beyond it reallocates geometrically, so repeatedly adding a few elements
+(e.g., in cell divisions) costs amortized O(1) per element, and shrinking never reallocates.
+Assigning one GPUArray to another makes a deep copy; prefer copyFrom, which reuses the
+destination's memory and makes the copy explicit, or std::move / swap when the source is not
+needed afterwards.
 
 GPUArray<T> objects are manipulated by ArrayHandle<T> objects. So, if you have declared a
 GPUArray<int> cellIndex(numberOfCells)
@@ -118,8 +123,16 @@ template<class T> class GPUArray
 
         bool neverGPU = false;
         
+        //!A deep copy
         GPUArray(const GPUArray& from);
+        //!A deep copy (kept for compatibility; see copyFrom)
         GPUArray& operator=(const GPUArray& rhs);
+        //!Take over the memory of another GPUArray, leaving it empty
+        GPUArray(GPUArray&& from) noexcept;
+        //!Take over the memory of another GPUArray, leaving it empty
+        GPUArray& operator=(GPUArray&& rhs) noexcept;
+        //!Copy the contents of another GPUArray, reusing the current allocation when it is large enough
+        void copyFrom(const GPUArray& from);
         //!Swap two GPUarrays efficiently
         inline void swap(GPUArray& from);
         //!Get the size of the array
@@ -127,6 +140,11 @@ template<class T> class GPUArray
             {
             return Num_elements;
             }
+        //!Get the number of elements the array can hold without reallocating
+        unsigned int getCapacity() const
+            {
+            return Capacity;
+            }
         //! Switch from simple memcpys to HostRegister pinned memory copies. Not currently fully functional
         void setRegistered(bool _reg)
             {
@@ -134,8 +152,12 @@ template<class T> class GPUArray
             if(RegisterArray)
                 cudaHostRegister(h_data,Num_elements*sizeof(T),cudaHostRegisterDefault);
             };
-        //!Resize the array...performs operations on both the CPU and GPU
+        //!Resize the array, keeping the first min(old,new) elements and zeroing any new ones...performs operations on both the CPU and GPU
         virtual void resize(unsigned int num_elements);
+        //!Make room for at least num_elements elements without changing the size of the array
+        void reserve(unsigned int num_elements);
+        //!Release any memory beyond the current size of the array
+        void shrink_to_fit();
 
     protected:
         inline void memclear(unsigned int first=0);
@@ -149,6 +171,7 @@ template<class T> class GPUArray
 
     private:
         mutable unsigned int Num_elements;            //!< Number of elements
+        unsigned int Capacity;                        //!< Number of elements that fit in the current allocation
         mutable bool Acquired;                //!< Tracks whether the data has been acquired
         bool RegisterArray;                //!< Tracks whether the data has been acquired
         mutable data_location::Enum Data_location;    //!< Tracks the current location of the data
@@ -168,9 +191,12 @@ template<class T> class GPUArray
         inline void memcpyHostToDevice() const;
 #endif
 
-        inline T* resizeHostArray(unsigned int num_elements);
+        inline T* resizeHostArray(unsigned int capacity);
+
+        inline T* resizeDeviceArray(unsigned int capacity);
 
-        inline T* resizeDeviceArray(unsigned int num_elements);
+        //!Move the data into an allocation of the given capacity
+        inline void reallocate(unsigned int capacity);
 
         //needs to be friends with ArrayHandle for this all to work
         friend class ArrayHandle<T>;
@@ -194,7 +220,7 @@ template<class T> ArrayHandle<T>::~ArrayHandle()
 // GPUArray implementation
 // *****************************************
 template<class T> GPUArray<T>::GPUArray(bool _register) :
-        Num_elements(0), Acquired(false), Data_location(data_location::host), RegisterArray(_register),
+        Num_elements(0), Capacity(0), Acquired(false), Data_location(data_location::host), RegisterArray(_register),
 #ifdef ENABLE_CUDA
         d_data(NULL),
 #endif
@@ -203,7 +229,7 @@ template<class T> GPUArray<T>::GPUArray(bool _register) :
     }
 
 template<class T> GPUArray<T>::GPUArray(unsigned int num_elements, bool _register) :
-        Num_elements(num_elements), Acquired(false), Data_location(data_location::host), RegisterArray(_register),
+        Num_elements(num_elements), Capacity(0), Acquired(false), Data_location(data_location::host), RegisterArray(_register),
 #ifdef ENABLE_CUDA
         d_data(NULL),
 #endif
@@ -219,7 +245,7 @@ template<class T> GPUArray<T>::~GPUArray()
     deallocate();
     }
 
-template<class T> GPUArray<T>::GPUArray(const GPUArray& from) : Num_elements(from.Num_elements), 
+template<class T> GPUArray<T>::GPUArray(const GPUArray& from) : Num_elements(from.Num_elements), Capacity(0),
         Acquired(false), Data_location(data_location::host),
 #ifdef ENABLE_CUDA
         d_data(NULL),
@@ -242,33 +268,79 @@ template<class T> GPUArray<T>& GPUArray<T>::operator=(const GPUArray& rhs)
     {
     if (this != &rhs) // protect against invalid self-assignment
         {
-        // free current memory
-        deallocate();
-
         // is the array registered
         RegisterArray = rhs.RegisterArray;
+        copyFrom(rhs);
+        }
 
-        // copy over basic elements
-        Num_elements = rhs.Num_elements;
-
-        // initialize state variables
-        Data_location = data_location::host;
+    return *this;
+    }
 
-        // allocate and clear new memory the same size as the data in rhs
-        allocate();
-        memclear();
+template<class T> GPUArray<T>::GPUArray(GPUArray&& from) noexcept : Num_elements(from.Num_elements),
+        Capacity(from.Capacity), Acquired(false), RegisterArray(from.RegisterArray), Data_location(from.Data_location),
+#ifdef ENABLE_CUDA
+        d_data(from.d_data),
+#endif
+        h_data(from.h_data)
+    {
+    neverGPU = from.neverGPU;
+    from.Num_elements = 0;
+    from.Capacity = 0;
+    from.Data_location = data_location::host;
+#ifdef ENABLE_CUDA
+    from.d_data = NULL;
+#endif
+    from.h_data = NULL;
+    }
 
-        // copy over the data to the new GPUArray
-        if (Num_elements > 0)
-            {
-            ArrayHandle<T> h_handle(rhs, access_location::host, access_mode::read);
-            memcpy(h_data, h_handle.data, sizeof(T)*Num_elements);
-            }
+template<class T> GPUArray<T>& GPUArray<T>::operator=(GPUArray&& rhs) noexcept
+    {
+    if (this != &rhs)
+        {
+        deallocate();
+        Num_elements = 0;
+        Data_location = data_location::host;
+        swap(rhs);
+        neverGPU = rhs.neverGPU;
         }
-
     return *this;
     }
 
+/*!
+The data is copied wherever it is current: device-to-device if it was last modified on the GPU
+(so that, e.g., handing forces to an integrator does not round-trip through the host), and
+host-to-host otherwise. No memory is allocated unless from is larger than the current capacity.
+*/
+template<class T> void GPUArray<T>::copyFrom(const GPUArray& from)
+    {
+    if (this == &from)
+        return;
+    if (from.Num_elements > Capacity)
+        {
+        // the old contents are about to be overwritten, so don't bother preserving them
+        Num_elements = 0;
+        reallocate(from.Num_elements);
+        }
+    Num_elements = from.Num_elements;
+    if (Num_elements == 0)
+        {
+        Data_location = data_location::host;
+        return;
+        }
+#ifdef ENABLE_CUDA
+    if (from.Data_location == data_location::device && !neverGPU)
+        {
+        ArrayHandle<T> d_handle(from, access_location::device, access_mode::read);
+        cudaMemcpy(d_data, d_handle.data, sizeof(T)*Num_elements, cudaMemcpyDeviceToDevice);
+        Data_location = data_location::device;
+        return;
+        }
+#endif
+    ArrayHandle<T> h_handle(from, access_location::host, access_mode::read);
+    memcpy(h_data, h_handle.data, sizeof(T)*Num_elements);
+    Data_location = data_location::host;
+    }
+
 /*!
     a.swap(b) is:
         GPUArray c(a);
@@ -279,6 +351,7 @@ template<class T> GPUArray<T>& GPUArray<T>::operator=(const GPUArray& rhs)
 template<class T> void GPUArray<T>::swap(GPUArray& from)
     {
     std::swap(Num_elements, from.Num_elements);
+    std::swap(Capacity, from.Capacity);
     std::swap(Acquired, from.Acquired);
     std::swap(Data_location, from.Data_location);
     std::swap(RegisterArray,from.RegisterArray);
@@ -291,11 +364,12 @@ template<class T> void GPUArray<T>::swap(GPUArray& from)
 template<class T> void GPUArray<T>::allocate()
     {
     // don't allocate anything if there are zero elements
+    Capacity = Num_elements;
     if (Num_elements == 0)
         return;
     // allocate host memory
-    // at minimum, alignment needs to be 32 bytes for AVX
-    int retval = posix_memalign((void**)&h_data, 32, Num_elements*sizeof(T));
+    // at minimum, alignment needs to be 32 bytes for AVX; use a full cache line so AVX-512 loads are aligned
+    int retval = posix_memalign((void**)&h_data, 64, Num_elements*sizeof(T));
     if (retval != 0)
         {
         throw std::runtime_error("Error allocating GPUArray.");
@@ -310,8 +384,8 @@ template<class T> void GPUArray<T>::allocate()
 
 template<class T> void GPUArray<T>::deallocate()
     {
-    // don't do anything if there are no elements
-    if (Num_elements == 0)
+    // don't do anything if nothing was allocated
+    if (Capacity == 0)
         return;
     // free memory
 #ifdef ENABLE_CUDA
@@ -327,6 +401,7 @@ template<class T> void GPUArray<T>::deallocate()
 #ifdef ENABLE_CUDA
     d_data = NULL;
 #endif
+    Capacity = 0;
     }
 
 template<class T> void GPUArray<T>::memclear(unsigned int first)
@@ -339,7 +414,8 @@ template<class T> void GPUArray<T>::memclear(unsigned int first)
     memset(h_data+first, 0, sizeof(T)*(Num_elements-first));
 
 #ifdef ENABLE_CUDA
-    cudaMemset(d_data+first, 0, (Num_elements-first)*sizeof(T));
+    if (!neverGPU)
+        cudaMemset(d_data+first, 0, (Num_elements-first)*sizeof(T));
 #endif
     }
 
@@ -483,35 +559,27 @@ template<class T> T* GPUArray<T>::acquire(const access_location::Enum location,
         }
     }
 
-template<class T> T* GPUArray<T>::resizeHostArray(unsigned int num_elements)
+/*!
+Only the first Num_elements elements are moved over; whatever lies beyond them in the new
+allocation is left for resize to clear when it is exposed.
+*/
+template<class T> T* GPUArray<T>::resizeHostArray(unsigned int capacity)
     {
     // allocate resized array
     T *h_tmp = NULL;
 
     // allocate host memory
-    // at minimum, alignment needs to be 32 bytes for AVX
-    int retval = posix_memalign((void**)&h_tmp, 32, num_elements*sizeof(T));
+    // at minimum, alignment needs to be 32 bytes for AVX; use a full cache line so AVX-512 loads are aligned
+    int retval = posix_memalign((void**)&h_tmp, 64, capacity*sizeof(T));
     if (retval != 0)
         {
         throw std::runtime_error("Error allocating GPUArray.");
         }
 
-#ifdef ENABLE_CUDA
-//    if(RegisterArray)
-//        cudaHostRegister(h_tmp,Num_elements*sizeof(T),cudaHostRegisterDefault);
-#endif
-
-    // clear memory
-    memset(h_tmp, 0, sizeof(T)*num_elements);
-
     // copy over data
-    unsigned int num_copy_elements = Num_elements > num_elements ? num_elements : Num_elements;
-    memcpy(h_tmp, h_data, sizeof(T)*num_copy_elements);
-
-#ifdef ENABLE_CUDA
-//    if(RegisterArray)
-//        cudaHostUnregister(h_data);
-#endif
+    unsigned int num_copy_elements = Num_elements > capacity ? capacity : Num_elements;
+    if (num_copy_elements > 0)
+        memcpy(h_tmp, h_data, sizeof(T)*num_copy_elements);
 
     // free old memory location
     free(h_data);
@@ -520,19 +588,17 @@ template<class T> T* GPUArray<T>::resizeHostArray(unsigned int num_elements)
     return h_data;
     }
 
-template<class T> T* GPUArray<T>::resizeDeviceArray(unsigned int num_elements)
+template<class T> T* GPUArray<T>::resizeDeviceArray(unsigned int capacity)
     {
 #ifdef ENABLE_CUDA
     // allocate resized array
     T *d_tmp;
-    cudaMalloc(&d_tmp, num_elements*sizeof(T));
-
-    // clear memory
-    cudaMemset(d_tmp, 0, num_elements*sizeof(T));
+    cudaMalloc(&d_tmp, capacity*sizeof(T));
 
     // copy over data
-    unsigned int num_copy_elements = Num_elements > num_elements ? num_elements : Num_elements;
-    cudaMemcpy(d_tmp, d_data, sizeof(T)*num_copy_elements,cudaMemcpyDeviceToDevice);
+    unsigned int num_copy_elements = Num_elements > capacity ? capacity : Num_elements;
+    if (num_copy_elements > 0)
+        cudaMemcpy(d_tmp, d_data, sizeof(T)*num_copy_elements,cudaMemcpyDeviceToDevice);
 
     // free old memory location
     cudaFree(d_data);
@@ -544,14 +610,49 @@ template<class T> T* GPUArray<T>::resizeDeviceArray(unsigned int num_elements)
 #endif
     }
 
-template<class T> void GPUArray<T>::resize(unsigned int num_elements)
+template<class T> void GPUArray<T>::reallocate(unsigned int capacity)
     {
-    resizeHostArray(num_elements);
+    if (capacity == 0)
+        {
+        deallocate();
+        return;
+        }
 #ifdef ENABLE_CUDA
     if (!neverGPU)
-        resizeDeviceArray(num_elements);
+        resizeDeviceArray(capacity);
 #endif
+    resizeHostArray(capacity);
+    Capacity = capacity;
+    }
+
+/*!
+Shrinking only changes the size. Growing within the capacity clears the newly exposed elements;
+growing beyond it reallocates to at least 1.5 times the old capacity, so a sequence of small
+resizes costs amortized O(1) per added element.
+*/
+template<class T> void GPUArray<T>::resize(unsigned int num_elements)
+    {
+    if (num_elements > Capacity)
+        {
+        unsigned int grown = Capacity + Capacity/2;
+        reallocate(num_elements > grown ? num_elements : grown);
+        }
+    unsigned int oldSize = Num_elements;
     Num_elements = num_elements;
+    if (num_elements > oldSize)
+        memclear(oldSize);
+    }
+
+template<class T> void GPUArray<T>::reserve(unsigned int num_elements)
+    {
+    if (num_elements > Capacity)
+        reallocate(num_elements);
+    }
+
+template<class T> void GPUArray<T>::shrink_to_fit()
+    {
+    if (Capacity > Num_elements)
+        reallocate(Num_elements);
     }
 
 #endif
@@ -37,8 +37,8 @@ double noiseSource::getRealNormal(double mean, double std)
 /*!
 \param globalSeed the global seed to use
 \param offset the value of the offset that should be sent to the cuda RNG...
-This is one part of what would be required to support reproducibly being able to load a state
-from a databse and continue the dynamics in the same way every time. This is not currently supported.
+Continuing the same random stream after a restart is done by checkpointing the generator states
+(see writeCheckpoint), not by re-initializing them.
 */
 void noiseSource::initializeGPURNGs(int globalSeed,int tempSeed)
     {
@@ -67,3 +67,35 @@ void noiseSource::setReproducibleSeed(int _seed)
 #endif
     };
 
+
+/*!
+The Mersenne twisters are stored in their standard text representation, and the curand states as raw
+bytes, so that a restored noiseSource continues exactly the same streams
+*/
+void noiseSource::writeCheckpoint(checkpointWriter &out, const string &name)
+    {
+    out.addValue(name+"/Reproducible",Reproducible);
+    out.addValue(name+"/RNGSeed",RNGSeed);
+    out.addValue(name+"/N",N);
+    stringstream reproducibleState, randomState;
+    reproducibleState << gen;
+    randomState << genrd;
+    out.addString(name+"/gen",reproducibleState.str());
+    out.addString(name+"/genrd",randomState.str());
+    out.addArray(name+"/RNGs",RNGs);
+    };
+
+void noiseSource::readCheckpoint(checkpointReader &in, const string &name)
+    {
+    in.readValue(name+"/Reproducible",Reproducible);
+    in.readValue(name+"/RNGSeed",RNGSeed);
+    in.readValue(name+"/N",N);
+    string state;
+    in.readString(name+"/gen",state);
+    stringstream reproducibleState(state);
+    reproducibleState >> gen;
+    in.readString(name+"/genrd",state);
+    stringstream randomState(state);
+    randomState >> genrd;
+    in.readArray(name+"/RNGs",RNGs);
+    };
@@ -5,6 +5,7 @@
 #include "curand_kernel.h"
 #include "std_include.h"
 #include "gpuarray.h"
+#include "checkpointFile.h"
 #include "noiseSource.cuh"
 
 /*! \file noiseSource.h */
@@ -70,6 +71,11 @@ class noiseSource
         //!allow for whatever GPU RNG initialization is needed
         void initializeGPURNGs(int globalSeed=1337, int tempSeed=0);
 
+        //!Add the state of the CPU and GPU generators to a checkpoint, as records starting with name
+        void writeCheckpoint(checkpointWriter &out, const string &name);
+        //!Restore the state of the CPU and GPU generators from a checkpoint
+        void readCheckpoint(checkpointReader &in, const string &name);
+
         //!An array random-number-generators for use on the GPU branch of the code
         GPUArray<curandState> RNGs;
     };
@@ -21,6 +21,12 @@ stores the result in disp. Also
 Box.putInBoxReal(&point), which will take the point and put it back in the primary unit cell.
 Please note that while the periodicBoundaries class can handle generic 2D periodic domains, many of the other classes
 that interface with it do not yet have this functionality implemented.
+
+minDist, putInBoxReal and move also come in versions templated on the shape of the box,
+Box.minDist<rectangular>(vecA,vecB,&disp), which skip the runtime test of isBoxSquare(). Kernels that call
+them in their inner loops are templated in the same way and dispatch on isBoxSquare() once per call, so
+that the rectangular case compiles to a handful of multiplies, fused multiply-adds and roundings. The
+template argument must agree with isBoxSquare().
 */
 struct periodicBoundaries
     {
@@ -38,6 +44,8 @@ struct periodicBoundaries
         //!Get the inverse of the box transformation matrix
         HOSTDEVICE void getBoxInvDims(double &xx, double &xy, double &yx, double &yy)
             {xx=xi11;xy=xi12;yx=xi21;yy=xi22;};
+        //!Get the distances between opposite sides of the unit cell
+        HOSTDEVICE void getBoxHeights(double &hx, double &hy);
 
         //!Set the box to some new rectangular specification
         HOSTDEVICE void setSquare(double x, double y);
@@ -54,6 +62,26 @@ struct periodicBoundaries
         HOSTDEVICE void minDist(const double2 &p1, const double2 &p2, double2 &pans);
         //!Move p1 by the amount disp, then put it in the box
         HOSTDEVICE void move(double2 &p1, const double2 &disp);
+        //!Put the point back in the unit cell, adding the number of box vectors removed to image
+        HOSTDEVICE void putInBoxReal(double2 &p1, int2 &image);
+        //!The unwrapped position of a point in the unit cell that has crossed the boundaries "image" times
+        HOSTDEVICE void unwrap(const double2 &p1, const int2 &image, double2 &pans);
+
+        //!Calculate the minimum distance between two points in a box known to be rectangular (or not) at compile time
+        template<bool rectangular> HOSTDEVICE void minDist(const double2 &p1, const double2 &p2, double2 &pans);
+        //!Put the point back in the unit cell of a box known to be rectangular (or not) at compile time
+        template<bool rectangular> HOSTDEVICE void putInBoxReal(double2 &p1);
+        //!Move p1 by disp and put it back in the unit cell of a box known to be rectangular (or not) at compile time
+        template<bool rectangular> HOSTDEVICE void move(double2 &p1, const double2 &disp);
+        //!As putInBoxReal<rectangular>, also updating the periodic image counter
+        template<bool rectangular> HOSTDEVICE void putInBoxReal(double2 &p1, int2 &image);
+
+        //!Put every point in an array back in the unit cell (host only; written so the loop vectorizes)
+        inline void putInBoxReal(double2 *points, int N);
+        //!Move every point in an array by scale*disp, then put it in the box (host only; vectorized)
+        inline void move(double2 *points, const double2 *disp, int N, double scale = 1.0);
+        //!As above, also updating the periodic image counter of every point
+        inline void move(double2 *points, const double2 *disp, int2 *images, int N, double scale = 1.0);
 
         HOSTDEVICE void operator=(periodicBoundaries &other)
             {
@@ -70,6 +98,8 @@ struct periodicBoundaries
         bool isSquare;
 
         HOSTDEVICE void putInBox(double2 &vp);
+        //!floor(x), computed on the host in a way that loops calling it can be vectorized
+        HOSTDEVICE double wrapFloor(double x);
     };
 
 void periodicBoundaries::setSquare(double x, double y)
@@ -100,6 +130,26 @@ void periodicBoundaries::setGeneral(double a, double b,double c, double d)
     isSquare = false;
     };
 
+/*!
+hx is the distance between the two sides of the unit cell along the second box vector (i.e., the width of
+the cell measured across the first fractional coordinate), and hy the distance between the sides along the
+first box vector. Two points closer than half of the smaller height are each other's minimum image, and
+minDist finds the right periodic image of any displacement shorter than that
+*/
+void periodicBoundaries::getBoxHeights(double &hx, double &hy)
+    {
+    if(isSquare)
+        {
+        hx = x11;
+        hy = x22;
+        }
+    else
+        {
+        hx = 1.0/sqrt(xi11*xi11+xi12*xi12);
+        hy = 1.0/sqrt(xi21*xi21+xi22*xi22);
+        };
+    };
+
 void periodicBoundaries::Trans(const double2 &p1, double2 &pans)
     {
     if(isSquare)
@@ -130,62 +180,245 @@ void periodicBoundaries::invTrans(const double2 p1, double2 &pans)
 
 void periodicBoundaries::putInBoxReal(double2 &p1)
     {//assume real space entries. Puts it back in box
-    double2 vP;
-    invTrans(p1,vP);
-    putInBox(vP);
-    Trans(vP,p1);
+    if(isSquare)
+        putInBoxReal<true>(p1);
+    else
+        putInBoxReal<false>(p1);
+    };
+
+/*!
+gcc does not vectorize calls to floor under the build flags (-frounding-math, and the default
+-ftrapping-math), which kept the simd loops below scalar. On the host the floor is instead computed from
+a truncation, which is a vectorizable conversion, and a comparison; this is exact for |x| < 2^63
+*/
+double periodicBoundaries::wrapFloor(double x)
+    {
+#ifdef __CUDA_ARCH__
+    return floor(x);
+#else
+    double truncated = (double)(long long)x;
+    return (truncated > x) ? truncated - 1.0 : truncated;
+#endif
     };
 
+/*!
+Branch-free (so that loops calling it can be vectorized). The final comparison catches the case
+where a tiny negative coordinate rounds up to exactly 1.0
+*/
 void periodicBoundaries::putInBox(double2 &vp)
     {//acts on points in the virtual space
-    while(vp.x < 0) vp.x +=1.0;
-    while(vp.y < 0) vp.y +=1.0;
-
-    while(vp.x>=1.0)
-        {
-        vp.x -= 1.0;
-        };
-    while(vp.y>=1.)
-        {
-        vp.y -= 1.;
-        };
+    vp.x -= wrapFloor(vp.x);
+    vp.y -= wrapFloor(vp.y);
+    vp.x = (vp.x >= 1.0) ? vp.x - 1.0 : vp.x;
+    vp.y = (vp.y >= 1.0) ? vp.y - 1.0 : vp.y;
     };
 
 void periodicBoundaries::minDist(const double2 &p1, const double2 &p2, double2 &pans)
     {
     if (isSquare)
+        minDist<true>(p1,p2,pans);
+    else
+        minDist<false>(p1,p2,pans);
+    };
+
+void periodicBoundaries::move(double2 &p1, const double2 &disp)
+    {//assume real space entries. Moves p1 by disp, and puts it back in box
+    if(isSquare)
+        move<true>(p1,disp);
+    else
+        move<false>(p1,disp);
+    };
+
+/*!
+The image counter convention is that the unwrapped position is p1 + Trans(image), so a point that
+leaves through the right edge of the box has image.x incremented by one
+*/
+void periodicBoundaries::putInBoxReal(double2 &p1, int2 &image)
+    {
+    if(isSquare)
+        putInBoxReal<true>(p1,image);
+    else
+        putInBoxReal<false>(p1,image);
+    };
+
+void periodicBoundaries::unwrap(const double2 &p1, const int2 &image, double2 &pans)
+    {
+    double2 shift;
+    Trans(make_double2((double)image.x,(double)image.y),shift);
+    pans.x = p1.x + shift.x;
+    pans.y = p1.y + shift.y;
+    };
+
+/*!
+In a rectangular box each component is a subtraction, a multiply and a fused multiply-add with a
+rounding in between; the general case goes through the fractional coordinates
+*/
+template<bool rectangular>
+void periodicBoundaries::minDist(const double2 &p1, const double2 &p2, double2 &pans)
+    {
+    if(rectangular)
         {
         pans.x = p1.x-p2.x;
-        pans.y = p1.y-p2.y;;
-        while(pans.x < -halfx11) pans.x += x11;
-        while(pans.y < -halfx22) pans.y += x22;
-        while(pans.x > halfx11) pans.x -= x11;
-        while(pans.y > halfx22) pans.y -= x22;
+        pans.y = p1.y-p2.y;
+        pans.x -= x11*rint(pans.x*xi11);
+        pans.y -= x22*rint(pans.y*xi22);
         }
     else
         {
-        double2 vA,vB;
-        invTrans(p1,vA);
-        invTrans(p2,vB);
-        double2 disp= make_double2(vA.x-vB.x,vA.y-vB.y);
-
-        while(disp.x < -0.5) disp.x +=1.0;
-        while(disp.y < -0.5) disp.y +=1.0;
-        while(disp.x > 0.5) disp.x -=1.0;
-        while(disp.y > 0.5) disp.y -=1.0;
+        double2 disp;
+        disp.x = (xi11*p1.x + xi12*p1.y) - (xi11*p2.x + xi12*p2.y);
+        disp.y = (xi21*p1.x + xi22*p1.y) - (xi21*p2.x + xi22*p2.y);
+        disp.x -= rint(disp.x);
+        disp.y -= rint(disp.y);
+        pans.x = x11*disp.x + x12*disp.y;
+        pans.y = x21*disp.x + x22*disp.y;
+        };
+    };
 
-        Trans(disp,pans);
+/*!
+The rectangular case works directly in real space: a multiply, a floor, a fused multiply-add and two
+selects (to catch round-off at the box edges) per component
+*/
+template<bool rectangular>
+void periodicBoundaries::putInBoxReal(double2 &p1)
+    {
+    if(rectangular)
+        {
+        double x = p1.x - x11*wrapFloor(p1.x*xi11);
+        double y = p1.y - x22*wrapFloor(p1.y*xi22);
+        x = (x < 0.0) ? x + x11 : x;
+        y = (y < 0.0) ? y + x22 : y;
+        p1.x = (x >= x11) ? x - x11 : x;
+        p1.y = (y >= x22) ? y - x22 : y;
+        }
+    else
+        {
+        double2 vP;
+        vP.x = xi11*p1.x + xi12*p1.y;
+        vP.y = xi21*p1.x + xi22*p1.y;
+        putInBox(vP);
+        p1.x = x11*vP.x + x12*vP.y;
+        p1.y = x21*vP.x + x22*vP.y;
         };
     };
 
+template<bool rectangular>
 void periodicBoundaries::move(double2 &p1, const double2 &disp)
-    {//assume real space entries. Moves p1 by disp, and puts it back in box
-    double2 vP;
+    {
     p1.x = p1.x+disp.x;
     p1.y = p1.y+disp.y;
-    invTrans(p1,vP);
-    putInBox(vP);
-    Trans(vP,p1);
+    putInBoxReal<rectangular>(p1);
+    };
+
+template<bool rectangular>
+void periodicBoundaries::putInBoxReal(double2 &p1, int2 &image)
+    {
+    double2 vP;
+    double fx,fy;
+    if(rectangular)
+        {
+        fx = wrapFloor(p1.x*xi11);
+        fy = wrapFloor(p1.y*xi22);
+        vP.x = p1.x - x11*fx;
+        vP.y = p1.y - x22*fy;
+        fx = (vP.x < 0.0) ? fx - 1.0 : fx;
+        fy = (vP.y < 0.0) ? fy - 1.0 : fy;
+        vP.x = (vP.x < 0.0) ? vP.x + x11 : vP.x;
+        vP.y = (vP.y < 0.0) ? vP.y + x22 : vP.y;
+        fx = (vP.x >= x11) ? fx + 1.0 : fx;
+        fy = (vP.y >= x22) ? fy + 1.0 : fy;
+        p1.x = (vP.x >= x11) ? vP.x - x11 : vP.x;
+        p1.y = (vP.y >= x22) ? vP.y - x22 : vP.y;
+        }
+    else
+        {
+        vP.x = xi11*p1.x + xi12*p1.y;
+        vP.y = xi21*p1.x + xi22*p1.y;
+        fx = wrapFloor(vP.x);
+        fy = wrapFloor(vP.y);
+        vP.x -= fx;
+        vP.y -= fy;
+        fx = (vP.x >= 1.0) ? fx + 1.0 : fx;
+        fy = (vP.y >= 1.0) ? fy + 1.0 : fy;
+        vP.x = (vP.x >= 1.0) ? vP.x - 1.0 : vP.x;
+        vP.y = (vP.y >= 1.0) ? vP.y - 1.0 : vP.y;
+        p1.x = x11*vP.x + x12*vP.y;
+        p1.y = x21*vP.x + x22*vP.y;
+        };
+    image.x += (int)fx;
+    image.y += (int)fy;
+    };
+
+/*!
+The box shape is tested once, outside of the loop, and the loop bodies are the (inlined)
+compile-time specializations above
+*/
+void periodicBoundaries::move(double2 *points, const double2 *disp, int N, double scale)
+    {
+    if(isSquare)
+        {
+        #pragma omp simd
+        for (int ii = 0; ii < N; ++ii)
+            {
+            points[ii].x += scale*disp[ii].x;
+            points[ii].y += scale*disp[ii].y;
+            putInBoxReal<true>(points[ii]);
+            };
+        }
+    else
+        {
+        #pragma omp simd
+        for (int ii = 0; ii < N; ++ii)
+            {
+            points[ii].x += scale*disp[ii].x;
+            points[ii].y += scale*disp[ii].y;
+            putInBoxReal<false>(points[ii]);
+            };
+        };
+    };
+
+/*!
+Identical to the function above, but the number of box vectors removed from each point is also
+accumulated in its image counter
+*/
+void periodicBoundaries::move(double2 *points, const double2 *disp, int2 *images, int N, double scale)
+    {
+    if(isSquare)
+        {
+        #pragma omp simd
+        for (int ii = 0; ii < N; ++ii)
+            {
+            points[ii].x += scale*disp[ii].x;
+            points[ii].y += scale*disp[ii].y;
+            putInBoxReal<true>(points[ii],images[ii]);
+            };
+        }
+    else
+        {
+        #pragma omp simd
+        for (int ii = 0; ii < N; ++ii)
+            {
+            points[ii].x += scale*disp[ii].x;
+            points[ii].y += scale*disp[ii].y;
+            putInBoxReal<false>(points[ii],images[ii]);
+            };
+        };
+    };
+
+void periodicBoundaries::putInBoxReal(double2 *points, int N)
+    {
+    if(isSquare)
+        {
+        #pragma omp simd
+        for (int ii = 0; ii < N; ++ii)
+            putInBoxReal<true>(points[ii]);
+        }
+    else
+        {
+        #pragma omp simd
+        for (int ii = 0; ii < N; ++ii)
+            putInBoxReal<false>(points[ii]);
+        };
     };
 
 typedef shared_ptr<periodicBoundaries> PeriodicBoxPtr;
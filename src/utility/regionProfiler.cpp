@@ -0,0 +1,191 @@
+#include "regionProfiler.h"
+#include <cstdio>
+#include <algorithm>
+#include <stdexcept>
+
+/*! \file regionProfiler.cpp */
+
+bool regionProfiler::enabled = true;
+int regionProfiler::traceCapacity = 1 << 18;
+chrono::steady_clock::time_point regionProfiler::origin = chrono::steady_clock::now();
+int regionProfiler::numberOfRegions = 0;
+const char *regionProfiler::names[regionProfiler::maximumRegions];
+vector<unique_ptr<regionThreadBuffer> > regionProfiler::buffers;
+mutex regionProfiler::registrationMutex;
+
+/*!
+Called once per PROFILE_SCOPE (the result is kept in a static), so the cost of the lock is irrelevant.
+Registering the same name twice gives two regions that happen to share a name; the summaries keep
+them apart
+*/
+int regionProfiler::registerRegion(const char *name)
+    {
+    lock_guard<mutex> lock(registrationMutex);
+    if(numberOfRegions == maximumRegions)
+        {
+        printf("regionProfiler: more than %i regions were registered\n",maximumRegions);
+        throw std::exception();
+        };
+    names[numberOfRegions] = name;
+    numberOfRegions += 1;
+    return numberOfRegions-1;
+    };
+
+/*!
+The statistics are sized for every possible region, and the trace reserved to its full capacity, so
+that nothing is allocated while regions are being timed
+*/
+regionThreadBuffer *regionProfiler::createThreadBuffer()
+    {
+    lock_guard<mutex> lock(registrationMutex);
+    unique_ptr<regionThreadBuffer> buffer(new regionThreadBuffer);
+    buffer->threadIndex = buffers.size();
+    buffer->stack.resize(maximumDepth);
+    buffer->statistics.resize(maximumRegions);
+    buffer->events.reserve(traceCapacity);
+    buffers.push_back(std::move(buffer));
+    return buffers.back().get();
+    };
+
+void regionProfiler::reset()
+    {
+    lock_guard<mutex> lock(registrationMutex);
+    for (size_t tt = 0; tt < buffers.size(); ++tt)
+        {
+        std::fill(buffers[tt]->statistics.begin(),buffers[tt]->statistics.end(),regionStatistics());
+        buffers[tt]->events.clear();
+        buffers[tt]->droppedEvents = 0;
+        };
+    origin = chrono::steady_clock::now();
+    };
+
+vector<string> regionProfiler::regionNames()
+    {
+    lock_guard<mutex> lock(registrationMutex);
+    vector<string> result(numberOfRegions);
+    for (int rr = 0; rr < numberOfRegions; ++rr)
+        result[rr] = names[rr];
+    return result;
+    };
+
+/*!
+Calls and times are summed over threads, and the extrema are taken over all of them. The parent of a
+region is the one recorded by the first thread (in order of creation) that completed a call of it
+*/
+vector<regionStatistics> regionProfiler::aggregatedStatistics()
+    {
+    lock_guard<mutex> lock(registrationMutex);
+    vector<regionStatistics> result(numberOfRegions);
+    for (size_t tt = 0; tt < buffers.size(); ++tt)
+        for (int rr = 0; rr < numberOfRegions; ++rr)
+            {
+            const regionStatistics &stats = buffers[tt]->statistics[rr];
+            if(stats.calls == 0)
+                continue;
+            regionStatistics &total = result[rr];
+            if(total.calls == 0)
+                {
+                total.parent = stats.parent;
+                total.minimum = stats.minimum;
+                total.maximum = stats.maximum;
+                };
+            total.calls += stats.calls;
+            total.total += stats.total;
+            total.self += stats.self;
+            total.minimum = min(total.minimum,stats.minimum);
+            total.maximum = max(total.maximum,stats.maximum);
+            };
+    return result;
+    };
+
+//!Append the called regions below parent to order, depth first, each group sorted by total time
+static void regionTree(const vector<regionStatistics> &stats, int parent, int depth,
+                       vector<pair<int,int> > &order)
+    {
+    vector<int> children;
+    for (int rr = 0; rr < (int)stats.size(); ++rr)
+        if(stats[rr].calls > 0 && stats[rr].parent == parent && rr != parent)
+            children.push_back(rr);
+    sort(children.begin(),children.end(),[&](int a, int b){return stats[a].total > stats[b].total;});
+    for (size_t cc = 0; cc < children.size(); ++cc)
+        {
+        order.push_back(make_pair(children[cc],depth));
+        //parents recorded by different threads can form a cycle; the depth bound ends the descent
+        if(depth < regionProfiler::maximumDepth)
+            regionTree(stats,children[cc],depth+1,order);
+        };
+    };
+
+void regionProfiler::printSummary()
+    {
+    vector<regionStatistics> stats = aggregatedStatistics();
+    vector<string> regions = regionNames();
+    vector<pair<int,int> > order;
+    regionTree(stats,-1,0,order);
+    printf("%-60s %10s %12s %12s %12s %12s %12s\n","region","calls","total (s)","self (s)","mean (s)","min (s)","max (s)");
+    for (size_t ii = 0; ii < order.size(); ++ii)
+        {
+        const regionStatistics &s = stats[order[ii].first];
+        string name = string(2*order[ii].second,' ') + regions[order[ii].first];
+        printf("%-60s %10lld %12.4e %12.4e %12.4e %12.4e %12.4e\n",name.c_str(),s.calls,1e-9*s.total,1e-9*s.self,
+               1e-9*s.total/s.calls,1e-9*s.minimum,1e-9*s.maximum);
+        };
+    long long dropped = 0;
+    for (size_t tt = 0; tt < buffers.size(); ++tt)
+        dropped += buffers[tt]->droppedEvents;
+    if(dropped > 0)
+        printf("%lld calls were not stored in the trace (see regionProfiler::setTraceCapacity)\n",dropped);
+    };
+
+void regionProfiler::writeSummary(const string &fileName)
+    {
+    FILE *output = fopen(fileName.c_str(),"w");
+    if(output == NULL)
+        {
+        printf("could not open %s for writing\n",fileName.c_str());
+        throw std::exception();
+        };
+    vector<regionStatistics> stats = aggregatedStatistics();
+    vector<string> regions = regionNames();
+    vector<pair<int,int> > order;
+    regionTree(stats,-1,0,order);
+    fprintf(output,"region,parent,depth,calls,total_s,self_s,mean_s,min_s,max_s\n");
+    for (size_t ii = 0; ii < order.size(); ++ii)
+        {
+        const regionStatistics &s = stats[order[ii].first];
+        fprintf(output,"\"%s\",\"%s\",%i,%lld,%.9e,%.9e,%.9e,%.9e,%.9e\n",regions[order[ii].first].c_str(),
+                s.parent >= 0 ? regions[s.parent].c_str() : "",order[ii].second,s.calls,1e-9*s.total,1e-9*s.self,
+                1e-9*s.total/s.calls,1e-9*s.minimum,1e-9*s.maximum);
+        };
+    fclose(output);
+    };
+
+/*!
+Every stored call becomes a complete ("X") event on the track of the thread that made it, with times in
+microseconds since the profiler's origin
+*/
+void regionProfiler::writeChromeTrace(const string &fileName)
+    {
+    FILE *output = fopen(fileName.c_str(),"w");
+    if(output == NULL)
+        {
+        printf("could not open %s for writing\n",fileName.c_str());
+        throw std::exception();
+        };
+    vector<string> regions = regionNames();
+    lock_guard<mutex> lock(registrationMutex);
+    fprintf(output,"{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n");
+    bool first = true;
+    for (int tt = 0; tt < (int)buffers.size(); ++tt)
+        {
+        fprintf(output,"%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %i, \"args\": {\"name\": \"thread %i\"}}",
+                first ? "" : ",\n",tt,tt);
+        first = false;
+        const vector<regionEvent> &events = buffers[tt]->events;
+        for (size_t ee = 0; ee < events.size(); ++ee)
+            fprintf(output,",\n{\"name\": \"%s\", \"cat\": \"cellGPU\", \"ph\": \"X\", \"pid\": 1, \"tid\": %i, \"ts\": %.3f, \"dur\": %.3f}",
+                    regions[events[ee].region].c_str(),tt,1e-3*events[ee].start,1e-3*events[ee].duration);
+        };
+    fprintf(output,"\n]}\n");
+    fclose(output);
+    };
@@ -0,0 +1,222 @@
+#ifndef regionProfiler_H
+#define regionProfiler_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+using namespace std;
+
+/*! \file regionProfiler.h */
+
+//!The statistics of one region, as accumulated by one thread
+struct regionStatistics
+    {
+    //!The number of completed calls
+    long long calls = 0;
+    //!The total time spent in the region, in nanoseconds
+    long long total = 0;
+    //!The time spent in the region but not in any region nested inside of it
+    long long self = 0;
+    long long minimum = 0;
+    long long maximum = 0;
+    //!The region that enclosed the first call of this one (-1 for top-level regions)
+    int parent = -1;
+    };
+
+//!One completed call of a region, as stored for the trace
+struct regionEvent
+    {
+    int region;
+    int depth;
+    //!Start time, in nanoseconds since the profiler's origin
+    long long start;
+    long long duration;
+    };
+
+//!The per-thread state of the profiler: a stack of open regions, statistics, and a preallocated trace
+struct regionThreadBuffer
+    {
+    struct openRegion
+        {
+        int region;
+        long long start;
+        long long childTime;
+        };
+    int threadIndex;
+    int depth = 0;
+    //!open regions deeper than the stack are counted but not timed
+    int overflow = 0;
+    vector<openRegion> stack;
+    vector<regionStatistics> statistics;
+    vector<regionEvent> events;
+    //!The number of events that did not fit in the trace buffer
+    long long droppedEvents = 0;
+    };
+
+//!A low-overhead, hierarchical profiler of named code regions
+/*!
+Regions are marked with the PROFILE_SCOPE macro, which times the enclosing scope:
+\code
+void voronoiModelBase::enforceTopology()
+    {
+    PROFILE_SCOPE("voronoiModelBase::enforceTopology");
+    ...
+    }
+\endcode
+Each use of the macro registers its name once, the first time it is executed, and from then on refers
+to the region only through an integer id held in a function-local static: there are no string
+comparisons or map lookups per call. Every thread that enters a region gets its own buffer -- a stack
+of open regions, per-region statistics, and a trace of completed calls whose capacity is reserved when
+the buffer is created -- so recording a call takes two clock reads and never allocates or locks.
+Regions nest: the statistics hold both the inclusive time of a region and its "self" time (excluding
+nested regions), and the aggregated table is printed as a tree.
+
+Unless cellGPU is configured with -DPROFILING=ON (which defines ENABLE_PROFILING), PROFILE_SCOPE
+expands to nothing and instrumented code is exactly as fast as uninstrumented code. When compiled in,
+profiling is on from the start of the program and can be paused with setEnabled(false).
+
+Times are host wall-clock times; GPU kernels are launched asynchronously, so on the GPU a region only
+includes the kernels it waits for (e.g. through ArrayHandles on the host). The reporting functions
+(printSummary, writeSummary, writeChromeTrace) and reset should be called from serial code, while no
+region is open on another thread.
+*/
+class regionProfiler
+    {
+    public:
+        //!The largest number of distinct regions
+        static const int maximumRegions = 512;
+        //!The deepest nesting of regions that is timed
+        static const int maximumDepth = 64;
+
+        //!Register a region name (a string literal, or any string that outlives the profiler), returning its id
+        static int registerRegion(const char *name);
+        //!Open a region on the calling thread (every begin must be paired with an end; PROFILE_SCOPE does this)
+        static void begin(int region)
+            {
+            regionThreadBuffer *buffer = threadBuffer();
+            if(buffer->depth == maximumDepth)
+                {
+                buffer->overflow += 1;
+                return;
+                };
+            regionThreadBuffer::openRegion &open = buffer->stack[buffer->depth];
+            open.region = region;
+            open.childTime = 0;
+            buffer->depth += 1;
+            open.start = now();
+            };
+        //!Close the innermost region open on the calling thread
+        static void end()
+            {
+            long long endTime = now();
+            regionThreadBuffer *buffer = threadBuffer();
+            if(buffer->overflow > 0)
+                {
+                buffer->overflow -= 1;
+                return;
+                };
+            if(buffer->depth == 0)
+                return;
+            buffer->depth -= 1;
+            regionThreadBuffer::openRegion &open = buffer->stack[buffer->depth];
+            long long duration = endTime - open.start;
+            regionStatistics &stats = buffer->statistics[open.region];
+            if(stats.calls == 0)
+                {
+                stats.parent = (buffer->depth > 0) ? buffer->stack[buffer->depth-1].region : -1;
+                stats.minimum = duration;
+                stats.maximum = duration;
+                };
+            stats.calls += 1;
+            stats.total += duration;
+            stats.self += duration - open.childTime;
+            if(duration < stats.minimum) stats.minimum = duration;
+            if(duration > stats.maximum) stats.maximum = duration;
+            if(buffer->depth > 0)
+                buffer->stack[buffer->depth-1].childTime += duration;
+
+            if(buffer->events.size() < buffer->events.capacity())
+                buffer->events.push_back({open.region,buffer->depth,open.start,duration});
+            else
+                buffer->droppedEvents += 1;
+            };
+
+        //!Pause or resume recording (regions that are open when recording is paused are still closed correctly)
+        static void setEnabled(bool _enabled){enabled = _enabled;};
+        static bool isEnabled(){return enabled;};
+        //!Set the number of trace events each thread can hold; applies to threads that have not yet entered a region
+        static void setTraceCapacity(int events){traceCapacity = events;};
+        //!Discard all statistics and trace events, and restart the clock
+        static void reset();
+
+        //!Print the per-region statistics, summed over threads, as an indented tree
+        static void printSummary();
+        //!Write the per-region statistics as a CSV table
+        static void writeSummary(const string &fileName);
+        //!Write the trace in the Chrome trace event format (readable by chrome://tracing and Perfetto)
+        static void writeChromeTrace(const string &fileName);
+        //!The statistics of every region, summed over threads
+        static vector<regionStatistics> aggregatedStatistics();
+        //!The names of the registered regions, indexed by region id
+        static vector<string> regionNames();
+
+    protected:
+        //!Nanoseconds since the profiler's origin
+        static long long now()
+            {
+            return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now()-origin).count();
+            };
+        //!The calling thread's buffer, created on first use
+        static regionThreadBuffer *threadBuffer()
+            {
+            static thread_local regionThreadBuffer *buffer = nullptr;
+            if(buffer == nullptr)
+                buffer = createThreadBuffer();
+            return buffer;
+            };
+        static regionThreadBuffer *createThreadBuffer();
+
+        static bool enabled;
+        static int traceCapacity;
+        static chrono::steady_clock::time_point origin;
+        static int numberOfRegions;
+        static const char *names[maximumRegions];
+        static vector<unique_ptr<regionThreadBuffer> > buffers;
+        static mutex registrationMutex;
+    };
+
+//!Times the scope it is declared in as one call of a region
+class profileScope
+    {
+    public:
+        profileScope(int region)
+            {
+            active = regionProfiler::isEnabled();
+            if(active)
+                regionProfiler::begin(region);
+            };
+        ~profileScope()
+            {
+            if(active)
+                regionProfiler::end();
+            };
+        profileScope(const profileScope &other) = delete;
+        profileScope &operator=(const profileScope &other) = delete;
+    protected:
+        bool active;
+    };
+
+#define PROFILE_CONCATENATE_IMPLEMENTATION(a,b) a##b
+#define PROFILE_CONCATENATE(a,b) PROFILE_CONCATENATE_IMPLEMENTATION(a,b)
+#ifdef ENABLE_PROFILING
+//!Time the enclosing scope as a region with the given name
+#define PROFILE_SCOPE(name) \
+    static const int PROFILE_CONCATENATE(profileRegion,__LINE__) = regionProfiler::registerRegion(name); \
+    profileScope PROFILE_CONCATENATE(profileScope,__LINE__)(PROFILE_CONCATENATE(profileRegion,__LINE__))
+#else
+#define PROFILE_SCOPE(name)
+#endif
+
+#endif
@@ -0,0 +1,198 @@
+#include "runtimeMetrics.h"
+#include <cstdio>
+#include <stdexcept>
+
+/*! \file runtimeMetrics.cpp */
+
+int runtimeMetrics::find(const string &name, kind k)
+    {
+    unordered_map<string,pair<int,int> >::iterator it = index.find(name);
+    if(it == index.end())
+        return -1;
+    if(it->second.first != k)
+        {
+        printf("runtimeMetrics: the metric %s was already registered as a different kind\n",name.c_str());
+        throw std::exception();
+        };
+    return it->second.second;
+    };
+
+int runtimeMetrics::registerCounter(const string &name)
+    {
+    int id = find(name,counterKind);
+    if(id >= 0)
+        return id;
+    counters.push_back(counterData());
+    counters.back().name = name;
+    id = counters.size()-1;
+    index[name] = make_pair((int)counterKind,id);
+    return id;
+    };
+
+int runtimeMetrics::registerGauge(const string &name)
+    {
+    int id = find(name,gaugeKind);
+    if(id >= 0)
+        return id;
+    gauges.push_back(gaugeData());
+    gauges.back().name = name;
+    id = gauges.size()-1;
+    index[name] = make_pair((int)gaugeKind,id);
+    return id;
+    };
+
+/*!
+A histogram registered again under the same name keeps its original edges
+*/
+int runtimeMetrics::registerHistogram(const string &name, const vector<double> &edges)
+    {
+    int id = find(name,histogramKind);
+    if(id >= 0)
+        return id;
+    if(!is_sorted(edges.begin(),edges.end()))
+        {
+        printf("runtimeMetrics: the bin edges of histogram %s must be sorted\n",name.c_str());
+        throw std::exception();
+        };
+    histograms.push_back(histogramData());
+    histogramData &h = histograms.back();
+    h.name = name;
+    h.edges = edges;
+    h.counts.resize(edges.size()+1,0);
+    h.atSnapshot.resize(edges.size()+1,0);
+    id = histograms.size()-1;
+    index[name] = make_pair((int)histogramKind,id);
+    return id;
+    };
+
+vector<double> runtimeMetrics::powerOfTwoEdges(double maximum)
+    {
+    vector<double> edges(1,0.0);
+    for (double edge = 1.0; edge <= 2.0*maximum; edge *= 2.0)
+        edges.push_back(edge);
+    return edges;
+    };
+
+void runtimeMetrics::endStep()
+    {
+    for (size_t cc = 0; cc < counters.size(); ++cc)
+        {
+        counters[cc].lastStep = counters[cc].total - counters[cc].atStepStart;
+        counters[cc].atStepStart = counters[cc].total;
+        };
+    steps += 1;
+    };
+
+void runtimeMetrics::reset()
+    {
+    for (size_t cc = 0; cc < counters.size(); ++cc)
+        counters[cc] = counterData{counters[cc].name};
+    for (size_t hh = 0; hh < histograms.size(); ++hh)
+        {
+        fill(histograms[hh].counts.begin(),histograms[hh].counts.end(),0);
+        fill(histograms[hh].atSnapshot.begin(),histograms[hh].atSnapshot.end(),0);
+        };
+    steps = 0;
+    stepsAtSnapshot = 0;
+    lastSnapshotTime = chrono::steady_clock::now();
+    };
+
+long long runtimeMetrics::counterTotal(const string &name)
+    {
+    int id = find(name,counterKind);
+    return id < 0 ? 0 : counters[id].total;
+    };
+
+long long runtimeMetrics::counterLastStep(const string &name)
+    {
+    int id = find(name,counterKind);
+    return id < 0 ? 0 : counters[id].lastStep;
+    };
+
+double runtimeMetrics::gaugeValue(const string &name)
+    {
+    int id = find(name,gaugeKind);
+    return id < 0 ? 0.0 : gauges[id].value;
+    };
+
+vector<long long> runtimeMetrics::histogramCounts(const string &name)
+    {
+    int id = find(name,histogramKind);
+    return id < 0 ? vector<long long>() : histograms[id].counts;
+    };
+
+//!a bin edge as it appears in a column name
+static string edgeName(double edge)
+    {
+    char buffer[64];
+    snprintf(buffer,sizeof(buffer),"%g",edge);
+    return string(buffer);
+    };
+
+/*!
+The columns are "steps" and "wallTime", then every counter, every gauge, and one column per histogram
+bin, named by the histogram and the lower edge of the bin (e.g. "delaunay/repairedPointsPerCall[>=8]")
+*/
+vector<string> runtimeMetrics::columnNames()
+    {
+    vector<string> names;
+    names.push_back("steps");
+    names.push_back("wallTime");
+    for (size_t cc = 0; cc < counters.size(); ++cc)
+        names.push_back(counters[cc].name);
+    for (size_t gg = 0; gg < gauges.size(); ++gg)
+        names.push_back(gauges[gg].name);
+    for (size_t hh = 0; hh < histograms.size(); ++hh)
+        {
+        names.push_back(histograms[hh].name+"[<"+edgeName(histograms[hh].edges.empty() ? 0.0 : histograms[hh].edges[0])+"]");
+        for (size_t bb = 0; bb < histograms[hh].edges.size(); ++bb)
+            names.push_back(histograms[hh].name+"[>="+edgeName(histograms[hh].edges[bb])+"]");
+        };
+    return names;
+    };
+
+void runtimeMetrics::snapshot(vector<double> &values)
+    {
+    values.clear();
+    chrono::steady_clock::time_point now = chrono::steady_clock::now();
+    values.push_back(steps - stepsAtSnapshot);
+    values.push_back(chrono::duration<double>(now - lastSnapshotTime).count());
+    stepsAtSnapshot = steps;
+    lastSnapshotTime = now;
+    for (size_t cc = 0; cc < counters.size(); ++cc)
+        {
+        values.push_back(counters[cc].total - counters[cc].atSnapshot);
+        counters[cc].atSnapshot = counters[cc].total;
+        };
+    for (size_t gg = 0; gg < gauges.size(); ++gg)
+        values.push_back(gauges[gg].value);
+    for (size_t hh = 0; hh < histograms.size(); ++hh)
+        for (size_t bb = 0; bb < histograms[hh].counts.size(); ++bb)
+            {
+            values.push_back(histograms[hh].counts[bb] - histograms[hh].atSnapshot[bb]);
+            histograms[hh].atSnapshot[bb] = histograms[hh].counts[bb];
+            };
+    };
+
+void runtimeMetrics::report()
+    {
+    printf("runtime metrics after %lld steps\n",steps);
+    for (size_t cc = 0; cc < counters.size(); ++cc)
+        printf("  %-44s total %12lld\t last step %lld\n",counters[cc].name.c_str(),counters[cc].total,counters[cc].lastStep);
+    for (size_t gg = 0; gg < gauges.size(); ++gg)
+        printf("  %-44s value %12g\n",gauges[gg].name.c_str(),gauges[gg].value);
+    for (size_t hh = 0; hh < histograms.size(); ++hh)
+        {
+        const histogramData &h = histograms[hh];
+        printf("  %-44s",h.name.c_str());
+        for (size_t bb = 0; bb < h.counts.size(); ++bb)
+            if(h.counts[bb] > 0)
+                {
+                if(bb == 0)
+                    printf(" <%g: %lld",h.edges.empty() ? 0.0 : h.edges[0],h.counts[bb]);
+                else
+                    printf(" >=%g: %lld",h.edges[bb-1],h.counts[bb]);
+                };
+        printf("\n");
+        };
+    };
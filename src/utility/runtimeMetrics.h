@@ -0,0 +1,121 @@
+#ifndef runtimeMetrics_H
+#define runtimeMetrics_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+using namespace std;
+
+/*! \file runtimeMetrics.h */
+//!A registry of counters, gauges and histograms that the parts of a simulation report into
+/*!
+Each component that has something to report (e.g. the number of points a triangulation repair touched,
+or the number of T1 transitions) registers its metrics by name when it is given the registry, keeps the
+returned integer ids, and from then on reports through them -- increment, setGauge and record are a
+handful of instructions, with no lookups. Registering an existing name of the same kind returns the
+existing id, so several components can share a metric.
+
+    counters   accumulate integer events (global rescues, one-ring resizes, T1 transitions...)
+    gauges     hold the latest value of some quantity (the maximum number of neighbors, ...)
+    histograms count how often values fall in fixed bins, e.g. the number of repaired points per call
+
+A Simulation owns a registry once getMetrics or setMetrics is called, hands it to its configuration and
+updaters, and calls endStep after every time step. Values can be queried by name at any time; the
+totals since the last reset and the counts of the last complete step are kept. For output, snapshot
+produces one flat row (see columnNames): the steps and wall-clock time since the previous snapshot, the
+counter increments and histogram counts since then, and the current gauges -- so that consecutive rows
+can be lined up against throughput. The metricsUpdater writes these rows periodically to a
+valueVectorDatabase or a CSV file.
+
+Metrics are reported from serial host code only.
+*/
+class runtimeMetrics
+    {
+    public:
+        runtimeMetrics(){lastSnapshotTime = chrono::steady_clock::now();};
+
+        //!Register (or look up) a counter, returning its id
+        int registerCounter(const string &name);
+        //!Register (or look up) a gauge, returning its id
+        int registerGauge(const string &name);
+        /*!
+        Register (or look up) a histogram with bins (-inf,edges[0]), [edges[0],edges[1]), ... [edges.back(),inf),
+        returning its id
+        */
+        int registerHistogram(const string &name, const vector<double> &edges);
+        //!Bin edges 0,1,2,4,... up to (at least) maximum, suited to event counts
+        static vector<double> powerOfTwoEdges(double maximum);
+
+        //!Add to a counter
+        void increment(int counter, long long amount = 1){counters[counter].total += amount;};
+        //!Set the value of a gauge
+        void setGauge(int gauge, double value){gauges[gauge].value = value;};
+        //!Add a value to a histogram
+        void record(int histogram, double value)
+            {
+            histogramData &h = histograms[histogram];
+            int bin = upper_bound(h.edges.begin(),h.edges.end(),value) - h.edges.begin();
+            h.counts[bin] += 1;
+            };
+
+        //!Mark the end of a time step
+        void endStep();
+        //!Zero every counter and histogram (gauges keep their values)
+        void reset();
+
+        //!The number of completed time steps since the last reset
+        long long steps = 0;
+        //!The total of a counter since the last reset
+        long long counterTotal(const string &name);
+        //!The increment of a counter during the last complete time step
+        long long counterLastStep(const string &name);
+        //!The current value of a gauge
+        double gaugeValue(const string &name);
+        //!The counts in each bin of a histogram since the last reset
+        vector<long long> histogramCounts(const string &name);
+        //!Is there a metric with this name?
+        bool hasMetric(const string &name){return index.find(name) != index.end();};
+
+        //!The names of the columns of a snapshot
+        vector<string> columnNames();
+        //!Fill values with one row of output, as described above, and start a new snapshot interval
+        void snapshot(vector<double> &values);
+        //!Print every metric
+        void report();
+
+    protected:
+        struct counterData
+            {
+            string name;
+            long long total = 0;
+            long long atStepStart = 0;
+            long long lastStep = 0;
+            long long atSnapshot = 0;
+            };
+        struct gaugeData
+            {
+            string name;
+            double value = 0.0;
+            };
+        struct histogramData
+            {
+            string name;
+            vector<double> edges;
+            vector<long long> counts;
+            vector<long long> atSnapshot;
+            };
+        enum kind {counterKind, gaugeKind, histogramKind};
+        //!find a metric of the given kind, returning -1 if there is none and throwing if the name has another kind
+        int find(const string &name, kind k);
+
+        vector<counterData> counters;
+        vector<gaugeData> gauges;
+        vector<histogramData> histograms;
+        //!name -> (kind, id)
+        unordered_map<string,pair<int,int> > index;
+        long long stepsAtSnapshot = 0;
+        chrono::steady_clock::time_point lastSnapshotTime;
+    };
+#endif
@@ -0,0 +1,105 @@
+#include "std_include.h"
+
+#include "Simulation.h"
+#include "voronoiQuadraticEnergy.h"
+#include "vertexQuadraticEnergy.h"
+#include "brownianParticleDynamics.h"
+#include "NoseHooverChainNVT.h"
+#include "testHelpers.h"
+
+/*!
+A regression test of checkpoint/restart. For a voronoi model with brownian dynamics, a vertex model
+(with T1 transitions) with brownian dynamics, and a voronoi model with a Nose-Hoover chain, a simulation
+writes a checkpoint part way through a run and continues. A second simulation, set up in the same way
+but with a non-reproducible random number generator, reads the checkpoint and runs the same number of
+steps. The positions, the time, and the time step count must then be bit-for-bit identical.
+*/
+
+//!The model and integrator of one of the three test cases, in a simulation
+testRun setUpCase(int testCase, int N, bool reproducible)
+    {
+    ForcePtr model;
+    UpdaterPtr integrator;
+    if(testCase == 1)
+        {
+        shared_ptr<VertexQuadraticEnergy> vertexModel = make_shared<VertexQuadraticEnergy>(N,1.0,3.9,reproducible,false,false);
+        vertexModel->setT1Threshold(0.04);
+        model = vertexModel;
+        }
+    else
+        model = make_shared<VoronoiQuadraticEnergy>(N,1.0,3.8,reproducible,false);
+
+    if(testCase == 2)
+        {
+        shared_ptr<NoseHooverChainNVT> nvt = make_shared<NoseHooverChainNVT>(N,2,false);
+        nvt->setT(0.1);
+        integrator = nvt;
+        }
+    else
+        {
+        shared_ptr<brownianParticleDynamics> brownian = make_shared<brownianParticleDynamics>(model->getNumberOfDegreesOfFreedom(),false);
+        brownian->setT(0.05);
+        integrator = brownian;
+        };
+
+    testRun run = makeTestRun(model,integrator,0.01,25,reproducible);
+    if(testCase == 2)
+        model->setCellVelocitiesMaxwellBoltzmann(0.1);
+    return run;
+    };
+
+int main(int argc, char*argv[])
+{
+    int numpts = 400; //number of cells
+    int stepsBefore = 60; //time steps before the checkpoint is written
+    int stepsAfter = 80; //time steps run by both simulations after the checkpoint
+    string fileName = "checkpointRestart_test.ckpt";
+    int c;
+    while((c=getopt(argc,argv,"n:t:f:")) != -1)
+        switch(c)
+        {
+            case 'n': numpts = atoi(optarg); break;
+            case 't': stepsAfter = atoi(optarg); break;
+            case 'f': fileName = optarg; break;
+            case '?':
+                    if(isprint(optopt))
+                        std::cerr<<"Unknown option '-" << optopt << "'.\n";
+                    else
+                        std::cerr << "Unknown option character.\n";
+                    return 1;
+            default:
+                       abort();
+        };
+
+    const char *caseNames[3] = {"voronoi/brownian","vertex/brownian","voronoi/noseHoover"};
+    int failures = 0;
+    for (int testCase = 0; testCase < 3; ++testCase)
+        {
+        testRun original = setUpCase(testCase,numpts,true);
+        for (int ii = 0; ii < stepsBefore; ++ii)
+            original.simulation->performTimestep();
+        original.simulation->writeCheckpoint(fileName);
+        for (int ii = 0; ii < stepsAfter; ++ii)
+            original.simulation->performTimestep();
+        original.simulation->waitForCheckpoint();
+
+        testRun restarted = setUpCase(testCase,numpts,false);
+        restarted.simulation->readCheckpoint(fileName);
+        for (int ii = 0; ii < stepsAfter; ++ii)
+            restarted.simulation->performTimestep();
+
+        int Ndof = original.model->getNumberOfDegreesOfFreedom();
+        int differing = differingPositions(original.model,restarted.model);
+        bool sameClock = original.simulation->Time == restarted.simulation->Time &&
+                         original.simulation->integerTimestep == restarted.simulation->integerTimestep;
+        printf("%-20s %i of %i positions differ after the restart%s\n",caseNames[testCase],differing,Ndof,
+               sameClock ? "" : ", and the clocks disagree");
+        if(differing > 0 || !sameClock)
+            failures += 1;
+        };
+    std::remove(fileName.c_str());
+
+    if(failures > 0)
+        printf("%i of 3 checkpoint restarts did not continue exactly\n",failures);
+    return failures > 0 ? 1 : 0;
+};
@@ -0,0 +1,170 @@
+#include "std_include.h"
+
+#include "DelaunayCPU.h"
+#include "functions.h"
+#include <random>
+
+/*!
+A regression test of the native periodic Delaunay triangulation (DelaunayCPU), in a square and in a
+sheared box, for random points and for a square lattice (every circumcircle then passes through a
+fourth point). Every triangle must be counter-clockwise and have an empty circumcircle, checked by brute
+force against all points; the triangulation of the torus must have 2N triangles and 6N neighbor
+entries, with every neighbor relation symmetric; and the triangulation must not depend on the number of
+threads.
+*/
+
+//!Count the triangles of the triangulation that are clockwise or have a point inside their circumcircle
+int badTriangles(DelaunayCPU &delaunay, GPUArray<double2> &points, PeriodicBoxPtr box)
+    {
+    ArrayHandle<double2> h_p(points,access_location::host,access_mode::read);
+    int N = points.getNumElements();
+    int bad = 0;
+    for (size_t tt = 0; tt < delaunay.triangles.size(); ++tt)
+        {
+        int3 t = delaunay.triangles[tt];
+        double2 origin = make_double2(0.0,0.0);
+        double2 pa = h_p.data[t.x];
+        double2 rb, rc, center, d;
+        box->minDist(h_p.data[t.y],pa,rb);
+        box->minDist(h_p.data[t.z],pa,rc);
+        if(orient2D(origin,rb,rc) <= 0)
+            {
+            bad += 1;
+            continue;
+            };
+        Circumcenter(rb,rc,center);
+        double radius = norm(center);
+        center = center + pa;
+        for (int jj = 0; jj < N; ++jj)
+            {
+            if(jj == t.x || jj == t.y || jj == t.z)
+                continue;
+            box->minDist(h_p.data[jj],center,d);
+            if(norm(d) < radius*(1.0-1e-12))
+                {
+                bad += 1;
+                break;
+                };
+            };
+        };
+    return bad;
+    };
+
+//!Is every point a neighbor of each of its neighbors, and do the neighbor counts add up to 6N?
+bool neighborsAreSymmetric(DelaunayCPU &delaunay, int N)
+    {
+    int total = 0;
+    for (int ii = 0; ii < N; ++ii)
+        {
+        total += delaunay.neighborNumber[ii];
+        for (int nn = 0; nn < delaunay.neighborNumber[ii]; ++nn)
+            {
+            int jj = delaunay.neighborList[delaunay.neighborIndexer(nn,ii)];
+            bool found = false;
+            for (int mm = 0; mm < delaunay.neighborNumber[jj] && !found; ++mm)
+                found = delaunay.neighborList[delaunay.neighborIndexer(mm,jj)] == ii;
+            if(!found)
+                return false;
+            };
+        };
+    return total == 6*N;
+    };
+
+int main(int argc, char*argv[])
+{
+    int numpts = 600; //number of random points
+    int c;
+    while((c=getopt(argc,argv,"n:")) != -1)
+        switch(c)
+        {
+            case 'n': numpts = atoi(optarg); break;
+            case '?':
+                    if(isprint(optopt))
+                        std::cerr<<"Unknown option '-" << optopt << "'.\n";
+                    else
+                        std::cerr << "Unknown option character.\n";
+                    return 1;
+            default:
+                       abort();
+        };
+
+    std::mt19937 generator(11);
+    std::uniform_real_distribution<double> uniform(0.0,1.0);
+    const char *caseNames[3] = {"square box, random points","sheared box, random points","square box, square lattice"};
+    int failures = 0;
+    for (int testCase = 0; testCase < 3; ++testCase)
+        {
+        int N = numpts;
+        PeriodicBoxPtr box;
+        if(testCase == 1)
+            {
+            box = make_shared<periodicBoundaries>();
+            box->setGeneral(25.0,7.0,0.0,24.0);
+            }
+        else if(testCase == 2)
+            {
+            int side = (int)floor(sqrt((double)numpts));
+            N = side*side;
+            box = make_shared<periodicBoundaries>(side,side);
+            }
+        else
+            box = make_shared<periodicBoundaries>(sqrt((double)N),sqrt((double)N));
+
+        GPUArray<double2> points;
+        points.neverGPU = true;
+        points.resize(N);
+            {
+            ArrayHandle<double2> h_p(points,access_location::host,access_mode::overwrite);
+            int side = (int)floor(sqrt((double)N));
+            for (int ii = 0; ii < N; ++ii)
+                {
+                if(testCase == 2)
+                    h_p.data[ii] = make_double2(ii % side + 0.5, ii / side + 0.5);
+                else
+                    {
+                    double2 fractional = make_double2(uniform(generator),uniform(generator));
+                    box->Trans(fractional,h_p.data[ii]);
+                    };
+                };
+            }
+
+        vector<int3> singleThreaded;
+        for (int threads = 1; threads <= 4; threads += 3)
+            {
+            DelaunayCPU delaunay(box);
+            delaunay.setOmpThreads(threads);
+            bool consistent = delaunay.periodicTriangulation(points);
+            int bad = badTriangles(delaunay,points,box);
+            bool counted = delaunay.triangles.size() == (size_t)(2*N) && neighborsAreSymmetric(delaunay,N);
+            bool sameAsSerial = true;
+            if(threads == 1)
+                singleThreaded = delaunay.triangles;
+            else
+                {
+                //triangles are compared as sets, each rotated to start from its smallest index
+                vector<int3> a = singleThreaded, b = delaunay.triangles;
+                auto canonical = [](vector<int3> &ts)
+                    {
+                    for (auto &t : ts)
+                        {
+                        while(t.x > t.y || t.x > t.z)
+                            t = make_int3(t.y,t.z,t.x);
+                        };
+                    std::sort(ts.begin(),ts.end(),[](const int3 &l, const int3 &r)
+                        {return l.x < r.x || (l.x == r.x && (l.y < r.y || (l.y == r.y && l.z < r.z)));});
+                    };
+                canonical(a);
+                canonical(b);
+                sameAsSerial = a.size() == b.size();
+                for (size_t tt = 0; sameAsSerial && tt < a.size(); ++tt)
+                    sameAsSerial = a[tt].x == b[tt].x && a[tt].y == b[tt].y && a[tt].z == b[tt].z;
+                };
+            printf("%-28s %i threads: %zu triangles, %i clockwise or non-empty circumcircles%s%s%s\n",caseNames[testCase],
+                   threads,delaunay.triangles.size(),bad,consistent ? "" : ", reported inconsistent",
+                   counted ? "" : ", wrong triangle or neighbor counts",sameAsSerial ? "" : ", differs from one thread");
+            if(!consistent || bad > 0 || !counted || !sameAsSerial)
+                failures += 1;
+            };
+        };
+    return failures > 0 ? 1 : 0;
+};
@@ -0,0 +1,195 @@
+#include "std_include.h"
+
+#include "gpuarray.h"
+#include "functions.h"
+
+/*!
+A regression test of the size, capacity and ownership semantics of GPUArray: resize, reserve and
+shrink_to_fit, growth by growGPUArray, removal of elements with removeGPUArrayElement, the move
+constructor and move assignment, copyFrom, and the deep copy of the copy assignment. Contents are
+compared against std::vectors that are given the same operations.
+*/
+
+//!Count (and report) the checks that fail
+static int failures = 0;
+static void check(bool passed, const char *description)
+    {
+    if(!passed)
+        {
+        printf("failed: %s\n",description);
+        failures += 1;
+        };
+    };
+
+//!Does the GPUArray hold exactly the elements of the vector?
+static bool sameContents(GPUArray<int> &array, const vector<int> &reference)
+    {
+    if(array.getNumElements() != reference.size())
+        return false;
+    ArrayHandle<int> h(array,access_location::host,access_mode::read);
+    for (size_t ii = 0; ii < reference.size(); ++ii)
+        if(h.data[ii] != reference[ii])
+            return false;
+    return true;
+    };
+
+//!Fill the GPUArray and the vector with the same values
+static void fillWithValues(GPUArray<int> &array, vector<int> &reference, int n, int offset)
+    {
+    reference.resize(n);
+    for (int ii = 0; ii < n; ++ii)
+        reference[ii] = ii + offset;
+    fillGPUArrayWithVector(reference,array);
+    };
+
+int main(int argc, char*argv[])
+{
+    int numElements = 100000; //length reached by growing an array one element at a time
+    int c;
+    while((c=getopt(argc,argv,"n:")) != -1)
+        switch(c)
+        {
+            case 'n': numElements = atoi(optarg); break;
+            case '?':
+                    if(isprint(optopt))
+                        std::cerr<<"Unknown option '-" << optopt << "'.\n";
+                    else
+                        std::cerr << "Unknown option character.\n";
+                    return 1;
+            default:
+                       abort();
+        };
+
+    //growing one element at a time reallocates geometrically, and zeroes every new element
+        {
+        GPUArray<int> grown;
+        int reallocations = 0;
+        unsigned int capacity = grown.getCapacity();
+        bool zeroed = true;
+        for (int ii = 0; ii < numElements; ++ii)
+            {
+            growGPUArray(grown,1);
+            if(grown.getCapacity() != capacity)
+                {
+                reallocations += 1;
+                capacity = grown.getCapacity();
+                };
+            ArrayHandle<int> h(grown,access_location::host,access_mode::readwrite);
+            zeroed = zeroed && h.data[ii] == 0;
+            h.data[ii] = ii;
+            };
+        vector<int> reference(numElements);
+        for (int ii = 0; ii < numElements; ++ii)
+            reference[ii] = ii;
+        check(zeroed,"growGPUArray zeroes the new elements");
+        check(sameContents(grown,reference),"growGPUArray keeps the old elements");
+        check(grown.getCapacity() >= grown.getNumElements(),"the capacity covers the size");
+        check(reallocations <= 2*log((double)numElements)/log(1.5)+2,"growth by one element reallocates geometrically");
+        printf("grew to %u elements (capacity %u) with %i reallocations\n",grown.getNumElements(),grown.getCapacity(),reallocations);
+        }
+
+    //resize, reserve and shrink_to_fit
+        {
+        GPUArray<int> array;
+        vector<int> reference;
+        fillWithValues(array,reference,100,1);
+        unsigned int capacity = array.getCapacity();
+        array.resize(10);
+        reference.resize(10);
+        check(sameContents(array,reference),"shrinking keeps the leading elements");
+        check(array.getCapacity() == capacity,"shrinking keeps the allocation");
+        array.resize(40);
+        reference.resize(40,0);
+        check(sameContents(array,reference),"growing within the capacity zeroes the exposed elements");
+        check(array.getCapacity() == capacity,"growing within the capacity does not reallocate");
+        array.shrink_to_fit();
+        check(array.getCapacity() == 40 && sameContents(array,reference),"shrink_to_fit releases the extra capacity");
+        array.reserve(1000);
+        check(array.getCapacity() == 1000 && sameContents(array,reference),"reserve changes the capacity but not the contents");
+        array.reserve(10);
+        check(array.getCapacity() == 1000,"reserve never shrinks the allocation");
+        array.resize(0);
+        array.shrink_to_fit();
+        check(array.getNumElements() == 0 && array.getCapacity() == 0,"an empty array can release all of its memory");
+        }
+
+    //removing elements shifts the later ones into place
+        {
+        GPUArray<int> array;
+        vector<int> reference;
+        fillWithValues(array,reference,1000,0);
+        removeGPUArrayElement(array,5);
+        reference.erase(reference.begin()+5);
+        check(sameContents(array,reference),"removeGPUArrayElement removes a single element");
+        vector<int> indices = {998,0,17,4,500};
+        removeGPUArrayElement(array,indices);
+        std::sort(indices.begin(),indices.end());
+        for (int ii = indices.size()-1; ii >= 0; --ii)
+            reference.erase(reference.begin()+indices[ii]);
+        check(sameContents(array,reference),"removeGPUArrayElement removes a list of (unsorted) elements");
+        removeGPUArrayElement(array,vector<int>());
+        check(sameContents(array,reference),"removing an empty list of elements changes nothing");
+        }
+
+    //moves take over the memory, and leave the source empty
+        {
+        GPUArray<int> source;
+        vector<int> reference;
+        fillWithValues(source,reference,64,3);
+        GPUArray<int> moved(std::move(source));
+        check(source.getNumElements() == 0 && source.getCapacity() == 0,"the move constructor empties its source");
+        check(sameContents(moved,reference),"the move constructor takes over the contents");
+        GPUArray<int> assigned(5u);
+        assigned = std::move(moved);
+        check(moved.getNumElements() == 0 && moved.getCapacity() == 0,"move assignment empties its source");
+        check(sameContents(assigned,reference),"move assignment takes over the contents");
+        moved.resize(4);
+        check(sameContents(moved,vector<int>(4,0)),"a moved-from array can be reused");
+
+        vector<GPUArray<double> > arrays;
+        for (int ii = 0; ii < 50; ++ii)
+            {
+            arrays.emplace_back(10u);
+            ArrayHandle<double> h(arrays.back(),access_location::host,access_mode::overwrite);
+            for (int jj = 0; jj < 10; ++jj)
+                h.data[jj] = ii + 0.1*jj;
+            };
+        bool kept = true;
+        for (int ii = 0; ii < 50; ++ii)
+            {
+            ArrayHandle<double> h(arrays[ii],access_location::host,access_mode::read);
+            for (int jj = 0; jj < 10; ++jj)
+                kept = kept && h.data[jj] == ii + 0.1*jj;
+            };
+        check(kept,"arrays keep their contents when a vector of them reallocates");
+        }
+
+    //copies are deep, and copyFrom reuses a large enough allocation
+        {
+        GPUArray<int> original;
+        vector<int> reference;
+        fillWithValues(original,reference,20,7);
+        GPUArray<int> target(3u);
+        target.reserve(50);
+        target.copyFrom(original);
+        check(sameContents(target,reference),"copyFrom copies the contents");
+        check(target.getCapacity() == 50,"copyFrom reuses an allocation that is large enough");
+        GPUArray<int> small(3u);
+        small.copyFrom(original);
+        check(sameContents(small,reference),"copyFrom grows a smaller array");
+        GPUArray<int> copied;
+        copied = original;
+        GPUArray<int> constructed(original);
+            {
+            ArrayHandle<int> h(original,access_location::host,access_mode::readwrite);
+            h.data[0] = -1;
+            }
+        check(sameContents(copied,reference) && sameContents(constructed,reference),"copies do not share memory with the original");
+        }
+
+    if(failures > 0)
+        printf("%i GPUArray checks failed\n",failures);
+    else
+        printf("all GPUArray checks passed\n");
+    return failures > 0 ? 1 : 0;
+};
@@ -0,0 +1,123 @@
+#include "std_include.h"
+
+#include "Simulation.h"
+#include "vertexQuadraticEnergy.h"
+#include "brownianParticleDynamics.h"
+#include "runtimeMetrics.h"
+#include "testHelpers.h"
+
+/*!
+A regression test of the half-edge mesh of vertex models. Two copies of a vertex model run the same
+brownian dynamics, hot enough for frequent T1 transitions, with cell divisions and (when a triangular
+cell exists) T2 transitions along the way; one copy keeps a halfEdgeMesh up to date and uses it in its
+CPU topology routines. After every time step the maintained mesh must be identical to one freshly built
+from the flat topology arrays, and at the end the two copies must have taken the same T1 transitions and
+have bit-for-bit identical vertex positions.
+*/
+
+//!Compare the half-edge mesh of the model with one built from scratch
+bool meshIsConsistent(VertexQuadraticEnergy &model)
+    {
+    const halfEdgeMesh &mesh = model.getHalfEdgeMesh();
+    ArrayHandle<int> h_vn(model.vertexNeighbors,access_location::host,access_mode::read);
+    ArrayHandle<int> h_cvn(model.cellVertexNum,access_location::host,access_mode::read);
+    ArrayHandle<int> h_cv(model.returnCellVertices(),access_location::host,access_mode::read);
+    return mesh.checkConsistency(model.Nvertices,model.Ncells,h_vn.data,h_cvn.data,h_cv.data,model.n_idx);
+    };
+
+int main(int argc, char*argv[])
+{
+    int numpts = 300; //number of cells
+    int tSteps = 600; //number of time steps
+    int c;
+    while((c=getopt(argc,argv,"n:t:")) != -1)
+        switch(c)
+        {
+            case 'n': numpts = atoi(optarg); break;
+            case 't': tSteps = atoi(optarg); break;
+            case '?':
+                    if(isprint(optopt))
+                        std::cerr<<"Unknown option '-" << optopt << "'.\n";
+                    else
+                        std::cerr << "Unknown option character.\n";
+                    return 1;
+            default:
+                       abort();
+        };
+
+    //two identical runs, of which only the second maintains a half-edge mesh
+    shared_ptr<VertexQuadraticEnergy> models[2];
+    shared_ptr<runtimeMetrics> metrics[2];
+    testRun runs[2];
+    for (int rr = 0; rr < 2; ++rr)
+        {
+        models[rr] = make_shared<VertexQuadraticEnergy>(numpts,1.0,3.9,true,false,false);
+        models[rr]->setT1Threshold(0.08);
+        models[rr]->setUseHalfEdgeMesh(rr == 1);
+        metrics[rr] = make_shared<runtimeMetrics>();
+        models[rr]->setMetrics(metrics[rr]);
+        shared_ptr<brownianParticleDynamics> brownian = make_shared<brownianParticleDynamics>(models[rr]->getNumberOfDegreesOfFreedom(),false);
+        brownian->setT(0.2);
+        runs[rr] = makeTestRun(models[rr],brownian,0.01,50,true);
+        };
+    VertexQuadraticEnergy &flat = *models[0];
+    VertexQuadraticEnergy &mesh = *models[1];
+    int failures = 0;
+    int divisions = 0;
+    int deaths = 0;
+    for (int step = 0; step < tSteps; ++step)
+        {
+        runs[0].simulation->performTimestep();
+        runs[1].simulation->performTimestep();
+        if(step % 100 == 57)
+            {
+            //divide a cell between its first vertex and the one half way around it
+            int cell = (step*7919) % flat.Ncells;
+            int vertices;
+                {
+                ArrayHandle<int> h_cvn(flat.cellVertexNum,access_location::host,access_mode::read);
+                vertices = h_cvn.data[cell];
+                }
+            vector<int> parameters = {cell,0,vertices/2};
+            flat.cellDivision(parameters);
+            mesh.cellDivision(parameters);
+            divisions += 1;
+            };
+        if(step % 100 == 77)
+            {
+            int triangle = -1;
+                {
+                ArrayHandle<int> h_cvn(flat.cellVertexNum,access_location::host,access_mode::read);
+                for (int cell = 0; cell < flat.Ncells && triangle < 0; ++cell)
+                    if(h_cvn.data[cell] == 3)
+                        triangle = cell;
+                }
+            if(triangle >= 0)
+                {
+                flat.cellDeath(triangle);
+                mesh.cellDeath(triangle);
+                deaths += 1;
+                };
+            };
+        if(!meshIsConsistent(mesh))
+            {
+            printf("the half-edge mesh differs from a fresh rebuild after time step %i\n",step);
+            failures += 1;
+            break;
+            };
+        };
+
+    long long flatT1 = metrics[0]->counterTotal("vertex/T1Transitions");
+    long long meshT1 = metrics[1]->counterTotal("vertex/T1Transitions");
+    int differing = differingPositions(models[0],models[1]);
+    printf("%i divisions, %i T2 transitions, %lld and %lld T1 transitions; %i of %i vertex positions differ\n",
+           divisions,deaths,flatT1,meshT1,differing,flat.Nvertices);
+    if(flatT1 == 0)
+        {
+        printf("no T1 transitions took place, so the mesh updates were not exercised\n");
+        failures += 1;
+        };
+    if(flatT1 != meshT1 || differing > 0)
+        failures += 1;
+    return failures > 0 ? 1 : 0;
+};
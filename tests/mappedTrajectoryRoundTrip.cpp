@@ -0,0 +1,167 @@
+#include "std_include.h"
+
+#include "Simulation.h"
+#include "voronoiQuadraticEnergy.h"
+#include "vertexQuadraticEnergy.h"
+#include "brownianParticleDynamics.h"
+#include "mappedTrajectoryDatabase.h"
+#include "baseHDF5Database.h"
+
+/*!
+A regression test of the memory-mapped trajectory format, for a voronoi and a vertex model. A short
+brownian dynamics run is written frame by frame while the times, the positions (in tag order) and the
+energies are kept in memory. The file is then reopened and every frame, visited in reverse order, must
+reproduce them bit for bit; exportToHDF5 must give the same times, positions and neighbor counts; and
+readState must load a frame into a new model with the energy of the original.
+*/
+
+//!Count the frames of the mapped file and of its hdf5 export that differ from what was written
+int checkTrajectory(bool vertexModel, int N, int frames, const string &fileName, const string &exportName)
+    {
+    int failures = 0;
+    ForcePtr model;
+    shared_ptr<Simple2DCell> cells;
+    if(vertexModel)
+        {
+        shared_ptr<VertexQuadraticEnergy> vertices = make_shared<VertexQuadraticEnergy>(N,1.0,3.9,true,false,false);
+        vertices->setT1Threshold(0.04);
+        model = vertices;
+        cells = vertices;
+        }
+    else
+        {
+        shared_ptr<VoronoiQuadraticEnergy> voronoi = make_shared<VoronoiQuadraticEnergy>(N,1.0,3.8,true,false);
+        model = voronoi;
+        cells = voronoi;
+        };
+    int Ndof = model->getNumberOfDegreesOfFreedom();
+    shared_ptr<brownianParticleDynamics> brownian = make_shared<brownianParticleDynamics>(Ndof,false);
+    brownian->setT(0.05);
+    SimulationPtr sim = make_shared<Simulation>();
+    sim->setConfiguration(model);
+    sim->addUpdater(brownian,model);
+    sim->setIntegrationTimestep(0.01);
+    sim->setSortPeriod(25);
+    sim->setCPUOperation(true);
+    sim->setReproducible(true);
+
+    //write the trajectory, remembering what was written
+    vector<double> times(frames), energies(frames);
+    vector<vector<double2> > positions(frames,vector<double2>(Ndof));
+        {
+        mappedTrajectoryDatabase output(fileName,fileMode::replace);
+        for (int ff = 0; ff < frames; ++ff)
+            {
+            for (int ii = 0; ii < 20; ++ii)
+                sim->performTimestep();
+            model->computeForces();
+            energies[ff] = model->computeEnergy();
+            times[ff] = cells->currentTime;
+            vector<int> &tagToIdx = vertexModel ? cells->tagToIdxVertex : cells->tagToIdx;
+            ArrayHandle<double2> h_p(model->returnPositions(),access_location::host,access_mode::read);
+            for (int tag = 0; tag < Ndof; ++tag)
+                positions[ff][tag] = h_p.data[tagToIdx[tag]];
+            output.writeState(cells);
+            };
+        }
+
+    mappedTrajectoryDatabase input(fileName);
+    if(input.numberOfFrames() != frames)
+        {
+        printf("%i frames were written but %i were read back\n",frames,input.numberOfFrames());
+        return 1;
+        };
+    for (int ff = frames-1; ff >= 0; --ff)
+        {
+        trajectoryFrame frame = input.getFrame(ff);
+        bool same = (frame.time == times[ff]) && (frame.positions.size == (size_t)Ndof);
+        for (int tag = 0; same && tag < Ndof; ++tag)
+            same = memcmp(&frame.positions[tag],&positions[ff][tag],sizeof(double2)) == 0;
+        if(!same)
+            {
+            printf("mapped frame %i differs from the state that was written\n",ff);
+            failures += 1;
+            };
+        };
+
+    input.exportToHDF5(exportName);
+        {
+        baseHDF5Database archive(exportName);
+        if(archive.getDatasetDimensions("time") != (unsigned long)frames)
+            {
+            printf("the hdf5 export has %lu records instead of %i\n",archive.getDatasetDimensions("time"),frames);
+            failures += 1;
+            };
+        vector<double> time(1), coordinates(2*Ndof);
+        vector<int> counts(N);
+        for (int ff = 0; ff < frames; ++ff)
+            {
+            trajectoryFrame frame = input.getFrame(ff);
+            archive.readDataset("time",time,ff);
+            archive.readDataset(vertexModel ? "vertexPosition" : "position",coordinates,ff);
+            archive.readDataset(vertexModel ? "cellVertexNum" : "neighborNum",counts,ff);
+            trajectorySpan<int> &frameCounts = vertexModel ? frame.cellVertexNum : frame.neighborNum;
+            bool same = time[0] == frame.time;
+            for (int tag = 0; same && tag < Ndof; ++tag)
+                same = coordinates[2*tag] == frame.positions[tag].x && coordinates[2*tag+1] == frame.positions[tag].y;
+            for (int cell = 0; same && cell < N; ++cell)
+                same = counts[cell] == frameCounts[cell];
+            if(!same)
+                {
+                printf("hdf5 record %i differs from the mapped frame\n",ff);
+                failures += 1;
+                };
+            };
+        }
+
+    //load the middle frame into a new model
+    int loadedFrame = frames/2;
+    shared_ptr<Simple2DCell> fresh;
+    if(vertexModel)
+        fresh = make_shared<VertexQuadraticEnergy>(N,1.0,3.9,true,false,false);
+    else
+        fresh = make_shared<VoronoiQuadraticEnergy>(N,1.0,3.8,true,false);
+    input.readState(fresh,loadedFrame);
+    fresh->computeForces();
+    double energy = fresh->computeEnergy();
+    if(fabs(energy-energies[loadedFrame]) > 1e-10*fabs(energies[loadedFrame]))
+        {
+        printf("the energy of frame %i is %.15g after readState, but was %.15g\n",loadedFrame,energy,energies[loadedFrame]);
+        failures += 1;
+        };
+    return failures;
+    };
+
+int main(int argc, char*argv[])
+{
+    int numpts = 400; //number of cells
+    int frames = 10; //number of frames written
+    int c;
+    while((c=getopt(argc,argv,"n:f:")) != -1)
+        switch(c)
+        {
+            case 'n': numpts = atoi(optarg); break;
+            case 'f': frames = atoi(optarg); break;
+            case '?':
+                    if(isprint(optopt))
+                        std::cerr<<"Unknown option '-" << optopt << "'.\n";
+                    else
+                        std::cerr << "Unknown option character.\n";
+                    return 1;
+            default:
+                       abort();
+        };
+
+    string fileName = "mappedTrajectoryRoundTrip_test.cgt";
+    string exportName = "mappedTrajectoryRoundTrip_test.h5";
+    int failures = 0;
+    for (int vertexModel = 0; vertexModel < 2; ++vertexModel)
+        {
+        int modelFailures = checkTrajectory(vertexModel == 1,numpts,frames,fileName,exportName);
+        printf("%s model: %i failed checks\n",vertexModel == 1 ? "vertex" : "voronoi",modelFailures);
+        failures += modelFailures;
+        std::remove(fileName.c_str());
+        std::remove(exportName.c_str());
+        };
+    return failures > 0 ? 1 : 0;
+};
@@ -0,0 +1,69 @@
+"""
+A smoke test of the cellGPU python module (registered with ctest when configured with -DPYTHON_BINDINGS=ON):
+import the module, take time steps, and check that views of model arrays see the model's own memory, are
+counted per model, and block time steps only of a simulation that uses the viewed model.
+Exits with a nonzero code if a check fails.
+"""
+import sys
+import numpy as np
+import cellGPU
+
+failures = []
+def check(condition, message):
+    if not condition:
+        failures.append(message)
+        print("failed: " + message)
+
+N = 100
+model = cellGPU.VoronoiQuadraticEnergy(N, 1.0, 3.8, reproducible=True, usegpu=False)
+bd = cellGPU.brownianParticleDynamics(N, usegpu=False)
+bd.setT(0.01)
+sim = cellGPU.Simulation()
+sim.setConfiguration(model)
+sim.addUpdater(bd, model)
+sim.setIntegrationTimestep(0.01)
+sim.setCPUOperation(True)
+sim.setReproducible(True)
+
+sim.performTimesteps(10)
+check(sim.integerTimestep == 10, "ten time steps were not taken")
+
+#a read-only view is a (N,2) array over the positions, counted by its model while open
+view = model.positions()
+x = view.open()
+check(x.shape == (N, 2), "positions have shape %s" % str(x.shape))
+check(not x.flags.writeable, "a read view is writeable")
+check(model.openHostViews == 1, "the model counts %d open views" % model.openHostViews)
+blocked = False
+try:
+    sim.performTimestep()
+except RuntimeError:
+    blocked = True
+check(blocked, "a time step was taken while a view of the configuration was open")
+view.close()
+check(model.openHostViews == 0, "the model counts %d open views after closing" % model.openHostViews)
+
+#a view of another model does not block this simulation
+other = cellGPU.VoronoiQuadraticEnergy(N, 1.0, 3.8, reproducible=True, usegpu=False)
+with other.positions() as y:
+    check(other.openHostViews == 1 and model.openHostViews == 0, "views are not counted per model")
+    sim.performTimestep()
+check(sim.integerTimestep == 11, "a view of an unrelated model blocked the simulation")
+
+#writes through a readwrite view reach the model, and the array is read-only once the view closes
+with model.positions(cellGPU.access_mode.readwrite) as x:
+    before = np.array(x)
+    x[0, 0] = 0.5*(x[0, 0] + x[1, 0])
+    written = x[0, 0]
+check(not x.flags.writeable, "an array stays writeable after its view closed")
+with model.positions() as x:
+    check(x[0, 0] == written and x[1, 0] == before[1, 0], "a write through a view did not reach the model")
+
+with model.areaPeri() as ap:
+    check(abs(ap[:, 0].sum() - N) < 1e-8*N, "cell areas do not add up to the box area")
+
+sim.performTimesteps(5)
+check(sim.integerTimestep == 16, "time steps stopped after the views were closed")
+
+print("%d failed checks" % len(failures))
+sys.exit(1 if failures else 0)
@@ -0,0 +1,72 @@
+#include "std_include.h"
+
+#include "voronoiQuadraticEnergy.h"
+#include "stressAutocorrelationUpdater.h"
+
+/*!
+A regression test of the sign of the shear stress sampled by stressAutocorrelationUpdater. The potential
+part, VoronoiQuadraticEnergy::getSigmaXY, must agree with (1/A) dE/dgamma, computed by a central finite
+difference of the energy under affine shears of the box. Giving every cell the velocity (u,u), whose
+kinetic contribution to the stress is known to be -(sum_i m_i) u^2/A, the sampled stress must then be the
+potential part minus (sum_i m_i) u^2/A.
+*/
+
+int main(int argc, char*argv[])
+{
+    int numpts = 200; //number of cells
+    int c;
+    while((c=getopt(argc,argv,"n:")) != -1)
+        switch(c)
+        {
+            case 'n': numpts = atoi(optarg); break;
+            case '?':
+                    if(isprint(optopt))
+                        std::cerr<<"Unknown option '-" << optopt << "'.\n";
+                    else
+                        std::cerr << "Unknown option character.\n";
+                    return 1;
+            default:
+                       abort();
+        };
+
+    shared_ptr<VoronoiQuadraticEnergy> model = make_shared<VoronoiQuadraticEnergy>(numpts,1.0,3.8,true,false);
+    double L = sqrt((double)numpts);
+    double area = L*L;
+    double sigmaXY = model->getSigmaXY();
+
+    double strain = 1e-5;
+    model->deformBox(L,strain*L,0.0,L);
+    double energyPlus = model->computeEnergy();
+    model->deformBox(L,-strain*L,0.0,L);
+    double energyMinus = model->computeEnergy();
+    model->deformBox(L,0.0,0.0,L);
+    double finiteDifference = (energyPlus-energyMinus)/(2.0*strain*area);
+    bool potentialAgrees = fabs(sigmaXY-finiteDifference) < 1e-6*max(1.0,fabs(sigmaXY));
+    printf("potential sigma_xy %.10g, (1/A) dE/dgamma by finite differences %.10g\n",sigmaXY,finiteDifference);
+
+    double u = 0.3;
+    double mass = 0.0;
+        {
+        ArrayHandle<double2> h_v(model->returnVelocities(),access_location::host,access_mode::overwrite);
+        ArrayHandle<double> h_m(model->returnMasses(),access_location::host,access_mode::read);
+        for (int ii = 0; ii < numpts; ++ii)
+            {
+            h_v.data[ii] = make_double2(u,u);
+            mass += h_m.data[ii];
+            };
+        }
+    stressAutocorrelationUpdater stress(1);
+    stress.set2DModel(model);
+    stress.setIncludeKinetic(true);
+    double sampled = stress.computeSigmaXY();
+    double expected = model->getSigmaXY() - mass*u*u/area;
+    bool kineticAgrees = fabs(sampled-expected) < 1e-12*max(1.0,fabs(expected));
+    printf("sampled sigma_xy with a uniform velocity (%g,%g): %.10g, expected %.10g\n",u,u,sampled,expected);
+
+    int failures = 0;
+    if(!potentialAgrees)
+        failures += 1;
+    if(!kineticAgrees)
+        failures += 1;
+    return failures > 0 ? 1 : 0;
+};
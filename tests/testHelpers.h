@@ -0,0 +1,50 @@
+#ifndef testHelpers_H
+#define testHelpers_H
+
+#include "std_include.h"
+#include "Simulation.h"
+
+/*! \file testHelpers.h */
+//!A model, its integrator, and the simulation advancing them
+/*!
+The simulation only holds weak pointers to the model and the integrator, so a regression driver keeps a
+testRun alive for as long as it steps the simulation.
+*/
+struct testRun
+    {
+    ForcePtr model;
+    UpdaterPtr integrator;
+    SimulationPtr simulation;
+    };
+
+//!Set up a simulation that advances the model with a single integrator, on the CPU
+inline testRun makeTestRun(ForcePtr model, UpdaterPtr integrator, double dt, int sortPeriod, bool reproducible)
+    {
+    testRun run;
+    run.model = model;
+    run.integrator = integrator;
+    run.simulation = make_shared<Simulation>();
+    run.simulation->setConfiguration(model);
+    run.simulation->addUpdater(integrator,model);
+    run.simulation->setIntegrationTimestep(dt);
+    run.simulation->setSortPeriod(sortPeriod);
+    run.simulation->setCPUOperation(true);
+    run.simulation->setReproducible(reproducible);
+    return run;
+    };
+
+//!The number of positions that are not bit-for-bit identical in two models (all of them, if the numbers differ)
+inline int differingPositions(ForcePtr first, ForcePtr second)
+    {
+    int N = first->getNumberOfDegreesOfFreedom();
+    if(second->getNumberOfDegreesOfFreedom() != N)
+        return N;
+    ArrayHandle<double2> h_p1(first->returnPositions(),access_location::host,access_mode::read);
+    ArrayHandle<double2> h_p2(second->returnPositions(),access_location::host,access_mode::read);
+    int differing = 0;
+    for (int ii = 0; ii < N; ++ii)
+        if(memcmp(&h_p1.data[ii],&h_p2.data[ii],sizeof(double2)) != 0)
+            differing += 1;
+    return differing;
+    };
+#endif
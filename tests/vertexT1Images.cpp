@@ -0,0 +1,129 @@
+#include "std_include.h"
+
+#include "vertexQuadraticEnergy.h"
+
+/*!
+A regression test of the periodic image counters of vertices that take part in a T1 transition. The
+configuration of a vertex model is translated so that a mostly vertical edge sits just to the right of
+the left edge of the box, and the edge is shrunk below the T1 threshold. The T1 transition rotates the edge,
+so one of its vertices leaves through the box boundary. The unwrapped position of every vertex (its position
+plus its image counter times the box vectors) must then have moved by no more than the length of the edge.
+*/
+
+//!The unwrapped positions of all vertices of the model
+vector<double2> unwrappedPositions(VertexQuadraticEnergy &model)
+    {
+    ArrayHandle<double2> h_p(model.returnPositions(),access_location::host,access_mode::read);
+    ArrayHandle<int2> h_i(model.returnImages(),access_location::host,access_mode::read);
+    vector<double2> unwrapped(model.Nvertices);
+    for (int ii = 0; ii < model.Nvertices; ++ii)
+        model.Box->unwrap(h_p.data[ii],h_i.data[ii],unwrapped[ii]);
+    return unwrapped;
+    };
+
+int main(int argc, char*argv[])
+{
+    int numpts = 200; //number of cells
+    int c;
+    while((c=getopt(argc,argv,"n:")) != -1)
+        switch(c)
+        {
+            case 'n': numpts = atoi(optarg); break;
+            case '?':
+                    if(isprint(optopt))
+                        std::cerr<<"Unknown option '-" << optopt << "'.\n";
+                    else
+                        std::cerr << "Unknown option character.\n";
+                    return 1;
+            default:
+                       abort();
+        };
+
+    double threshold = 0.04;
+    VertexQuadraticEnergy model(numpts,1.0,3.9,true,false,false);
+    model.setT1Threshold(threshold);
+    double boxX, boxXY, boxYX, boxY;
+    model.Box->getBoxDims(boxX,boxXY,boxYX,boxY);
+
+    //find a mostly vertical edge, none of whose cells is a triangle
+    int vertex1 = -1, vertex2 = -1;
+    double2 edge;
+        {
+        ArrayHandle<double2> h_p(model.returnPositions(),access_location::host,access_mode::read);
+        ArrayHandle<int> h_vn(model.vertexNeighbors,access_location::host,access_mode::read);
+        ArrayHandle<int> h_vcn(model.vertexCellNeighbors,access_location::host,access_mode::read);
+        ArrayHandle<int> h_cvn(model.cellVertexNum,access_location::host,access_mode::read);
+        for (int ii = 0; ii < model.Nvertices && vertex1 < 0; ++ii)
+            for (int nn = 0; nn < 3 && vertex1 < 0; ++nn)
+                {
+                int jj = h_vn.data[3*ii+nn];
+                model.Box->minDist(h_p.data[ii],h_p.data[jj],edge);
+                bool triangle = false;
+                for (int cc = 0; cc < 3; ++cc)
+                    triangle = triangle || h_cvn.data[h_vcn.data[3*ii+cc]] == 3 || h_cvn.data[h_vcn.data[3*jj+cc]] == 3;
+                if(!triangle && fabs(edge.y) > 2.0*fabs(edge.x))
+                    {
+                    vertex1 = ii;
+                    vertex2 = jj;
+                    };
+                };
+        }
+    if(vertex1 < 0)
+        {
+        printf("no suitable edge was found\n");
+        return 1;
+        };
+
+    //shrink the edge to half the threshold, and translate everything so that its midpoint is at a
+    //distance of half its height from the left edge of the box
+        {
+        ArrayHandle<double2> h_p(model.returnPositions(),access_location::host,access_mode::readwrite);
+        ArrayHandle<int2> h_i(model.returnImages(),access_location::host,access_mode::readwrite);
+        double shrink = 0.5*(1.0-0.5*threshold/norm(edge));
+        h_p.data[vertex1].x -= shrink*edge.x;
+        h_p.data[vertex1].y -= shrink*edge.y;
+        h_p.data[vertex2].x += shrink*edge.x;
+        h_p.data[vertex2].y += shrink*edge.y;
+        double2 midpoint = h_p.data[vertex2] + 0.5*(1.0-2.0*shrink)*edge;
+        double shift = 0.5*fabs(edge.y)*(1.0-2.0*shrink) - midpoint.x;
+        for (int ii = 0; ii < model.Nvertices; ++ii)
+            {
+            h_p.data[ii].x += shift;
+            model.Box->putInBoxReal(h_p.data[ii],h_i.data[ii]);
+            };
+        }
+    vector<double2> before = unwrappedPositions(model);
+    vector<int> neighborsBefore;
+    vector<double2> wrappedBefore;
+        {
+        ArrayHandle<int> h_vn(model.vertexNeighbors,access_location::host,access_mode::read);
+        ArrayHandle<double2> h_p(model.returnPositions(),access_location::host,access_mode::read);
+        neighborsBefore.assign(h_vn.data+3*vertex1,h_vn.data+3*vertex1+3);
+        wrappedBefore.assign(h_p.data,h_p.data+model.Nvertices);
+        }
+
+    model.enforceTopology();
+
+    vector<double2> after = unwrappedPositions(model);
+    bool flipped, crossed = false;
+        {
+        ArrayHandle<int> h_vn(model.vertexNeighbors,access_location::host,access_mode::read);
+        ArrayHandle<double2> h_p(model.returnPositions(),access_location::host,access_mode::read);
+        flipped = !std::equal(neighborsBefore.begin(),neighborsBefore.end(),h_vn.data+3*vertex1);
+        for (int ii = 0; ii < model.Nvertices; ++ii)
+            crossed = crossed || fabs(h_p.data[ii].x-wrappedBefore[ii].x) > 0.5*boxX;
+        }
+    double largestJump = 0.0;
+    for (int ii = 0; ii < model.Nvertices; ++ii)
+        largestJump = max(largestJump,norm(after[ii]-before[ii]));
+
+    printf("T1 transition of vertices %i and %i: %s, %s; largest change of an unwrapped position %g\n",vertex1,vertex2,
+           flipped ? "performed" : "not performed", crossed ? "a vertex crossed the boundary" : "no vertex crossed the boundary",
+           largestJump);
+    int failures = 0;
+    if(!flipped || !crossed)
+        failures += 1;
+    if(largestJump > 2.0*threshold)
+        failures += 1;
+    return failures > 0 ? 1 : 0;
+};
@@ -125,6 +125,10 @@ int main(int argc, char*argv[])
     //run for additional timesteps, compute dynamical features, and record timing information
     dynamicalFeatures dynFeat(voronoiModel->returnPositions(),voronoiModel->Box);
     t1=clock();
+#ifdef ENABLE_PROFILING
+    //time only the production run
+    regionProfiler::reset();
+#endif
 //    cudaProfilerStart();
     for(long long int ii = 0; ii < tSteps; ++ii)
         {
@@ -141,6 +145,10 @@ int main(int argc, char*argv[])
     printf("final state:\t\t energy %f \t msd %f \t overlap %f\n",voronoiModel->computeEnergy(),dynFeat.computeMSD(voronoiModel->returnPositions()),dynFeat.computeOverlapFunction(voronoiModel->returnPositions()));
     double steptime = (t2-t1)/(double)CLOCKS_PER_SEC/tSteps;
     cout << "timestep ~ " << steptime << " per frame; " << endl;
+#ifdef ENABLE_PROFILING
+    regionProfiler::printSummary();
+    regionProfiler::writeChromeTrace("voronoiTrace.json");
+#endif
 
     if(initializeGPU)
         cudaDeviceReset();